@@ -0,0 +1,150 @@
+// COMTRADE export cost of long multi-stream SV recordings
+//
+// Usage: comtrade_export_throughput [minutes] [streams] [directory]
+//
+// Writes a recording of minutes (default 5) of streams (default 4)
+// synchronised 4000 Hz 9-2LE streams to directory (default the temp
+// directory) in each COMTRADE 2013 format, then once more the way the
+// export used to: ASCII through an ofstream, flushed every line. Reports
+// rows/s, MB/s and the export time per minute of recording; the files
+// are removed afterwards.
+
+#include "core/logger.h"
+#include "iec61850/sv/comtrade_writer.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace gateway;
+using namespace gateway::iec61850::sv;
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr uint64_t kT0 = 1700000000000000ull;
+constexpr uint32_t kSampleRate = 4000;
+
+// One second of rows, streams samples a row, smpCnt 0 .. 3999
+std::vector<SVSample> generate(size_t streams) {
+  std::vector<SVSample> rows(kSampleRate * streams);
+  for (uint32_t i = 0; i < kSampleRate; ++i) {
+    double t = static_cast<double>(i) / kSampleRate;
+    for (size_t s = 0; s < streams; ++s) {
+      SVSample &sample = rows[i * streams + s];
+      sample.smpCnt = static_cast<uint16_t>(i);
+      sample.synchronised = true;
+      for (int p = 0; p < 3; ++p) {
+        double angle = 2 * kPi * 50 * t - p * 2 * kPi / 3 + 0.1 * s;
+        sample.values[p] = static_cast<int32_t>(1414213 * std::cos(angle));
+        sample.values[kCurrentChannels + p] =
+            static_cast<int32_t>(9428090 * std::cos(angle + 0.3));
+      }
+    }
+  }
+  return rows;
+}
+
+// Calls row(samples) for every row of the recording, timestamps set
+template <typename Row>
+void forEachRow(const std::vector<SVSample> &second, size_t streams,
+                int minutes, Row row) {
+  std::vector<SVSample> samples(streams);
+  for (int s = 0; s < minutes * 60; ++s) {
+    for (uint32_t i = 0; i < kSampleRate; ++i) {
+      uint64_t timestamp = kT0 + s * 1000000ull + i * 1000000ull / kSampleRate;
+      for (size_t k = 0; k < streams; ++k) {
+        samples[k] = second[i * streams + k];
+        samples[k].timestamp = timestamp;
+      }
+      row(samples.data());
+    }
+  }
+}
+
+void report(const char *name, double elapsed, uint64_t rows, uint64_t bytes,
+            int minutes) {
+  std::printf("%-14s %7.2f s  %9.0f rows/s  %7.1f MB/s  %6.0f MB  "
+              "%6.3f s per recorded minute\n",
+              name, elapsed, rows / elapsed, bytes / elapsed / 1e6,
+              bytes / 1e6, elapsed / minutes);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  int minutes = argc > 1 ? std::atoi(argv[1]) : 5;
+  size_t streams = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4;
+  std::filesystem::path directory =
+      argc > 3 ? std::filesystem::path(argv[3])
+               : std::filesystem::temp_directory_path();
+  if (minutes < 1 || streams < 1) {
+    std::fprintf(stderr, "minutes and streams must be positive\n");
+    return 1;
+  }
+  core::Logger::init("comtrade_export_throughput.log", spdlog::level::warn);
+
+  std::vector<SVSample> second = generate(streams);
+  std::printf("%d min of %zu streams at %u Hz: %llu rows\n", minutes, streams,
+              kSampleRate,
+              static_cast<unsigned long long>(minutes) * 60 * kSampleRate);
+
+  ComtradeConfig config;
+  config.sampleRate = kSampleRate;
+  for (size_t s = 0; s < streams; ++s) {
+    ComtradeStream stream;
+    stream.name = "MU" + std::to_string(s + 1);
+    for (int ch = 0; ch < kChannels; ++ch)
+      stream.peak[ch] = 9428090;
+    config.streams.push_back(stream);
+  }
+
+  const std::string path = (directory / "comtrade_export_throughput").string();
+  for (ComtradeFormat format :
+       {ComtradeFormat::Binary, ComtradeFormat::Binary32,
+        ComtradeFormat::Float32, ComtradeFormat::Ascii}) {
+    config.format = format;
+    ComtradeWriter writer(config);
+    auto start = std::chrono::steady_clock::now();
+    if (!writer.open(path))
+      return 1;
+    forEachRow(second, streams, minutes,
+               [&](const SVSample *row) { writer.write(row); });
+    if (!writer.close())
+      return 1;
+    double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+            .count();
+    report(comtradeFormatName(format), elapsed, writer.rows(),
+           writer.bytesWritten(), minutes);
+  }
+
+  // The previous export: one formatted, flushed line per row
+  {
+    uint64_t rows = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::ofstream dat(path + ".dat");
+    forEachRow(second, streams, minutes, [&](const SVSample *row) {
+      dat << ++rows << "," << (row[0].timestamp - kT0);
+      for (size_t s = 0; s < streams; ++s) {
+        for (int ch = 0; ch < kChannels; ++ch)
+          dat << "," << row[s].values[ch];
+      }
+      dat << std::endl;
+    });
+    uint64_t bytes = static_cast<uint64_t>(dat.tellp());
+    dat.close();
+    double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+            .count();
+    report("ASCII endl", elapsed, rows, bytes, minutes);
+  }
+
+  std::filesystem::remove(path + ".cfg");
+  std::filesystem::remove(path + ".dat");
+  return 0;
+}
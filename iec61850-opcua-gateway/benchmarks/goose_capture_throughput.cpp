@@ -0,0 +1,216 @@
+// Receive cost of libiec61850's Ethernet socket vs. the TPACKET_V3 ring
+//
+// Usage: goose_capture_throughput [seconds] [subscribed_percent]
+//
+// Creates a veth pair (needs root) and floods one end with GOOSE frames,
+// <subscribed_percent> of them with the subscribed APPID and the rest with
+// other APPIDs, as on a shared process bus. The other end is read first
+// through the libiec61850 Ethernet HAL, one receive call per frame with
+// the APPID checked in user space, then through the packet ring with the
+// APPID checked by the kernel filter. Reports subscribed frames per second
+// and receiver-thread CPU time per subscribed frame.
+
+#include "core/logger.h"
+#include "iec61850/capture/packet_ring.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <libiec61850/hal_ethernet.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace gateway;
+using namespace gateway::iec61850::capture;
+
+namespace {
+
+constexpr const char *kRxInterface = "gwbench0";
+constexpr const char *kTxInterface = "gwbench1";
+constexpr uint16_t kAppId = 0x1001;
+constexpr size_t kFrameSize = 180; // A data set of a few booleans
+constexpr unsigned int kBatch = 64;
+
+struct Result {
+  uint64_t frames = 0; // Subscribed frames delivered
+  double seconds = 0.0;
+  double cpuSeconds = 0.0;
+};
+
+double threadCpuSeconds() {
+  rusage usage{};
+  getrusage(RUSAGE_THREAD, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+std::vector<uint8_t> gooseFrame(uint16_t appId) {
+  std::vector<uint8_t> f = {0x01, 0x0C, 0xCD, 0x01, 0x00, 0x01,
+                            0x02, 0x00, 0x00, 0x00, 0x00, 0x01,
+                            0x88, 0xB8, static_cast<uint8_t>(appId >> 8),
+                            static_cast<uint8_t>(appId & 0xFF)};
+  f.resize(kFrameSize, 0);
+  return f;
+}
+
+// Floods the transmit end until stopped; returns frames sent
+uint64_t flood(std::atomic<bool> &running, int subscribedPercent) {
+  int fd = socket(AF_PACKET, SOCK_RAW, 0);
+  sockaddr_ll addr{};
+  addr.sll_family = AF_PACKET;
+  addr.sll_ifindex = static_cast<int>(if_nametoindex(kTxInterface));
+  addr.sll_halen = 6;
+
+  std::vector<std::vector<uint8_t>> frames;
+  std::vector<iovec> iov(kBatch);
+  std::vector<mmsghdr> msgs(kBatch);
+  for (unsigned int i = 0; i < kBatch; ++i) {
+    bool ours = static_cast<int>(i * 100 / kBatch) < subscribedPercent;
+    frames.push_back(gooseFrame(ours ? kAppId : 0x2000 + i));
+  }
+  for (unsigned int i = 0; i < kBatch; ++i) {
+    iov[i] = {frames[i].data(), frames[i].size()};
+    msgs[i] = {};
+    msgs[i].msg_hdr.msg_name = &addr;
+    msgs[i].msg_hdr.msg_namelen = sizeof(addr);
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  uint64_t sent = 0;
+  while (running) {
+    int n = sendmmsg(fd, msgs.data(), kBatch, 0);
+    if (n > 0)
+      sent += n;
+  }
+  close(fd);
+  return sent;
+}
+
+Result runSocket(std::atomic<bool> &running) {
+  Result result;
+  EthernetSocket socket = Ethernet_createSocket(kRxInterface, nullptr);
+  if (!socket) {
+    std::fprintf(stderr, "cannot open libiec61850 socket\n");
+    return result;
+  }
+  Ethernet_setProtocolFilter(socket, kEtherTypeGoose);
+  EthernetHandleSet handles = EthernetHandleSet_new();
+  EthernetHandleSet_addSocket(handles, socket);
+
+  std::vector<uint8_t> buffer(1536);
+  double cpu = threadCpuSeconds();
+  auto start = std::chrono::steady_clock::now();
+  while (running) {
+    if (EthernetHandleSet_waitReady(handles, 10) <= 0)
+      continue;
+    int size;
+    while ((size = Ethernet_receivePacket(socket, buffer.data(),
+                                          static_cast<int>(buffer.size()))) >
+           0) {
+      uint16_t appId = (buffer[14] << 8) | buffer[15];
+      if (appId == kAppId)
+        result.frames++;
+    }
+  }
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  result.cpuSeconds = threadCpuSeconds() - cpu;
+  EthernetHandleSet_destroy(handles);
+  Ethernet_destroySocket(socket);
+  return result;
+}
+
+Result runRing(std::atomic<bool> &running, PacketRingStats &stats) {
+  Result result;
+  PacketRingConfig config;
+  config.interfaceName = kRxInterface;
+  config.etherTypes = {kEtherTypeGoose};
+  config.appIds = {kAppId};
+  PacketRing ring;
+  if (!ring.open(config)) {
+    std::fprintf(stderr, "cannot open packet ring\n");
+    return result;
+  }
+
+  double cpu = threadCpuSeconds();
+  auto start = std::chrono::steady_clock::now();
+  while (running) {
+    ring.poll(10, [&](const CapturedFrame *frames, size_t count) {
+      for (size_t i = 0; i < count; ++i)
+        result.frames += frames[i].data[15] == (kAppId & 0xFF);
+    });
+  }
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  result.cpuSeconds = threadCpuSeconds() - cpu;
+  stats = ring.getStats();
+  return result;
+}
+
+template <typename Receive>
+void measure(const char *name, int seconds, int subscribedPercent,
+             Receive receive) {
+  std::atomic<bool> receiving{true};
+  std::atomic<bool> sending{true};
+  Result result;
+  std::thread rx([&] { result = receive(receiving); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  uint64_t sent = 0;
+  std::thread tx([&] { sent = flood(sending, subscribedPercent); });
+  std::this_thread::sleep_for(std::chrono::seconds(seconds));
+  sending = false;
+  tx.join();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  receiving = false;
+  rx.join();
+
+  uint64_t expected = sent * subscribedPercent / 100;
+  std::printf("%-8s sent %10llu  delivered %10llu (%5.1f%%)  %9.0f frames/s"
+              "  %7.1f ns CPU/frame\n",
+              name, static_cast<unsigned long long>(sent),
+              static_cast<unsigned long long>(result.frames),
+              expected ? 100.0 * result.frames / expected : 0.0,
+              result.seconds > 0 ? result.frames / result.seconds : 0.0,
+              result.frames ? result.cpuSeconds * 1e9 / result.frames : 0.0);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  core::Logger::init("goose_capture_throughput.log", spdlog::level::warn);
+
+  int seconds = argc > 1 ? std::atoi(argv[1]) : 5;
+  int subscribedPercent = argc > 2 ? std::atoi(argv[2]) : 25;
+
+  std::system("ip link del gwbench0 >/dev/null 2>&1");
+  if (std::system("ip link add gwbench0 type veth peer name gwbench1 && "
+                  "ip link set gwbench0 up && ip link set gwbench1 up") !=
+      0) {
+    std::fprintf(stderr, "cannot create veth pair (run as root)\n");
+    return 1;
+  }
+
+  std::printf("%d s per run, %d%% of the GOOSE frames subscribed\n", seconds,
+              subscribedPercent);
+  measure("socket", seconds, subscribedPercent,
+          [](std::atomic<bool> &running) { return runSocket(running); });
+  PacketRingStats stats;
+  measure("ring", seconds, subscribedPercent,
+          [&](std::atomic<bool> &running) { return runRing(running, stats); });
+  std::printf("ring: %llu blocks, max batch %llu, %llu kernel drops\n",
+              static_cast<unsigned long long>(stats.blocks),
+              static_cast<unsigned long long>(stats.maxBatch),
+              static_cast<unsigned long long>(stats.drops));
+
+  std::system("ip link del gwbench0 >/dev/null 2>&1");
+  return 0;
+}
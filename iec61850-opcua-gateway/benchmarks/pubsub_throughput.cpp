@@ -0,0 +1,273 @@
+// Throughput of the PubSub publisher vs. client/server subscriptions
+//
+// Usage: pubsub_throughput [points] [interval_ms] [consumers] [seconds]
+//
+// Runs an in-process OPC UA server with <points> Double variables that all
+// change every <interval_ms>. The same data is then delivered to
+// <consumers> receivers twice: as UADP multicast on loopback, and through
+// one session + subscription per consumer. Reports delivered values per
+// second and server-process CPU time per million delivered values.
+
+#include "core/logger.h"
+#include "opcua/opcua_server.h"
+#include "opcua/pubsub/uadp_encoder.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <open62541/client_subscriptions.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace gateway;
+
+namespace {
+
+constexpr int kServerPort = 4841;
+constexpr int kPubSubPort = 14840;
+constexpr const char *kGroup = "239.0.0.1";
+
+struct Bench {
+  int points = 1000;
+  int intervalMs = 50;
+  int consumers = 4;
+  int seconds = 10;
+  UA_UInt16 ns = 1;
+  uint64_t tick = 0;
+};
+
+double cpuSeconds() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+std::string pointName(int i) { return "bench.P" + std::to_string(i); }
+
+void addPoints(UA_Server *server, const Bench &bench) {
+  for (int i = 0; i < bench.points; ++i) {
+    std::string name = pointName(i);
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Double value = 0.0;
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_DOUBLE]);
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ;
+    UA_Server_addVariableNode(
+        server, UA_NODEID_STRING(bench.ns, (char *)name.c_str()),
+        UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+        UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+        UA_QUALIFIEDNAME(bench.ns, (char *)name.c_str()),
+        UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE), attr, NULL,
+        NULL);
+  }
+}
+
+// Every point changes on every tick
+void changeValues(UA_Server *server, void *data) {
+  auto *bench = static_cast<Bench *>(data);
+  bench->tick++;
+  for (int i = 0; i < bench->points; ++i) {
+    std::string name = pointName(i);
+    UA_Double value = static_cast<double>(bench->tick) + i * 0.001;
+    UA_Variant v;
+    UA_Variant_setScalar(&v, &value, &UA_TYPES[UA_TYPES_DOUBLE]);
+    UA_Server_writeValue(
+        server, UA_NODEID_STRING(bench->ns, (char *)name.c_str()), v);
+  }
+}
+
+int openReceiver() {
+  int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  int reuse = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  int rcvbuf = 8 * 1024 * 1024;
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(kPubSubPort);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+
+  ip_mreq mreq{};
+  inet_pton(AF_INET, kGroup, &mreq.imr_multiaddr);
+  mreq.imr_interface.s_addr = htonl(INADDR_LOOPBACK);
+  setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq));
+
+  timeval timeout{0, 100000};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  return fd;
+}
+
+void report(const char *name, uint64_t values, double seconds, double cpu) {
+  std::printf("%-12s %12.0f values/s  %8.1f ms CPU per 1M values\n", name,
+              values / seconds, values ? cpu * 1e9 / values : 0.0);
+}
+
+void runPubSub(opcua::OPCUAServer &server, const Bench &bench) {
+  std::atomic<uint64_t> values{0};
+  std::atomic<bool> done{false};
+  std::vector<std::thread> receivers;
+  for (int c = 0; c < bench.consumers; ++c) {
+    receivers.emplace_back([&]() {
+      int fd = openReceiver();
+      std::vector<uint8_t> buffer(65536);
+      opcua::pubsub::DecodedNetworkMessage msg;
+      while (!done) {
+        ssize_t n = recv(fd, buffer.data(), buffer.size(), 0);
+        if (n <= 0)
+          continue;
+        if (opcua::pubsub::UadpEncoder::decodeNetworkMessage(
+                buffer.data(), static_cast<size_t>(n), msg)) {
+          for (const auto &m : msg.messages)
+            values += m.values.size();
+        }
+      }
+      close(fd);
+    });
+  }
+
+  // The publisher runs since the server started; count from here
+  auto publisher = server.getPubSubPublisher();
+  double cpu = cpuSeconds();
+  auto start = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(std::chrono::seconds(bench.seconds));
+  publisher->stop();
+  double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  cpu = cpuSeconds() - cpu;
+
+  done = true;
+  for (auto &t : receivers)
+    t.join();
+  report("pubsub", values, elapsed, cpu);
+}
+
+void dataChanged(UA_Client *client, UA_UInt32 subId, void *subContext,
+                 UA_UInt32 monId, void *monContext, UA_DataValue *value) {
+  (void)client;
+  (void)subId;
+  (void)subContext;
+  (void)monId;
+  (void)value;
+  static_cast<std::atomic<uint64_t> *>(monContext)->fetch_add(1);
+}
+
+void runClientServer(const Bench &bench) {
+  std::atomic<uint64_t> values{0};
+  std::atomic<bool> done{false};
+  std::string url = "opc.tcp://localhost:" + std::to_string(kServerPort);
+
+  double cpu = cpuSeconds();
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < bench.consumers; ++c) {
+    consumers.emplace_back([&]() {
+      UA_Client *client = UA_Client_new();
+      UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+      if (UA_Client_connect(client, url.c_str()) != UA_STATUSCODE_GOOD) {
+        std::fprintf(stderr, "connect to %s failed\n", url.c_str());
+        UA_Client_delete(client);
+        return;
+      }
+
+      UA_CreateSubscriptionRequest request =
+          UA_CreateSubscriptionRequest_default();
+      request.requestedPublishingInterval = bench.intervalMs;
+      UA_CreateSubscriptionResponse response =
+          UA_Client_Subscriptions_create(client, request, NULL, NULL, NULL);
+      for (int i = 0; i < bench.points; ++i) {
+        std::string name = pointName(i);
+        UA_MonitoredItemCreateRequest item =
+            UA_MonitoredItemCreateRequest_default(
+                UA_NODEID_STRING(bench.ns, (char *)name.c_str()));
+        item.requestedParameters.samplingInterval = bench.intervalMs;
+        UA_Client_MonitoredItems_createDataChange(
+            client, response.subscriptionId, UA_TIMESTAMPSTORETURN_NEITHER,
+            item, &values, dataChanged, NULL);
+      }
+
+      while (!done)
+        UA_Client_run_iterate(client, 10);
+      UA_Client_disconnect(client);
+      UA_Client_delete(client);
+    });
+  }
+
+  std::this_thread::sleep_for(std::chrono::seconds(bench.seconds));
+  done = true;
+  for (auto &t : consumers)
+    t.join();
+  double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  // Includes the in-process clients, which a real deployment would not pay
+  report("client/srv", values, elapsed, cpuSeconds() - cpu);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  core::Logger::init("pubsub_throughput.log", spdlog::level::warn);
+
+  Bench bench;
+  if (argc > 1)
+    bench.points = std::atoi(argv[1]);
+  if (argc > 2)
+    bench.intervalMs = std::atoi(argv[2]);
+  if (argc > 3)
+    bench.consumers = std::atoi(argv[3]);
+  if (argc > 4)
+    bench.seconds = std::atoi(argv[4]);
+
+  opcua::ServerConfig config;
+  config.port = kServerPort;
+  config.pubsub.enabled = true;
+  config.pubsub.address = kGroup;
+  config.pubsub.port = kPubSubPort;
+  config.pubsub.interfaceAddress = "127.0.0.1";
+  config.pubsub.loopback = true;
+
+  opcua::pubsub::DataSetConfig dataSet;
+  dataSet.name = "bench";
+  dataSet.intervalMs = bench.intervalMs;
+  dataSet.keyFrameCount = 10;
+  for (int i = 0; i < bench.points; ++i)
+    dataSet.points.push_back(pointName(i));
+  config.pubsub.dataSets.push_back(dataSet);
+
+  opcua::OPCUAServer server;
+  server.init(config);
+  bench.ns = server.addNamespace("urn:pubsub-benchmark");
+  UA_Server *uaServer = server.getNativeServer();
+  addPoints(uaServer, bench);
+  UA_Server_addRepeatedCallback(uaServer, changeValues, &bench,
+                                bench.intervalMs, NULL);
+
+  // Benchmark points are named by their NodeId string
+  auto publisher = server.getPubSubPublisher();
+  UA_UInt16 ns = bench.ns;
+  publisher->setResolver([ns](const std::string &ref, UA_NodeId *id) {
+    *id = UA_NODEID_STRING_ALLOC(ns, ref.c_str());
+    return true;
+  });
+
+  server.start(); // Also starts the publisher
+  std::printf("%d points every %d ms, %d consumers, %d s per run\n",
+              bench.points, bench.intervalMs, bench.consumers, bench.seconds);
+
+  runPubSub(server, bench);
+  runClientServer(bench);
+
+  server.stop();
+  return 0;
+}
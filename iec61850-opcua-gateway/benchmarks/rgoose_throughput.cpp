@@ -0,0 +1,148 @@
+// R-GOOSE receive throughput over a loopback UDP session
+//
+// Usage: rgoose_throughput [seconds] [signature]
+//
+// One thread floods 127.0.0.1 with R-GOOSE messages of a small data set,
+// signed with <signature> ("none", "hmac-sha256-80", ...); a routable
+// GOOSEReceiver decodes them into a subscriber as the gateway does.
+// Reports messages received per second and per second of receive CPU
+// time: the process's CPU time less the sender thread's, so the figure
+// is messages per second one core sustains.
+
+#include "core/logger.h"
+#include "iec61850/goose/goose_receiver.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <libiec61850/goose_publisher.h>
+#include <libiec61850/goose_subscriber.h>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+
+using namespace gateway;
+using namespace gateway::iec61850;
+
+namespace {
+
+constexpr int kPort = 30102;
+constexpr uint16_t kAppId = 0x1001;
+constexpr int kMembers = 8;
+char kGoCbRef[] = "BENCHLD0/LLN0$GO$gcb1";
+char kDataSetRef[] = "BENCHLD0/LLN0$DataSet1";
+
+double cpuSeconds(int who) {
+  rusage usage{};
+  getrusage(who, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+core::RSessionConfig session(bool publishing, const std::string &signature) {
+  core::RSessionConfig config;
+  config.enabled = true;
+  config.localAddress = "127.0.0.1";
+  config.port = kPort;
+  if (publishing)
+    config.remoteAddress = "127.0.0.1";
+  config.keys.push_back(
+      {1, "00112233445566778899aabbccddeeff", "none", signature});
+  config.activeKeyId = 1;
+  return config;
+}
+
+// Floods the session until stopped; returns messages sent and the
+// thread's CPU time
+uint64_t flood(std::atomic<bool> &running, const std::string &signature,
+               double &cpu) {
+  auto publishing = capture::openRSession(session(true, signature));
+  GoosePublisher publisher =
+      publishing ? GoosePublisher_createRemote(publishing.get(), kAppId)
+                 : nullptr;
+  if (!publisher) {
+    std::fprintf(stderr, "cannot open publishing session\n");
+    return 0;
+  }
+  GoosePublisher_setGoCbRef(publisher, kGoCbRef);
+  GoosePublisher_setDataSetRef(publisher, kDataSetRef);
+  GoosePublisher_setTimeAllowedToLive(publisher, 1000);
+  LinkedList values = LinkedList_create();
+  for (int i = 0; i < kMembers; ++i)
+    LinkedList_add(values, MmsValue_newBoolean(i % 2 == 0));
+
+  double started = cpuSeconds(RUSAGE_THREAD);
+  uint64_t sent = 0;
+  while (running) {
+    if (GoosePublisher_publish(publisher, values) == 0)
+      sent++;
+  }
+  cpu = cpuSeconds(RUSAGE_THREAD) - started;
+
+  LinkedList_destroyDeep(values,
+                         (LinkedListValueDeleteFunction)MmsValue_delete);
+  GoosePublisher_destroy(publisher);
+  return sent;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  core::Logger::init("rgoose_throughput.log", spdlog::level::warn);
+
+  int seconds = argc > 1 ? std::atoi(argv[1]) : 5;
+  std::string signature = argc > 2 ? argv[2] : "hmac-sha256-256";
+
+  goose::GOOSEReceiver receiver(session(false, signature));
+  std::atomic<uint64_t> received{0};
+  GooseSubscriber subscriber = GooseSubscriber_create(kGoCbRef, nullptr);
+  GooseSubscriber_setAppId(subscriber, kAppId);
+  GooseSubscriber_setListener(
+      subscriber,
+      [](GooseSubscriber, void *parameter) {
+        auto *count = static_cast<std::atomic<uint64_t> *>(parameter);
+        count->store(count->load(std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
+      },
+      &received);
+  capture::DispatchKey key;
+  key.appId = kAppId;
+  receiver.addSubscriber(subscriber, key);
+  receiver.start();
+  if (!receiver.isRunning()) {
+    std::fprintf(stderr, "cannot start receiver on %s\n",
+                 receiver.getName().c_str());
+    return 1;
+  }
+
+  std::atomic<bool> sending{true};
+  uint64_t sent = 0;
+  double senderCpu = 0.0;
+  double cpu = cpuSeconds(RUSAGE_SELF);
+  auto start = std::chrono::steady_clock::now();
+  std::thread tx([&] { sent = flood(sending, signature, senderCpu); });
+  std::this_thread::sleep_for(std::chrono::seconds(seconds));
+  sending = false;
+  tx.join();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  double wall =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+  double receiveCpu = cpuSeconds(RUSAGE_SELF) - cpu - senderCpu;
+  receiver.stop();
+
+  uint64_t delivered = received.load();
+  std::printf("%s, %d s: sent %llu  delivered %llu (%5.1f%%)\n",
+              signature.c_str(), seconds, static_cast<unsigned long long>(sent),
+              static_cast<unsigned long long>(delivered),
+              sent ? 100.0 * delivered / sent : 0.0);
+  std::printf("%9.0f messages/s  %9.0f messages/s per core"
+              "  %7.1f us CPU/message\n",
+              wall > 0 ? delivered / wall : 0.0,
+              receiveCpu > 0 ? delivered / receiveCpu : 0.0,
+              delivered ? receiveCpu * 1e6 / delivered : 0.0);
+
+  receiver.removeSubscriber(subscriber);
+  GooseSubscriber_destroy(subscriber);
+  return 0;
+}
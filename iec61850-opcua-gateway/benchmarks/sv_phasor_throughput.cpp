@@ -0,0 +1,97 @@
+// Per-stream CPU cost of the SV analytics stage
+//
+// Usage: sv_phasor_throughput [seconds]
+//
+// Feeds pre-generated 9-2LE samples of a balanced three-phase system,
+// 2 % off nominal, through a SampleClock and a PhasorEstimator as the
+// analytics stage does for every stream, at each 9-2LE rate. Reports
+// nanoseconds per sample, the share of one core a real-time stream
+// takes, and streams one core sustains.
+
+#include "iec61850/sv/phasor_estimator.h"
+#include "iec61850/sv/sample_clock.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace gateway::iec61850::sv;
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr uint64_t kT0 = 1700000000000000ull;
+
+struct Rate {
+  uint32_t sampleRate;
+  uint16_t samplesPerCycle;
+  uint16_t nominalFrequency;
+};
+
+// One second of samples, smpCnt 0 .. rate - 1
+std::vector<SVSample> generate(const Rate &rate) {
+  std::vector<SVSample> samples(rate.sampleRate);
+  double frequency = rate.nominalFrequency * 1.02;
+  for (uint32_t i = 0; i < rate.sampleRate; ++i) {
+    SVSample &sample = samples[i];
+    sample.smpCnt = static_cast<uint16_t>(i);
+    sample.synchronised = true;
+    double t = static_cast<double>(i) / rate.sampleRate;
+    for (int p = 0; p < 3; ++p) {
+      double angle = 2 * kPi * frequency * t - p * 2 * kPi / 3;
+      sample.values[p] = static_cast<int32_t>(1414213 * std::cos(angle));
+      sample.values[kCurrentChannels + p] =
+          static_cast<int32_t>(9428090 * std::cos(angle + 0.3));
+    }
+  }
+  return samples;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  int seconds = argc > 1 ? std::atoi(argv[1]) : 2;
+
+  for (Rate rate : {Rate{4000, 80, 50}, Rate{4800, 80, 60},
+                    Rate{12800, 256, 50}, Rate{15360, 256, 60}}) {
+    std::vector<SVSample> samples = generate(rate);
+    SVStreamFormat format;
+    format.sampleRate = rate.sampleRate;
+    format.samplesPerCycle = rate.samplesPerCycle;
+    format.nominalFrequency = rate.nominalFrequency;
+    format.detected = true;
+
+    SampleClock clock;
+    PhasorEstimator estimator(format);
+    uint64_t processed = 0;
+    uint64_t cycles = 0;
+    double checksum = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::seconds(seconds);
+    for (uint64_t second = 0; std::chrono::steady_clock::now() < deadline;
+         ++second) {
+      uint64_t arrival = kT0 + second * 1000000;
+      for (SVSample sample : samples) {
+        sample.timestamp = clock.timestamp(sample.smpCnt, true, arrival);
+        if (estimator.add(sample)) {
+          cycles++;
+          checksum += estimator.result().frequency;
+        }
+      }
+      processed += samples.size();
+    }
+    double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+            .count();
+
+    double nsPerSample = processed ? elapsed * 1e9 / processed : 0.0;
+    double coreShare = nsPerSample * rate.sampleRate / 1e9;
+    std::printf("%5u Hz, %3u/cycle: %6.1f ns/sample  %6.3f %% core/stream"
+                "  %6.0f streams/core  (f = %.3f Hz)\n",
+                rate.sampleRate, rate.samplesPerCycle, nsPerSample,
+                100.0 * coreShare, coreShare > 0 ? 1.0 / coreShare : 0.0,
+                cycles ? checksum / cycles : 0.0);
+  }
+  return 0;
+}
@@ -0,0 +1,104 @@
+// Min/max waveform envelope cost over recorded SV segments
+//
+// Usage: sv_waveform_throughput [minutes] [width] [directory]
+//
+// Records minutes (default 10) of a 4000 Hz 9-2LE stream into 60 s
+// segments in directory (default the temp directory), then computes the
+// envelope of spans from 10 ms to the whole recording at width (default
+// 1000) buckets. Reports the time per request, samples/s scanned and the
+// response size against the raw samples as JSON; the segments are
+// removed afterwards.
+
+#include "iec61850/sv/waveform_envelope.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace gateway::iec61850::sv;
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr uint64_t kT0 = 1700000000000000ull;
+constexpr uint32_t kSampleRate = 4000;
+constexpr size_t kSegmentSamples = 60 * kSampleRate;
+
+// Rough JSON size of one raw sample: a timestamp and eight values
+constexpr size_t kJsonBytesPerSample = 16 + kChannels * 10;
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int minutes = argc > 1 ? std::atoi(argv[1]) : 10;
+  size_t width = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+  std::filesystem::path directory =
+      argc > 3 ? std::filesystem::path(argv[3])
+               : std::filesystem::temp_directory_path();
+  directory /= "sv_waveform_throughput";
+  std::filesystem::create_directories(directory);
+
+  std::vector<std::shared_ptr<SampleSegment>> segments;
+  uint64_t total = uint64_t(minutes) * 60 * kSampleRate;
+  for (uint64_t n = 0; n < total; ++n) {
+    if (n % kSegmentSamples == 0) {
+      char name[32];
+      std::snprintf(name, sizeof(name), "%04llu.svseg",
+                    static_cast<unsigned long long>(n / kSegmentSamples));
+      segments.push_back(SampleSegment::create((directory / name).string(),
+                                               n, kSegmentSamples));
+      if (!segments.back())
+        return 1;
+      segments.back()->retire();
+    }
+    SVSample s;
+    s.timestamp = kT0 + n * 1000000 / kSampleRate;
+    s.smpCnt = static_cast<uint16_t>(n % kSampleRate);
+    double t = static_cast<double>(n) / kSampleRate;
+    for (int p = 0; p < 3; ++p) {
+      double angle = 2 * kPi * 50 * t - p * 2 * kPi / 3;
+      s.values[p] = static_cast<int32_t>(1414213 * std::cos(angle));
+      s.values[kCurrentChannels + p] =
+          static_cast<int32_t>(9428090 * std::cos(angle + 0.3));
+    }
+    segments.back()->append(s);
+  }
+
+  std::printf("%d min at %u Hz, %zu buckets\n", minutes, kSampleRate, width);
+  std::printf("%10s %10s %10s %12s %10s %12s\n", "span s", "samples", "ms",
+              "Msamples/s", "bytes", "JSON bytes");
+  const double spans[] = {0.01, 0.1, 1, 10, 60, 600, 3600};
+  for (double span : spans) {
+    uint64_t spanUs = static_cast<uint64_t>(span * 1e6);
+    if (spanUs > total * 1000000 / kSampleRate)
+      break;
+    // Centre of the recording, across a segment boundary
+    uint64_t from = kT0 + total * 1000000 / kSampleRate / 2 - spanUs / 2;
+    // As SVRecorder::waveform: no more buckets than sample periods
+    size_t buckets = static_cast<size_t>(
+        std::min<uint64_t>(width, spanUs * kSampleRate / 1000000));
+    int repeats = span < 10 ? 200 : 5;
+    auto begin = std::chrono::steady_clock::now();
+    WaveformEnvelope e;
+    for (int i = 0; i < repeats; ++i)
+      e = envelope(segments, from, from + spanUs, buckets);
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - begin)
+                    .count() /
+                repeats;
+    std::string body = encodeEnvelope(e, 0xFF);
+    std::printf("%10.2f %10llu %10.3f %12.1f %10zu %12llu\n", span,
+                static_cast<unsigned long long>(e.samples), ms,
+                e.samples / ms / 1000.0, body.size(),
+                static_cast<unsigned long long>(e.samples *
+                                                kJsonBytesPerSample));
+  }
+
+  segments.clear();
+  std::filesystem::remove_all(directory);
+  return 0;
+}
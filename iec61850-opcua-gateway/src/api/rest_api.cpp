@@ -1,12 +1,21 @@
 #include "rest_api.h"
+#include "core/config_parser.h"
 #include "core/logger.h"
 #include "httplib/httplib.h"
+#include "iec61850/goose/goose_publisher.h"
+#include "iec61850/goose/goose_service.h"
 #include "iec61850/mms/mms_connection.h"
 #include "iec61850/scl/scd_generator.h"
 #include "iec61850/scl/scl_generator.h"
 #include "iec61850/scl/scl_parser.h"
+#include "iec61850/sv/sv_analytics.h"
+#include "iec61850/sv/sv_recorder.h"
+#include "opcua/history/history_backend.h"
 #include "opcua/namespace/namespace_builder.h"
 #include "opcua/opcua_server.h"
+#include "opcua/sv/harmonic_nodes.h"
+#include "opcua/sv/health_nodes.h"
+#include "opcua/subscription/subscription_manager.h"
 #include "topology_parser.h"
 #include <filesystem>
 #include <fstream>
@@ -43,6 +52,37 @@ RESTApi::RESTApi(int port, int updateIntervalMs,
       opcua_server_(opcua_server) {
   if (opcua_server_) {
     dataBinder_ = std::make_shared<opcua::DataBinder>(opcua_server_);
+    namespaceBuilder_ = std::make_shared<opcua::ns::NamespaceBuilder>(
+        opcua_server_, dataBinder_);
+    namespaceBuilder_->setSnapshotPath("./config/station.snapshot");
+
+    // PubSub data sets name IEC61850 references; publish their bound nodes
+    if (auto publisher = opcua_server_->getPubSubPublisher()) {
+      std::weak_ptr<opcua::DataBinder> binder = dataBinder_;
+      publisher->setResolver([binder](const std::string &ref, UA_NodeId *id) {
+        auto b = binder.lock();
+        return b && b->getNodeId(ref, id);
+      });
+    }
+
+    // Unobserved points fall back to a tenth of the configured rate
+    subscriptionManager_ =
+        std::make_shared<opcua::subscription::SubscriptionManager>(
+            opcua_server_, dataBinder_);
+    subscriptionManager_->setIntervals(updateIntervalMs_,
+                                       10 * updateIntervalMs_, 50);
+
+    // 8 x 4 KiB per point holds hours of a regularly polled value
+    historyStore_ = std::make_shared<storage::HistoryStore>(4096, 8);
+    historyBackend_ = std::make_shared<opcua::history::HistoryBackend>(
+        opcua_server_, historyStore_);
+
+    // Points deleted by an SCD update take their history with them
+    std::weak_ptr<storage::HistoryStore> history = historyStore_;
+    namespaceBuilder_->setRemovedNodeHook([history](const UA_NodeId &nodeId) {
+      if (auto store = history.lock())
+        store->remove(opcua::history::HistoryBackend::nodeKey(nodeId));
+    });
   }
 }
 
@@ -55,13 +95,39 @@ void RESTApi::start() {
 
   server_ptr_ = new httplib::Server();
 
-  // Load existing SCD file if it exists
+  // Loaded once for the services below; left at the defaults, which
+  // enable none of them, if the file is missing or cannot be read
+  std::string configPath = "./config/gateway.yaml";
+  core::GatewayConfig config;
+  if (std::filesystem::exists(configPath)) {
+    try {
+      config = core::ConfigParser::load(configPath);
+    } catch (const std::exception &e) {
+      LOG_WARN("Failed to load {}: {}", configPath, e.what());
+    }
+  }
+
+  // The GOOSE services need the full model, so the SCD is parsed once and
+  // shared with the namespace. Without them a current namespace snapshot
+  // spares the parse entirely.
   std::string scdPath = "./config/station.scd";
-  if (std::filesystem::exists(scdPath) && opcua_server_ && dataBinder_) {
+  bool haveScd = std::filesystem::exists(scdPath);
+  std::vector<iec61850::IEDConfig> scdIeds;
+  bool scdParsed = false;
+  if (haveScd && (config.goose.enabled || config.goose.publisher.enabled)) {
     try {
-      using namespace gateway::opcua::ns;
-      NamespaceBuilder builder(opcua_server_, dataBinder_);
-      builder.buildFromSCD(scdPath);
+      iec61850::SCLParser parser;
+      scdIeds = parser.parse(scdPath);
+      scdParsed = true;
+    } catch (const std::exception &e) {
+      LOG_WARN("Failed to parse {}: {}", scdPath, e.what());
+    }
+  }
+
+  // Load existing SCD file if it exists
+  if (haveScd && namespaceBuilder_) {
+    try {
+      namespaceBuilder_->buildFromSCD(scdPath, scdParsed ? &scdIeds : nullptr);
       LOG_INFO("Loaded OPC UA namespace from existing SCD: {}", scdPath);
     } catch (const std::exception &e) {
       LOG_WARN("Failed to load SCD on startup: {}", e.what());
@@ -75,8 +141,115 @@ void RESTApi::start() {
   }
 
   // Auto-connect to enabled IEDs from configuration
-  std::string configPath = "./config/gateway.yaml";
   if (std::filesystem::exists(configPath)) {
+    // Before GOOSE, whose members may trigger it
+    try {
+      if (config.sv.enabled && config.sv.recording.enabled) {
+        svRecorder_ = std::make_shared<iec61850::sv::SVRecorder>(config.sv);
+        if (!svRecorder_->start())
+          svRecorder_.reset();
+      }
+    } catch (const std::exception &e) {
+      LOG_WARN("Failed to start SV recording: {}", e.what());
+    }
+
+    try {
+      if (config.goose.enabled) {
+        gooseService_ =
+            std::make_shared<iec61850::goose::GOOSEService>(config.goose);
+        auto *routable = gooseService_->getRoutableManager();
+        if (dataBinder_ || svRecorder_) {
+          std::weak_ptr<opcua::DataBinder> binder = dataBinder_;
+          std::weak_ptr<iec61850::sv::SVRecorder> recorder = svRecorder_;
+          auto sink = [binder, recorder](const std::string &ref,
+                                         MmsValue *value) {
+            if (auto b = binder.lock())
+              b->updateValue(ref, value);
+            if (auto r = recorder.lock())
+              r->onGooseValue(ref, value);
+          };
+          gooseService_->getManager().setValueSink(sink);
+          if (routable)
+            routable->setValueSink(sink);
+        }
+        // Every GoCB of the active SCD is subscribed, on both transports
+        if (scdParsed) {
+          gooseService_->getManager().subscribeAll(scdIeds);
+          if (routable)
+            routable->subscribeAll(scdIeds);
+        }
+        gooseService_->start();
+      }
+    } catch (const std::exception &e) {
+      LOG_WARN("Failed to start GOOSE service: {}", e.what());
+    }
+
+    try {
+      if (config.goose.publisher.enabled) {
+        goosePublisher_ = std::make_shared<iec61850::goose::GOOSEPublisher>(
+            config.goose.publisher);
+        if (dataBinder_) {
+          std::weak_ptr<iec61850::goose::GOOSEPublisher> publisher =
+              goosePublisher_;
+          dataBinder_->setWriteHook(
+              [publisher](const std::string &ref, const MmsValue *value) {
+                auto p = publisher.lock();
+                return p && p->update(ref, value);
+              });
+        }
+        if (scdParsed)
+          configureGoosePublisher(scdIeds);
+        goosePublisher_->start();
+      }
+    } catch (const std::exception &e) {
+      LOG_WARN("Failed to start GOOSE publisher: {}", e.what());
+    }
+
+    try {
+      if (config.sv.enabled) {
+        svAnalytics_ = std::make_shared<iec61850::sv::SVAnalytics>(config.sv);
+        if (dataBinder_) {
+          std::weak_ptr<opcua::DataBinder> binder = dataBinder_;
+          svAnalytics_->setValueSink(
+              [binder](const std::string &ref, MmsValue *value) {
+                if (auto b = binder.lock())
+                  b->updateValue(ref, value);
+              });
+        }
+        if (config.sv.harmonics.enabled && opcua_server_) {
+          harmonicNodes_ =
+              std::make_shared<opcua::sv::HarmonicNodes>(opcua_server_);
+          std::weak_ptr<opcua::sv::HarmonicNodes> nodes = harmonicNodes_;
+          svAnalytics_->setHarmonicSink(
+              [nodes](const core::SVStreamConfig &stream,
+                      const iec61850::sv::HarmonicResult &result) {
+                if (auto n = nodes.lock())
+                  n->update(
+                      iec61850::sv::streamName(stream.appId, stream.svID),
+                      result);
+              });
+        }
+        if (opcua_server_) {
+          svHealthNodes_ =
+              std::make_shared<opcua::sv::HealthNodes>(opcua_server_);
+          std::weak_ptr<opcua::sv::HealthNodes> nodes = svHealthNodes_;
+          svAnalytics_->setHealthSink(
+              [nodes](const core::SVStreamConfig &stream,
+                      const iec61850::sv::SVHealthSnapshot &health) {
+                if (auto n = nodes.lock())
+                  n->update(
+                      iec61850::sv::streamName(stream.appId, stream.svID),
+                      health);
+              });
+        }
+        if (svRecorder_)
+          svAnalytics_->setRecorder(svRecorder_);
+        svAnalytics_->start();
+      }
+    } catch (const std::exception &e) {
+      LOG_WARN("Failed to start SV analytics: {}", e.what());
+    }
+
     try {
       std::ifstream file(configPath);
       std::string line;
@@ -179,6 +352,22 @@ void RESTApi::stop() {
       pollingThread_.join();
     }
 
+    if (gooseService_) {
+      gooseService_->stop();
+    }
+
+    if (goosePublisher_) {
+      goosePublisher_->stop();
+    }
+
+    if (svAnalytics_) {
+      svAnalytics_->stop();
+    }
+
+    if (svRecorder_) {
+      svRecorder_->stop();
+    }
+
     if (server_ptr_) {
       delete static_cast<httplib::Server *>(server_ptr_);
       server_ptr_ = nullptr;
@@ -188,15 +377,186 @@ void RESTApi::stop() {
   }
 }
 
+size_t RESTApi::configureGoosePublisher(
+    const std::vector<iec61850::IEDConfig> &ieds) {
+  size_t count = goosePublisher_->configure(ieds);
+  if (!dataBinder_ || !opcua_server_)
+    return count;
+
+  // Published points are status the gateway owns, read-only as built
+  UA_Server *server = opcua_server_->getNativeServer();
+  for (const auto &ref : goosePublisher_->getReferences()) {
+    UA_NodeId nodeId;
+    if (!dataBinder_->getNodeId(ref, &nodeId))
+      continue;
+    UA_Byte accessLevel = UA_ACCESSLEVELMASK_READ;
+    UA_Server_readAccessLevel(server, nodeId, &accessLevel);
+    UA_Server_writeAccessLevel(server, nodeId,
+                               accessLevel | UA_ACCESSLEVELMASK_WRITE);
+    dataBinder_->setWriteCallback(nodeId);
+    UA_NodeId_clear(&nodeId);
+  }
+  return count;
+}
+
+namespace {
+
+// Most buckets /api/v1/sv/waveform returns, pixels across an 8K display
+constexpr uint64_t kMaxWaveformWidth = 8192;
+
+// Unsigned query parameter, @p fallback if absent or not a number
+uint64_t numberParam(const httplib::Request &req, const char *name,
+                     uint64_t fallback) {
+  if (!req.has_param(name))
+    return fallback;
+  std::string text = req.get_param_value(name);
+  char *end = nullptr;
+  uint64_t value = std::strtoull(text.c_str(), &end, 10);
+  return !text.empty() && *end == '\0' ? value : fallback;
+}
+
+// Mask of the SV channels named in a comma-separated list, all if empty
+uint16_t channelMask(const std::string &list) {
+  if (list.empty())
+    return (1u << iec61850::sv::kChannels) - 1;
+  uint16_t mask = 0;
+  std::stringstream names(list);
+  std::string name;
+  while (std::getline(names, name, ',')) {
+    for (size_t ch = 0; ch < iec61850::sv::kChannelNames.size(); ++ch) {
+      if (name == iec61850::sv::kChannelNames[ch])
+        mask |= 1u << ch;
+    }
+  }
+  return mask;
+}
+
+topology::GOOSEStreamStats
+streamStats(const iec61850::goose::SubscriptionStats &sub) {
+  const auto &s = sub.supervision;
+  topology::GOOSEStreamStats stream;
+  stream.gocbRef = sub.goCbRef;
+  stream.dataSet = sub.dataSet;
+  stream.status = !s.messages ? "waiting" : s.alive ? "online" : "expired";
+  stream.messageRate = s.messageRate;
+  stream.stateChangeRate = s.stateChangeRate;
+  stream.messages = s.messages;
+  stream.stateChanges = s.stateChanges;
+  stream.sqNumGaps = s.sqNumGaps;
+  stream.stNumGaps = s.stNumGaps;
+  stream.talExpiries = s.talExpiries;
+  stream.confRevMismatches = s.confRevMismatches;
+  stream.ndsComFrames = s.ndsComFrames;
+  stream.duplicates = sub.duplicates;
+  stream.msSinceLast = s.msSinceLast;
+  stream.jitterHistogram.assign(s.jitter.begin(), s.jitter.end());
+  return stream;
+}
+
+} // namespace
+
+void RESTApi::fillGooseStatistics(topology::TopologyInfo &topology) const {
+  using namespace iec61850::goose;
+
+  topology.jitterBucketsUs.assign(kJitterBucketBoundsUs.begin(),
+                                  kJitterBucketBoundsUs.end());
+  if (!gooseService_)
+    return;
+
+  const auto &manager = gooseService_->getManager();
+  auto interfaces = gooseService_->getInterfaces();
+  auto lans = manager.getLanStats();
+  auto subscriptions = manager.getStats();
+
+  uint64_t sqNumGaps = 0;
+  bool anyAlive = false;
+  for (const auto &sub : subscriptions) {
+    const auto &s = sub.supervision;
+    sqNumGaps += s.sqNumGaps;
+    anyAlive = anyAlive || s.alive;
+    topology.streams.push_back(streamStats(sub));
+  }
+
+  // R-GOOSE subscribes the same GoCBs; only those actually routed are shown
+  if (const auto *routable = gooseService_->getRoutableManager()) {
+    const auto *receiver = gooseService_->getRoutableReceiver();
+    topology.routable.endpoint = receiver->getName();
+    topology.routable.running = receiver->isRunning();
+    topology.routable.messages = receiver->getDecodedFrames();
+    topology.routable.unknownKeys = receiver->getUnknownKeyMessages();
+    for (const auto &sub : routable->getStats()) {
+      if (!sub.supervision.messages)
+        continue;
+      topology.streams.push_back(streamStats(sub));
+      topology.streams.back().routable = true;
+    }
+  }
+
+  // A LAN's losses are the frames only its partner delivered; without a
+  // partner they show up as sequence gaps
+  auto fill = [&](topology::NetworkStats &net, size_t lan) {
+    if (lan < interfaces.size())
+      net.interface = interfaces[lan];
+    if (lan >= lans.size())
+      return;
+    const auto &stats = lans[lan];
+    uint64_t lost = lans.size() > 1 ? stats.missing : sqNumGaps;
+    uint64_t expected = stats.arrivals + lost;
+    net.messageRate = static_cast<int>(stats.messageRate + 0.5);
+    net.errors = static_cast<int>(lost);
+    net.quality = expected ? 100.0 * static_cast<double>(stats.arrivals) /
+                                 static_cast<double>(expected)
+                           : 0.0;
+    net.avgSkewUs = stats.avgSkewUs;
+    net.maxSkewUs = stats.maxSkewUs;
+    net.filtered = stats.filtered;
+    net.dispatchNs = stats.dispatchNs;
+    net.dispatchProbes = stats.dispatchProbes;
+    if (!gooseService_->isRunning() || stats.messageRate == 0.0)
+      net.status = "offline";
+    else if (net.quality < 99.0 || (!anyAlive && !subscriptions.empty()))
+      net.status = "degraded";
+    else
+      net.status = "online";
+  };
+  fill(topology.networkA, 0);
+  if (lans.size() > 1) {
+    // Two LANs are PRP unless the SCD already named the redundancy type
+    if (topology.type == topology::RedundancyType::NONE)
+      topology.type = topology::RedundancyType::PRP;
+    fill(topology.networkB, 1);
+  }
+}
+
 void RESTApi::pollData() {
-  LOG_INFO("Starting data polling loop (interval: {}ms)", updateIntervalMs_);
+  using Clock = std::chrono::steady_clock;
+
+  // Upper bound on the scheduler sleep, so new demand is served promptly
+  constexpr auto kMaxPollSleep = std::chrono::milliseconds(100);
+
+  LOG_INFO("Starting demand-driven polling loop (default interval: {}ms)",
+           updateIntervalMs_);
+  uint64_t generation = 0;
+  bool haveReferences = false;
+  Clock::time_point nextDue = Clock::now();
+
   while (running_) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(updateIntervalMs_));
+    // Sleep until the next poll is due
+    std::this_thread::sleep_until(
+        std::min(nextDue, Clock::now() + kMaxPollSleep));
 
-    if (!dataBinder_)
+    if (!dataBinder_ || !subscriptionManager_)
       continue;
 
-    auto refs = dataBinder_->getBoundReferences();
+    // Hand new or removed bindings to the scheduler
+    uint64_t current = dataBinder_->getGeneration();
+    if (!haveReferences || current != generation) {
+      generation = current;
+      haveReferences = true;
+      subscriptionManager_->setReferences(dataBinder_->getBoundReferences());
+    }
+
+    auto refs = subscriptionManager_->collectDue(Clock::now(), &nextDue);
     if (refs.empty())
       continue;
 
@@ -229,74 +589,30 @@ void RESTApi::pollData() {
           size_t slashPos = fullRef.find('/');
           std::string objRef = fullRef.substr(slashPos + 1);
 
+          // Read exactly the DA the point was bound to, with its FC
+          opcua::DataBinder::ReadPlan plan;
+          if (!dataBinder_->getReadPlan(fullRef, &plan) ||
+              plan.attribute.empty()) {
+            LOG_DEBUG("No read plan for {}", fullRef);
+            continue;
+          }
+
           try {
             IedClientError error;
-            MmsValue *value = nullptr;
-
-            // Try reading .stVal FIRST for SPS/DPS/Boolean types (ST FC)
-            std::string stValRef = objRef + ".stVal";
-            value =
-                IedConnection_readObject(conn->getNativeConnection(), &error,
-                                         stValRef.c_str(), IEC61850_FC_ST);
-
-            if (error == IED_ERROR_OK && value) {
-              MmsType type = MmsValue_getType(value);
-              if (type == MMS_BOOLEAN) {
-                // This is a real Boolean status value - use it
-                bool boolVal = MmsValue_getBoolean(value);
-                LOG_INFO("✓ Read {} = {}", stValRef, boolVal);
-                dataBinder_->updateValue(fullRef, value);
-                MmsValue_delete(value);
-                continue; // Found boolean - done
-              } else if (type == MMS_INTEGER || type == MMS_UNSIGNED ||
-                         type == MMS_BIT_STRING) {
-                // Handle Enum/Integer types (Beh, Health, Mod, etc.)
-                int intVal = 0;
-                if (type == MMS_INTEGER)
-                  intVal = MmsValue_toInt32(value);
-                else if (type == MMS_UNSIGNED)
-                  intVal = MmsValue_toUint32(value);
-                else if (type == MMS_BIT_STRING)
-                  intVal = MmsValue_getBitStringAsInteger(value);
-
-                LOG_INFO("✓ Read {} = {} (Enum/Int)", stValRef, intVal);
-                dataBinder_->updateValue(fullRef, value);
-                MmsValue_delete(value);
-                continue;
-              } else {
-                // stVal exists but not Boolean/Int/Enum - might be complex or
-                // unexpected Don't use this value, delete and try .mag.f
-                // instead
-                MmsValue_delete(value);
-              }
-            }
-
-            // Try reading .mag.f for MV types (MX FC)
-            std::string magfRef = objRef + ".mag.f";
-            value =
-                IedConnection_readObject(conn->getNativeConnection(), &error,
-                                         magfRef.c_str(), IEC61850_FC_MX);
-
-            if (error == IED_ERROR_OK && value) {
-              float floatVal = MmsValue_toFloat(value);
-              LOG_INFO("✓ Read {} = {}", magfRef, floatVal);
-              dataBinder_->updateValue(fullRef, value);
-              MmsValue_delete(value);
-              continue;
-            }
+            std::string daRef = objRef + "." + plan.attribute;
+            MmsValue *value = IedConnection_readObject(
+                conn->getNativeConnection(), &error, daRef.c_str(),
+                FunctionalConstraint_fromString(plan.fc.c_str()));
 
-            // Fallback: try reading the DO directly
-            value =
-                IedConnection_readObject(conn->getNativeConnection(), &error,
-                                         objRef.c_str(), IEC61850_FC_ST);
             if (error == IED_ERROR_OK && value) {
-              LOG_INFO("✓ Read DO directly: {}", objRef);
+              LOG_DEBUG("✓ Read {} [{}]", daRef, plan.fc);
               dataBinder_->updateValue(fullRef, value);
-              MmsValue_delete(value);
             } else {
-              LOG_WARN("✗ Failed to read {}, error: {}", objRef, (int)error);
+              LOG_WARN("✗ Failed to read {} [{}], error: {}", daRef, plan.fc,
+                       (int)error);
             }
-
+            if (value)
+              MmsValue_delete(value);
           } catch (const std::exception &e) {
             LOG_WARN("Exception while polling {}: {}", fullRef, e.what());
           }
@@ -384,8 +700,7 @@ void RESTApi::broadcast(const std::string &message) {
 }
 
 // Helper function to regenerate SCD from all ICD files
-void regenerateSCD(std::shared_ptr<opcua::OPCUAServer> opcua_server,
-                   std::shared_ptr<opcua::DataBinder> binder) {
+void regenerateSCD(std::shared_ptr<opcua::ns::NamespaceBuilder> builder) {
   using namespace gateway::iec61850::scl;
 
   try {
@@ -455,15 +770,12 @@ void regenerateSCD(std::shared_ptr<opcua::OPCUAServer> opcua_server,
 
     LOG_INFO("Generated SCD with {} IEDs at ./config/station.scd", icdCount);
 
-    // Rebuild OPC UA namespace
-    if (opcua_server) {
+    // Apply only what changed to the OPC UA namespace
+    if (builder) {
       try {
-        using namespace gateway::opcua::ns;
-        NamespaceBuilder builder(opcua_server, binder);
-        builder.buildFromSCD("./config/station.scd");
-        LOG_INFO("Rebuilt OPC UA namespace from SCD");
+        builder->updateFromSCD("./config/station.scd");
       } catch (const std::exception &e) {
-        LOG_ERROR("Failed to rebuild OPC UA namespace: {}", e.what());
+        LOG_ERROR("Failed to update OPC UA namespace: {}", e.what());
       }
     }
 
@@ -816,7 +1128,7 @@ void RESTApi::runServer() {
         response["icd_path"] = icdPath;
 
         // Regenerate SCD from all ICDs and rebuild OPC UA namespace
-        regenerateSCD(opcua_server_, dataBinder_);
+        regenerateSCD(namespaceBuilder_);
 
       } catch (const std::exception &e) {
         LOG_ERROR("Failed to generate ICD for {}: {}", iedName, e.what());
@@ -1115,15 +1427,14 @@ void RESTApi::runServer() {
   });
 
   // API: Topology
-  svr.Get("/api/v1/topology", [](const httplib::Request &,
-                                 httplib::Response &res) {
-    // In production, use actual SCD file path from config
-    // For now, generate mock topology
+  svr.Get("/api/v1/topology", [this](const httplib::Request &,
+                                     httplib::Response &res) {
     gateway::topology::TopologyParser parser;
 
     // Try to load from configured SCD file
     // If file doesn't exist, parser will return default topology
     auto topology = parser.parseFromSCD("./config/station.scd");
+    fillGooseStatistics(topology);
 
     std::string jsonResponse = parser.toJSON(topology);
 
@@ -1133,6 +1444,347 @@ void RESTApi::runServer() {
     LOG_INFO("Topology API called, returned {} IEDs", topology.nodes.size());
   });
 
+  // API: Live GOOSE statistics, polled by the GOOSE monitor
+  svr.Get("/api/v1/goose/statistics", [this](const httplib::Request &,
+                                             httplib::Response &res) {
+    gateway::topology::TopologyParser parser;
+    gateway::topology::TopologyInfo topology;
+    topology.type = gateway::topology::RedundancyType::NONE;
+    fillGooseStatistics(topology);
+
+    res.set_header("Access-Control-Allow-Origin", "*");
+    res.set_content(parser.statisticsToJSON(topology), "application/json");
+  });
+
+  // API: GOOSE the gateway publishes, with latency from the triggering
+  // write
+  svr.Get("/api/v1/goose/publisher", [this](const httplib::Request &,
+                                            httplib::Response &res) {
+    nlohmann::json response;
+    response["running"] = goosePublisher_ && goosePublisher_->isRunning();
+    response["latencyBucketsUs"] = iec61850::goose::kLatencyBucketBoundsUs;
+    nlohmann::json controlBlocks = nlohmann::json::array();
+    if (goosePublisher_) {
+      for (const auto &s : goosePublisher_->getStats()) {
+        controlBlocks.push_back(
+            {{"goCbRef", s.goCbRef},
+             {"dataSet", s.dataSet},
+             {"stNum", s.stNum},
+             {"sqNum", s.sqNum},
+             {"messages", s.messages},
+             {"stateChanges", s.stateChanges},
+             {"retransmissions", s.retransmissions},
+             {"sendErrors", s.sendErrors},
+             {"currentIntervalMs", s.currentIntervalMs},
+             {"boundMembers", s.boundMembers},
+             {"latency",
+              {{"samples", s.latency.samples},
+               {"avgUs", s.latency.avgUs},
+               {"lastUs", s.latency.lastUs},
+               {"maxUs", s.latency.maxUs},
+               {"p99Us", s.latency.p99Us},
+               {"buckets", s.latency.buckets}}}});
+      }
+    }
+    response["controlBlocks"] = controlBlocks;
+
+    res.set_header("Access-Control-Allow-Origin", "*");
+    res.set_content(response.dump(), "application/json");
+  });
+
+  // API: Per-stream results of the SV analytics, latest complete cycle
+  svr.Get("/api/v1/sv/analytics", [this](const httplib::Request &,
+                                         httplib::Response &res) {
+    nlohmann::json response;
+    response["running"] = svAnalytics_ && svAnalytics_->isRunning();
+    nlohmann::json streams = nlohmann::json::array();
+    if (svAnalytics_) {
+      response["receiver"] = svAnalytics_->getReceiver().getName();
+      for (const auto &s : svAnalytics_->getStats()) {
+        const auto &r = s.latest;
+        nlohmann::json channels = nlohmann::json::array();
+        for (size_t ch = 0; ch < iec61850::sv::kChannelNames.size(); ++ch) {
+          channels.push_back({{"name", iec61850::sv::kChannelNames[ch]},
+                              {"rms", r.rms[ch]},
+                              {"magnitude", r.phasors[ch].magnitude},
+                              {"angle", r.phasors[ch].angle}});
+        }
+        auto sequence = [](const iec61850::sv::SequenceComponents &c) {
+          return nlohmann::json{{"positive", c.positive.magnitude},
+                                {"negative", c.negative.magnitude},
+                                {"zero", c.zero.magnitude}};
+        };
+        streams.push_back(
+            {{"appId", s.appId},
+             {"svID", s.svID},
+             {"reference", s.reference},
+             {"sampleRate", s.format.sampleRate},
+             {"samplesPerCycle", s.format.samplesPerCycle},
+             {"rateDetected", s.format.detected},
+             {"samples", s.samples},
+             {"lostSamples", s.lostSamples},
+             {"malformedASDUs", s.health.malformed},
+             {"cycles", s.cycles},
+             {"nsPerSample", s.nsPerSample},
+             {"valid", r.valid},
+             {"timestamp", r.timestamp},
+             {"frequency", r.frequency},
+             {"channels", channels},
+             {"currentSequence", sequence(r.current)},
+             {"voltageSequence", sequence(r.voltage)}});
+      }
+    }
+    response["streams"] = streams;
+
+    res.set_header("Access-Control-Allow-Origin", "*");
+    res.set_content(response.dump(), "application/json");
+  });
+
+  // API: Harmonic subgroups and THD of the last analysed SV window
+  svr.Get("/api/v1/sv/harmonics", [this](const httplib::Request &,
+                                         httplib::Response &res) {
+    nlohmann::json response;
+    response["running"] = svAnalytics_ && svAnalytics_->isRunning();
+    nlohmann::json streams = nlohmann::json::array();
+    if (svAnalytics_) {
+      for (const auto &s : svAnalytics_->getStats()) {
+        const auto &h = s.harmonics;
+        nlohmann::json channels = nlohmann::json::array();
+        for (size_t ch = 0; ch < iec61850::sv::kChannelNames.size(); ++ch) {
+          channels.push_back({{"name", iec61850::sv::kChannelNames[ch]},
+                              {"thd", h.thd[ch]},
+                              {"harmonics", h.harmonics[ch]}});
+        }
+        streams.push_back({{"appId", s.appId},
+                           {"svID", s.svID},
+                           {"name", iec61850::sv::streamName(s.appId, s.svID)},
+                           {"windows", s.harmonicWindows},
+                           {"skippedWindows", s.skippedWindows},
+                           {"valid", h.valid},
+                           {"timestamp", h.timestamp},
+                           {"windowCycles", h.windowCycles},
+                           {"maxOrder", h.maxOrder},
+                           {"channels", channels}});
+      }
+    }
+    response["streams"] = streams;
+
+    res.set_header("Access-Control-Allow-Origin", "*");
+    res.set_content(response.dump(), "application/json");
+  });
+
+  // API: Stream quality of each SV stream: smpCnt, jitter, smpSynch, confRev
+  svr.Get("/api/v1/sv/health", [this](const httplib::Request &,
+                                      httplib::Response &res) {
+    nlohmann::json response;
+    response["running"] = svAnalytics_ && svAnalytics_->isRunning();
+    response["jitterBoundsUs"] = iec61850::sv::kArrivalJitterBoundsUs;
+    nlohmann::json streams = nlohmann::json::array();
+    if (svAnalytics_) {
+      for (const auto &s : svAnalytics_->getStats()) {
+        const auto &h = s.health;
+        streams.push_back({{"appId", s.appId},
+                           {"svID", s.svID},
+                           {"name", iec61850::sv::streamName(s.appId, s.svID)},
+                           {"sampleRate", s.format.sampleRate},
+                           {"samples", h.samples},
+                           {"missingSamples", h.missingSamples},
+                           {"gaps", h.gaps},
+                           {"duplicates", h.duplicates},
+                           {"outOfOrder", h.outOfOrder},
+                           {"malformedASDUs", h.malformed},
+                           {"smpSynch", h.synchronised},
+                           {"smpSynchChanges", h.synchChanges},
+                           {"lastSmpSynchChange", h.lastSynchChangeUs},
+                           {"confRev", h.confRev},
+                           {"confRevChanges", h.confRevChanges},
+                           {"lastConfRevChange", h.lastConfRevChangeUs},
+                           {"lastArrival", h.lastArrivalUs},
+                           {"maxJitterUs", h.maxJitterUs},
+                           {"jitterHistogram", h.jitter}});
+      }
+    }
+    response["streams"] = streams;
+
+    res.set_header("Access-Control-Allow-Origin", "*");
+    res.set_content(response.dump(), "application/json");
+  });
+
+  // API: Alignment of the merged SV streams into multi-stream frames
+  svr.Get("/api/v1/sv/merge", [this](const httplib::Request &,
+                                     httplib::Response &res) {
+    const iec61850::sv::SVStreamMerger *merger =
+        svAnalytics_ ? svAnalytics_->getMerger() : nullptr;
+    nlohmann::json response;
+    response["enabled"] = merger != nullptr;
+    response["latencyBoundsUs"] = iec61850::sv::kAlignmentLatencyBoundsUs;
+    nlohmann::json streams = nlohmann::json::array();
+    if (merger) {
+      auto stats = merger->getStats();
+      for (const auto &s : stats.streams) {
+        streams.push_back({{"name", s.name},
+                           {"samples", s.samples},
+                           {"dropped", s.dropped},
+                           {"late", s.late},
+                           {"unaligned", s.unaligned},
+                           {"missing", s.missing},
+                           {"avgLagUs", s.avgLagUs},
+                           {"maxLagUs", s.maxLagUs}});
+      }
+      response["sampleRate"] = stats.sampleRate;
+      response["frames"] = stats.frames;
+      response["completeFrames"] = stats.completeFrames;
+      response["resyncs"] = stats.resyncs;
+      response["avgLatencyUs"] = stats.avgLatencyUs;
+      response["maxLatencyUs"] = stats.maxLatencyUs;
+      response["latencyHistogram"] = stats.latency;
+      auto differential = svAnalytics_->getDifferential();
+      response["differential"] = {{"phsA", differential.rms[0]},
+                                  {"phsB", differential.rms[1]},
+                                  {"phsC", differential.rms[2]},
+                                  {"neut", differential.rms[3]},
+                                  {"frames", differential.frames}};
+    }
+    response["streams"] = streams;
+
+    res.set_header("Access-Control-Allow-Origin", "*");
+    res.set_content(response.dump(), "application/json");
+  });
+
+  // API: Continuous SV recording and the records cut from it
+  svr.Get("/api/v1/sv/recording", [this](const httplib::Request &,
+                                         httplib::Response &res) {
+    nlohmann::json response;
+    response["running"] = svRecorder_ && svRecorder_->isRunning();
+    nlohmann::json streams = nlohmann::json::array();
+    nlohmann::json recordings = nlohmann::json::array();
+    if (svRecorder_) {
+      auto stats = svRecorder_->getStats();
+      for (const auto &s : stats.streams) {
+        streams.push_back({{"name", s.name},
+                           {"segments", s.segments},
+                           {"samples", s.samples},
+                           {"dropped", s.dropped},
+                           {"oldest", s.oldestUs},
+                           {"newest", s.newestUs},
+                           {"diskBytes", s.diskBytes}});
+      }
+      for (const auto &r : stats.recordings) {
+        recordings.push_back({{"path", r.path},
+                              {"stream", r.stream},
+                              {"reason", r.reason},
+                              {"trigger", r.triggerUs},
+                              {"rows", r.rows},
+                              {"written", r.written}});
+      }
+      response["triggers"] = stats.triggers;
+      response["pendingTriggers"] = stats.pendingTriggers;
+    }
+    response["streams"] = streams;
+    response["recordings"] = recordings;
+
+    res.set_header("Access-Control-Allow-Origin", "*");
+    res.set_content(response.dump(), "application/json");
+  });
+
+  // API: Trigger a record of one SV stream ("stream") or all of them
+  svr.Post("/api/v1/sv/recording/trigger",
+           [this](const httplib::Request &req, httplib::Response &res) {
+             nlohmann::json reqBody = nlohmann::json::object();
+             if (!req.body.empty()) {
+               try {
+                 reqBody = nlohmann::json::parse(req.body);
+               } catch (...) {
+                 res.set_content("{\"success\": false, \"message\": "
+                                 "\"Invalid JSON\"}",
+                                 "application/json");
+                 return;
+               }
+             }
+             nlohmann::json response;
+             if (!svRecorder_) {
+               response["success"] = false;
+               response["message"] = "SV recording is not enabled";
+             } else {
+               std::string stream = reqBody.value("stream", "");
+               std::string reason = reqBody.value("reason", "REST");
+               size_t triggered = svRecorder_->trigger(reason, stream);
+               response["success"] = triggered > 0;
+               response["streams"] = triggered;
+               if (!triggered)
+                 response["message"] = "Unknown stream " + stream;
+             }
+             res.set_header("Access-Control-Allow-Origin", "*");
+             res.set_content(response.dump(), "application/json");
+           });
+
+  // API: Min/max envelope of a recorded SV stream, one bucket per pixel.
+  // stream, from/to (us since the epoch), width, channels (Ia,Ua,...),
+  // format=binary (default, see encodeEnvelope) or json
+  svr.Get("/api/v1/sv/waveform", [this](const httplib::Request &req,
+                                        httplib::Response &res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+    nlohmann::json error;
+    error["success"] = false;
+    if (!svRecorder_) {
+      error["message"] = "SV recording is not enabled";
+      res.set_content(error.dump(), "application/json");
+      return;
+    }
+    std::string stream = req.get_param_value("stream");
+    uint16_t mask = channelMask(req.get_param_value("channels"));
+    if (!mask) {
+      error["message"] = "No known channel in channels";
+      res.set_content(error.dump(), "application/json");
+      return;
+    }
+    size_t width = static_cast<size_t>(std::min<uint64_t>(
+        numberParam(req, "width", 1000), kMaxWaveformWidth));
+
+    iec61850::sv::WaveformEnvelope envelope;
+    if (!svRecorder_->waveform(stream, numberParam(req, "from", 0),
+                               numberParam(req, "to", 0), width, envelope)) {
+      error["message"] = "Unknown stream " + stream;
+      res.set_content(error.dump(), "application/json");
+      return;
+    }
+    if (req.get_param_value("format") != "json") {
+      res.set_content(iec61850::sv::encodeEnvelope(envelope, mask),
+                      "application/octet-stream");
+      return;
+    }
+
+    nlohmann::json channels = nlohmann::json::array();
+    for (size_t ch = 0; ch < iec61850::sv::kChannelNames.size(); ++ch) {
+      if (!((mask >> ch) & 1u))
+        continue;
+      double scale = iec61850::sv::channelScale(static_cast<int>(ch));
+      nlohmann::json min = nlohmann::json::array();
+      nlohmann::json max = nlohmann::json::array();
+      for (size_t b = 0; b < envelope.buckets; ++b) {
+        size_t k = b * iec61850::sv::kChannels + ch;
+        // null where the bucket holds no sample
+        bool empty = envelope.counts[b] == 0;
+        min.push_back(empty ? nlohmann::json()
+                            : nlohmann::json(envelope.min[k] * scale));
+        max.push_back(empty ? nlohmann::json()
+                            : nlohmann::json(envelope.max[k] * scale));
+      }
+      channels.push_back({{"name", iec61850::sv::kChannelNames[ch]},
+                          {"min", min},
+                          {"max", max}});
+    }
+    nlohmann::json response;
+    response["success"] = true;
+    response["stream"] = stream;
+    response["from"] = envelope.fromUs;
+    response["to"] = envelope.toUs;
+    response["buckets"] = envelope.buckets;
+    response["samples"] = envelope.samples;
+    response["channels"] = channels;
+    res.set_content(response.dump(), "application/json");
+  });
+
   // API: Upload SCD file (Multipart support TODO - requires httplib
   // configuration)
   svr.Post("/api/v1/config/scd",
@@ -1192,7 +1844,7 @@ void RESTApi::runServer() {
 
   // API: Activate SCD file
   svr.Post("/api/v1/config/scd/activate",
-           [](const httplib::Request &req, httplib::Response &res) {
+           [&](const httplib::Request &req, httplib::Response &res) {
              nlohmann::json reqBody;
              try {
                reqBody = nlohmann::json::parse(req.body);
@@ -1226,6 +1878,42 @@ void RESTApi::runServer() {
                response["message"] = "Configuration activated";
                response["filename"] = filename;
 
+               // Parsed once for the namespace and the GOOSE services
+               iec61850::SCLParser parser;
+               auto ieds = parser.parse(targetPath);
+
+               // Patch the OPC UA namespace to the new station
+               if (namespaceBuilder_) {
+                 auto stats =
+                     namespaceBuilder_->updateFromSCD(targetPath, &ieds);
+                 response["namespace"] = {
+                     {"iedsAdded", stats.iedsAdded},
+                     {"iedsRemoved", stats.iedsRemoved},
+                     {"iedsModified", stats.iedsModified},
+                     {"iedsUnchanged", stats.iedsUnchanged}};
+               }
+
+               // Follow the new station's GoCBs
+               if (gooseService_) {
+                 auto stats = gooseService_->getManager().subscribeAll(ieds);
+                 response["goose"] = {{"added", stats.added},
+                                      {"removed", stats.removed},
+                                      {"changed", stats.changed},
+                                      {"unchanged", stats.unchanged}};
+                 if (auto *routable = gooseService_->getRoutableManager()) {
+                   auto r = routable->subscribeAll(ieds);
+                   response["goose"]["routable"] = {
+                       {"added", r.added},
+                       {"removed", r.removed},
+                       {"changed", r.changed},
+                       {"unchanged", r.unchanged}};
+                 }
+               }
+
+               if (goosePublisher_)
+                 response["goosePublisher"] = {
+                     {"controlBlocks", configureGoosePublisher(ieds)}};
+
                res.set_content(response.dump(), "application/json");
                LOG_INFO("Activated SCD file: {}", filename);
              } catch (const std::exception &e) {
@@ -1270,6 +1958,73 @@ void RESTApi::runServer() {
             }
           });
 
+  // ========== Acquisition API ==========
+
+  // API: Register or renew a REST watcher. Watched points are polled at the
+  // requested interval until the watcher expires or is deleted.
+  svr.Post("/api/v1/acquisition/watch", [&](const httplib::Request &req,
+                                            httplib::Response &res) {
+    nlohmann::json response;
+    if (!subscriptionManager_) {
+      response["success"] = false;
+      response["message"] = "Acquisition not available";
+      res.set_content(response.dump(), "application/json");
+      return;
+    }
+
+    try {
+      auto json = nlohmann::json::parse(req.body);
+      int ttlMs = json.value("ttl_ms", 30000);
+
+      if (json.contains("id")) {
+        uint64_t id = json["id"].get<uint64_t>();
+        response["success"] = subscriptionManager_->renewWatcher(id, ttlMs);
+        response["id"] = id;
+        if (!response["success"].get<bool>())
+          response["message"] = "Unknown or expired watcher";
+      } else {
+        std::vector<std::string> refs = json.at("refs");
+        int intervalMs = json.value("interval_ms", updateIntervalMs_);
+        response["id"] =
+            subscriptionManager_->addWatcher(refs, intervalMs, ttlMs);
+        response["success"] = true;
+      }
+    } catch (const std::exception &e) {
+      response["success"] = false;
+      response["message"] = e.what();
+    }
+    res.set_content(response.dump(), "application/json");
+  });
+
+  // API: Remove a REST watcher
+  svr.Delete(R"(/api/v1/acquisition/watch/(\d+))",
+             [&](const httplib::Request &req, httplib::Response &res) {
+               nlohmann::json response;
+               uint64_t id = std::stoull(req.matches[1].str());
+               response["success"] = subscriptionManager_ &&
+                                     subscriptionManager_->removeWatcher(id);
+               res.set_content(response.dump(), "application/json");
+             });
+
+  // API: Current acquisition demand per observed point
+  svr.Get("/api/v1/acquisition", [&](const httplib::Request &,
+                                     httplib::Response &res) {
+    nlohmann::json response;
+    nlohmann::json points = nlohmann::json::array();
+    if (subscriptionManager_) {
+      for (const auto &d : subscriptionManager_->getDemand()) {
+        points.push_back({{"ref", d.reference},
+                          {"monitored_items", d.monitoredItems},
+                          {"rest_watchers", d.restWatchers},
+                          {"sampling_ms", d.samplingMs},
+                          {"poll_interval_ms", d.pollIntervalMs}});
+      }
+    }
+    response["success"] = subscriptionManager_ != nullptr;
+    response["observed"] = points;
+    res.set_content(response.dump(), "application/json");
+  });
+
   // ========== OPC UA Server API ==========
 
   // API: Get OPC UA Server status
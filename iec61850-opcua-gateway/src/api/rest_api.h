@@ -2,15 +2,47 @@
 
 #include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 // Forward declarations
 namespace gateway {
 namespace opcua {
 class OPCUAServer;
 class DataBinder;
+namespace ns {
+class NamespaceBuilder;
+}
+namespace subscription {
+class SubscriptionManager;
+}
+namespace history {
+class HistoryBackend;
+}
+namespace sv {
+class HarmonicNodes;
+class HealthNodes;
+}
 } // namespace opcua
+namespace storage {
+class HistoryStore;
+}
+namespace iec61850 {
+struct IEDConfig;
+namespace goose {
+class GOOSEService;
+class GOOSEPublisher;
+} // namespace goose
+namespace sv {
+class SVAnalytics;
+class SVRecorder;
+} // namespace sv
+} // namespace iec61850
+namespace topology {
+struct TopologyInfo;
+}
 } // namespace gateway
 
 namespace gateway {
@@ -38,6 +70,26 @@ private:
   std::thread serverThread_;
   std::shared_ptr<opcua::OPCUAServer> opcua_server_;
   std::shared_ptr<opcua::DataBinder> dataBinder_;
+  // Long-lived so SCD/ICD changes can be applied as incremental updates
+  std::shared_ptr<opcua::ns::NamespaceBuilder> namespaceBuilder_;
+  // Poll rates follow OPC UA monitored items and REST watchers
+  std::shared_ptr<opcua::subscription::SubscriptionManager>
+      subscriptionManager_;
+  // Short-term history served to OPC UA HistoryRead
+  std::shared_ptr<storage::HistoryStore> historyStore_;
+  std::shared_ptr<opcua::history::HistoryBackend> historyBackend_;
+  // GOOSE reception and supervision, when enabled in gateway.yaml
+  std::shared_ptr<iec61850::goose::GOOSEService> gooseService_;
+  // Publishes OPC UA writes to the gateway IED's GoCBs as GOOSE
+  std::shared_ptr<iec61850::goose::GOOSEPublisher> goosePublisher_;
+  // Phasors, RMS and frequency of merging unit streams
+  std::shared_ptr<iec61850::sv::SVAnalytics> svAnalytics_;
+  // Continuous SV recording, cut into COMTRADE records on triggers
+  std::shared_ptr<iec61850::sv::SVRecorder> svRecorder_;
+  // OPC UA arrays of the SV harmonic analysis
+  std::shared_ptr<opcua::sv::HarmonicNodes> harmonicNodes_;
+  // OPC UA diagnostics of SV stream quality
+  std::shared_ptr<opcua::sv::HealthNodes> svHealthNodes_;
 
   // Opaque pointer to httplib::Server to avoid header dependency
   void *server_ptr_{nullptr};
@@ -50,6 +102,10 @@ private:
   std::thread pollingThread_;
   void runServer();
   void pollData();
+  void fillGooseStatistics(topology::TopologyInfo &topology) const;
+  // Publish the GoCBs of a parsed SCD and let OPC UA write their points
+  size_t
+  configureGoosePublisher(const std::vector<iec61850::IEDConfig> &ieds);
 };
 
 } // namespace api
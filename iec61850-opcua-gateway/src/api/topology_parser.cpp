@@ -9,6 +9,57 @@ using json = nlohmann::json;
 namespace gateway {
 namespace topology {
 
+namespace {
+
+json networkJSON(const NetworkStats &stats) {
+  return {{"interface", stats.interface},
+          {"messageRate", stats.messageRate},
+          {"errors", stats.errors},
+          {"quality", stats.quality},
+          {"status", stats.status},
+          {"avgSkewUs", stats.avgSkewUs},
+          {"maxSkewUs", stats.maxSkewUs},
+          {"filtered", stats.filtered},
+          {"dispatchNs", stats.dispatchNs},
+          {"dispatchProbes", stats.dispatchProbes}};
+}
+
+json statisticsJSON(const TopologyInfo &topology) {
+  json j;
+  j["networkA"] = networkJSON(topology.networkA);
+  if (topology.type == RedundancyType::PRP)
+    j["networkB"] = networkJSON(topology.networkB);
+
+  j["jitterBucketsUs"] = topology.jitterBucketsUs;
+  j["gocbs"] = json::array();
+  for (const auto &stream : topology.streams) {
+    j["gocbs"].push_back({{"gocbRef", stream.gocbRef},
+                          {"dataSet", stream.dataSet},
+                          {"status", stream.status},
+                          {"messageRate", stream.messageRate},
+                          {"stateChangeRate", stream.stateChangeRate},
+                          {"messages", stream.messages},
+                          {"stateChanges", stream.stateChanges},
+                          {"sqNumGaps", stream.sqNumGaps},
+                          {"stNumGaps", stream.stNumGaps},
+                          {"talExpiries", stream.talExpiries},
+                          {"confRevMismatches", stream.confRevMismatches},
+                          {"ndsComFrames", stream.ndsComFrames},
+                          {"duplicates", stream.duplicates},
+                          {"msSinceLast", stream.msSinceLast},
+                          {"jitterHistogram", stream.jitterHistogram},
+                          {"routable", stream.routable}});
+  }
+  if (!topology.routable.endpoint.empty())
+    j["routable"] = {{"endpoint", topology.routable.endpoint},
+                     {"running", topology.routable.running},
+                     {"messages", topology.routable.messages},
+                     {"unknownKeys", topology.routable.unknownKeys}};
+  return j;
+}
+
+} // namespace
+
 TopologyParser::TopologyParser() {}
 
 TopologyParser::~TopologyParser() {}
@@ -79,21 +130,12 @@ TopologyInfo TopologyParser::parseFromSCD(const std::string &scdPath) {
     topology.connections = extractConnections(doc);
   }
 
-  // Mock network statistics (in production, get from actual network monitoring)
+  // Live statistics are filled in by the GOOSE service when it runs
   topology.networkA.interface =
       topology.networks.size() > 0 ? topology.networks[0] : "eth0";
-  topology.networkA.messageRate = 1234;
-  topology.networkA.errors = 0;
-  topology.networkA.quality = 99.8;
-  topology.networkA.status = "online";
-
   if (topology.type == RedundancyType::PRP) {
     topology.networkB.interface =
         topology.networks.size() > 1 ? topology.networks[1] : "eth1";
-    topology.networkB.messageRate = 1230;
-    topology.networkB.errors = 2;
-    topology.networkB.quality = 99.5;
-    topology.networkB.status = "online";
   }
 
   LOG_INFO("Parsed {} IEDs and {} connections", topology.nodes.size(),
@@ -376,25 +418,15 @@ std::string TopologyParser::toJSON(const TopologyInfo &topology) {
   // Networks
   j["networks"] = topology.networks;
 
-  // Statistics
-  j["statistics"]["networkA"] = {{"interface", topology.networkA.interface},
-                                 {"messageRate", topology.networkA.messageRate},
-                                 {"errors", topology.networkA.errors},
-                                 {"quality", topology.networkA.quality},
-                                 {"status", topology.networkA.status}};
-
-  if (topology.type == RedundancyType::PRP) {
-    j["statistics"]["networkB"] = {
-        {"interface", topology.networkB.interface},
-        {"messageRate", topology.networkB.messageRate},
-        {"errors", topology.networkB.errors},
-        {"quality", topology.networkB.quality},
-        {"status", topology.networkB.status}};
-  }
+  j["statistics"] = statisticsJSON(topology);
 
   return j.dump(2); // Pretty print with 2 spaces
 }
 
+std::string TopologyParser::statisticsToJSON(const TopologyInfo &topology) {
+  return statisticsJSON(topology).dump(2);
+}
+
 std::string TopologyParser::redundancyTypeToString(RedundancyType type) {
   switch (type) {
   case RedundancyType::PRP:
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "pugixml.hpp"
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -33,10 +34,43 @@ struct GOOSEConnection {
 
 struct NetworkStats {
   std::string interface;
-  int messageRate;
-  int errors;
-  double quality;
-  std::string status;
+  int messageRate = 0;
+  int errors = 0;       // Frames lost on this LAN
+  double quality = 0.0; // Percentage of frames received
+  std::string status = "offline"; // online, degraded or offline
+  double avgSkewUs = 0.0; // PRP: lateness of this LAN's duplicates
+  uint32_t maxSkewUs = 0;
+  uint64_t filtered = 0; // Unsubscribed GOOSE dropped before decoding
+  double dispatchNs = 0.0; // Mean routing cost per frame
+  double dispatchProbes = 0.0;
+};
+
+// Live supervision of one subscribed GoCB
+struct GOOSEStreamStats {
+  std::string gocbRef;
+  std::string dataSet;
+  std::string status; // online, expired (TAL elapsed) or waiting
+  double messageRate = 0.0;
+  double stateChangeRate = 0.0;
+  uint64_t messages = 0;
+  uint64_t stateChanges = 0;
+  uint64_t sqNumGaps = 0;
+  uint64_t stNumGaps = 0;
+  uint64_t talExpiries = 0;
+  uint64_t confRevMismatches = 0;
+  uint64_t ndsComFrames = 0;
+  uint64_t duplicates = 0;
+  uint64_t msSinceLast = 0;
+  std::vector<uint64_t> jitterHistogram;
+  bool routable = false; // Received as R-GOOSE
+};
+
+// R-GOOSE reception over UDP
+struct RoutableStats {
+  std::string endpoint; // Empty = off
+  bool running = false;
+  uint64_t messages = 0;
+  uint64_t unknownKeys = 0; // Secured with a key not configured
 };
 
 struct TopologyInfo {
@@ -46,6 +80,9 @@ struct TopologyInfo {
   std::vector<std::string> networks;
   NetworkStats networkA;
   NetworkStats networkB; // Only for PRP
+  std::vector<GOOSEStreamStats> streams;
+  std::vector<uint32_t> jitterBucketsUs; // Upper bounds, last is open
+  RoutableStats routable;
 };
 
 class TopologyParser {
@@ -74,6 +111,11 @@ public:
    */
   std::string toJSON(const TopologyInfo &topology);
 
+  /**
+   * @brief Convert only the live statistics of a topology to JSON
+   */
+  std::string statisticsToJSON(const TopologyInfo &topology);
+
 private:
   std::vector<IEDNode> extractIEDs(const pugi::xml_document &doc);
   std::vector<GOOSEConnection>
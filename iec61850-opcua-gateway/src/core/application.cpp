@@ -1,5 +1,6 @@
 #include "application.h"
 #include "../opcua/opcua_server.h"
+#include "config_parser.h"
 #include "logger.h"
 #include <chrono>
 #include <thread>
@@ -7,6 +8,31 @@
 namespace gateway {
 namespace core {
 
+namespace {
+
+opcua::pubsub::PublisherConfig toPublisherConfig(const PubSubConfig &config) {
+  opcua::pubsub::PublisherConfig result;
+  result.enabled = config.enabled;
+  result.address = config.address;
+  result.port = config.port;
+  result.interfaceAddress = config.interfaceAddress;
+  result.ttl = config.ttl;
+  result.loopback = config.loopback;
+  result.publisherId = static_cast<uint16_t>(config.publisherId);
+  for (const auto &ds : config.dataSets) {
+    opcua::pubsub::DataSetConfig dataSet;
+    dataSet.name = ds.name;
+    dataSet.writerId = static_cast<uint16_t>(ds.writerId);
+    dataSet.intervalMs = ds.intervalMs;
+    dataSet.keyFrameCount = ds.keyFrameCount;
+    dataSet.points = ds.points;
+    result.dataSets.push_back(dataSet);
+  }
+  return result;
+}
+
+} // namespace
+
 Application::Application()
     : service_manager_(std::make_unique<ServiceManager>()) {}
 
@@ -24,6 +50,12 @@ bool Application::initialize(const std::string &configPath) {
   opcua::ServerConfig opcuaConfig;
   opcuaConfig.port = 4840;
   opcuaConfig.appName = "IEC61850-OPC UA Gateway";
+  try {
+    GatewayConfig config = ConfigParser::load(configPath);
+    opcuaConfig.pubsub = toPublisherConfig(config.opcua.pubsub);
+  } catch (const std::exception &e) {
+    LOG_WARN("Using default OPC UA settings: {}", e.what());
+  }
   if (!opcua_server_->init(opcuaConfig)) {
     LOG_ERROR("Failed to initialize OPC UA Server");
     return false;
@@ -5,6 +5,184 @@
 namespace gateway {
 namespace core {
 
+namespace {
+
+void parsePubSub(const YAML::Node &node, PubSubConfig &pubsub) {
+  if (node["enabled"])
+    pubsub.enabled = node["enabled"].as<bool>();
+  if (node["address"])
+    pubsub.address = node["address"].as<std::string>();
+  if (node["port"])
+    pubsub.port = node["port"].as<int>();
+  if (node["interface"])
+    pubsub.interfaceAddress = node["interface"].as<std::string>();
+  if (node["ttl"])
+    pubsub.ttl = node["ttl"].as<int>();
+  if (node["loopback"])
+    pubsub.loopback = node["loopback"].as<bool>();
+  if (node["publisher_id"])
+    pubsub.publisherId = node["publisher_id"].as<int>();
+
+  if (node["datasets"] && node["datasets"].IsSequence()) {
+    for (const auto &ds : node["datasets"]) {
+      PubSubDataSetConfig dataSet;
+      if (ds["name"])
+        dataSet.name = ds["name"].as<std::string>();
+      if (ds["writer_id"])
+        dataSet.writerId = ds["writer_id"].as<int>();
+      if (ds["interval_ms"])
+        dataSet.intervalMs = ds["interval_ms"].as<int>();
+      if (ds["key_frame_count"])
+        dataSet.keyFrameCount = ds["key_frame_count"].as<int>();
+      if (ds["points"] && ds["points"].IsSequence()) {
+        for (const auto &point : ds["points"])
+          dataSet.points.push_back(point.as<std::string>());
+      }
+      pubsub.dataSets.push_back(dataSet);
+    }
+  }
+}
+
+void parseRSession(const YAML::Node &node, RSessionConfig &session) {
+  if (node["enabled"])
+    session.enabled = node["enabled"].as<bool>();
+  if (node["local_address"])
+    session.localAddress = node["local_address"].as<std::string>();
+  if (node["port"])
+    session.port = node["port"].as<int>();
+  if (node["remote_address"])
+    session.remoteAddress = node["remote_address"].as<std::string>();
+  if (node["multicast_groups"] && node["multicast_groups"].IsSequence()) {
+    for (const auto &group : node["multicast_groups"])
+      session.multicastGroups.push_back(group.as<std::string>());
+  }
+  if (node["keys"] && node["keys"].IsSequence()) {
+    for (const auto &k : node["keys"]) {
+      RSessionKeyConfig key;
+      if (k["id"])
+        key.id = k["id"].as<uint32_t>();
+      if (k["key"])
+        key.key = k["key"].as<std::string>();
+      if (k["security"])
+        key.security = k["security"].as<std::string>();
+      if (k["signature"])
+        key.signature = k["signature"].as<std::string>();
+      session.keys.push_back(key);
+    }
+  }
+  if (node["active_key"])
+    session.activeKeyId = node["active_key"].as<uint32_t>();
+}
+
+void parseGoose(const YAML::Node &node, GOOSEConfig &goose) {
+  if (node["enabled"])
+    goose.enabled = node["enabled"].as<bool>();
+  if (node["interface"])
+    goose.interfaceName = node["interface"].as<std::string>();
+  if (node["interface_b"])
+    goose.interfaceB = node["interface_b"].as<std::string>();
+  if (node["duplicate_discard"])
+    goose.duplicateDiscard = node["duplicate_discard"].as<bool>();
+  if (node["packet_ring"])
+    goose.packetRing = node["packet_ring"].as<bool>();
+  if (node["replay_file"])
+    goose.replayFile = node["replay_file"].as<std::string>();
+  if (node["replay_speed"])
+    goose.replaySpeed = node["replay_speed"].as<double>();
+
+  if (const YAML::Node publisher = node["publisher"]) {
+    GOOSEPublisherConfig &pub = goose.publisher;
+    if (publisher["enabled"])
+      pub.enabled = publisher["enabled"].as<bool>();
+    if (publisher["interface"])
+      pub.interfaceName = publisher["interface"].as<std::string>();
+    if (publisher["ied"])
+      pub.iedName = publisher["ied"].as<std::string>();
+    if (publisher["min_time_ms"])
+      pub.minTimeMs = publisher["min_time_ms"].as<int>();
+    if (publisher["max_time_ms"])
+      pub.maxTimeMs = publisher["max_time_ms"].as<int>();
+    if (publisher["thread_priority"])
+      pub.threadPriority = publisher["thread_priority"].as<int>();
+  }
+
+  if (node["routable"])
+    parseRSession(node["routable"], goose.routable);
+}
+
+void parseSv(const YAML::Node &node, SVConfig &sv) {
+  if (node["enabled"])
+    sv.enabled = node["enabled"].as<bool>();
+  if (node["interface"])
+    sv.interfaceName = node["interface"].as<std::string>();
+  if (node["publish_interval_ms"])
+    sv.publishIntervalMs = node["publish_interval_ms"].as<int>();
+  if (node["routable"])
+    parseRSession(node["routable"], sv.routable);
+  if (const YAML::Node harmonics = node["harmonics"]) {
+    if (harmonics["enabled"])
+      sv.harmonics.enabled = harmonics["enabled"].as<bool>();
+    if (harmonics["max_order"])
+      sv.harmonics.maxOrder = harmonics["max_order"].as<int>();
+    if (harmonics["workers"])
+      sv.harmonics.workers = harmonics["workers"].as<int>();
+  }
+  if (const YAML::Node recording = node["recording"]) {
+    SVRecordingConfig &r = sv.recording;
+    if (recording["enabled"])
+      r.enabled = recording["enabled"].as<bool>();
+    if (recording["directory"])
+      r.directory = recording["directory"].as<std::string>();
+    if (recording["segment_seconds"])
+      r.segmentSeconds = recording["segment_seconds"].as<int>();
+    if (recording["retention_minutes"])
+      r.retentionMinutes = recording["retention_minutes"].as<int>();
+    if (recording["pre_trigger_ms"])
+      r.preTriggerMs = recording["pre_trigger_ms"].as<int>();
+    if (recording["post_trigger_ms"])
+      r.postTriggerMs = recording["post_trigger_ms"].as<int>();
+    if (recording["format"])
+      r.format = recording["format"].as<std::string>();
+    if (recording["current_threshold"])
+      r.currentThreshold = recording["current_threshold"].as<double>();
+    if (recording["voltage_threshold"])
+      r.voltageThreshold = recording["voltage_threshold"].as<double>();
+    const YAML::Node triggers = recording["goose_triggers"];
+    if (triggers && triggers.IsSequence()) {
+      for (const auto &ref : triggers)
+        r.gooseTriggers.push_back(ref.as<std::string>());
+    }
+  }
+  if (const YAML::Node merge = node["merge"]) {
+    if (merge["enabled"])
+      sv.merge.enabled = merge["enabled"].as<bool>();
+    if (merge["max_skew_us"])
+      sv.merge.maxSkewUs = merge["max_skew_us"].as<int>();
+    const YAML::Node streams = merge["streams"];
+    if (streams && streams.IsSequence()) {
+      for (const auto &name : streams)
+        sv.merge.streams.push_back(name.as<std::string>());
+    }
+  }
+
+  if (node["streams"] && node["streams"].IsSequence()) {
+    for (const auto &st : node["streams"]) {
+      SVStreamConfig stream;
+      if (st["app_id"])
+        stream.appId = st["app_id"].as<uint16_t>();
+      if (st["sv_id"])
+        stream.svID = st["sv_id"].as<std::string>();
+      if (st["reference"])
+        stream.reference = st["reference"].as<std::string>();
+      if (st["sequence_reference"])
+        stream.sequenceReference = st["sequence_reference"].as<std::string>();
+      sv.streams.push_back(stream);
+    }
+  }
+}
+
+} // namespace
+
 GatewayConfig ConfigParser::load(const std::string &path) {
   GatewayConfig config;
   try {
@@ -22,6 +200,8 @@ GatewayConfig ConfigParser::load(const std::string &path) {
         config.opcua.endpointUrl = opcua["endpoint_url"].as<std::string>();
       if (opcua["enable_security"])
         config.opcua.enableSecurity = opcua["enable_security"].as<bool>();
+      if (opcua["pubsub"])
+        parsePubSub(opcua["pubsub"], config.opcua.pubsub);
     }
 
     if (root["storage"]) {
@@ -40,6 +220,12 @@ GatewayConfig ConfigParser::load(const std::string &path) {
         config.storage.enabled = storage["enabled"].as<bool>();
     }
 
+    if (root["goose"])
+      parseGoose(root["goose"], config.goose);
+
+    if (root["sv"])
+      parseSv(root["sv"], config.sv);
+
     if (root["ieds"] && root["ieds"].IsSequence()) {
       for (const auto &node : root["ieds"]) {
         IEDConfig ied;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <yaml-cpp/yaml.h>
@@ -14,10 +15,30 @@ struct IEDConfig {
   bool enabled = true;
 };
 
+struct PubSubDataSetConfig {
+  std::string name;
+  int writerId = 1;
+  int intervalMs = 100;
+  int keyFrameCount = 10;
+  std::vector<std::string> points; // IEC61850 references
+};
+
+struct PubSubConfig {
+  bool enabled = false;
+  std::string address = "239.0.0.1"; // UDP multicast group
+  int port = 4840;
+  std::string interfaceAddress; // Outgoing interface IPv4
+  int ttl = 1;
+  bool loopback = true;
+  int publisherId = 1;
+  std::vector<PubSubDataSetConfig> dataSets;
+};
+
 struct OPCUAConfig {
   int port = 4840;
   std::string endpointUrl;
   bool enableSecurity = false;
+  PubSubConfig pubsub;
 };
 
 struct StorageConfig {
@@ -29,10 +50,109 @@ struct StorageConfig {
   bool enabled = false;
 };
 
+// Key of a routable GOOSE/SV session, referenced by id in each message
+struct RSessionKeyConfig {
+  uint32_t id = 0;
+  std::string key; // Hex
+  // none, aes-128-gcm or aes-256-gcm
+  std::string security = "none";
+  // none, hmac-sha256-80/128/256, aes-gmac-64/128 or hmac-sha3-80/128/256
+  std::string signature = "hmac-sha256-256";
+};
+
+// UDP session carrying R-GOOSE / R-SV (IEC 61850-90-5)
+struct RSessionConfig {
+  bool enabled = false;
+  std::string localAddress = "0.0.0.0";
+  int port = 102;
+  std::vector<std::string> multicastGroups; // Joined to receive
+  std::string remoteAddress; // Destination when publishing, empty = receive
+  std::vector<RSessionKeyConfig> keys;
+  uint32_t activeKeyId = 0; // Key securing sent messages, 0 = none
+};
+
+// GOOSE the gateway itself publishes, GoCBs taken from the station SCD
+struct GOOSEPublisherConfig {
+  bool enabled = false;
+  std::string interfaceName = "eth0";
+  std::string iedName; // Gateway IED in the SCD whose GoCBs are published
+  // Retransmission curve where the SCD's GSE has no MinTime/MaxTime
+  int minTimeMs = 2;
+  int maxTimeMs = 1000;
+  int threadPriority = 0; // SCHED_FIFO priority of the timer thread, 0 = off
+};
+
+struct GOOSEConfig {
+  bool enabled = false;
+  std::string interfaceName = "eth0"; // LAN A
+  std::string interfaceB;             // LAN B of a PRP pair, empty = none
+  bool duplicateDiscard = false;      // Single-port HSR
+  bool packetRing = false;            // Linux TPACKET_V3 capture
+  // Replay a pcap/pcapng recording instead of receiving live; pcapng
+  // interface 1 feeds LAN B
+  std::string replayFile;
+  double replaySpeed = 1.0; // 0 = as fast as possible
+  GOOSEPublisherConfig publisher;
+  RSessionConfig routable; // R-GOOSE reception next to the interfaces
+};
+
+// Sampled value stream whose phasors, RMS and frequency are published
+struct SVStreamConfig {
+  uint16_t appId = 0x4000;
+  std::string svID;              // Empty = any stream on the APPID
+  std::string reference;         // MMXU written to, IED/LD/LN
+  std::string sequenceReference; // MSQI written to, empty = none
+};
+
+// Harmonic analysis over 10/12-cycle windows of every SV stream
+struct SVHarmonicsConfig {
+  bool enabled = false;
+  int maxOrder = 50; // Capped below the Nyquist rate of the stream
+  int workers = 2;   // Analysis threads shared by the streams
+};
+
+// Continuous recording of every SV stream into rotating segment files,
+// cut into COMTRADE records around each trigger
+struct SVRecordingConfig {
+  bool enabled = false;
+  std::string directory = "./data/sv";
+  int segmentSeconds = 60;
+  int retentionMinutes = 240; // Older segments are deleted
+  int preTriggerMs = 500;
+  int postTriggerMs = 1000;
+  std::string format = "BINARY32"; // COMTRADE DAT file format
+  double currentThreshold = 0.0;   // A, 0 = no threshold trigger
+  double voltageThreshold = 0.0;   // V, likewise
+  // DataBinder references of GOOSE members whose rise to true triggers
+  std::vector<std::string> gooseTriggers;
+};
+
+// Alignment of several merging units' streams, sample by sample, on
+// smpCnt within the synchronised second
+struct SVMergeConfig {
+  bool enabled = false;
+  int maxSkewUs = 2000; // Longest wait for a late stream
+  // Stream names (svID, or APPID_xxxx), empty = every configured stream
+  std::vector<std::string> streams;
+};
+
+struct SVConfig {
+  bool enabled = false;
+  std::string interfaceName = "eth0";
+  RSessionConfig routable;     // R-SV instead of the interface
+  int publishIntervalMs = 100; // Latest cycle's results, this often
+  SVHarmonicsConfig harmonics;
+  SVRecordingConfig recording;
+  SVMergeConfig merge;
+  std::vector<SVStreamConfig> streams;
+};
+
 struct GatewayConfig {
   std::string version;
   OPCUAConfig opcua;
   StorageConfig storage;
+  GOOSEConfig goose;
+  SVConfig sv;
   std::vector<IEDConfig> ieds;
 };
 
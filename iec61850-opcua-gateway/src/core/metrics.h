@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace gateway {
+namespace core {
+
+constexpr uint64_t kUsPerSecond = 1000000;
+
+// Wall-clock time, microseconds since the epoch
+inline uint64_t nowUs() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+}
+
+/**
+ * @brief Add to a counter only one thread writes; any thread may load it
+ * relaxed
+ */
+inline void increment(std::atomic<uint64_t> &counter, uint64_t by = 1) {
+  counter.store(counter.load(std::memory_order_relaxed) + by,
+                std::memory_order_relaxed);
+}
+
+/**
+ * @brief Histogram bucket of @p value: the first whose upper bound it
+ * does not exceed, else the open bucket after the last bound
+ */
+template <size_t N>
+size_t histogramBucket(const std::array<uint32_t, N> &bounds,
+                       uint64_t value) {
+  for (size_t i = 0; i < N; ++i) {
+    if (value <= bounds[i])
+      return i;
+  }
+  return N;
+}
+
+} // namespace core
+} // namespace gateway
@@ -0,0 +1,222 @@
+#include "frame_dispatcher.h"
+#include <algorithm>
+#include <chrono>
+
+namespace gateway {
+namespace iec61850 {
+namespace capture {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto kRelaxed = std::memory_order_relaxed;
+constexpr uint32_t kNoRoute = UINT32_MAX;
+constexpr uint32_t kUsed = 1u << 31;
+constexpr unsigned kAnyAppId = 1; // Class bits
+constexpr unsigned kAnyMac = 2;
+
+struct FrameHeader {
+  uint16_t etherType = 0;
+  uint16_t appId = 0;
+  uint64_t mac = 0;
+};
+
+// Destination MAC, optional 802.1Q tag, EtherType, APPID
+bool parseHeader(const uint8_t *frame, size_t length, FrameHeader &header) {
+  size_t offset = 12;
+  if (length >= 16 && frame[12] == 0x81 && frame[13] == 0x00)
+    offset = 16;
+  if (length < offset + 4)
+    return false;
+  header.etherType = static_cast<uint16_t>(frame[offset] << 8 |
+                                           frame[offset + 1]);
+  header.appId = static_cast<uint16_t>(frame[offset + 2] << 8 |
+                                       frame[offset + 3]);
+  header.mac = 0;
+  for (int i = 0; i < 6; ++i)
+    header.mac = header.mac << 8 | frame[i];
+  return true;
+}
+
+uint64_t slotKey(uint64_t mac, uint16_t appId, unsigned cls) {
+  return ((cls & kAnyMac) ? 0 : mac << 16) | ((cls & kAnyAppId) ? 0 : appId);
+}
+
+uint32_t slotTag(uint16_t etherType, unsigned cls) {
+  return kUsed | cls << 16 | etherType;
+}
+
+size_t slotIndex(uint64_t key, uint32_t tag, size_t mask) {
+  // splitmix64 finaliser
+  uint64_t h = key ^ (uint64_t{tag} * 0x9E3779B97F4A7C15ULL);
+  h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+  return static_cast<size_t>(h ^ (h >> 31)) & mask;
+}
+
+void increment(std::atomic<uint64_t> &counter, uint64_t by = 1) {
+  counter.store(counter.load(kRelaxed) + by, kRelaxed);
+}
+
+uint64_t elapsedNs(Clock::time_point since) {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                           since)
+          .count());
+}
+
+} // namespace
+
+void FrameDispatcher::setRoutes(std::vector<Route> routes) {
+  auto table = std::make_shared<Table>();
+  size_t slots = 16;
+  while (slots < routes.size() * 2)
+    slots <<= 1;
+  table->slots.resize(slots);
+  table->mask = slots - 1;
+
+  for (auto &route : routes) {
+    const DispatchKey &key = route.key;
+    unsigned cls = (key.appId < 0 ? kAnyAppId : 0) | (key.hasMac ? 0 : kAnyMac);
+    uint64_t mac = 0;
+    for (int i = 0; i < 6; ++i)
+      mac = mac << 8 | key.mac[i];
+    uint64_t slotKeyValue =
+        slotKey(mac, static_cast<uint16_t>(key.appId < 0 ? 0 : key.appId),
+                cls);
+    uint32_t tag = slotTag(key.etherType, cls);
+
+    size_t i = slotIndex(slotKeyValue, tag, table->mask);
+    while (table->slots[i].tag &&
+           !(table->slots[i].tag == tag && table->slots[i].key == slotKeyValue))
+      i = (i + 1) & table->mask;
+    if (table->slots[i].tag)
+      continue;
+    table->slots[i] = {slotKeyValue, tag,
+                       static_cast<uint32_t>(table->handlers.size())};
+    table->handlers.push_back(std::move(route.handler));
+    table->keys.push_back(key);
+    table->classes |= 1u << cls;
+  }
+
+  std::atomic_store(&table_, std::shared_ptr<const Table>(std::move(table)));
+  generation_++;
+}
+
+size_t FrameDispatcher::route(const Table &table, const uint8_t *frame,
+                              size_t length) {
+  uint64_t sequence = frames_.load(kRelaxed);
+  frames_.store(sequence + 1, kRelaxed);
+  bool timed = sequence % kTimingSample == 0;
+  Clock::time_point started;
+  if (timed)
+    started = Clock::now();
+
+  const Handler *hits[kClasses];
+  size_t count = 0;
+  uint64_t probes = 0;
+  FrameHeader header;
+  if (frame && parseHeader(frame, length, header)) {
+    for (unsigned cls = 0; cls < kClasses; ++cls) {
+      if (!(table.classes & (1u << cls)))
+        continue;
+      uint64_t key = slotKey(header.mac, header.appId, cls);
+      uint32_t tag = slotTag(header.etherType, cls);
+      uint32_t found = kNoRoute;
+      for (size_t i = slotIndex(key, tag, table.mask);;
+           i = (i + 1) & table.mask) {
+        probes++;
+        const Slot &slot = table.slots[i];
+        if (!slot.tag)
+          break;
+        if (slot.tag == tag && slot.key == key) {
+          found = slot.route;
+          break;
+        }
+      }
+      if (found != kNoRoute)
+        hits[count++] = &table.handlers[found];
+    }
+  }
+  increment(probes_, probes);
+
+  if (timed) {
+    uint64_t ns = elapsedNs(started);
+    increment(lookupSamples_);
+    increment(lookupNs_, ns);
+    if (ns > maxLookupNs_.load(kRelaxed))
+      maxLookupNs_.store(ns, kRelaxed);
+  }
+  if (!count) {
+    increment(unrouted_);
+    return 0;
+  }
+  increment(routed_);
+
+  if (timed)
+    started = Clock::now();
+  for (size_t i = 0; i < count; ++i)
+    (*hits[i])(frame, length);
+  if (timed) {
+    increment(handlerSamples_);
+    increment(handlerNs_, elapsedNs(started));
+  }
+  return count;
+}
+
+size_t FrameDispatcher::dispatch(const uint8_t *frame, size_t length) {
+  auto table = std::atomic_load(&table_);
+  return route(*table, frame, length);
+}
+
+size_t FrameDispatcher::dispatch(const CapturedFrame *frames, size_t count) {
+  auto table = std::atomic_load(&table_);
+  size_t routed = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (route(*table, frames[i].data, frames[i].length))
+      routed++;
+  }
+  return routed;
+}
+
+std::vector<uint16_t> FrameDispatcher::appIds(uint16_t etherType) const {
+  auto table = std::atomic_load(&table_);
+  std::vector<uint16_t> result;
+  for (const auto &key : table->keys) {
+    if (key.etherType != etherType)
+      continue;
+    if (key.appId < 0)
+      return {};
+    result.push_back(static_cast<uint16_t>(key.appId));
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+DispatchStats FrameDispatcher::getStats() const {
+  DispatchStats s;
+  s.frames = frames_.load(kRelaxed);
+  s.routed = routed_.load(kRelaxed);
+  s.unrouted = unrouted_.load(kRelaxed);
+  if (s.frames)
+    s.avgProbes = static_cast<double>(probes_.load(kRelaxed)) /
+                  static_cast<double>(s.frames);
+  if (uint64_t n = lookupSamples_.load(kRelaxed))
+    s.avgLookupNs =
+        static_cast<double>(lookupNs_.load(kRelaxed)) / static_cast<double>(n);
+  s.maxLookupNs = maxLookupNs_.load(kRelaxed);
+  if (uint64_t n = handlerSamples_.load(kRelaxed))
+    s.avgHandlerNs = static_cast<double>(handlerNs_.load(kRelaxed)) /
+                     static_cast<double>(n);
+
+  auto table = std::atomic_load(&table_);
+  s.routes = table->handlers.size();
+  s.slots = table->slots.size();
+  return s;
+}
+
+} // namespace capture
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "pcap_replay.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace gateway {
+namespace iec61850 {
+namespace capture {
+
+// Frames one route takes
+struct DispatchKey {
+  uint16_t etherType = kEtherTypeGoose;
+  int appId = -1;      // -1 = any APPID
+  bool hasMac = false; // false = any destination
+  uint8_t mac[6] = {};
+};
+
+struct DispatchStats {
+  uint64_t frames = 0;       // Frames offered
+  uint64_t routed = 0;       // Frames at least one route took
+  uint64_t unrouted = 0;     // Frames no route wanted, dropped undecoded
+  double avgProbes = 0.0;    // Table slots read per frame
+  double avgLookupNs = 0.0;  // Header parse and lookup, sampled
+  uint64_t maxLookupNs = 0;
+  double avgHandlerNs = 0.0; // Decoding per routed frame, sampled
+  size_t routes = 0;
+  size_t slots = 0;
+};
+
+/**
+ * @brief Routes raw Ethernet frames to their decoders by EtherType, APPID
+ * and destination MAC
+ *
+ * GOOSEReceiver routes GOOSE frames through it. SV frames do not pass
+ * through here, since the libiec61850 SV receiver reads its own socket.
+ *
+ * All routes live in one flat open-addressing table kept at most half
+ * full, so a frame costs one hash and usually one probe however many
+ * routes there are. Routes with a wildcard APPID or MAC are stored under
+ * a wildcard key and only probed while some exist; a frame reaches every
+ * matching route, most specific first, at most four.
+ *
+ * The table is replaced as a whole and dispatch() reads an immutable
+ * snapshot, so routes may change from any thread while frames flow.
+ * dispatch() itself runs on one thread at a time (the receive path);
+ * its counters are relaxed atomics that getStats() may read from
+ * anywhere. Every kTimingSample-th frame is timed.
+ */
+class FrameDispatcher {
+public:
+  using Handler = std::function<void(const uint8_t *frame, size_t length)>;
+
+  struct Route {
+    DispatchKey key;
+    Handler handler;
+  };
+
+  static constexpr uint64_t kTimingSample = 64;
+
+  /**
+   * @brief Replace all routes; a key given twice keeps its first route
+   */
+  void setRoutes(std::vector<Route> routes);
+
+  /**
+   * @return Number of routes that took the frame
+   */
+  size_t dispatch(const uint8_t *frame, size_t length);
+
+  /**
+   * @brief Dispatch a batch against a single table snapshot
+   * @return Frames at least one route took
+   */
+  size_t dispatch(const CapturedFrame *frames, size_t count);
+
+  /**
+   * @brief APPIDs routed for @p etherType that a kernel filter may
+   * restrict to; empty if some route takes any APPID
+   */
+  std::vector<uint16_t> appIds(uint16_t etherType) const;
+
+  // Incremented by every setRoutes()
+  uint64_t generation() const { return generation_.load(); }
+
+  DispatchStats getStats() const;
+
+private:
+  // Key classes, most specific first
+  static constexpr int kClasses = 4;
+
+  struct Slot {
+    uint64_t key = 0; // MAC << 16 | APPID, wildcard parts zero
+    uint32_t tag = 0; // Used bit, class and EtherType; 0 = empty
+    uint32_t route = 0;
+  };
+
+  struct Table {
+    std::vector<Slot> slots;
+    size_t mask = 0;
+    std::vector<Handler> handlers;
+    std::vector<DispatchKey> keys;
+    unsigned classes = 0; // Bit per key class with routes
+  };
+
+  size_t route(const Table &table, const uint8_t *frame, size_t length);
+
+  std::shared_ptr<const Table> table_ = std::make_shared<Table>();
+  std::atomic<uint64_t> generation_{0};
+
+  std::atomic<uint64_t> frames_{0};
+  std::atomic<uint64_t> routed_{0};
+  std::atomic<uint64_t> unrouted_{0};
+  std::atomic<uint64_t> probes_{0};
+  std::atomic<uint64_t> lookupSamples_{0};
+  std::atomic<uint64_t> lookupNs_{0};
+  std::atomic<uint64_t> maxLookupNs_{0};
+  std::atomic<uint64_t> handlerSamples_{0};
+  std::atomic<uint64_t> handlerNs_{0};
+};
+
+} // namespace capture
+} // namespace iec61850
+} // namespace gateway
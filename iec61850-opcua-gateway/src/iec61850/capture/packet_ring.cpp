@@ -0,0 +1,282 @@
+#include "packet_ring.h"
+#include "core/logger.h"
+#include <algorithm>
+#include <atomic>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace gateway {
+namespace iec61850 {
+namespace capture {
+
+namespace {
+
+// Classic BPF opcodes
+constexpr uint16_t kLdxImm = 0x01;   // BPF_LDX | BPF_W | BPF_IMM
+constexpr uint16_t kLdhAbs = 0x28;   // BPF_LD | BPF_H | BPF_ABS
+constexpr uint16_t kLdhInd = 0x48;   // BPF_LD | BPF_H | BPF_IND
+constexpr uint16_t kJeq = 0x15;      // BPF_JMP | BPF_JEQ | BPF_K
+constexpr uint16_t kRet = 0x06;      // BPF_RET | BPF_K
+constexpr uint32_t kSnapLen = 0x40000;
+
+} // namespace
+
+std::vector<BpfInstruction>
+buildEtherTypeFilter(const std::vector<uint16_t> &etherTypes,
+                     const std::vector<uint16_t> &appIds) {
+  const size_t types = etherTypes.size();
+  const size_t ids = appIds.size();
+  // Layout: VLAN skip (5), EtherType tests, [APPID load + tests], accept,
+  // reject
+  const size_t typeStart = 5;
+  const size_t idStart = typeStart + types;
+  const size_t accept = ids ? idStart + 1 + ids : idStart;
+  const size_t reject = accept + 1;
+  if (reject - typeStart > 255) {
+    if (ids)
+      return buildEtherTypeFilter(etherTypes, {});
+    return {};
+  }
+
+  auto jump = [](size_t from, size_t to) {
+    return static_cast<uint8_t>(to - from - 1);
+  };
+
+  std::vector<BpfInstruction> prog;
+  prog.push_back({kLdxImm, 0, 0, 0});
+  prog.push_back({kLdhAbs, 0, 0, 12});
+  prog.push_back({kJeq, 0, 2, 0x8100});
+  prog.push_back({kLdxImm, 0, 0, 4});
+  prog.push_back({kLdhAbs, 0, 0, 16});
+  for (size_t i = 0; i < types; ++i) {
+    size_t at = typeStart + i;
+    uint8_t jf = i + 1 == types ? jump(at, reject) : 0;
+    prog.push_back({kJeq, jump(at, ids ? idStart : accept), jf,
+                    etherTypes[i]});
+  }
+  if (ids) {
+    // APPID follows the EtherType, behind the tag if there is one
+    prog.push_back({kLdhInd, 0, 0, 14});
+    for (size_t i = 0; i < ids; ++i) {
+      size_t at = idStart + 1 + i;
+      uint8_t jf = i + 1 == ids ? jump(at, reject) : 0;
+      prog.push_back({kJeq, jump(at, accept), jf, appIds[i]});
+    }
+  }
+  prog.push_back({kRet, 0, 0, kSnapLen});
+  prog.push_back({kRet, 0, 0, 0});
+  return prog;
+}
+
+PacketRing::~PacketRing() { close(); }
+
+#ifdef __linux__
+
+bool PacketRing::isSupported() { return true; }
+
+bool PacketRing::open(const PacketRingConfig &config) {
+  close();
+  config_ = config;
+
+  unsigned int ifIndex = if_nametoindex(config.interfaceName.c_str());
+  if (!ifIndex) {
+    LOG_ERROR("Packet ring: unknown interface {}", config.interfaceName);
+    return false;
+  }
+
+  // Protocol 0 receives nothing until bound, so no frame skips the filter
+  fd_ = socket(AF_PACKET, SOCK_RAW, 0);
+  if (fd_ < 0) {
+    LOG_ERROR("Packet ring: socket failed: {}", std::strerror(errno));
+    return false;
+  }
+
+  int version = TPACKET_V3;
+  if (setsockopt(fd_, SOL_PACKET, PACKET_VERSION, &version,
+                 sizeof(version)) < 0 ||
+      !setFilter(config.etherTypes, config.appIds)) {
+    LOG_ERROR("Packet ring: setup failed: {}", std::strerror(errno));
+    close();
+    return false;
+  }
+
+  tpacket_req3 req{};
+  req.tp_block_size = config.blockSize;
+  req.tp_block_nr = config.blockCount;
+  req.tp_frame_size = TPACKET_ALIGNMENT << 7; // Only sizes the request
+  req.tp_frame_nr = (config.blockSize / req.tp_frame_size) * config.blockCount;
+  req.tp_retire_blk_tov = config.retireTimeoutMs;
+  if (setsockopt(fd_, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0) {
+    LOG_ERROR("Packet ring: PACKET_RX_RING failed: {}", std::strerror(errno));
+    close();
+    return false;
+  }
+
+  mapSize_ = size_t(config.blockSize) * config.blockCount;
+  void *map =
+      mmap(nullptr, mapSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (map == MAP_FAILED) {
+    LOG_ERROR("Packet ring: mmap failed: {}", std::strerror(errno));
+    mapSize_ = 0;
+    close();
+    return false;
+  }
+  map_ = static_cast<uint8_t *>(map);
+
+  // GOOSE and SV are multicast; let the NIC pass all multicast groups
+  packet_mreq mreq{};
+  mreq.mr_ifindex = static_cast<int>(ifIndex);
+  mreq.mr_type = PACKET_MR_ALLMULTI;
+  setsockopt(fd_, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof(mreq));
+
+  sockaddr_ll addr{};
+  addr.sll_family = AF_PACKET;
+  addr.sll_protocol = htons(ETH_P_ALL);
+  addr.sll_ifindex = static_cast<int>(ifIndex);
+  if (bind(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+    LOG_ERROR("Packet ring: bind to {} failed: {}", config.interfaceName,
+              std::strerror(errno));
+    close();
+    return false;
+  }
+
+  current_ = 0;
+  stats_ = PacketRingStats{};
+  LOG_INFO("Packet ring on {}: {} x {} KiB blocks", config.interfaceName,
+           config.blockCount, config.blockSize / 1024);
+  return true;
+}
+
+void PacketRing::close() {
+  if (map_) {
+    munmap(map_, mapSize_);
+    map_ = nullptr;
+    mapSize_ = 0;
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+bool PacketRing::setFilter(const std::vector<uint16_t> &etherTypes,
+                           const std::vector<uint16_t> &appIds) {
+  if (fd_ < 0)
+    return false;
+  static_assert(sizeof(BpfInstruction) == sizeof(sock_filter),
+                "BpfInstruction must match sock_filter");
+  auto prog = buildEtherTypeFilter(etherTypes, appIds);
+  sock_fprog fprog{};
+  fprog.len = static_cast<unsigned short>(prog.size());
+  fprog.filter = reinterpret_cast<sock_filter *>(prog.data());
+  return setsockopt(fd_, SOL_SOCKET, SO_ATTACH_FILTER, &fprog,
+                    sizeof(fprog)) == 0;
+}
+
+size_t PacketRing::poll(int timeoutMs, const BatchHandler &handler) {
+  if (!map_)
+    return 0;
+
+  size_t handled = 0;
+  bool waited = false;
+  while (true) {
+    auto *block = reinterpret_cast<tpacket_block_desc *>(
+        map_ + current_ * config_.blockSize);
+    auto &status = reinterpret_cast<std::atomic<uint32_t> &>(
+        block->hdr.bh1.block_status);
+    if (!(status.load(std::memory_order_acquire) & TP_STATUS_USER)) {
+      if (handled || waited)
+        break;
+      pollfd pfd{fd_, POLLIN | POLLERR, 0};
+      ::poll(&pfd, 1, timeoutMs);
+      waited = true;
+      continue;
+    }
+
+    uint32_t count = block->hdr.bh1.num_pkts;
+    batch_.resize(count);
+    auto *packet = reinterpret_cast<tpacket3_hdr *>(
+        reinterpret_cast<uint8_t *>(block) +
+        block->hdr.bh1.offset_to_first_pkt);
+    for (uint32_t i = 0; i < count; ++i) {
+      CapturedFrame &frame = batch_[i];
+      frame.timestampNs = uint64_t(packet->tp_sec) * 1000000000ULL +
+                          packet->tp_nsec;
+      frame.interfaceId = 0;
+      frame.data = reinterpret_cast<const uint8_t *>(packet) + packet->tp_mac;
+      frame.length = packet->tp_snaplen;
+      // A tag the NIC stripped is not in the data any more
+      size_t offset = 12;
+      if (frame.length >= 18 && frame.data[12] == 0x81 && frame.data[13] == 0)
+        offset = 16;
+      frame.etherType = frame.length >= offset + 2
+                            ? (frame.data[offset] << 8) | frame.data[offset + 1]
+                            : 0;
+      stats_.bytes += frame.length;
+      packet = reinterpret_cast<tpacket3_hdr *>(
+          reinterpret_cast<uint8_t *>(packet) + packet->tp_next_offset);
+    }
+
+    if (count)
+      handler(batch_.data(), count);
+    handled += count;
+    stats_.frames += count;
+    stats_.blocks++;
+    stats_.maxBatch = std::max<uint64_t>(stats_.maxBatch, count);
+
+    status.store(TP_STATUS_KERNEL, std::memory_order_release);
+    current_ = (current_ + 1) % config_.blockCount;
+  }
+  return handled;
+}
+
+PacketRingStats PacketRing::getStats() {
+  if (fd_ >= 0) {
+    // The kernel counters reset on every read
+    tpacket_stats_v3 kernel{};
+    socklen_t len = sizeof(kernel);
+    if (getsockopt(fd_, SOL_PACKET, PACKET_STATISTICS, &kernel, &len) == 0) {
+      stats_.drops += kernel.tp_drops;
+      stats_.freezes += kernel.tp_freeze_q_cnt;
+    }
+  }
+  return stats_;
+}
+
+#else
+
+bool PacketRing::isSupported() { return false; }
+
+bool PacketRing::open(const PacketRingConfig &) {
+  LOG_ERROR("Packet ring capture is only available on Linux");
+  return false;
+}
+
+void PacketRing::close() {}
+
+bool PacketRing::setFilter(const std::vector<uint16_t> &,
+                           const std::vector<uint16_t> &) {
+  return false;
+}
+
+size_t PacketRing::poll(int, const BatchHandler &) { return 0; }
+
+PacketRingStats PacketRing::getStats() { return stats_; }
+
+#endif
+
+} // namespace capture
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "pcap_replay.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace gateway {
+namespace iec61850 {
+namespace capture {
+
+struct PacketRingConfig {
+  std::string interfaceName;
+  std::vector<uint16_t> etherTypes = {kEtherTypeGoose, kEtherTypeSV};
+  std::vector<uint16_t> appIds; // Empty = any APPID
+  uint32_t blockSize = 1 << 20; // Power of two, multiple of the page size
+  uint32_t blockCount = 16;
+  uint32_t retireTimeoutMs = 2; // Hand over partly filled blocks after this
+};
+
+struct PacketRingStats {
+  uint64_t frames = 0;
+  uint64_t bytes = 0;
+  uint64_t blocks = 0;
+  uint64_t maxBatch = 0; // Most frames handed over in one block
+  uint64_t drops = 0;    // Kernel: ring full
+  uint64_t freezes = 0;  // Kernel: times the ring ran full
+};
+
+// Classic BPF instruction, layout of struct sock_filter
+struct BpfInstruction {
+  uint16_t code;
+  uint8_t jt;
+  uint8_t jf;
+  uint32_t k;
+};
+
+/**
+ * @brief Classic BPF program accepting the EtherTypes and, if given, the
+ * APPIDs, with or without an 802.1Q tag in the frame
+ *
+ * When the APPID list is too long for the 8-bit jump offsets only the
+ * EtherTypes are checked.
+ */
+std::vector<BpfInstruction>
+buildEtherTypeFilter(const std::vector<uint16_t> &etherTypes,
+                     const std::vector<uint16_t> &appIds);
+
+/**
+ * @brief Linux AF_PACKET TPACKET_V3 receive ring
+ *
+ * The kernel fills fixed-size blocks of an mmap'd ring with every frame
+ * the BPF filter accepts and hands a block over when it is full or the
+ * retire timeout expires. poll() passes each block's frames as one batch,
+ * pointing straight into the ring; no frame is copied. A block goes back
+ * to the kernel after its batch handler returns.
+ *
+ * Needs CAP_NET_RAW. Not available on other platforms.
+ */
+class PacketRing {
+public:
+  using BatchHandler =
+      std::function<void(const CapturedFrame *frames, size_t count)>;
+
+  PacketRing() = default;
+  ~PacketRing();
+  PacketRing(const PacketRing &) = delete;
+  PacketRing &operator=(const PacketRing &) = delete;
+
+  static bool isSupported();
+
+  bool open(const PacketRingConfig &config);
+  void close();
+  bool isOpen() const { return fd_ >= 0; }
+
+  /**
+   * @brief Replace the kernel filter of an open ring
+   */
+  bool setFilter(const std::vector<uint16_t> &etherTypes,
+                 const std::vector<uint16_t> &appIds);
+
+  /**
+   * @brief Hand every ready block to @p handler, waiting up to
+   * @p timeoutMs for the first one
+   * @return Frames handled
+   */
+  size_t poll(int timeoutMs, const BatchHandler &handler);
+
+  PacketRingStats getStats();
+
+private:
+  int fd_ = -1;
+  uint8_t *map_ = nullptr;
+  size_t mapSize_ = 0;
+  PacketRingConfig config_;
+  size_t current_ = 0;
+  std::vector<CapturedFrame> batch_;
+  PacketRingStats stats_;
+};
+
+} // namespace capture
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,170 @@
+#include "r_session.h"
+#include "core/logger.h"
+#include <cctype>
+
+namespace gateway {
+namespace iec61850 {
+namespace capture {
+
+namespace {
+
+int hexDigit(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  return -1;
+}
+
+void onKeyEvent(void *parameter, RSession, RSessionKeyEvent event,
+                uint32_t keyId) {
+  if (event != RSESSION_KEY_EVENT__NEED_KEY)
+    return;
+  auto *unknownKeys = static_cast<std::atomic<uint64_t> *>(parameter);
+  // First request of each burst only; the counter tells the rest
+  if (!unknownKeys || unknownKeys->fetch_add(1) % 1000 == 0)
+    LOG_WARN("R-Session: message secured with unknown key {}", keyId);
+}
+
+} // namespace
+
+bool parseSecurityAlgorithm(const std::string &name,
+                            RSecurityAlgorithm &algorithm) {
+  if (name == "none")
+    algorithm = R_SESSION_SEC_ALGO_NONE;
+  else if (name == "aes-128-gcm")
+    algorithm = R_SESSION_SEC_ALGO_AES_128_GCM;
+  else if (name == "aes-256-gcm")
+    algorithm = R_SESSION_SEC_ALGO_AES_256_GCM;
+  else
+    return false;
+  return true;
+}
+
+bool parseSignatureAlgorithm(const std::string &name,
+                             RSignatureAlgorithm &algorithm) {
+  static const struct {
+    const char *name;
+    RSignatureAlgorithm algorithm;
+  } kAlgorithms[] = {
+      {"none", R_SESSION_SIG_ALGO_NONE},
+      {"hmac-sha256-80", R_SESSION_SIG_ALGO_HMAC_SHA256_80},
+      {"hmac-sha256-128", R_SESSION_SIG_ALGO_HMAC_SHA256_128},
+      {"hmac-sha256-256", R_SESSION_SIG_ALGO_HMAC_SHA256_256},
+      {"aes-gmac-64", R_SESSION_SIG_ALGO_AES_GMAC_64},
+      {"aes-gmac-128", R_SESSION_SIG_ALGO_AES_GMAC_128},
+      {"hmac-sha3-80", R_SESSION_SIG_ALGO_HMAC_SHA3_80},
+      {"hmac-sha3-128", R_SESSION_SIG_ALGO_HMAC_SHA3_128},
+      {"hmac-sha3-256", R_SESSION_SIG_ALGO_HMAC_SHA3_256}};
+  for (const auto &entry : kAlgorithms) {
+    if (name == entry.name) {
+      algorithm = entry.algorithm;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool parseHexKey(const std::string &text, std::vector<uint8_t> &key) {
+  std::vector<uint8_t> bytes;
+  int high = -1;
+  for (char c : text) {
+    if (c == ':' || c == '-' || c == ' ')
+      continue;
+    int digit = hexDigit(c);
+    if (digit < 0)
+      return false;
+    if (high < 0) {
+      high = digit;
+    } else {
+      bytes.push_back(static_cast<uint8_t>(high << 4 | digit));
+      high = -1;
+    }
+  }
+  if (high >= 0 || bytes.empty())
+    return false;
+  key = std::move(bytes);
+  return true;
+}
+
+RSessionHandle openRSession(const core::RSessionConfig &config,
+                            std::atomic<uint64_t> *unknownKeys) {
+  RSessionHandle session(RSession_create());
+  if (!session) {
+    LOG_ERROR("R-Session: out of memory");
+    return nullptr;
+  }
+
+  bool publishing = !config.remoteAddress.empty();
+  RSessionError error =
+      publishing
+          ? RSession_setRemoteAddress(session.get(),
+                                      config.remoteAddress.c_str(),
+                                      config.port)
+          : RSession_setLocalAddress(session.get(),
+                                     config.localAddress.c_str(),
+                                     config.port);
+  if (error != R_SESSION_ERROR_OK) {
+    LOG_ERROR("R-Session: cannot use {} (error {})", describeRSession(config),
+              static_cast<int>(error));
+    return nullptr;
+  }
+  if (!publishing) {
+    for (const auto &group : config.multicastGroups) {
+      if (RSession_addMulticastGroup(session.get(), group.c_str()) !=
+          R_SESSION_ERROR_OK) {
+        LOG_ERROR("R-Session: cannot join multicast group {}", group);
+        return nullptr;
+      }
+    }
+  }
+
+  for (const auto &key : config.keys) {
+    RSecurityAlgorithm security;
+    RSignatureAlgorithm signature;
+    std::vector<uint8_t> bytes;
+    if (!parseSecurityAlgorithm(key.security, security) ||
+        !parseSignatureAlgorithm(key.signature, signature) ||
+        !parseHexKey(key.key, bytes)) {
+      LOG_ERROR("R-Session: key {} is invalid ({} / {})", key.id,
+                key.security, key.signature);
+      return nullptr;
+    }
+    error = RSession_addKey(session.get(), key.id, bytes.data(),
+                            static_cast<int>(bytes.size()), security,
+                            signature);
+    if (error != R_SESSION_ERROR_OK) {
+      LOG_ERROR("R-Session: key {} refused (error {})", key.id,
+                static_cast<int>(error));
+      return nullptr;
+    }
+  }
+  if (config.activeKeyId &&
+      RSession_setActiveKey(session.get(), config.activeKeyId) !=
+          R_SESSION_ERROR_OK) {
+    LOG_ERROR("R-Session: active key {} is not configured",
+              config.activeKeyId);
+    return nullptr;
+  }
+  RSession_setKeyEventHandler(session.get(), onKeyEvent, unknownKeys);
+
+  // Receiving sessions are started by their receiver
+  if (publishing && RSession_start(session.get()) != R_SESSION_ERROR_OK) {
+    LOG_ERROR("R-Session: cannot open a socket for {}",
+              describeRSession(config));
+    return nullptr;
+  }
+  return session;
+}
+
+std::string describeRSession(const core::RSessionConfig &config) {
+  const std::string &address = config.remoteAddress.empty()
+                                   ? config.localAddress
+                                   : config.remoteAddress;
+  return "udp://" + address + ":" + std::to_string(config.port);
+}
+
+} // namespace capture
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "core/config_parser.h"
+#include <atomic>
+#include <cstdint>
+#include <libiec61850/r_session.h>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace gateway {
+namespace iec61850 {
+namespace capture {
+
+// "none", "aes-128-gcm", "aes-256-gcm"
+bool parseSecurityAlgorithm(const std::string &name,
+                            RSecurityAlgorithm &algorithm);
+
+// "none", "hmac-sha256-80", ..., "aes-gmac-64", ..., "hmac-sha3-256"
+bool parseSignatureAlgorithm(const std::string &name,
+                             RSignatureAlgorithm &algorithm);
+
+// Even number of hex digits, optionally separated by ':', '-' or spaces
+bool parseHexKey(const std::string &text, std::vector<uint8_t> &key);
+
+struct RSessionDeleter {
+  void operator()(RSession session) const { RSession_destroy(session); }
+};
+using RSessionHandle =
+    std::unique_ptr<std::remove_pointer<RSession>::type, RSessionDeleter>;
+
+/**
+ * @brief Create an R-GOOSE/R-SV session as configured
+ *
+ * Without a remote address the session receives: it is bound to the
+ * local address and port and joins the multicast groups when its
+ * receiver starts. With one it publishes and is started here. Every key
+ * is installed; the active key secures sent messages.
+ * @param unknownKeys Counts messages referencing a key not configured
+ * @return nullptr, logged, if a setting or key is refused
+ */
+RSessionHandle openRSession(const core::RSessionConfig &config,
+                            std::atomic<uint64_t> *unknownKeys = nullptr);
+
+/**
+ * @brief "udp://address:port" of a session, for status displays
+ */
+std::string describeRSession(const core::RSessionConfig &config);
+
+} // namespace capture
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,137 @@
+#include "duplicate_filter.h"
+#include <algorithm>
+#include <chrono>
+
+namespace gateway {
+namespace iec61850 {
+namespace goose {
+
+namespace {
+
+// Slot word: fingerprint (32) | LAN (1) | arrival time in us (31)
+constexpr uint64_t kTimeMask = 0x7FFFFFFF;
+constexpr int kLanShift = 31;
+constexpr int kFingerprintShift = 32;
+
+// Slots per bucket; one cache line
+constexpr size_t kWays = 8;
+
+// splitmix64 finalizer
+uint64_t mix(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBULL;
+  x ^= x >> 31;
+  return x;
+}
+
+void updateMax(std::atomic<uint32_t> &max, uint32_t value) {
+  uint32_t current = max.load(std::memory_order_relaxed);
+  while (value > current &&
+         !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    ;
+}
+
+} // namespace
+
+DuplicateFilter::DuplicateFilter(int lans, size_t slots)
+    : lans_(std::min(std::max(lans, 1), kMaxLans)) {
+  size_t size = kWays;
+  while (size < slots)
+    size <<= 1;
+  mask_ = size - 1;
+  slots_.reset(new std::atomic<uint64_t>[size]);
+  for (size_t i = 0; i < size; ++i)
+    slots_[i].store(0, std::memory_order_relaxed);
+}
+
+bool DuplicateFilter::accept(int lan, uint16_t appId, const uint8_t srcMac[6],
+                             uint32_t stNum, uint32_t sqNum) {
+  auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch());
+  return accept(lan, appId, srcMac, stNum, sqNum,
+                static_cast<uint64_t>(now.count()));
+}
+
+bool DuplicateFilter::accept(int lan, uint16_t appId, const uint8_t srcMac[6],
+                             uint32_t stNum, uint32_t sqNum, uint64_t nowUs) {
+  lan = std::min(std::max(lan, 0), lans_ - 1);
+  LanCounters &counters = counters_[lan];
+  counters.arrivals.fetch_add(1, std::memory_order_relaxed);
+
+  uint64_t source = appId;
+  for (int i = 0; i < 6; ++i)
+    source = (source << 8) | srcMac[i];
+  uint64_t hash =
+      mix(source ^ mix((static_cast<uint64_t>(stNum) << 32) | sqNum));
+
+  // Odd fingerprints keep claimed slots distinct from empty ones
+  uint64_t fingerprint = (hash >> kFingerprintShift) | 1;
+  uint64_t word = (fingerprint << kFingerprintShift) |
+                  (static_cast<uint64_t>(lan) << kLanShift) |
+                  (nowUs & kTimeMask);
+
+  std::atomic<uint64_t> *bucket = &slots_[(hash & mask_) & ~(kWays - 1)];
+  while (true) {
+    // Look for the other copy; otherwise claim an empty or the oldest slot
+    int victim = 0;
+    uint64_t victimWord = 0;
+    uint64_t victimAge = 0;
+    for (size_t i = 0; i < kWays; ++i) {
+      uint64_t current = bucket[i].load(std::memory_order_acquire);
+      if ((current >> kFingerprintShift) == fingerprint) {
+        auto skew = static_cast<uint32_t>((nowUs - current) & kTimeMask);
+        counters.duplicates.fetch_add(1, std::memory_order_relaxed);
+        counters.skewSumUs.fetch_add(skew, std::memory_order_relaxed);
+        counters.lastSkewUs.store(skew, std::memory_order_relaxed);
+        updateMax(counters.maxSkewUs, skew);
+        return false;
+      }
+      // Stamped by another LAN after our clock read: newest, not oldest
+      uint64_t age = (nowUs - current) & kTimeMask;
+      age = !current ? ~0ULL : age > kTimeMask / 2 ? 0 : age + 1;
+      if (age > victimAge) {
+        victim = static_cast<int>(i);
+        victimWord = current;
+        victimAge = age;
+      }
+    }
+    // A failed exchange means the bucket changed; it may now hold the copy
+    if (bucket[victim].compare_exchange_strong(victimWord, word,
+                                               std::memory_order_acq_rel)) {
+      counters.accepted.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+}
+
+LanStats DuplicateFilter::getStats(int lan) const {
+  LanStats stats;
+  if (lan < 0 || lan >= lans_)
+    return stats;
+  const LanCounters &counters = counters_[lan];
+  stats.arrivals = counters.arrivals.load(std::memory_order_relaxed);
+  stats.accepted = counters.accepted.load(std::memory_order_relaxed);
+  stats.duplicates = counters.duplicates.load(std::memory_order_relaxed);
+  stats.maxSkewUs = counters.maxSkewUs.load(std::memory_order_relaxed);
+  stats.lastSkewUs = counters.lastSkewUs.load(std::memory_order_relaxed);
+  if (stats.duplicates) {
+    uint64_t skewSum = counters.skewSumUs.load(std::memory_order_relaxed);
+    stats.avgSkewUs =
+        static_cast<double>(skewSum) / static_cast<double>(stats.duplicates);
+  }
+
+  // Every distinct frame should have arrived once on each PRP LAN
+  if (lans_ > 1) {
+    uint64_t unique = 0;
+    for (int i = 0; i < lans_; ++i)
+      unique += counters_[i].accepted.load(std::memory_order_relaxed);
+    stats.missing = unique > stats.arrivals ? unique - stats.arrivals : 0;
+  }
+  return stats;
+}
+
+} // namespace goose
+} // namespace iec61850
+} // namespace gateway
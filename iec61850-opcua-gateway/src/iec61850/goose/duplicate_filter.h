@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace gateway {
+namespace iec61850 {
+namespace goose {
+
+struct LanStats {
+  uint64_t arrivals = 0;   // Frames seen on this LAN
+  uint64_t accepted = 0;   // Frames this LAN delivered first
+  uint64_t duplicates = 0; // Frames the other copy had already delivered
+  uint64_t missing = 0;    // Frames only the other LAN delivered (PRP)
+  uint64_t filtered = 0;   // Other publishers' frames, dropped undecoded
+  double dispatchNs = 0.0; // Mean APPID/MAC lookup cost per frame
+  double dispatchProbes = 0.0;
+  double messageRate = 0.0; // Arrivals/s, filled in by the reader
+  double avgSkewUs = 0.0;  // How late this LAN's duplicates arrived
+  uint32_t maxSkewUs = 0;
+  uint32_t lastSkewUs = 0;
+};
+
+/**
+ * @brief Lock-free duplicate discard for PRP/HSR redundant GOOSE copies
+ *
+ * Frames are keyed on (APPID, source MAC, stNum, sqNum). Each key hashes
+ * to an 8-way bucket of a fixed table whose slots hold a 32-bit
+ * fingerprint, the LAN and the arrival time. The copy whose
+ * compare-exchange claims a slot is delivered; later copies find the
+ * fingerprint, are discarded and their lateness is recorded as skew. The
+ * oldest slot of a bucket is reused, so the table must cover the frames
+ * in flight during the skew between the LANs. A slot lost early only lets
+ * a duplicate through, which the stNum check of the subscriber absorbs.
+ */
+class DuplicateFilter {
+public:
+  static constexpr int kMaxLans = 2;
+
+  /**
+   * @param lans Number of receiving LANs (2 for PRP, 1 for HSR)
+   * @param slots Table size, rounded up to a power of two
+   */
+  explicit DuplicateFilter(int lans = kMaxLans, size_t slots = 4096);
+
+  /**
+   * @brief Register a frame seen on @p lan
+   * @return true for the first copy, false for a duplicate
+   */
+  bool accept(int lan, uint16_t appId, const uint8_t srcMac[6],
+              uint32_t stNum, uint32_t sqNum);
+  bool accept(int lan, uint16_t appId, const uint8_t srcMac[6],
+              uint32_t stNum, uint32_t sqNum, uint64_t nowUs);
+
+  int lanCount() const { return lans_; }
+  LanStats getStats(int lan) const;
+
+private:
+  struct alignas(64) LanCounters {
+    std::atomic<uint64_t> arrivals{0};
+    std::atomic<uint64_t> accepted{0};
+    std::atomic<uint64_t> duplicates{0};
+    std::atomic<uint64_t> skewSumUs{0};
+    std::atomic<uint32_t> maxSkewUs{0};
+    std::atomic<uint32_t> lastSkewUs{0};
+  };
+
+  int lans_;
+  size_t mask_;
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  LanCounters counters_[kMaxLans];
+};
+
+} // namespace goose
+} // namespace iec61850
+} // namespace gateway
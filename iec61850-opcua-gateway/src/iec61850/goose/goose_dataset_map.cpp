@@ -0,0 +1,221 @@
+#include "goose_dataset_map.h"
+#include "core/logger.h"
+#include <algorithm>
+
+namespace gateway {
+namespace iec61850 {
+namespace goose {
+
+namespace {
+
+const LogicalNode *findLogicalNode(const IEDConfig &ied,
+                                   const DataSetMember &member,
+                                   const LogicalDevice **ld) {
+  for (const auto &device : ied.logicalDevices) {
+    if (device.inst != member.ldInst)
+      continue;
+    for (const auto &ln : device.logicalNodes) {
+      if (ln.lnClass == member.lnClass && ln.inst == member.lnInst) {
+        *ld = &device;
+        return &ln;
+      }
+    }
+  }
+  return nullptr;
+}
+
+const DataObject *findDataObject(const LogicalNode &ln,
+                                 const std::string &name) {
+  for (const auto &dobj : ln.dataObjects) {
+    if (dobj.name == name)
+      return &dobj;
+  }
+  return nullptr;
+}
+
+// Component names directly below @p prefix, in DOType order
+std::vector<std::string> components(const DOTypeTemplate &type,
+                                    const std::string &prefix,
+                                    const std::string &fc) {
+  std::vector<std::string> result;
+  std::string start = prefix.empty() ? "" : prefix + ".";
+  for (const auto &da : type.attributes) {
+    if (da.fc != fc || da.name.compare(0, start.size(), start) != 0)
+      continue;
+    std::string rest = da.name.substr(start.size());
+    std::string name = rest.substr(0, rest.find('.'));
+    if (std::find(result.begin(), result.end(), name) == result.end())
+      result.push_back(name);
+  }
+  return result;
+}
+
+// Path from the member (at @p memberPath below the DO) to @p primary
+bool pathTo(const DOTypeTemplate &type, const std::string &memberPath,
+            const std::string &primary, const std::string &fc,
+            std::vector<int> &path) {
+  bool hasPrimary = false;
+  for (const auto &da : type.attributes)
+    hasPrimary |= da.name == primary && da.fc == fc;
+  if (!hasPrimary)
+    return false;
+  if (memberPath == primary)
+    return true;
+  if (!memberPath.empty() &&
+      primary.compare(0, memberPath.size() + 1, memberPath + ".") != 0)
+    return false;
+
+  std::string prefix = memberPath;
+  size_t pos = memberPath.empty() ? 0 : memberPath.size() + 1;
+  while (pos <= primary.size()) {
+    size_t end = primary.find('.', pos);
+    if (end == std::string::npos)
+      end = primary.size();
+    std::string segment = primary.substr(pos, end - pos);
+
+    auto names = components(type, prefix, fc);
+    auto it = std::find(names.begin(), names.end(), segment);
+    if (it == names.end())
+      return false;
+    path.push_back(static_cast<int>(it - names.begin()));
+
+    prefix = prefix.empty() ? segment : prefix + "." + segment;
+    pos = end + 1;
+  }
+  return true;
+}
+
+// The namespace binds top-level DOs; an SDO is a path below it
+struct ResolvedMember {
+  const LogicalDevice *ld = nullptr;
+  const LogicalNode *ln = nullptr;
+  const DataObject *dobj = nullptr;
+  std::string doName;
+  std::string path; // Below the DO, empty for the DO itself
+};
+
+bool resolveMember(const IEDConfig &ied, const DataSetMember &member,
+                   ResolvedMember &out) {
+  out.ln = findLogicalNode(ied, member, &out.ld);
+  if (!out.ln)
+    return false;
+
+  out.doName = member.doName.substr(0, member.doName.find('.'));
+  out.path.clear();
+  if (out.doName.size() < member.doName.size())
+    out.path = member.doName.substr(out.doName.size() + 1);
+  if (!member.daName.empty())
+    out.path += (out.path.empty() ? "" : ".") + member.daName;
+
+  out.dobj = findDataObject(*out.ln, out.doName);
+  return out.dobj != nullptr;
+}
+
+MmsValue *newLeaf(const std::string &bType) {
+  if (bType == "BOOLEAN")
+    return MmsValue_newBoolean(false);
+  if (bType == "FLOAT32")
+    return MmsValue_newFloat(0.0f);
+  if (bType == "FLOAT64")
+    return MmsValue_newDouble(0.0);
+  if (bType == "Dbpos" || bType == "Tcmd" || bType == "Check")
+    return MmsValue_newBitString(2);
+  if (bType == "Quality")
+    return MmsValue_newBitString(13);
+  if (bType == "Timestamp")
+    return MmsValue_newUtcTime(0);
+  if (bType == "INT64")
+    return MmsValue_newIntegerFromInt64(0);
+  if (bType.compare(0, 3, "INT") == 0 && bType.back() == 'U')
+    return MmsValue_newUnsignedFromUint32(0);
+  if (bType.compare(0, 9, "VisString") == 0 ||
+      bType.compare(0, 7, "Unicode") == 0)
+    return MmsValue_newVisibleString("");
+  if (bType.compare(0, 5, "Octet") == 0)
+    return MmsValue_newOctetString(0, 64);
+  return MmsValue_newIntegerFromInt32(0); // INTn, Enum
+}
+
+// Value of the attribute or structure at @p prefix below the DO
+MmsValue *newValue(const DOTypeTemplate &type, const std::string &prefix,
+                   const std::string &fc) {
+  for (const auto &da : type.attributes) {
+    if (da.name == prefix && da.fc == fc)
+      return newLeaf(da.bType);
+  }
+  auto names = components(type, prefix, fc);
+  if (names.empty())
+    return nullptr;
+  MmsValue *value =
+      MmsValue_createEmptyStructure(static_cast<int>(names.size()));
+  for (size_t i = 0; i < names.size(); ++i) {
+    MmsValue *element =
+        newValue(type, prefix.empty() ? names[i] : prefix + "." + names[i],
+                 fc);
+    MmsValue_setElement(value, static_cast<int>(i),
+                        element ? element : MmsValue_newBoolean(false));
+  }
+  return value;
+}
+
+} // namespace
+
+GooseDataSetMap::GooseDataSetMap(const IEDConfig &ied,
+                                 const GOOSEControlBlock &gcb) {
+  members_.resize(gcb.members.size());
+  for (size_t i = 0; i < gcb.members.size(); ++i) {
+    const DataSetMember &member = gcb.members[i];
+    ResolvedMember resolved;
+    if (!resolveMember(ied, member, resolved))
+      continue;
+
+    std::vector<int> path;
+    bool bound;
+    const DataObject *dobj = resolved.dobj;
+    if (dobj->typeTemplate) {
+      bound = pathTo(*dobj->typeTemplate, resolved.path,
+                     primaryAttribute(*dobj->typeTemplate), member.fc, path);
+    } else {
+      bound = resolved.path == "stVal" || resolved.path == "mag.f";
+    }
+    if (!bound)
+      continue;
+
+    members_[i].reference = ied.name + "/" + resolved.ld->name + "/" +
+                            resolved.ln->name + "." + resolved.doName;
+    members_[i].path = std::move(path);
+    bound_++;
+  }
+
+  LOG_DEBUG("GOOSE {}: {} of {} data set members bound", gcb.reference,
+            bound_, members_.size());
+}
+
+MmsValue *createMemberValue(const IEDConfig &ied, const DataSetMember &member,
+                            std::vector<int> *timePath) {
+  ResolvedMember resolved;
+  if (!resolveMember(ied, member, resolved))
+    return nullptr;
+
+  const DOTypeTemplate *type = resolved.dobj->typeTemplate.get();
+  if (!type) {
+    if (resolved.path == "stVal")
+      return MmsValue_newBoolean(false);
+    if (resolved.path == "mag.f")
+      return MmsValue_newFloat(0.0f);
+    return nullptr;
+  }
+
+  MmsValue *value = newValue(*type, resolved.path, member.fc);
+  if (value && timePath && MmsValue_getType(value) == MMS_STRUCTURE) {
+    auto names = components(*type, resolved.path, member.fc);
+    auto it = std::find(names.begin(), names.end(), "t");
+    if (it != names.end())
+      timePath->assign(1, static_cast<int>(it - names.begin()));
+  }
+  return value;
+}
+
+} // namespace goose
+} // namespace iec61850
+} // namespace gateway
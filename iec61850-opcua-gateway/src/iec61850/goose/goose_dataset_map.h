@@ -0,0 +1,59 @@
+#pragma once
+
+#include "iec61850/scl/scl_parser.h"
+#include <cstddef>
+#include <libiec61850/mms_value.h>
+#include <string>
+#include <vector>
+
+namespace gateway {
+namespace iec61850 {
+namespace goose {
+
+/**
+ * @brief Where one data set member ends up in the point database
+ */
+struct MemberBinding {
+  std::string reference; // DataBinder reference (IED/LD/LN.DO), empty = none
+  std::vector<int> path; // Structure element indexes down to the bound value
+};
+
+/**
+ * @brief Maps the members of a GOOSE data set, in FCDA order, to the
+ * references the namespace binds
+ *
+ * A DO is bound through its primaryAttribute(), as in the namespace: stVal,
+ * mag.f, cVal.mag.f, ... A member is bound when it is that attribute or a
+ * structure containing it; the path then walks the MMS structure
+ * components, which follow the DOType order filtered by the member's FC. Quality, time stamps and other attributes
+ * are left unbound. Everything is resolved here, once per subscription, so
+ * message handling only indexes into the received values.
+ */
+class GooseDataSetMap {
+public:
+  GooseDataSetMap() = default;
+  GooseDataSetMap(const IEDConfig &ied, const GOOSEControlBlock &gcb);
+
+  const std::vector<MemberBinding> &members() const { return members_; }
+  size_t size() const { return members_.size(); }
+  size_t boundCount() const { return bound_; }
+
+private:
+  std::vector<MemberBinding> members_;
+  size_t bound_ = 0;
+};
+
+/**
+ * @brief New MMS value shaped like a data set member, for publishing
+ *
+ * Structures follow the DOType order filtered by the member's FC, as in
+ * received data sets; leaves start out zero, false or good quality.
+ * @param timePath Set to the path of the member's "t" component, if any
+ * @return nullptr if the member is not in the IED's data model
+ */
+MmsValue *createMemberValue(const IEDConfig &ied, const DataSetMember &member,
+                            std::vector<int> *timePath = nullptr);
+
+} // namespace goose
+} // namespace iec61850
+} // namespace gateway
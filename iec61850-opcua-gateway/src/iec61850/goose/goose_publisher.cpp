@@ -0,0 +1,395 @@
+#include "goose_publisher.h"
+#include "core/logger.h"
+#include "core/metrics.h"
+#include "goose_dataset_map.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace gateway {
+namespace iec61850 {
+namespace goose {
+
+namespace {
+
+constexpr auto kRelaxed = std::memory_order_relaxed;
+
+// Longest sleep of the timer thread without any message due
+constexpr auto kIdleWait = std::chrono::seconds(1);
+
+// "01-0C-CD-01-00-01" or "01:0C:CD:01:00:01"
+bool parseMac(const std::string &text, uint8_t mac[6]) {
+  unsigned int b[6];
+  char sep[5];
+  if (std::sscanf(text.c_str(), "%2x%c%2x%c%2x%c%2x%c%2x%c%2x", &b[0],
+                  &sep[0], &b[1], &sep[1], &b[2], &sep[2], &b[3], &sep[3],
+                  &b[4], &sep[4], &b[5]) != 11)
+    return false;
+  for (int i = 0; i < 6; ++i)
+    mac[i] = static_cast<uint8_t>(b[i]);
+  return true;
+}
+
+MmsValue *resolve(MmsValue *value, const std::vector<int> &path) {
+  for (int index : path) {
+    if (!value || MmsValue_getType(value) != MMS_STRUCTURE ||
+        index >= static_cast<int>(MmsValue_getArraySize(value)))
+      return nullptr;
+    value = MmsValue_getElement(value, index);
+  }
+  return value;
+}
+
+bool number(const MmsValue *value, double &result) {
+  switch (MmsValue_getType(value)) {
+  case MMS_BOOLEAN:
+    result = MmsValue_getBoolean(value) ? 1.0 : 0.0;
+    return true;
+  case MMS_FLOAT:
+    result = MmsValue_toDouble(value);
+    return true;
+  case MMS_INTEGER:
+    result = static_cast<double>(MmsValue_toInt64(value));
+    return true;
+  case MMS_UNSIGNED:
+    result = MmsValue_toUint32(value);
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Convert @p source into the published member @p target
+bool assign(MmsValue *target, const MmsValue *source) {
+  if (MmsValue_equalTypes(target, source) && MmsValue_update(target, source))
+    return true;
+  double n = 0.0;
+  if (!number(source, n))
+    return false;
+  switch (MmsValue_getType(target)) {
+  case MMS_BOOLEAN:
+    MmsValue_setBoolean(target, n != 0.0);
+    return true;
+  case MMS_FLOAT:
+    MmsValue_setDouble(target, n);
+    return true;
+  case MMS_INTEGER:
+    MmsValue_setInt64(target, static_cast<int64_t>(n));
+    return true;
+  case MMS_UNSIGNED:
+    MmsValue_setUint32(target, n < 0.0 ? 0 : static_cast<uint32_t>(n));
+    return true;
+  case MMS_BIT_STRING:
+    // Double point (Dbpos): DBPOS_OFF = 1, DBPOS_ON = 2
+    if (MmsValue_getBitStringSize(target) != 2)
+      return false;
+    MmsValue_setBitStringFromInteger(target, n != 0.0 ? 2 : 1);
+    return true;
+  default:
+    return false;
+  }
+}
+
+uint64_t nowMs() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+}
+
+} // namespace
+
+GOOSEPublisher::Publication::~Publication() {
+  if (publisher)
+    GoosePublisher_destroy(publisher);
+  if (dataSetValues)
+    LinkedList_destroyStatic(dataSetValues);
+  for (MmsValue *value : values)
+    MmsValue_delete(value);
+}
+
+GOOSEPublisher::GOOSEPublisher(const core::GOOSEPublisherConfig &config)
+    : config_(config) {}
+
+GOOSEPublisher::~GOOSEPublisher() { stop(); }
+
+std::unique_ptr<GOOSEPublisher::Publication>
+GOOSEPublisher::makePublication(const IEDConfig &ied,
+                                const GOOSEControlBlock &gcb) {
+  CommParameters params{};
+  char *end = nullptr;
+  unsigned long appId = std::strtoul(gcb.appID.c_str(), &end, 16);
+  if (gcb.appID.empty() || *end != '\0' || appId > 0xFFFF ||
+      !parseMac(gcb.macAddress, params.dstAddress)) {
+    LOG_WARN("GOOSE publisher: {} has no valid APPID/MAC address",
+             gcb.reference);
+    return nullptr;
+  }
+  params.appId = static_cast<uint16_t>(appId);
+  params.vlanId = static_cast<uint16_t>(gcb.vlanID & 0xFFF);
+  params.vlanPriority = static_cast<uint8_t>(gcb.vlanPriority & 0x7);
+
+  auto pub = std::make_unique<Publication>();
+  pub->goCbRef = gcb.reference;
+  pub->dataSet = gcb.dataSet;
+  for (const auto &member : gcb.members) {
+    std::vector<int> timePath;
+    MmsValue *value = createMemberValue(ied, member, &timePath);
+    if (!value) {
+      LOG_WARN("GOOSE publisher: {} member {}/{}.{}.{} not in the data model",
+               gcb.reference, member.ldInst,
+               member.prefix + member.lnClass + member.lnInst,
+               member.doName, member.daName);
+      return nullptr;
+    }
+    pub->values.push_back(value);
+    pub->timePaths.push_back(std::move(timePath));
+  }
+  pub->dataSetValues = LinkedList_create();
+  for (MmsValue *value : pub->values)
+    LinkedList_add(pub->dataSetValues, value);
+
+  pub->publisher = GoosePublisher_createEx(
+      &params, config_.interfaceName.c_str(), gcb.vlanID != 0);
+  if (!pub->publisher) {
+    LOG_ERROR("GOOSE publisher: cannot open {} for {}",
+              config_.interfaceName, gcb.reference);
+    return nullptr;
+  }
+  std::string dataSetRef = ied.name + gcb.ldInst + "/LLN0$" + gcb.dataSet;
+  std::string goID = gcb.goID.empty() ? gcb.reference : gcb.goID;
+  GoosePublisher_setGoCbRef(pub->publisher,
+                            const_cast<char *>(gcb.reference.c_str()));
+  GoosePublisher_setDataSetRef(pub->publisher,
+                               const_cast<char *>(dataSetRef.c_str()));
+  GoosePublisher_setGoID(pub->publisher, const_cast<char *>(goID.c_str()));
+  GoosePublisher_setConfRev(pub->publisher,
+                            static_cast<uint32_t>(gcb.confRev));
+
+  RetransmissionCurve curve;
+  curve.minTimeMs = static_cast<uint32_t>(
+      gcb.minTimeMs > 0 ? gcb.minTimeMs : config_.minTimeMs);
+  curve.maxTimeMs = static_cast<uint32_t>(
+      gcb.maxTimeMs > 0 ? gcb.maxTimeMs : config_.maxTimeMs);
+  pub->schedule = RetransmissionSchedule(curve);
+  return pub;
+}
+
+size_t GOOSEPublisher::configure(const std::vector<IEDConfig> &ieds) {
+  std::vector<std::unique_ptr<Publication>> publications;
+  std::unordered_map<std::string, std::vector<Binding>> bindings;
+  for (const auto &ied : ieds) {
+    if (ied.name != config_.iedName)
+      continue;
+    for (const auto &gcb : ied.gooseControls) {
+      if (gcb.reference.empty())
+        continue;
+      auto pub = makePublication(ied, gcb);
+      if (!pub)
+        continue;
+      GooseDataSetMap map(ied, gcb);
+      for (size_t i = 0; i < map.size(); ++i) {
+        const MemberBinding &member = map.members()[i];
+        if (!member.reference.empty())
+          bindings[member.reference].push_back(
+              {publications.size(), i, member.path});
+      }
+      pub->boundMembers = map.boundCount();
+      publications.push_back(std::move(pub));
+    }
+  }
+  if (publications.empty())
+    LOG_WARN("GOOSE publisher: no GoCBs of IED '{}' in the SCD",
+             config_.iedName);
+
+  size_t count = publications.size();
+  size_t refs = bindings.size();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    publications_.swap(publications);
+    bindings_.swap(bindings);
+  }
+  wake_.notify_one();
+  LOG_INFO("GOOSE publisher: {} GoCBs, {} bound references", count, refs);
+  // The replaced publications are destroyed outside the lock
+  return count;
+}
+
+bool GOOSEPublisher::start() {
+  if (running_)
+    return true;
+  running_ = true;
+  thread_ = std::thread(&GOOSEPublisher::run, this);
+
+#ifdef __linux__
+  if (config_.threadPriority > 0) {
+    sched_param param{};
+    param.sched_priority = config_.threadPriority;
+    int rc = pthread_setschedparam(thread_.native_handle(), SCHED_FIFO,
+                                   &param);
+    if (rc != 0)
+      LOG_WARN("GOOSE publisher: SCHED_FIFO priority {} refused ({}), "
+               "running at normal priority",
+               config_.threadPriority, rc);
+  }
+#endif
+
+  LOG_INFO("GOOSE publisher started on {}", config_.interfaceName);
+  return true;
+}
+
+void GOOSEPublisher::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_)
+      return;
+    running_ = false;
+  }
+  wake_.notify_one();
+  if (thread_.joinable())
+    thread_.join();
+  LOG_INFO("GOOSE publisher stopped");
+}
+
+std::vector<std::string> GOOSEPublisher::getReferences() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::string> refs;
+  refs.reserve(bindings_.size());
+  for (const auto &pair : bindings_)
+    refs.push_back(pair.first);
+  std::sort(refs.begin(), refs.end());
+  return refs;
+}
+
+bool GOOSEPublisher::update(const std::string &ref, const MmsValue *value) {
+  Clock::time_point triggeredAt = Clock::now();
+  if (!value)
+    return false;
+
+  bool applied = false;
+  bool changed = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = bindings_.find(ref);
+    if (it == bindings_.end())
+      return false;
+
+    for (const auto &binding : it->second) {
+      Publication &pub = *publications_[binding.publication];
+      MmsValue *target = resolve(pub.values[binding.member], binding.path);
+      if (!target)
+        continue;
+      MmsValue *previous = MmsValue_clone(target);
+      if (!assign(target, value)) {
+        MmsValue_delete(previous);
+        LOG_WARN("GOOSE publisher: {} cannot carry a {} value for {}",
+                 pub.goCbRef,
+                 MmsValue_getTypeString(const_cast<MmsValue *>(value)), ref);
+        continue;
+      }
+      applied = true;
+      bool same = MmsValue_equals(previous, target);
+      MmsValue_delete(previous);
+      if (same)
+        continue;
+
+      const auto &timePath = pub.timePaths[binding.member];
+      if (!timePath.empty()) {
+        MmsValue *t = resolve(pub.values[binding.member], timePath);
+        if (t && MmsValue_getType(t) == MMS_UTC_TIME)
+          MmsValue_setUtcTimeMs(t, nowMs());
+      }
+      // Writes before the state goes out are coalesced into it
+      if (!pub.changed) {
+        pub.changed = true;
+        pub.latencyPending = true;
+        pub.triggeredAt = triggeredAt;
+      }
+      pub.schedule.trigger(triggeredAt);
+      changed = true;
+    }
+  }
+  if (changed)
+    wake_.notify_one();
+  return applied;
+}
+
+void GOOSEPublisher::publish(Publication &pub, Clock::time_point now) {
+  if (pub.changed && pub.sent) {
+    GoosePublisher_increaseStNum(pub.publisher);
+    pub.stNum.store(pub.stNum.load(kRelaxed) + 1, kRelaxed);
+    pub.sqNum.store(0, kRelaxed);
+    core::increment(pub.stateChanges);
+  }
+  bool repeat = !pub.changed && pub.sent;
+  pub.changed = false;
+  pub.sent = true;
+
+  GoosePublisher_setTimeAllowedToLive(
+      pub.publisher,
+      pub.schedule.curve().timeAllowedToLiveMs(pub.schedule.repeat()));
+  int rc = GoosePublisher_publish(pub.publisher, pub.dataSetValues);
+  Clock::time_point done = Clock::now();
+
+  if (rc != 0) {
+    core::increment(pub.sendErrors);
+  } else {
+    core::increment(pub.messages);
+    pub.sqNum.store(pub.sqNum.load(kRelaxed) + 1, kRelaxed);
+    if (repeat)
+      core::increment(pub.retransmissions);
+    if (pub.latencyPending) {
+      pub.latencyPending = false;
+      pub.latency.record(static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              done - pub.triggeredAt)
+              .count()));
+    }
+  }
+  pub.intervalMs.store(pub.schedule.nextIntervalMs(), kRelaxed);
+  pub.schedule.sent(now);
+}
+
+void GOOSEPublisher::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  // A new GoCB starts out due, so each sends its initial state first
+  while (running_) {
+    Clock::time_point now = Clock::now();
+    Clock::time_point next = now + kIdleWait;
+    for (auto &pub : publications_) {
+      if (pub->schedule.due(now))
+        publish(*pub, now);
+      next = std::min(next, pub->schedule.next());
+    }
+    wake_.wait_until(lock, next);
+  }
+}
+
+std::vector<PublicationStats> GOOSEPublisher::getStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<PublicationStats> result;
+  for (const auto &pub : publications_) {
+    PublicationStats s;
+    s.goCbRef = pub->goCbRef;
+    s.dataSet = pub->dataSet;
+    s.stNum = pub->stNum.load(kRelaxed);
+    s.sqNum = pub->sqNum.load(kRelaxed);
+    s.messages = pub->messages.load(kRelaxed);
+    s.stateChanges = pub->stateChanges.load(kRelaxed);
+    s.retransmissions = pub->retransmissions.load(kRelaxed);
+    s.sendErrors = pub->sendErrors.load(kRelaxed);
+    s.currentIntervalMs = pub->intervalMs.load(kRelaxed);
+    s.boundMembers = pub->boundMembers;
+    s.latency = pub->latency.snapshot();
+    result.push_back(std::move(s));
+  }
+  return result;
+}
+
+} // namespace goose
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "core/config_parser.h"
+#include "goose_statistics.h"
+#include "iec61850/scl/scl_parser.h"
+#include "retransmission_curve.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <libiec61850/goose_publisher.h>
+#include <libiec61850/linked_list.h>
+#include <libiec61850/mms_value.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace gateway {
+namespace iec61850 {
+namespace goose {
+
+struct PublicationStats {
+  std::string goCbRef;
+  std::string dataSet;
+  uint32_t stNum = 0;
+  uint32_t sqNum = 0;
+  uint64_t messages = 0;
+  uint64_t stateChanges = 0;
+  uint64_t retransmissions = 0; // Messages repeating an unchanged state
+  uint64_t sendErrors = 0;
+  uint32_t currentIntervalMs = 0; // Until the next message
+  size_t boundMembers = 0;
+  PublishLatencySnapshot latency; // From the triggering write
+};
+
+/**
+ * @brief Publishes the gateway IED's GoCBs from the SCD
+ *
+ * Each GoCB keeps its data set as MMS values; update() changes a member
+ * and starts a new state, which the timer thread sends at once and then
+ * repeats along the GSE's retransmission curve down to the heartbeat.
+ * The timer thread sleeps until the earliest due message and may run at
+ * real-time priority, so retransmissions are not delayed by the OPC UA
+ * or REST threads.
+ */
+class GOOSEPublisher {
+public:
+  explicit GOOSEPublisher(const core::GOOSEPublisherConfig &config);
+  ~GOOSEPublisher();
+
+  /**
+   * @brief Publish the GoCBs of the configured IED, replacing those of an
+   * earlier SCD; may be called while running
+   * @return Number of GoCBs published
+   */
+  size_t configure(const std::vector<IEDConfig> &ieds);
+
+  /**
+   * @brief Start the timer thread; every GoCB sends its initial state
+   */
+  bool start();
+  void stop();
+  bool isRunning() const { return running_; }
+
+  /**
+   * @brief DataBinder references bound into a published data set
+   */
+  std::vector<std::string> getReferences() const;
+
+  /**
+   * @brief Set the value of every data set member bound to @p ref
+   *
+   * A value that differs from the published one is a state change: stNum
+   * increases and the new state goes out immediately. Booleans are mapped
+   * onto double points and numbers converted as the member requires.
+   * @return false if @p ref is not published or the value does not fit
+   */
+  bool update(const std::string &ref, const MmsValue *value);
+
+  std::vector<PublicationStats> getStats() const;
+
+private:
+  using Clock = RetransmissionSchedule::Clock;
+
+  struct Publication {
+    std::string goCbRef;
+    std::string dataSet;
+    GoosePublisher publisher = nullptr;
+    std::vector<MmsValue *> values; // One per data set member, FCDA order
+    std::vector<std::vector<int>> timePaths; // Per member, empty = no "t"
+    LinkedList dataSetValues = nullptr;      // Borrows values
+    RetransmissionSchedule schedule;
+    size_t boundMembers = 0;
+
+    bool sent = false;           // Initial state went out
+    bool changed = false;        // New state not yet sent
+    bool latencyPending = false; // Waiting for a message to reach the wire
+    Clock::time_point triggeredAt;
+
+    std::atomic<uint32_t> stNum{1};
+    std::atomic<uint32_t> sqNum{0};
+    std::atomic<uint64_t> messages{0};
+    std::atomic<uint64_t> stateChanges{0};
+    std::atomic<uint64_t> retransmissions{0};
+    std::atomic<uint64_t> sendErrors{0};
+    std::atomic<uint32_t> intervalMs{0};
+    PublishLatencyStats latency;
+
+    ~Publication();
+  };
+
+  struct Binding {
+    size_t publication = 0;
+    size_t member = 0;
+    std::vector<int> path;
+  };
+
+  std::unique_ptr<Publication> makePublication(const IEDConfig &ied,
+                                               const GOOSEControlBlock &gcb);
+  void run();
+  void publish(Publication &pub, Clock::time_point now);
+
+  core::GOOSEPublisherConfig config_;
+
+  // Guards publications, bindings and every value and schedule in them;
+  // held by the timer thread while it sends
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::vector<std::unique_ptr<Publication>> publications_;
+  std::unordered_map<std::string, std::vector<Binding>> bindings_;
+
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+};
+
+} // namespace goose
+} // namespace iec61850
+} // namespace gateway
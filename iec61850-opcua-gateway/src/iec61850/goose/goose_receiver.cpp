@@ -1,21 +1,44 @@
 #include "goose_receiver.h"
 #include "core/logger.h"
+#include <algorithm>
+#include <chrono>
+#include <libiec61850/hal_ethernet.h>
 
 namespace gateway {
 namespace iec61850 {
 namespace goose {
 
-GOOSEReceiver::GOOSEReceiver(const std::string &interfaceName)
-    : interfaceName_(interfaceName) {
-  receiver_ = GooseReceiver_create();
-  GooseReceiver_setInterfaceId(receiver_, interfaceName_.c_str());
+namespace {
+constexpr int kMaxFrameSize = 1536;
+constexpr unsigned int kWaitMs = 100;
+// RSession's socket is not exposed to wait on; poll it while idle
+constexpr auto kSessionPoll = std::chrono::microseconds(200);
+} // namespace
+
+GOOSEReceiver::GOOSEReceiver(const std::string &interfaceName,
+                             bool packetRing)
+    : interfaceName_(interfaceName), packetRing_(packetRing) {}
+
+GOOSEReceiver::GOOSEReceiver(const core::RSessionConfig &session)
+    : interfaceName_(capture::describeRSession(session)), packetRing_(false),
+      routable_(true) {
+  session_ = capture::openRSession(session, &unknownKeys_);
+  if (session_)
+    remote_ = GooseReceiver_createRemote(session_.get());
 }
 
 GOOSEReceiver::~GOOSEReceiver() {
   stop();
-  if (receiver_) {
-    GooseReceiver_destroy(receiver_);
-    receiver_ = nullptr;
+  if (remote_) {
+    for (GooseSubscriber subscriber : remoteSubscribers_)
+      GooseReceiver_removeSubscriber(remote_, subscriber);
+    GooseReceiver_destroy(remote_);
+  }
+  // The subscribers belong to their manager
+  for (auto &decoder : decoders_) {
+    for (GooseSubscriber subscriber : decoder->subscribers)
+      GooseReceiver_removeSubscriber(decoder->receiver, subscriber);
+    GooseReceiver_destroy(decoder->receiver);
   }
 }
 
@@ -23,35 +46,204 @@ void GOOSEReceiver::start() {
   if (running_)
     return;
 
-  GooseReceiver_start(receiver_);
-  if (GooseReceiver_isRunning(receiver_)) {
+  if (routable_) {
+    if (!remote_ || !GooseReceiver_startThreadless(remote_)) {
+      LOG_ERROR("Failed to start R-GOOSE Receiver on {}", interfaceName_);
+      return;
+    }
     running_ = true;
-    LOG_INFO("GOOSE Receiver started on interface: {}", interfaceName_);
-  } else {
+    thread_ = std::thread(&GOOSEReceiver::sessionLoop, this);
+    LOG_INFO("R-GOOSE Receiver started on {}", interfaceName_);
+    return;
+  }
+
+  if (packetRing_ && capture::PacketRing::isSupported()) {
+    capture::PacketRingConfig config;
+    config.interfaceName = interfaceName_;
+    config.etherTypes = {capture::kEtherTypeGoose};
+    config.appIds = dispatcher_.appIds(capture::kEtherTypeGoose);
+    auto ring = std::make_unique<capture::PacketRing>();
+    if (ring->open(config)) {
+      ring_ = std::move(ring);
+      running_ = true;
+      thread_ = std::thread(&GOOSEReceiver::ringLoop, this);
+      LOG_INFO("GOOSE Receiver started on interface: {} (packet ring)",
+               interfaceName_);
+      return;
+    }
+    LOG_WARN("Packet ring unavailable on {}, using the socket",
+             interfaceName_);
+  }
+
+  // Every GOOSE multicast; the dispatcher picks the subscribed ones
+  socket_ = Ethernet_createSocket(interfaceName_.c_str(), nullptr);
+  if (!socket_) {
     LOG_ERROR("Failed to start GOOSE Receiver on interface: {}",
               interfaceName_);
+    return;
   }
+  Ethernet_setProtocolFilter(socket_, capture::kEtherTypeGoose);
+  Ethernet_setMode(socket_, ETHERNET_SOCKET_MODE_ALL_MULTICAST);
+  running_ = true;
+  thread_ = std::thread(&GOOSEReceiver::receiveLoop, this);
+  LOG_INFO("GOOSE Receiver started on interface: {}", interfaceName_);
 }
 
 void GOOSEReceiver::stop() {
   if (running_) {
-    GooseReceiver_stop(receiver_);
     running_ = false;
+    if (thread_.joinable())
+      thread_.join();
+    if (routable_) {
+      GooseReceiver_stopThreadless(remote_);
+    } else if (ring_) {
+      ring_.reset();
+    } else {
+      Ethernet_destroySocket(socket_);
+      socket_ = nullptr;
+    }
     LOG_INFO("GOOSE Receiver stopped on interface: {}", interfaceName_);
   }
 }
 
 bool GOOSEReceiver::isRunning() const { return running_; }
 
-void GOOSEReceiver::addSubscriber(GooseSubscriber subscriber) {
-  if (receiver_ && subscriber) {
-    GooseReceiver_addSubscriber(receiver_, subscriber);
+void GOOSEReceiver::addSubscriber(GooseSubscriber subscriber,
+                                  const capture::DispatchKey &key) {
+  if (!subscriber)
+    return;
+  std::lock_guard<std::mutex> lock(decodeMutex_);
+  if (routable_) {
+    // libiec61850 matches session payloads on APPID and GoCBRef itself
+    if (remote_) {
+      GooseReceiver_addSubscriber(remote_, subscriber);
+      remoteSubscribers_.push_back(subscriber);
+    }
+    return;
   }
+  auto it = std::find_if(
+      decoders_.begin(), decoders_.end(), [&](const auto &decoder) {
+        const capture::DispatchKey &k = decoder->key;
+        return k.etherType == key.etherType && k.appId == key.appId &&
+               k.hasMac == key.hasMac &&
+               (!k.hasMac || std::equal(k.mac, k.mac + 6, key.mac));
+      });
+  if (it == decoders_.end()) {
+    auto decoder = std::make_unique<Decoder>();
+    decoder->key = key;
+    // Fed through handleMessage only, so no frame buffer of its own
+    decoder->receiver = GooseReceiver_createEx(nullptr);
+    it = decoders_.insert(decoders_.end(), std::move(decoder));
+  }
+  GooseReceiver_addSubscriber((*it)->receiver, subscriber);
+  (*it)->subscribers.push_back(subscriber);
+  updateRoutes();
 }
 
 void GOOSEReceiver::removeSubscriber(GooseSubscriber subscriber) {
-  if (receiver_ && subscriber) {
-    GooseReceiver_removeSubscriber(receiver_, subscriber);
+  std::lock_guard<std::mutex> lock(decodeMutex_);
+  if (routable_) {
+    auto found = std::find(remoteSubscribers_.begin(),
+                           remoteSubscribers_.end(), subscriber);
+    if (found != remoteSubscribers_.end()) {
+      GooseReceiver_removeSubscriber(remote_, subscriber);
+      remoteSubscribers_.erase(found);
+    }
+    return;
+  }
+  for (auto it = decoders_.begin(); it != decoders_.end(); ++it) {
+    auto &subscribers = (*it)->subscribers;
+    auto found = std::find(subscribers.begin(), subscribers.end(), subscriber);
+    if (found == subscribers.end())
+      continue;
+    GooseReceiver_removeSubscriber((*it)->receiver, subscriber);
+    subscribers.erase(found);
+    if (subscribers.empty()) {
+      GooseReceiver_destroy((*it)->receiver);
+      decoders_.erase(it);
+    }
+    updateRoutes();
+    return;
+  }
+}
+
+void GOOSEReceiver::updateRoutes() {
+  std::vector<capture::FrameDispatcher::Route> routes;
+  routes.reserve(decoders_.size());
+  for (const auto &decoder : decoders_) {
+    GooseReceiver receiver = decoder->receiver;
+    // libiec61850 only reads the buffer
+    routes.push_back({decoder->key, [receiver](const uint8_t *frame,
+                                               size_t length) {
+                        GooseReceiver_handleMessage(
+                            receiver, const_cast<uint8_t *>(frame),
+                            static_cast<int>(length));
+                      }});
+  }
+  dispatcher_.setRoutes(std::move(routes));
+}
+
+void GOOSEReceiver::handleFrame(const uint8_t *frame, size_t length) {
+  if (!frame)
+    return;
+  std::lock_guard<std::mutex> lock(decodeMutex_);
+  dispatcher_.dispatch(frame, length);
+}
+
+void GOOSEReceiver::receiveLoop() {
+  std::vector<uint8_t> buffer(kMaxFrameSize);
+  EthernetHandleSet handles = EthernetHandleSet_new();
+  EthernetHandleSet_addSocket(handles, socket_);
+
+  while (running_) {
+    int ready = EthernetHandleSet_waitReady(handles, kWaitMs);
+    if (ready < 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(kWaitMs));
+    if (ready <= 0)
+      continue;
+    // Drain everything queued before waiting again
+    int size;
+    while (running_ && (size = Ethernet_receivePacket(
+                            socket_, buffer.data(), kMaxFrameSize)) > 0)
+      handleFrame(buffer.data(), static_cast<size_t>(size));
+  }
+
+  EthernetHandleSet_destroy(handles);
+}
+
+void GOOSEReceiver::sessionLoop() {
+  while (running_) {
+    bool parsed;
+    {
+      std::lock_guard<std::mutex> lock(decodeMutex_);
+      parsed = GooseReceiver_tick(remote_);
+    }
+    if (!parsed) {
+      std::this_thread::sleep_for(kSessionPoll);
+      continue;
+    }
+    // Only this thread writes
+    uint64_t messages = sessionMessages_.load(std::memory_order_relaxed);
+    sessionMessages_.store(messages + 1, std::memory_order_relaxed);
+  }
+}
+
+void GOOSEReceiver::ringLoop() {
+  uint64_t generation = dispatcher_.generation();
+
+  while (running_) {
+    // Follow subscription changes in the kernel filter
+    if (dispatcher_.generation() != generation) {
+      generation = dispatcher_.generation();
+      ring_->setFilter({capture::kEtherTypeGoose},
+                       dispatcher_.appIds(capture::kEtherTypeGoose));
+    }
+
+    ring_->poll(static_cast<int>(kWaitMs),
+                [&](const capture::CapturedFrame *frames, size_t count) {
+                  std::lock_guard<std::mutex> lock(decodeMutex_);
+                  dispatcher_.dispatch(frames, count);
+                });
   }
 }
 
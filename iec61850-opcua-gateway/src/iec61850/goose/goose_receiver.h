@@ -1,31 +1,118 @@
 #pragma once
 
+#include "iec61850/capture/frame_dispatcher.h"
+#include "iec61850/capture/packet_ring.h"
+#include "iec61850/capture/r_session.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <libiec61850/goose_receiver.h>
 #include <libiec61850/goose_subscriber.h>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace gateway {
 namespace iec61850 {
 namespace goose {
 
+/**
+ * @brief GOOSE reception on one interface
+ *
+ * The receive loop reads each frame and routes it by APPID and
+ * destination MAC to the libiec61850 decoder holding the subscribers of
+ * that key, so libiec61850 never scans a list of every subscriber and
+ * frames nobody subscribed to are dropped undecoded. Subscribers may be
+ * added and removed while running.
+ *
+ * Frames come from libiec61850's Ethernet socket, one read per frame, or
+ * on Linux from a TPACKET_V3 ring whose kernel filter already drops
+ * other EtherTypes and APPIDs; ring blocks are decoded in place.
+ *
+ * A routable receiver takes R-GOOSE from a UDP session instead. The
+ * session layer (keys, signatures) is libiec61850's RSession, whose
+ * payloads are matched to the subscribers by one libiec61850 receiver;
+ * everything above the subscribers is the same as on an interface.
+ */
 class GOOSEReceiver {
 public:
-  GOOSEReceiver(const std::string &interfaceName);
+  GOOSEReceiver(const std::string &interfaceName, bool packetRing = false);
+
+  /**
+   * @brief R-GOOSE over UDP (IEC 61850-90-5), unicast or multicast
+   */
+  explicit GOOSEReceiver(const core::RSessionConfig &session);
   ~GOOSEReceiver();
 
   void start();
   void stop();
   bool isRunning() const;
 
-  void addSubscriber(GooseSubscriber subscriber);
+  /**
+   * @brief Decode the frames matching @p key with @p subscriber;
+   * subscribers with equal keys share one libiec61850 decoder
+   */
+  void addSubscriber(GooseSubscriber subscriber,
+                     const capture::DispatchKey &key);
   void removeSubscriber(GooseSubscriber subscriber);
 
+  /**
+   * @brief Decode a complete Ethernet frame obtained elsewhere, e.g. from
+   * a capture file, exactly as if it had been received on the interface
+   */
+  void handleFrame(const uint8_t *frame, size_t length);
+
+  bool usesPacketRing() const { return ring_ != nullptr; }
+  bool isRoutable() const { return routable_; }
+
+  // Interface name, or the session's address
+  const std::string &getName() const { return interfaceName_; }
+
+  uint64_t getDecodedFrames() const {
+    return routable_ ? sessionMessages_.load() : getDispatchStats().routed;
+  }
+  // Routable only: messages secured with a key not configured
+  uint64_t getUnknownKeyMessages() const { return unknownKeys_.load(); }
+  uint64_t getFilteredFrames() const { return getDispatchStats().unrouted; }
+  capture::DispatchStats getDispatchStats() const {
+    return dispatcher_.getStats();
+  }
+
 private:
+  // libiec61850 decoder of the subscribers sharing one key
+  struct Decoder {
+    capture::DispatchKey key;
+    GooseReceiver receiver = nullptr;
+    std::vector<GooseSubscriber> subscribers;
+  };
+
+  void receiveLoop();
+  void ringLoop();
+  void sessionLoop();
+  void updateRoutes(); // Caller holds decodeMutex_
+
   std::string interfaceName_;
-  GooseReceiver receiver_{nullptr};
-  bool running_{false};
+  EthernetSocket socket_{nullptr};
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+  bool packetRing_;
+  std::unique_ptr<capture::PacketRing> ring_;
+
+  // R-GOOSE: the session and the receiver decoding its payloads
+  bool routable_ = false;
+  capture::RSessionHandle session_;
+  GooseReceiver remote_ = nullptr;
+  std::vector<GooseSubscriber> remoteSubscribers_;
+  std::atomic<uint64_t> sessionMessages_{0};
+  std::atomic<uint64_t> unknownKeys_{0};
+
+  // Serialises decoding with subscriber changes
+  std::mutex decodeMutex_;
+  std::vector<std::unique_ptr<Decoder>> decoders_;
+  capture::FrameDispatcher dispatcher_;
 };
 
 } // namespace goose
@@ -0,0 +1,105 @@
+#include "goose_service.h"
+#include "core/logger.h"
+#include <algorithm>
+
+namespace gateway {
+namespace iec61850 {
+namespace goose {
+
+GOOSEService::GOOSEService(const core::GOOSEConfig &config)
+    : config_(config) {
+  receivers_.push_back(std::make_shared<GOOSEReceiver>(
+      config_.interfaceName, config_.packetRing));
+  if (!config_.interfaceB.empty()) {
+    receivers_.push_back(std::make_shared<GOOSEReceiver>(
+        config_.interfaceB, config_.packetRing));
+    manager_ = std::make_unique<GOOSESubscriberManager>(receivers_[0],
+                                                        receivers_[1]);
+  } else {
+    manager_ = std::make_unique<GOOSESubscriberManager>(receivers_[0]);
+    manager_->setDuplicateDiscard(config_.duplicateDiscard);
+  }
+
+  if (config_.routable.enabled) {
+    routableReceiver_ = std::make_shared<GOOSEReceiver>(config_.routable);
+    routableManager_ =
+        std::make_unique<GOOSESubscriberManager>(routableReceiver_);
+  }
+
+  // Recorded interfaces map onto the LANs in order. SV frames are skipped:
+  // the libiec61850 SV receiver only reads from a socket, so a recorded
+  // frame cannot be fed into it
+  replay_.addHandler(
+      capture::kEtherTypeGoose, "goose",
+      [this](const capture::CapturedFrame &frame) {
+        size_t lan = std::min(static_cast<size_t>(frame.interfaceId),
+                              receivers_.size() - 1);
+        receivers_[lan]->handleFrame(frame.data, frame.length);
+      });
+}
+
+GOOSEService::~GOOSEService() { stop(); }
+
+void GOOSEService::start() {
+  if (!config_.replayFile.empty()) {
+    if (replaying_)
+      return;
+    if (replayThread_.joinable())
+      replayThread_.join();
+    replaying_ = true;
+    replayThread_ = std::thread(&GOOSEService::runReplay, this);
+    return;
+  }
+
+  for (auto &receiver : receivers_)
+    receiver->start();
+  if (routableReceiver_)
+    routableReceiver_->start();
+  LOG_INFO("GOOSE service started on {} interface(s){}", receivers_.size(),
+           routableReceiver_ ? " and " + routableReceiver_->getName() : "");
+}
+
+void GOOSEService::stop() {
+  replay_.stop();
+  if (replayThread_.joinable())
+    replayThread_.join();
+  for (auto &receiver : receivers_)
+    receiver->stop();
+  if (routableReceiver_)
+    routableReceiver_->stop();
+}
+
+void GOOSEService::runReplay() {
+  auto stats = replay_.run(config_.replayFile, config_.replaySpeed);
+  {
+    std::lock_guard<std::mutex> lock(replayMutex_);
+    replayStats_ = stats;
+  }
+  replaying_ = false;
+}
+
+capture::ReplayStats GOOSEService::getReplayStats() const {
+  std::lock_guard<std::mutex> lock(replayMutex_);
+  return replayStats_;
+}
+
+bool GOOSEService::isRunning() const {
+  if (replaying_)
+    return true;
+  for (const auto &receiver : receivers_) {
+    if (receiver->isRunning())
+      return true;
+  }
+  return routableReceiver_ && routableReceiver_->isRunning();
+}
+
+std::vector<std::string> GOOSEService::getInterfaces() const {
+  std::vector<std::string> names{config_.interfaceName};
+  if (!config_.interfaceB.empty())
+    names.push_back(config_.interfaceB);
+  return names;
+}
+
+} // namespace goose
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "core/config_parser.h"
+#include "goose_receiver.h"
+#include "goose_subscriber_manager.h"
+#include "iec61850/capture/pcap_replay.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gateway {
+namespace iec61850 {
+namespace goose {
+
+/**
+ * @brief GOOSE reception as configured in gateway.yaml
+ *
+ * Owns the receiver of each LAN and the subscriber manager on top of
+ * them. With a second interface the manager runs as a PRP pair. With a
+ * replay file the receivers decode the recording instead of the wire.
+ * R-GOOSE, when enabled, has a receiver and manager of its own, so remote
+ * streams are supervised apart from the local ones.
+ */
+class GOOSEService {
+public:
+  explicit GOOSEService(const core::GOOSEConfig &config);
+  ~GOOSEService();
+
+  void start();
+  void stop();
+  bool isRunning() const;
+
+  GOOSESubscriberManager &getManager() { return *manager_; }
+  const GOOSESubscriberManager &getManager() const { return *manager_; }
+
+  /**
+   * @brief R-GOOSE subscriptions, nullptr unless routable reception is on
+   */
+  GOOSESubscriberManager *getRoutableManager() {
+    return routableManager_.get();
+  }
+  const GOOSESubscriberManager *getRoutableManager() const {
+    return routableManager_.get();
+  }
+
+  const GOOSEReceiver *getRoutableReceiver() const {
+    return routableReceiver_.get();
+  }
+
+  /**
+   * @brief Interface names, LAN A first
+   */
+  std::vector<std::string> getInterfaces() const;
+
+  /**
+   * @brief Statistics of the last finished replay
+   */
+  capture::ReplayStats getReplayStats() const;
+
+private:
+  void runReplay();
+
+  core::GOOSEConfig config_;
+  std::vector<std::shared_ptr<GOOSEReceiver>> receivers_;
+  std::unique_ptr<GOOSESubscriberManager> manager_;
+  std::shared_ptr<GOOSEReceiver> routableReceiver_;
+  std::unique_ptr<GOOSESubscriberManager> routableManager_;
+
+  capture::PcapReplay replay_;
+  std::thread replayThread_;
+  std::atomic<bool> replaying_{false};
+  mutable std::mutex replayMutex_;
+  capture::ReplayStats replayStats_;
+};
+
+} // namespace goose
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,149 @@
+#include "goose_statistics.h"
+#include "core/metrics.h"
+#include <algorithm>
+
+namespace gateway {
+namespace iec61850 {
+namespace goose {
+
+namespace {
+
+constexpr auto kRelaxed = std::memory_order_relaxed;
+
+} // namespace
+
+void GooseStreamStats::record(const GooseFrameInfo &frame) {
+  core::increment(messages_);
+  if (frame.confRevMismatch)
+    core::increment(confRevMismatches_);
+  if (frame.needsCommission)
+    core::increment(ndsComFrames_);
+
+  uint64_t lastArrival = lastArrivalUs_.load(kRelaxed);
+  uint64_t intervalUs = seen_ ? frame.nowUs - lastArrival : 0;
+  uint32_t tal = timeAllowedToLiveMs_.load(kRelaxed);
+  if (seen_ && tal && intervalUs > tal * 1000ULL)
+    core::increment(talExpiries_);
+
+  bool steady = false;
+  if (!seen_) {
+    windowStartUs_.store(frame.nowUs, kRelaxed);
+  } else if (frame.stNum == lastStNum_) {
+    if (frame.sqNum > lastSqNum_ + 1)
+      core::increment(sqNumGaps_, frame.sqNum - lastSqNum_ - 1);
+    steady = frame.sqNum == lastSqNum_ + 1;
+  } else {
+    core::increment(stateChanges_);
+    windowChanges_++;
+    // A wrap of stNum restarts at 1, not a gap
+    if (frame.stNum > lastStNum_ + 1)
+      core::increment(stNumGaps_, frame.stNum - lastStNum_ - 1);
+    // The first message of a state carries sqNum 0 (Ed. 2) or 1 (Ed. 1)
+    if (frame.sqNum > 1)
+      core::increment(sqNumGaps_, frame.sqNum - 1);
+  }
+
+  // Heartbeat jitter; a backoff step (>1.5x) is not jitter
+  if (steady && lastIntervalUs_) {
+    uint64_t a = intervalUs, b = lastIntervalUs_;
+    if (a * 2 <= b * 3 && b * 2 <= a * 3)
+      core::increment(jitter_[core::histogramBucket(
+          kJitterBucketBoundsUs, a > b ? a - b : b - a)]);
+  }
+  lastIntervalUs_ = steady ? intervalUs : 0;
+
+  // Publish the rates of each completed window
+  windowMessages_++;
+  uint64_t windowStart = windowStartUs_.load(kRelaxed);
+  uint64_t elapsed = frame.nowUs - windowStart;
+  if (elapsed >= kRateWindowUs) {
+    messageRateMilli_.store(
+        static_cast<uint32_t>(windowMessages_ * 1000000000ULL / elapsed),
+        kRelaxed);
+    stateChangeRateMilli_.store(
+        static_cast<uint32_t>(windowChanges_ * 1000000000ULL / elapsed),
+        kRelaxed);
+    windowStartUs_.store(frame.nowUs, kRelaxed);
+    windowMessages_ = 0;
+    windowChanges_ = 0;
+  }
+
+  seen_ = true;
+  lastStNum_ = frame.stNum;
+  lastSqNum_ = frame.sqNum;
+  timeAllowedToLiveMs_.store(frame.timeAllowedToLiveMs, kRelaxed);
+  lastArrivalUs_.store(frame.nowUs, kRelaxed);
+}
+
+GooseStreamSnapshot GooseStreamStats::snapshot(uint64_t nowUs) const {
+  GooseStreamSnapshot s;
+  s.messages = messages_.load(kRelaxed);
+  s.stateChanges = stateChanges_.load(kRelaxed);
+  s.sqNumGaps = sqNumGaps_.load(kRelaxed);
+  s.stNumGaps = stNumGaps_.load(kRelaxed);
+  s.talExpiries = talExpiries_.load(kRelaxed);
+  s.confRevMismatches = confRevMismatches_.load(kRelaxed);
+  s.ndsComFrames = ndsComFrames_.load(kRelaxed);
+  for (size_t i = 0; i < kJitterBuckets; ++i)
+    s.jitter[i] = jitter_[i].load(kRelaxed);
+  if (!s.messages)
+    return s;
+
+  uint64_t lastArrival = lastArrivalUs_.load(kRelaxed);
+  uint64_t sinceUs = nowUs > lastArrival ? nowUs - lastArrival : 0;
+  s.msSinceLast = sinceUs / 1000;
+  s.timeAllowedToLiveMs = timeAllowedToLiveMs_.load(kRelaxed);
+  s.alive = sinceUs <= s.timeAllowedToLiveMs * 1000ULL;
+
+  // Without traffic the writer never closes the window; the rate is only
+  // current while the stream is alive
+  if (s.alive || sinceUs < 2 * kRateWindowUs) {
+    s.messageRate = messageRateMilli_.load(kRelaxed) / 1000.0;
+    s.stateChangeRate = stateChangeRateMilli_.load(kRelaxed) / 1000.0;
+  }
+  return s;
+}
+
+void PublishLatencyStats::record(uint64_t latencyUs) {
+  uint32_t us =
+      static_cast<uint32_t>(std::min<uint64_t>(latencyUs, UINT32_MAX));
+  core::increment(samples_);
+  core::increment(sumUs_, us);
+  core::increment(buckets_[core::histogramBucket(kLatencyBucketBoundsUs, us)]);
+  lastUs_.store(us, kRelaxed);
+  if (us > maxUs_.load(kRelaxed))
+    maxUs_.store(us, kRelaxed);
+}
+
+PublishLatencySnapshot PublishLatencyStats::snapshot() const {
+  PublishLatencySnapshot s;
+  s.samples = samples_.load(kRelaxed);
+  s.lastUs = lastUs_.load(kRelaxed);
+  s.maxUs = maxUs_.load(kRelaxed);
+  uint64_t total = 0;
+  for (size_t i = 0; i < kLatencyBuckets; ++i) {
+    s.buckets[i] = buckets_[i].load(kRelaxed);
+    total += s.buckets[i];
+  }
+  if (!s.samples)
+    return s;
+  s.avgUs = static_cast<double>(sumUs_.load(kRelaxed)) /
+            static_cast<double>(s.samples);
+
+  // Smallest bucket bound covering 99 % of the samples
+  uint64_t covered = 0;
+  for (size_t i = 0; i < kLatencyBuckets; ++i) {
+    covered += s.buckets[i];
+    if (covered * 100 >= total * 99) {
+      s.p99Us = i < kLatencyBucketBoundsUs.size()
+                    ? std::min(kLatencyBucketBoundsUs[i], s.maxUs)
+                    : s.maxUs;
+      break;
+    }
+  }
+  return s;
+}
+
+} // namespace goose
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace gateway {
+namespace iec61850 {
+namespace goose {
+
+constexpr size_t kJitterBuckets = 8;
+
+// Upper bounds (us) of the jitter histogram buckets; the last is open
+constexpr std::array<uint32_t, kJitterBuckets - 1> kJitterBucketBoundsUs = {
+    100, 250, 500, 1000, 2000, 5000, 10000};
+
+constexpr size_t kLatencyBuckets = 9;
+
+// Upper bounds (us) of the publish latency buckets; the last is open
+constexpr std::array<uint32_t, kLatencyBuckets - 1> kLatencyBucketBoundsUs = {
+    50, 100, 250, 500, 1000, 2000, 5000, 10000};
+
+// Supervision-relevant header fields of one received GOOSE message
+struct GooseFrameInfo {
+  uint64_t nowUs = 0;
+  uint32_t stNum = 0;
+  uint32_t sqNum = 0;
+  uint32_t timeAllowedToLiveMs = 0;
+  bool confRevMismatch = false;
+  bool needsCommission = false;
+};
+
+struct GooseStreamSnapshot {
+  uint64_t messages = 0;
+  uint64_t stateChanges = 0;      // stNum increments
+  uint64_t sqNumGaps = 0;         // Messages missed within a state
+  uint64_t stNumGaps = 0;         // State changes missed entirely
+  uint64_t talExpiries = 0;       // Silences longer than TimeAllowedToLive
+  uint64_t confRevMismatches = 0;
+  uint64_t ndsComFrames = 0;      // Publisher flagged needsCommissioning
+  double messageRate = 0.0;       // Messages/s over the last window
+  double stateChangeRate = 0.0;   // stNum changes/s over the last window
+  bool alive = false;             // Within TimeAllowedToLive of the last one
+  uint64_t msSinceLast = 0;
+  uint32_t timeAllowedToLiveMs = 0;
+  std::array<uint64_t, kJitterBuckets> jitter{};
+};
+
+/**
+ * @brief Per-GoCB supervision counters
+ *
+ * record() is called by one thread at a time (the subscription's decode
+ * path); snapshot() may run concurrently from any thread. All shared state
+ * is in relaxed atomics, so neither side ever waits.
+ *
+ * Jitter is the change between consecutive heartbeat intervals, measured
+ * only while the state is stable and no message was lost, so the fast
+ * repetition after a state change does not count as jitter.
+ */
+class GooseStreamStats {
+public:
+  void record(const GooseFrameInfo &frame);
+  GooseStreamSnapshot snapshot(uint64_t nowUs) const;
+
+private:
+  // Rates are published once per window
+  static constexpr uint64_t kRateWindowUs = 1000000;
+
+  std::atomic<uint64_t> messages_{0};
+  std::atomic<uint64_t> stateChanges_{0};
+  std::atomic<uint64_t> sqNumGaps_{0};
+  std::atomic<uint64_t> stNumGaps_{0};
+  std::atomic<uint64_t> talExpiries_{0};
+  std::atomic<uint64_t> confRevMismatches_{0};
+  std::atomic<uint64_t> ndsComFrames_{0};
+  std::array<std::atomic<uint64_t>, kJitterBuckets> jitter_{};
+
+  std::atomic<uint64_t> lastArrivalUs_{0};
+  std::atomic<uint32_t> timeAllowedToLiveMs_{0};
+  std::atomic<uint32_t> messageRateMilli_{0};
+  std::atomic<uint32_t> stateChangeRateMilli_{0};
+  std::atomic<uint64_t> windowStartUs_{0};
+
+  // Writer-only state
+  bool seen_ = false;
+  uint32_t lastStNum_ = 0;
+  uint32_t lastSqNum_ = 0;
+  uint64_t lastIntervalUs_ = 0;
+  uint64_t windowMessages_ = 0;
+  uint64_t windowChanges_ = 0;
+};
+
+struct PublishLatencySnapshot {
+  uint64_t samples = 0;
+  double avgUs = 0.0;
+  uint32_t lastUs = 0;
+  uint32_t maxUs = 0;
+  uint32_t p99Us = 0; // Bound of the 99th percentile's bucket, <= maxUs
+  std::array<uint64_t, kLatencyBuckets> buckets{};
+};
+
+/**
+ * @brief Time from the write that triggered a GOOSE state change to the
+ * first message carrying it being handed to the network
+ *
+ * Same threading as GooseStreamStats: one recording thread (the
+ * publisher's timer thread), snapshots from anywhere.
+ */
+class PublishLatencyStats {
+public:
+  void record(uint64_t latencyUs);
+  PublishLatencySnapshot snapshot() const;
+
+private:
+  std::atomic<uint64_t> samples_{0};
+  std::atomic<uint64_t> sumUs_{0};
+  std::atomic<uint32_t> lastUs_{0};
+  std::atomic<uint32_t> maxUs_{0};
+  std::array<std::atomic<uint64_t>, kLatencyBuckets> buckets_{};
+};
+
+} // namespace goose
+} // namespace iec61850
+} // namespace gateway
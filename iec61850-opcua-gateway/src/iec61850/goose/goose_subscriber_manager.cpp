@@ -1,66 +1,392 @@
 #include "goose_subscriber_manager.h"
 #include "core/logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 
 namespace gateway {
 namespace iec61850 {
 namespace goose {
 
+namespace {
+
+// "01-0C-CD-01-00-01" or "01:0C:CD:01:00:01"
+bool parseMac(const std::string &text, uint8_t mac[6]) {
+  unsigned int b[6];
+  char sep[5];
+  if (std::sscanf(text.c_str(), "%2x%c%2x%c%2x%c%2x%c%2x%c%2x", &b[0],
+                  &sep[0], &b[1], &sep[1], &b[2], &sep[2], &b[3], &sep[3],
+                  &b[4], &sep[4], &b[5]) != 11)
+    return false;
+  for (int i = 0; i < 6; ++i)
+    mac[i] = static_cast<uint8_t>(b[i]);
+  return true;
+}
+
+// Walk the precomputed structure path down to the bound attribute
+MmsValue *resolve(MmsValue *value, const std::vector<int> &path) {
+  for (int index : path) {
+    if (!value || MmsValue_getType(value) != MMS_STRUCTURE ||
+        index >= static_cast<int>(MmsValue_getArraySize(value)))
+      return nullptr;
+    value = MmsValue_getElement(value, index);
+  }
+  return value;
+}
+
+} // namespace
+
 GOOSESubscriberManager::GOOSESubscriberManager(
     std::shared_ptr<GOOSEReceiver> receiver)
-    : receiver_(receiver) {}
+    : receivers_{receiver} {}
+
+GOOSESubscriberManager::GOOSESubscriberManager(
+    std::shared_ptr<GOOSEReceiver> lanA, std::shared_ptr<GOOSEReceiver> lanB)
+    : receivers_{lanA, lanB}, filter_(std::make_unique<DuplicateFilter>(2)) {
+}
 
 GOOSESubscriberManager::~GOOSESubscriberManager() {
   for (auto &pair : subscribers_) {
-    GooseSubscriber_destroy(pair.second);
+    for (auto &lan : pair.second->lans) {
+      if (!lan.subscriber)
+        continue;
+      receivers_[static_cast<size_t>(lan.index)]->removeSubscriber(
+          lan.subscriber);
+      GooseSubscriber_destroy(lan.subscriber);
+    }
   }
   subscribers_.clear();
 }
 
+void GOOSESubscriberManager::setDuplicateDiscard(bool enabled) {
+  if (receivers_.size() > 1)
+    return;
+  if (enabled && !filter_)
+    filter_ = std::make_unique<DuplicateFilter>(1);
+  else if (!enabled)
+    filter_.reset();
+}
+
+void GOOSESubscriberManager::setValueSink(ValueSink sink) {
+  sink_ = std::move(sink);
+}
+
 void GOOSESubscriberManager::subscribe(const std::string &goCbRef) {
+  auto sub = std::make_unique<Subscription>();
+  sub->goCbRef = goCbRef;
+  addSubscription(std::move(sub));
+}
+
+void GOOSESubscriberManager::subscribe(const IEDConfig &ied,
+                                       const GOOSEControlBlock &gcb) {
+  addSubscription(makeSubscription(ied, gcb));
+}
+
+std::unique_ptr<GOOSESubscriberManager::Subscription>
+GOOSESubscriberManager::makeSubscription(const IEDConfig &ied,
+                                         const GOOSEControlBlock &gcb) {
+  auto sub = std::make_unique<Subscription>();
+  sub->goCbRef = gcb.reference;
+  sub->map = GooseDataSetMap(ied, gcb);
+  sub->confRev = static_cast<uint32_t>(gcb.confRev);
+  sub->dataSet = gcb.dataSet;
+
+  // Let the receivers filter on APPID and destination as configured
+  char *end = nullptr;
+  unsigned long appId = std::strtoul(gcb.appID.c_str(), &end, 16);
+  if (!gcb.appID.empty() && *end == '\0' && appId <= 0xFFFF)
+    sub->appId = static_cast<int>(appId);
+  sub->hasDstMac = parseMac(gcb.macAddress, sub->dstMac);
+
+  sub->signature = gcb.appID + "|" + gcb.macAddress + "|" +
+                   std::to_string(gcb.confRev) + "|" + gcb.dataSet;
+  for (const auto &member : sub->map.members())
+    sub->signature += "|" + member.reference;
+  return sub;
+}
+
+SyncStats
+GOOSESubscriberManager::subscribeAll(const std::vector<IEDConfig> &ieds) {
+  std::unordered_map<std::string, std::unique_ptr<Subscription>> wanted;
+  for (const auto &ied : ieds) {
+    for (const auto &gcb : ied.gooseControls) {
+      if (gcb.reference.empty())
+        continue;
+      auto sub = makeSubscription(ied, gcb);
+      wanted[sub->goCbRef] = std::move(sub);
+    }
+  }
+
+  SyncStats stats;
+  std::vector<std::string> stale;
+  {
+    std::lock_guard<std::mutex> lock(subscribersMutex_);
+    for (const auto &pair : subscribers_) {
+      const Subscription &current = *pair.second;
+      if (current.signature.empty())
+        continue;
+      auto it = wanted.find(pair.first);
+      if (it == wanted.end()) {
+        stale.push_back(pair.first);
+        stats.removed++;
+      } else if (it->second->signature != current.signature) {
+        stale.push_back(pair.first);
+        stats.changed++;
+      } else {
+        wanted.erase(it);
+        stats.unchanged++;
+      }
+    }
+  }
+
+  for (const auto &goCbRef : stale)
+    unsubscribe(goCbRef);
+  stats.added = wanted.size() - stats.changed;
+  for (auto &pair : wanted)
+    addSubscription(std::move(pair.second));
+
+  LOG_INFO("GOOSE subscriptions from SCD: {} added, {} removed, {} changed, "
+           "{} unchanged",
+           stats.added, stats.removed, stats.changed, stats.unchanged);
+  return stats;
+}
+
+void GOOSESubscriberManager::addSubscription(
+    std::unique_ptr<Subscription> sub) {
+  const std::string goCbRef = sub->goCbRef;
+  std::lock_guard<std::mutex> lock(subscribersMutex_);
   if (subscribers_.find(goCbRef) != subscribers_.end()) {
     LOG_WARN("Already subscribed to GOOSE: {}", goCbRef.c_str());
     return;
   }
 
-  GooseSubscriber subscriber =
-      GooseSubscriber_create((char *)goCbRef.c_str(), NULL);
-  if (subscriber) {
-    GooseSubscriber_setListener(subscriber, onGooseMessage, this);
-    receiver_->addSubscriber(subscriber);
-    subscribers_[goCbRef] = subscriber;
-    LOG_INFO("Subscribed to GOOSE: {}", goCbRef.c_str());
-  } else {
-    LOG_ERROR("Failed to create subscriber for GOOSE: {}", goCbRef.c_str());
+  // The receivers route frames to a subscriber by APPID and destination
+  capture::DispatchKey key;
+  key.appId = sub->appId;
+  key.hasMac = sub->hasDstMac;
+  std::copy(sub->dstMac, sub->dstMac + 6, key.mac);
+
+  // One libiec61850 subscriber per LAN, each with its own data set values
+  sub->owner = this;
+  for (size_t i = 0; i < receivers_.size(); ++i) {
+    GooseSubscriber subscriber =
+        GooseSubscriber_create((char *)goCbRef.c_str(), NULL);
+    if (!subscriber) {
+      LOG_ERROR("Failed to create subscriber for GOOSE: {}", goCbRef.c_str());
+      for (auto &lan : sub->lans) {
+        if (!lan.subscriber)
+          continue;
+        receivers_[static_cast<size_t>(lan.index)]->removeSubscriber(
+            lan.subscriber);
+        GooseSubscriber_destroy(lan.subscriber);
+      }
+      return;
+    }
+    Lan &lan = sub->lans[i];
+    lan.sub = sub.get();
+    lan.index = static_cast<int>(i);
+    lan.subscriber = subscriber;
+    if (sub->appId >= 0)
+      GooseSubscriber_setAppId(subscriber, static_cast<uint16_t>(sub->appId));
+    // R-GOOSE arrives over UDP, without the multicast MAC
+    if (sub->hasDstMac && !receivers_[i]->isRoutable())
+      GooseSubscriber_setDstMac(subscriber, sub->dstMac);
+    GooseSubscriber_setListener(subscriber, onGooseMessage, &lan);
+    receivers_[i]->addSubscriber(subscriber, key);
   }
+
+  LOG_INFO("Subscribed to GOOSE: {} ({} of {} members bound, {} LANs)",
+           goCbRef.c_str(), sub->map.boundCount(), sub->map.size(),
+           receivers_.size());
+  subscribers_[goCbRef] = std::move(sub);
 }
 
 void GOOSESubscriberManager::unsubscribe(const std::string &goCbRef) {
+  std::lock_guard<std::mutex> lock(subscribersMutex_);
   auto it = subscribers_.find(goCbRef);
   if (it != subscribers_.end()) {
-    receiver_->removeSubscriber(it->second);
-    GooseSubscriber_destroy(it->second);
+    for (auto &lan : it->second->lans) {
+      if (!lan.subscriber)
+        continue;
+      receivers_[static_cast<size_t>(lan.index)]->removeSubscriber(
+          lan.subscriber);
+      GooseSubscriber_destroy(lan.subscriber);
+    }
     subscribers_.erase(it);
     LOG_INFO("Unsubscribed from GOOSE: {}", goCbRef.c_str());
   }
 }
 
+std::vector<SubscriptionStats> GOOSESubscriberManager::getStats() const {
+  auto now = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+  std::vector<SubscriptionStats> result;
+  std::lock_guard<std::mutex> lock(subscribersMutex_);
+  for (const auto &pair : subscribers_) {
+    const Subscription &sub = *pair.second;
+    SubscriptionStats s;
+    s.goCbRef = sub.goCbRef;
+    s.received = sub.received.load();
+    s.stateChanges = sub.stateChanges.load();
+    s.retransmissions = sub.retransmissions.load();
+    s.rejected = sub.rejected.load();
+    s.duplicates = sub.duplicates.load();
+    s.receivedLanA = sub.lans[0].received.load();
+    s.receivedLanB = sub.lans[1].received.load();
+    s.lastProcessingUs = sub.lastProcessingUs.load();
+    s.maxProcessingUs = sub.maxProcessingUs.load();
+    s.boundMembers = sub.map.boundCount();
+    s.dataSet = sub.dataSet;
+    s.supervision = sub.supervision.snapshot(now);
+    result.push_back(std::move(s));
+  }
+  return result;
+}
+
+std::vector<LanStats> GOOSESubscriberManager::getLanStats() const {
+  std::vector<LanStats> result;
+  if (filter_) {
+    for (int i = 0; i < filter_->lanCount(); ++i)
+      result.push_back(filter_->getStats(i));
+  } else {
+    // Without duplicate discard every arrival is delivered
+    LanStats lan;
+    std::lock_guard<std::mutex> lock(subscribersMutex_);
+    for (const auto &pair : subscribers_)
+      lan.arrivals += pair.second->lans[0].received.load();
+    lan.accepted = lan.arrivals;
+    result.push_back(lan);
+  }
+
+  // Rates over at least a second between callers; only readers pay
+  auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(rateMutex_);
+  double elapsed =
+      std::chrono::duration<double>(now - lastRateSample_).count();
+  if (lastArrivals_.size() != result.size()) {
+    lastArrivals_.assign(result.size(), 0);
+    lastRates_.assign(result.size(), 0.0);
+    elapsed = 0;
+  }
+  if (elapsed == 0 || elapsed >= 1.0) {
+    for (size_t i = 0; i < result.size(); ++i) {
+      uint64_t delta = result[i].arrivals - lastArrivals_[i];
+      lastRates_[i] =
+          elapsed > 0 ? static_cast<double>(delta) / elapsed : 0.0;
+      lastArrivals_[i] = result[i].arrivals;
+    }
+    lastRateSample_ = now;
+  }
+  for (size_t i = 0; i < result.size(); ++i) {
+    result[i].messageRate = lastRates_[i];
+    if (i >= receivers_.size())
+      continue;
+    auto dispatch = receivers_[i]->getDispatchStats();
+    result[i].filtered = dispatch.unrouted;
+    result[i].dispatchNs = dispatch.avgLookupNs;
+    result[i].dispatchProbes = dispatch.avgProbes;
+  }
+  return result;
+}
+
 void GOOSESubscriberManager::onGooseMessage(GooseSubscriber subscriber,
                                             void *parameter) {
-  (void)parameter; // Unused
+  auto *lan = static_cast<Lan *>(parameter);
+  if (!lan || !lan->sub || !lan->sub->owner)
+    return;
+  Subscription &sub = *lan->sub;
+  GOOSESubscriberManager &owner = *sub.owner;
+  lan->received++;
 
-  uint32_t stNum = GooseSubscriber_getStNum(subscriber);
-  uint32_t sqNum = GooseSubscriber_getSqNum(subscriber);
-  (void)stNum; // Unused for now
-  (void)sqNum; // Unused for now
+  // Whichever LAN's copy claims the frame first is processed
+  if (owner.filter_ && GooseSubscriber_isValid(subscriber)) {
+    uint8_t srcMac[6];
+    GooseSubscriber_getSrcMac(subscriber, srcMac);
+    auto appId = static_cast<uint16_t>(GooseSubscriber_getAppId(subscriber));
+    if (!owner.filter_->accept(lan->index, appId, srcMac,
+                               GooseSubscriber_getStNum(subscriber),
+                               GooseSubscriber_getSqNum(subscriber))) {
+      sub.duplicates++;
+      return;
+    }
+  }
+  owner.handleMessage(sub, subscriber);
+}
 
-  // LOG_TRACE("Received GOOSE: stNum={}, sqNum={}", stNum, sqNum);
+void GOOSESubscriberManager::handleMessage(Subscription &sub,
+                                           GooseSubscriber subscriber) {
+  auto started = std::chrono::steady_clock::now();
+  sub.received++;
+
+  if (!GooseSubscriber_isValid(subscriber)) {
+    sub.rejected++;
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(sub.mutex);
+
+  GooseFrameInfo frame;
+  frame.nowUs = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          started.time_since_epoch())
+          .count());
+  frame.stNum = GooseSubscriber_getStNum(subscriber);
+  frame.sqNum = GooseSubscriber_getSqNum(subscriber);
+  frame.timeAllowedToLiveMs = GooseSubscriber_getTimeAllowedToLive(subscriber);
+  frame.confRevMismatch =
+      sub.confRev && GooseSubscriber_getConfRev(subscriber) != sub.confRev;
+  frame.needsCommission = GooseSubscriber_needsCommission(subscriber);
+  sub.supervision.record(frame);
+  if (frame.confRevMismatch) {
+    sub.rejected++;
+    return;
+  }
+
+  // A retransmission repeats the last state with only sqNum advanced
+  uint32_t stNum = frame.stNum;
+  if (sub.seen && stNum == sub.lastStNum) {
+    sub.retransmissions++;
+    return;
+  }
 
   MmsValue *values = GooseSubscriber_getDataSetValues(subscriber);
-  if (values) {
-    // TODO: Process dataset values and update internal model
-    // For now, just log that we got data
-    // LOG_DEBUG("GOOSE payload received");
+  if (!values || !sink_ || sub.map.boundCount() == 0) {
+    sub.seen = true;
+    sub.lastStNum = stNum;
+    return;
+  }
+  const auto &members = sub.map.members();
+  if (MmsValue_getArraySize(values) != members.size()) {
+    sub.rejected++;
+    LOG_DEBUG("GOOSE {}: {} data set members, expected {}", sub.goCbRef,
+              MmsValue_getArraySize(values), members.size());
+    return;
   }
+
+  sub.seen = true;
+  sub.lastStNum = stNum;
+  for (size_t i = 0; i < members.size(); ++i) {
+    const MemberBinding &binding = members[i];
+    if (binding.reference.empty())
+      continue;
+    MmsValue *value =
+        resolve(MmsValue_getElement(values, static_cast<int>(i)),
+                binding.path);
+    if (value)
+      sink_(binding.reference, value);
+  }
+  sub.stateChanges++;
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now() - started)
+                     .count();
+  auto us = static_cast<uint32_t>(elapsed);
+  sub.lastProcessingUs = us;
+  if (us > sub.maxProcessingUs)
+    sub.maxProcessingUs = us;
 }
 
 } // namespace goose
@@ -1,37 +1,171 @@
 #pragma once
 
+#include "duplicate_filter.h"
+#include "goose_dataset_map.h"
 #include "goose_receiver.h"
+#include "goose_statistics.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace gateway {
 namespace iec61850 {
 namespace goose {
 
+struct SubscriptionStats {
+  std::string goCbRef;
+  std::string dataSet;
+  uint64_t received = 0;
+  uint64_t stateChanges = 0;    // Messages whose values were applied
+  uint64_t retransmissions = 0; // Same stNum, skipped
+  uint64_t rejected = 0;        // Invalid, confRev or layout mismatch
+  uint64_t duplicates = 0;      // Redundant copies discarded
+  uint64_t receivedLanA = 0;
+  uint64_t receivedLanB = 0;
+  uint32_t lastProcessingUs = 0;
+  uint32_t maxProcessingUs = 0;
+  size_t boundMembers = 0;
+  GooseStreamSnapshot supervision;
+};
+
+// Outcome of aligning the subscriptions with an SCD
+struct SyncStats {
+  size_t added = 0;
+  size_t removed = 0;
+  size_t changed = 0; // Re-created with new APPID, MAC, confRev or members
+  size_t unchanged = 0;
+};
+
 class GOOSESubscriberManager {
 public:
+  /**
+   * @brief Receives each bound data set member, on the receiver thread
+   * @param ref DataBinder reference of the member
+   * @param value Bound value inside the received data set
+   */
+  using ValueSink =
+      std::function<void(const std::string &ref, MmsValue *value)>;
+
   GOOSESubscriberManager(std::shared_ptr<GOOSEReceiver> receiver);
+
+  /**
+   * @brief PRP: receive every subscription on LAN A and LAN B; the first
+   * copy of each frame is processed, the other one discarded
+   */
+  GOOSESubscriberManager(std::shared_ptr<GOOSEReceiver> lanA,
+                         std::shared_ptr<GOOSEReceiver> lanB);
   ~GOOSESubscriberManager();
 
+  /**
+   * @brief Discard duplicate frames on a single port, e.g. both directions
+   * of an HSR ring; always on with two LANs. Call before subscribing.
+   */
+  void setDuplicateDiscard(bool enabled);
+
+  /**
+   * @brief Set where decoded values go; call before subscribing
+   */
+  void setValueSink(ValueSink sink);
+
   /**
    * @brief Subscribe to a specific GOOSE Control Block
    * @param goCbRef GOOSE Control Block Reference (e.g., "IED1/LLN0$GO$gcb01")
    */
   void subscribe(const std::string &goCbRef);
 
+  /**
+   * @brief Subscribe to a GOOSE Control Block from the SCL and decode its
+   * data set into the value sink, members mapped in FCDA order
+   * @param ied Publishing IED, for the data model the members refer to
+   * @param gcb Control block of that IED
+   */
+  void subscribe(const IEDConfig &ied, const GOOSEControlBlock &gcb);
+
+  /**
+   * @brief Subscribe to every GoCB of the SCD's IEDs
+   *
+   * Subscriptions created from an earlier SCD that are gone are removed,
+   * and those whose APPID, MAC, confRev or data set changed are
+   * re-created. Subscriptions made by reference only are left alone.
+   */
+  SyncStats subscribeAll(const std::vector<IEDConfig> &ieds);
+
   /**
    * @brief Unsubscribe from a GOOSE Control Block
    * @param goCbRef GOOSE Control Block Reference
    */
   void unsubscribe(const std::string &goCbRef);
 
+  std::vector<SubscriptionStats> getStats() const;
+
+  /**
+   * @brief Arrival counters and rate per LAN; duplicate, skew and missing
+   * counters only while duplicate discard is on
+   */
+  std::vector<LanStats> getLanStats() const;
+
 private:
+  struct Subscription;
+
+  // Listener context of one LAN's subscriber
+  struct Lan {
+    Subscription *sub = nullptr;
+    int index = 0;
+    GooseSubscriber subscriber = nullptr;
+    std::atomic<uint64_t> received{0};
+  };
+
+  struct Subscription {
+    GOOSESubscriberManager *owner = nullptr;
+    std::string goCbRef;
+    std::string signature; // SCL settings it was made from, empty = manual
+    std::string dataSet;
+    Lan lans[DuplicateFilter::kMaxLans];
+    GooseDataSetMap map;
+    uint32_t confRev = 0; // 0 = accept any
+    int appId = -1;       // Receiver dispatch key, -1 / false = any
+    bool hasDstMac = false;
+    uint8_t dstMac[6] = {};
+
+    // Copies from both LANs may be processed concurrently
+    std::mutex mutex;
+    bool seen = false;
+    uint32_t lastStNum = 0;
+    GooseStreamStats supervision;
+
+    std::atomic<uint64_t> received{0};
+    std::atomic<uint64_t> stateChanges{0};
+    std::atomic<uint64_t> retransmissions{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> duplicates{0};
+    std::atomic<uint32_t> lastProcessingUs{0};
+    std::atomic<uint32_t> maxProcessingUs{0};
+  };
+
   static void onGooseMessage(GooseSubscriber subscriber, void *parameter);
+  void handleMessage(Subscription &sub, GooseSubscriber subscriber);
+  std::unique_ptr<Subscription> makeSubscription(const IEDConfig &ied,
+                                                 const GOOSEControlBlock &gcb);
+  void addSubscription(std::unique_ptr<Subscription> sub);
+
+  std::vector<std::shared_ptr<GOOSEReceiver>> receivers_;
+  std::unique_ptr<DuplicateFilter> filter_;
+  ValueSink sink_;
+  // Guards the map, not the subscriptions; callbacks never take it
+  mutable std::mutex subscribersMutex_;
+  std::unordered_map<std::string, std::unique_ptr<Subscription>>
+      subscribers_;
 
-  std::shared_ptr<GOOSEReceiver> receiver_;
-  std::unordered_map<std::string, GooseSubscriber> subscribers_;
+  mutable std::mutex rateMutex_;
+  mutable std::chrono::steady_clock::time_point lastRateSample_;
+  mutable std::vector<uint64_t> lastArrivals_;
+  mutable std::vector<double> lastRates_;
 };
 
 } // namespace goose
@@ -0,0 +1,31 @@
+#include "retransmission_curve.h"
+#include <algorithm>
+
+namespace gateway {
+namespace iec61850 {
+namespace goose {
+
+uint32_t RetransmissionCurve::intervalMs(uint32_t repeat) const {
+  uint32_t minTime = std::max<uint32_t>(minTimeMs, 1);
+  uint32_t maxTime = std::max(maxTimeMs, minTime);
+  uint64_t interval = minTime;
+  for (uint32_t i = 0; i < repeat && interval < maxTime; ++i)
+    interval <<= 1;
+  return static_cast<uint32_t>(std::min<uint64_t>(interval, maxTime));
+}
+
+void RetransmissionSchedule::trigger(Clock::time_point now) {
+  next_ = now;
+  repeat_ = 0;
+}
+
+void RetransmissionSchedule::sent(Clock::time_point now) {
+  auto interval = std::chrono::milliseconds(nextIntervalMs());
+  next_ = now - next_ > interval ? now + interval : next_ + interval;
+  if (repeat_ < UINT32_MAX)
+    repeat_++;
+}
+
+} // namespace goose
+} // namespace iec61850
+} // namespace gateway
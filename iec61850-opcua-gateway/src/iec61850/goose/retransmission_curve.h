@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace gateway {
+namespace iec61850 {
+namespace goose {
+
+/**
+ * @brief GOOSE retransmission intervals after a state change
+ *
+ * The first repeat follows after MinTime, each further one after twice
+ * the previous interval, until the heartbeat MaxTime is reached, as
+ * configured per GSE in the SCD.
+ */
+struct RetransmissionCurve {
+  uint32_t minTimeMs = 2;
+  uint32_t maxTimeMs = 1000;
+
+  /**
+   * @brief Interval between message @p repeat of a state and the next one
+   * @param repeat Messages of the state sent before, 0 = the change itself
+   */
+  uint32_t intervalMs(uint32_t repeat) const;
+
+  /**
+   * @brief TimeAllowedToLive carried by message @p repeat: twice the time
+   * until the next one, so a single lost message is tolerated
+   */
+  uint32_t timeAllowedToLiveMs(uint32_t repeat) const {
+    return 2 * intervalMs(repeat);
+  }
+};
+
+/**
+ * @brief When one GoCB sends next, following a RetransmissionCurve
+ *
+ * Due times are anchored to the schedule, not to when a message actually
+ * went out, so the heartbeat does not drift with send latency. A sender
+ * that fell behind by more than an interval restarts from now instead of
+ * bursting to catch up.
+ */
+class RetransmissionSchedule {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit RetransmissionSchedule(RetransmissionCurve curve = {})
+      : curve_(curve) {}
+
+  const RetransmissionCurve &curve() const { return curve_; }
+
+  /**
+   * @brief A state change: due at once, the curve starts over
+   */
+  void trigger(Clock::time_point now);
+
+  bool due(Clock::time_point now) const { return now >= next_; }
+  Clock::time_point next() const { return next_; }
+
+  // Messages of the current state sent so far
+  uint32_t repeat() const { return repeat_; }
+
+  // Interval after the message due next
+  uint32_t nextIntervalMs() const { return curve_.intervalMs(repeat_); }
+
+  /**
+   * @brief Record that the due message went out and schedule the next
+   */
+  void sent(Clock::time_point now);
+
+private:
+  RetransmissionCurve curve_;
+  Clock::time_point next_{};
+  uint32_t repeat_ = 0;
+};
+
+} // namespace goose
+} // namespace iec61850
+} // namespace gateway
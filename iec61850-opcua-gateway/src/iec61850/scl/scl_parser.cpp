@@ -1,10 +1,77 @@
 #include "scl_parser.h"
 #include "core/logger.h"
+#include <cstdlib>
 #include <iostream>
+#include <utility>
 
 namespace gateway {
 namespace iec61850 {
 
+namespace {
+
+// IEC 61850-7-3 CDC -> DA carrying the value and its FC. Measurands list
+// the float variant; an MV with only mag.i falls back like an unlisted CDC.
+struct PrimaryEntry {
+  const char *cdc;
+  const char *name;
+  const char *fc;
+};
+
+const PrimaryEntry kPrimaryAttributes[] = {
+    {"SPS", "stVal", "ST"},
+    {"DPS", "stVal", "ST"},
+    {"INS", "stVal", "ST"},
+    {"ENS", "stVal", "ST"},
+    {"ACT", "general", "ST"},
+    {"ACD", "general", "ST"},
+    {"SEC", "cnt", "ST"},
+    {"BCR", "actVal", "ST"},
+    {"MV", "mag.f", "MX"},
+    {"CMV", "cVal.mag.f", "MX"},
+    {"SAV", "instMag.f", "MX"},
+    {"WYE", "phsA.cVal.mag.f", "MX"},
+    {"DEL", "phsAB.cVal.mag.f", "MX"},
+    {"SEQ", "c1.cVal.mag.f", "MX"},
+    {"SPC", "stVal", "ST"},
+    {"DPC", "stVal", "ST"},
+    {"INC", "stVal", "ST"},
+    {"ENC", "stVal", "ST"},
+    {"BSC", "valWTr.posVal", "ST"},
+    {"ISC", "valWTr.posVal", "ST"},
+    {"APC", "mxVal.f", "MX"},
+    {"BAC", "mxVal.f", "MX"},
+};
+
+bool hasAttribute(const DOTypeTemplate &type, const std::string &name) {
+  for (const auto &da : type.attributes) {
+    if (da.name == name)
+      return true;
+  }
+  return false;
+}
+
+} // namespace
+
+std::string primaryAttribute(const DOTypeTemplate &type) {
+  for (const auto &entry : kPrimaryAttributes) {
+    if (type.cdc == entry.cdc && hasAttribute(type, entry.name))
+      return entry.name;
+  }
+  for (const char *fallback : {"stVal", "mag.f"}) {
+    if (hasAttribute(type, fallback))
+      return fallback;
+  }
+  return "";
+}
+
+DataAttributeTemplate primaryAttribute(const std::string &cdc) {
+  for (const auto &entry : kPrimaryAttributes) {
+    if (cdc == entry.cdc)
+      return {entry.name, entry.fc, ""};
+  }
+  return {"stVal", "ST", ""};
+}
+
 SCLParser::SCLParser() {}
 
 SCLParser::~SCLParser() {}
@@ -70,29 +137,112 @@ std::vector<IEDConfig> SCLParser::parse(const std::string &filepath) {
   }
 
   auto commNode = scl.child("Communication");
+  indexConnectedAPs(commNode);
 
   for (auto iedNode : scl.children("IED")) {
     configs.push_back(parseIED(iedNode, commNode));
   }
 
+  connectedAPs_.clear();
   return configs;
 }
 
+void SCLParser::indexConnectedAPs(const pugi::xml_node &commNode) {
+  connectedAPs_.clear();
+  if (!commNode)
+    return;
+
+  for (auto subNetwork : commNode.children("SubNetwork")) {
+    for (auto connAP : subNetwork.children("ConnectedAP")) {
+      std::string iedName = connAP.attribute("iedName").as_string();
+      if (!iedName.empty()) {
+        connectedAPs_[iedName].push_back(connAP);
+      }
+    }
+  }
+}
+
 void SCLParser::parseDataTypeTemplates(const pugi::xml_node &rootNode) {
   doTypeMap_.clear();
+
+  std::unordered_map<std::string, pugi::xml_node> doTypes;
+  std::unordered_map<std::string, pugi::xml_node> daTypes;
+  for (auto doType : rootNode.children("DOType")) {
+    doTypes.emplace(doType.attribute("id").as_string(), doType);
+  }
+  for (auto daType : rootNode.children("DAType")) {
+    daTypes.emplace(daType.attribute("id").as_string(), daType);
+  }
+
+  // Flatten each DOType once; every DO of that type shares the result
+  size_t attributeCount = 0;
   for (auto doType : rootNode.children("DOType")) {
     std::string id = doType.attribute("id").as_string();
     std::string cdc = doType.attribute("cdc").as_string();
-    if (!id.empty() && !cdc.empty()) {
-      doTypeMap_[id] = cdc;
-    }
+    if (id.empty() || cdc.empty())
+      continue;
+
+    auto tmpl = std::make_shared<DOTypeTemplate>();
+    tmpl->id = id;
+    tmpl->cdc = cdc;
+    flattenAttributes(doType, "", "", doTypes, daTypes, 0, tmpl->attributes);
+    attributeCount += tmpl->attributes.size();
+    doTypeMap_[id] = std::move(tmpl);
   }
-  LOG_INFO("Parsed {} DOTypes from templates", doTypeMap_.size());
+  LOG_INFO("Parsed {} DOTypes ({} leaf attributes) from templates",
+           doTypeMap_.size(), attributeCount);
 
   // Parse LNodeTypes
   parseLNodeTypes(rootNode);
 }
 
+void SCLParser::flattenAttributes(
+    const pugi::xml_node &typeNode, const std::string &prefix,
+    const std::string &fc,
+    const std::unordered_map<std::string, pugi::xml_node> &doTypes,
+    const std::unordered_map<std::string, pugi::xml_node> &daTypes, int depth,
+    std::vector<DataAttributeTemplate> &out) {
+  // Guards against recursive type references in malformed templates
+  constexpr int kMaxDepth = 8;
+  if (depth > kMaxDepth)
+    return;
+
+  for (auto child : typeNode.children()) {
+    std::string element = child.name();
+    if (element != "DA" && element != "SDO" && element != "BDA")
+      continue;
+
+    std::string name = child.attribute("name").as_string();
+    if (name.empty())
+      continue;
+    std::string path = prefix.empty() ? name : prefix + "." + name;
+    std::string type = child.attribute("type").as_string();
+
+    if (element == "SDO") {
+      auto it = doTypes.find(type);
+      if (it != doTypes.end()) {
+        flattenAttributes(it->second, path, fc, doTypes, daTypes, depth + 1,
+                          out);
+      }
+      continue;
+    }
+
+    // BDAs inherit the functional constraint of their enclosing DA
+    std::string daFc = element == "DA" ? child.attribute("fc").as_string() : fc;
+    std::string bType = child.attribute("bType").as_string();
+    if (bType == "Struct") {
+      auto it = daTypes.find(type);
+      if (it != daTypes.end()) {
+        flattenAttributes(it->second, path, daFc, doTypes, daTypes, depth + 1,
+                          out);
+      }
+      continue;
+    }
+
+    out.push_back({path, daFc, bType});
+  }
+}
+
 void SCLParser::parseLNodeTypes(const pugi::xml_node &rootNode) {
   lnTypeMap_.clear();
   for (auto lNodeType : rootNode.children("LNodeType")) {
@@ -121,20 +271,22 @@ IEDConfig SCLParser::parseIED(const pugi::xml_node &iedNode,
   config.manufacturer = iedNode.attribute("manufacturer").as_string();
 
   // Extract IP from Communication section if available
-  if (commNode) {
-    std::string xpath =
-        "//ConnectedAP[@iedName='" + config.name + "']/Address/P[@type='IP']";
-    auto ipNode = commNode.select_node(xpath.c_str()).node();
-    if (ipNode) {
-      config.ip = ipNode.text().as_string();
+  auto apIt = connectedAPs_.find(config.name);
+  if (apIt != connectedAPs_.end()) {
+    for (const auto &connAP : apIt->second) {
+      auto ipNode = connAP.select_node("Address/P[@type='IP']").node();
+      if (ipNode) {
+        config.ip = ipNode.text().as_string();
+        break;
+      }
     }
   }
 
   config.gooseControls = parseGOOSEControls(iedNode, commNode);
   config.logicalDevices = parseLogicalDevices(iedNode); // NEW
 
-  LOG_INFO("Parsed IED: {}, Type: {}, IP: {}", config.name, config.type,
-           config.ip);
+  LOG_DEBUG("Parsed IED: {}, Type: {}, IP: {}", config.name, config.type,
+            config.ip);
   return config;
 }
 
@@ -144,38 +296,85 @@ SCLParser::parseGOOSEControls(const pugi::xml_node &iedNode,
   std::vector<GOOSEControlBlock> controls;
   std::string iedName = iedNode.attribute("name").as_string();
 
-  // Find all GSEControl elements in the IED
-  // Note: This is a simplified search. Real implementation needs to traverse
-  // LDevice/LN0
+  // GSEControl lives in LN0, next to the DataSet it publishes
   auto gseControls = iedNode.select_nodes(".//GSEControl");
 
   for (auto gse : gseControls) {
+    pugi::xml_node ctrlNode = gse.node();
+    pugi::xml_node ln0Node = ctrlNode.parent();
     GOOSEControlBlock gcb;
-    gcb.name = gse.node().attribute("name").as_string();
-    gcb.appID = gse.node().attribute("appID").as_string();
-    gcb.dataSet = gse.node().attribute("datSet").as_string();
+    gcb.name = ctrlNode.attribute("name").as_string();
+    gcb.appID = ctrlNode.attribute("appID").as_string();
+    gcb.goID = gcb.appID;
+    gcb.dataSet = ctrlNode.attribute("datSet").as_string();
+    gcb.confRev = ctrlNode.attribute("confRev").as_int(1);
+    gcb.ldInst = ln0Node.parent().attribute("inst").as_string();
+    gcb.reference = iedName + gcb.ldInst + "/LLN0$GO$" + gcb.name;
+
+    auto dsNode = ln0Node.find_child_by_attribute("DataSet", "name",
+                                                  gcb.dataSet.c_str());
+    for (auto fcda : dsNode.children("FCDA")) {
+      DataSetMember member;
+      member.ldInst = fcda.attribute("ldInst").as_string(gcb.ldInst.c_str());
+      member.prefix = fcda.attribute("prefix").as_string();
+      member.lnClass = fcda.attribute("lnClass").as_string();
+      member.lnInst = fcda.attribute("lnInst").as_string();
+      member.doName = fcda.attribute("doName").as_string();
+      member.daName = fcda.attribute("daName").as_string();
+      member.fc = fcda.attribute("fc").as_string();
+      gcb.members.push_back(member);
+    }
 
     // Try to find MAC address in Communication section
-    if (commNode) {
-      // XPath to find GSE element in Communication section matching cbName
-      // This is complex because we need to match ldInst as well.
-      // For Phase 1/2 simplified, we might just look for matching cbName for
-      // this IED. A robust implementation would map LDevice inst correctly.
-
-      // Simplified lookup
-      std::string xpath = "//ConnectedAP[@iedName='" + iedName +
-                          "']//GSE[@cbName='" + gcb.name +
-                          "']//P[@type='MAC-Address']";
-      auto macNode = commNode.select_node(xpath.c_str()).node();
-      if (macNode) {
-        gcb.macAddress = macNode.text().as_string();
-      }
-
-      xpath = "//ConnectedAP[@iedName='" + iedName + "']//GSE[@cbName='" +
-              gcb.name + "']//P[@type='APPID']";
-      auto appidNode = commNode.select_node(xpath.c_str()).node();
-      if (appidNode) {
-        gcb.appID = appidNode.text().as_string(); // Override if present in Comm
+    auto apIt = connectedAPs_.find(iedName);
+    if (commNode && apIt != connectedAPs_.end()) {
+      // Find the GSE element in this IED's ConnectedAPs matching cbName
+      // and, when known, ldInst
+      std::string gsePath = ".//GSE[@cbName='" + gcb.name + "']";
+      if (!gcb.ldInst.empty())
+        gsePath = ".//GSE[@ldInst='" + gcb.ldInst + "'][@cbName='" +
+                  gcb.name + "']";
+      for (const auto &connAP : apIt->second) {
+        auto gseNode = connAP.select_node(gsePath.c_str()).node();
+        if (!gseNode)
+          continue;
+
+        auto macNode = gseNode.select_node(".//P[@type='MAC-Address']").node();
+        if (macNode) {
+          gcb.macAddress = macNode.text().as_string();
+        }
+
+        auto appidNode = gseNode.select_node(".//P[@type='APPID']").node();
+        if (appidNode) {
+          gcb.appID = appidNode.text().as_string(); // Override if present
+        }
+
+        auto vlanNode = gseNode.select_node(".//P[@type='VLAN-ID']").node();
+        if (vlanNode) {
+          gcb.vlanID = static_cast<int>(
+              std::strtol(vlanNode.text().as_string(), nullptr, 16));
+        }
+        auto priorityNode =
+            gseNode.select_node(".//P[@type='VLAN-PRIORITY']").node();
+        if (priorityNode) {
+          gcb.vlanPriority = priorityNode.text().as_int(gcb.vlanPriority);
+        }
+
+        // Retransmission bounds, in ms unless multiplier says otherwise
+        auto timeMs = [](const pugi::xml_node &node) {
+          double value = node.text().as_double();
+          std::string multiplier = node.attribute("multiplier").as_string("m");
+          if (multiplier.empty())
+            value *= 1000.0;
+          else if (multiplier == "u")
+            value /= 1000.0;
+          return static_cast<int>(value + 0.5);
+        };
+        if (auto minNode = gseNode.child("MinTime"))
+          gcb.minTimeMs = timeMs(minNode);
+        if (auto maxNode = gseNode.child("MaxTime"))
+          gcb.maxTimeMs = timeMs(maxNode);
+        break;
       }
     }
 
@@ -253,15 +452,21 @@ SCLParser::parseDataObjects(const pugi::xml_node &lnNode) {
 
     // Fallback: Look up in LNodeType template if type is missing
     if (typeId.empty() && !lnType.empty()) {
-      if (lnTypeMap_.count(lnType) && lnTypeMap_[lnType].count(dobj.name)) {
-        typeId = lnTypeMap_[lnType][dobj.name];
-        LOG_INFO("Resolved missing type for DOI {}: {} -> {}", dobj.name,
-                 lnType, typeId);
+      auto lnIt = lnTypeMap_.find(lnType);
+      if (lnIt != lnTypeMap_.end()) {
+        auto doIt = lnIt->second.find(dobj.name);
+        if (doIt != lnIt->second.end()) {
+          typeId = doIt->second;
+          LOG_TRACE("Resolved missing type for DOI {}: {} -> {}", dobj.name,
+                    lnType, typeId);
+        }
       }
     }
 
-    if (!typeId.empty() && doTypeMap_.count(typeId)) {
-      dobj.type = doTypeMap_[typeId]; // e.g. "SPS"
+    auto cdcIt = typeId.empty() ? doTypeMap_.end() : doTypeMap_.find(typeId);
+    if (cdcIt != doTypeMap_.end()) {
+      dobj.type = cdcIt->second->cdc; // e.g. "SPS"
+      dobj.typeTemplate = cdcIt->second;
     } else {
       // Fallback or keep empty/unknown
       dobj.type = typeId.empty() ? "Unknown" : typeId;
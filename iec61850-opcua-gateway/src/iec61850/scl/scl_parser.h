@@ -21,6 +21,17 @@ enum class SCLFileType {
   UNKNOWN
 };
 
+// FCDA of a DataSet; members travel on the wire in this order
+struct DataSetMember {
+  std::string ldInst;
+  std::string prefix;
+  std::string lnClass;
+  std::string lnInst;
+  std::string doName; // May name an SDO, e.g. "A.phsA"
+  std::string daName; // Empty when the whole DO is the member
+  std::string fc;
+};
+
 struct GOOSEControlBlock {
   std::string name;
   std::string appID;
@@ -28,13 +39,53 @@ struct GOOSEControlBlock {
   std::string dataSet;
   int vlanID = 0;
   int vlanPriority = 4;
+  int minTimeMs = 0; // GSE retransmission curve, 0 = not configured
+  int maxTimeMs = 0;
   int confRev = 1;
+  std::string ldInst;
+  std::string goID;
+  std::string reference; // GoCBRef as published, e.g. "IED1LD0/LLN0$GO$gcb01"
+  std::vector<DataSetMember> members; // FCDAs of dataSet
 };
 
+// Leaf data attribute of a DOType, flattened through SDOs and struct DAs
+struct DataAttributeTemplate {
+  std::string name;  // Path below the DO, e.g. "stVal", "phsA.cVal.mag.f"
+  std::string fc;    // Functional constraint, e.g. "ST", "MX", "CF"
+  std::string bType; // Basic type, e.g. "BOOLEAN", "FLOAT32", "Dbpos"
+};
+
+// DOType from DataTypeTemplates, shared by every DO instantiating it
+struct DOTypeTemplate {
+  std::string id;
+  std::string cdc;
+  std::vector<DataAttributeTemplate> attributes;
+};
+
+/**
+ * @brief Path of the DA carrying a DO's value, from a per-CDC table:
+ * "stVal" for SPS/DPC, "mag.f" for MV, "cVal.mag.f" for CMV,
+ * "phsA.cVal.mag.f" for WYE, "mxVal.f" for APC, ...
+ *
+ * CDCs missing from the table, or DOTypes lacking the listed DA, fall
+ * back to stVal, then mag.f.
+ * @return Empty if the DOType has no such attribute
+ */
+std::string primaryAttribute(const DOTypeTemplate &type);
+
+/**
+ * @brief Primary DA of a bare CDC, for DOs whose DOType is unresolved:
+ * name and FC from the same table, e.g. {"cVal.mag.f", "MX"} for CMV,
+ * {"actVal", "ST"} for BCR. Unlisted CDCs get {"stVal", "ST"}.
+ * @return Template with name and fc set; bType is left empty
+ */
+DataAttributeTemplate primaryAttribute(const std::string &cdc);
+
 // Data Object structure
 struct DataObject {
   std::string name;
   std::string type; // e.g., "SPS", "MV", "INS"
+  std::shared_ptr<const DOTypeTemplate> typeTemplate; // Null if unresolved
 };
 
 // Logical Node structure
@@ -98,13 +149,27 @@ private:
   void parseDataTypeTemplates(const pugi::xml_node &rootNode);
   void parseLNodeTypes(const pugi::xml_node &rootNode); // New helper
 
-  // Map DOType ID -> CDC (e.g. "SPS_Type" -> "SPS")
-  std::unordered_map<std::string, std::string> doTypeMap_;
+  // Map DOType ID -> flattened template (CDC + leaf DAs)
+  std::unordered_map<std::string, std::shared_ptr<const DOTypeTemplate>>
+      doTypeMap_;
+
+  // Flatten a DOType or DAType element into leaf attributes below @p prefix
+  void flattenAttributes(
+      const pugi::xml_node &typeNode, const std::string &prefix,
+      const std::string &fc,
+      const std::unordered_map<std::string, pugi::xml_node> &doTypes,
+      const std::unordered_map<std::string, pugi::xml_node> &daTypes,
+      int depth, std::vector<DataAttributeTemplate> &out);
 
   // Map of LNodeType ID -> Map of DO Name -> DO Type ID
   // e.g. "LPHD_Type" -> { "PhyNam" -> "DPL_1_PhyNam" }
   std::unordered_map<std::string, std::unordered_map<std::string, std::string>>
       lnTypeMap_;
+
+  // Map IED name -> ConnectedAP elements, built once per parse() so that
+  // per-IED lookups don't rescan the whole Communication section
+  void indexConnectedAPs(const pugi::xml_node &commNode);
+  std::unordered_map<std::string, std::vector<pugi::xml_node>> connectedAPs_;
 };
 
 } // namespace iec61850
@@ -0,0 +1,348 @@
+#include "comtrade_writer.h"
+#include "core/logger.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+namespace {
+
+constexpr uint32_t kMissingTime = 0xFFFFFFFF;
+constexpr int64_t kBinaryMax = 32767; // -32768 marks a missing value
+constexpr std::array<const char *, kChannels> kPhases = {"A", "B", "C", "N",
+                                                         "A", "B", "C", "N"};
+
+// 9-2LE quality: validity in the two lowest bits, 00 = good
+bool invalid(uint32_t quality) { return (quality & 0x3) != 0; }
+
+char *putLE16(char *p, uint16_t v) {
+  p[0] = static_cast<char>(v);
+  p[1] = static_cast<char>(v >> 8);
+  return p + 2;
+}
+
+char *putLE32(char *p, uint32_t v) {
+  p[0] = static_cast<char>(v);
+  p[1] = static_cast<char>(v >> 8);
+  p[2] = static_cast<char>(v >> 16);
+  p[3] = static_cast<char>(v >> 24);
+  return p + 4;
+}
+
+char *putNumber(char *p, char *end, int64_t v) {
+  return std::to_chars(p, end, v).ptr;
+}
+
+// CFG fields are comma separated
+std::string field(std::string text) {
+  std::replace(text.begin(), text.end(), ',', '_');
+  return text;
+}
+
+std::string formatTime(uint64_t unixUs) {
+  std::time_t seconds = static_cast<std::time_t>(unixUs / 1000000);
+  std::tm utc{};
+  gmtime_r(&seconds, &utc);
+  char text[80];
+  std::snprintf(text, sizeof(text), "%02d/%02d/%04d,%02d:%02d:%02d.%06u",
+                utc.tm_mday, utc.tm_mon + 1, utc.tm_year + 1900, utc.tm_hour,
+                utc.tm_min, utc.tm_sec,
+                static_cast<unsigned>(unixUs % 1000000));
+  return text;
+}
+
+std::string formatDouble(double value) {
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.9g", value);
+  return text;
+}
+
+} // namespace
+
+const char *comtradeFormatName(ComtradeFormat format) {
+  switch (format) {
+  case ComtradeFormat::Ascii:
+    return "ASCII";
+  case ComtradeFormat::Binary:
+    return "BINARY";
+  case ComtradeFormat::Binary32:
+    return "BINARY32";
+  case ComtradeFormat::Float32:
+    return "FLOAT32";
+  }
+  return "BINARY32";
+}
+
+bool parseComtradeFormat(const std::string &name, ComtradeFormat &format) {
+  std::string upper = name;
+  std::transform(upper.begin(), upper.end(), upper.begin(),
+                 [](unsigned char c) { return std::toupper(c); });
+  for (ComtradeFormat f :
+       {ComtradeFormat::Ascii, ComtradeFormat::Binary,
+        ComtradeFormat::Binary32, ComtradeFormat::Float32}) {
+    if (upper == comtradeFormatName(f)) {
+      format = f;
+      return true;
+    }
+  }
+  return false;
+}
+
+ComtradeWriter::ComtradeWriter(const ComtradeConfig &config)
+    : config_(config) {
+  if (config_.streams.empty())
+    config_.streams.push_back({});
+}
+
+ComtradeWriter::~ComtradeWriter() {
+  if (isOpen())
+    close();
+}
+
+bool ComtradeWriter::open(const std::string &path) {
+  if (isOpen())
+    return false;
+  path_ = path;
+  dat_.open(path + ".dat", std::ios::binary | std::ios::trunc);
+  if (!dat_.is_open()) {
+    LOG_ERROR("Failed to open COMTRADE data file {}.dat", path);
+    return false;
+  }
+  buffer_.clear();
+  buffer_.reserve(kBufferSize);
+  // The widest row is ASCII: up to 12 characters a value
+  row_.resize(32 + config_.streams.size() *
+                       (kChannels * 12 + kDigitalPerStream * 2));
+  failed_ = false;
+  rows_ = 0;
+  bytes_ = 0;
+  firstUs_ = 0;
+  synchronised_ = false;
+  return true;
+}
+
+int64_t ComtradeWriter::binaryDivisor(size_t stream, int channel) const {
+  int64_t peak = config_.streams[stream].peak[channel];
+  return std::max<int64_t>(1, (peak + kBinaryMax - 1) / kBinaryMax);
+}
+
+void ComtradeWriter::append(const void *data, size_t size) {
+  if (buffer_.size() + size > kBufferSize)
+    flush();
+  const char *bytes = static_cast<const char *>(data);
+  buffer_.insert(buffer_.end(), bytes, bytes + size);
+}
+
+bool ComtradeWriter::flush() {
+  if (!buffer_.empty()) {
+    dat_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    bytes_ += buffer_.size();
+    buffer_.clear();
+  }
+  if (!dat_)
+    failed_ = true;
+  return !failed_;
+}
+
+bool ComtradeWriter::write(const SVSample *samples) {
+  if (!isOpen() || failed_)
+    return false;
+  if (rows_ == 0) {
+    firstUs_ = samples[0].timestamp;
+    synchronised_ = samples[0].synchronised;
+  }
+
+  uint64_t offset =
+      samples[0].timestamp > firstUs_ ? samples[0].timestamp - firstUs_ : 0;
+  uint32_t time = offset < kMissingTime ? static_cast<uint32_t>(offset)
+                                        : kMissingTime;
+  uint32_t number = static_cast<uint32_t>(rows_ + 1);
+  const size_t streams = config_.streams.size();
+
+  char *begin = row_.data();
+  char *end = begin + row_.size();
+  char *p = begin;
+
+  if (config_.format == ComtradeFormat::Ascii) {
+    p = putNumber(p, end, number);
+    *p++ = ',';
+    if (time != kMissingTime)
+      p = putNumber(p, end, time);
+    for (size_t s = 0; s < streams; ++s) {
+      for (int ch = 0; ch < kChannels; ++ch) {
+        *p++ = ',';
+        p = putNumber(p, end, samples[s].values[ch]);
+      }
+    }
+    for (size_t s = 0; s < streams; ++s) {
+      for (int ch = 0; ch < kChannels; ++ch) {
+        *p++ = ',';
+        *p++ = invalid(samples[s].quality[ch]) ? '1' : '0';
+      }
+      *p++ = ',';
+      *p++ = samples[s].synchronised ? '1' : '0';
+    }
+    *p++ = '\r';
+    *p++ = '\n';
+    append(begin, static_cast<size_t>(p - begin));
+    rows_++;
+    return !failed_;
+  }
+
+  p = putLE32(p, number);
+  p = putLE32(p, time);
+  for (size_t s = 0; s < streams; ++s) {
+    const SVSample &sample = samples[s];
+    for (int ch = 0; ch < kChannels; ++ch) {
+      switch (config_.format) {
+      case ComtradeFormat::Binary: {
+        int64_t value = sample.values[ch] / binaryDivisor(s, ch);
+        value = std::clamp<int64_t>(value, -kBinaryMax, kBinaryMax);
+        p = putLE16(p, static_cast<uint16_t>(static_cast<int16_t>(value)));
+        break;
+      }
+      case ComtradeFormat::Float32: {
+        float value = static_cast<float>(scaledValue(sample, ch));
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        p = putLE32(p, bits);
+        break;
+      }
+      default:
+        p = putLE32(p, static_cast<uint32_t>(sample.values[ch]));
+        break;
+      }
+    }
+  }
+
+  // Digital channels, 16 to a word, first channel in the lowest bit
+  uint16_t word = 0;
+  int bit = 0;
+  auto pushBit = [&](bool set) {
+    if (set)
+      word |= static_cast<uint16_t>(1u << bit);
+    if (++bit == 16) {
+      p = putLE16(p, word);
+      word = 0;
+      bit = 0;
+    }
+  };
+  for (size_t s = 0; s < streams; ++s) {
+    for (int ch = 0; ch < kChannels; ++ch)
+      pushBit(invalid(samples[s].quality[ch]));
+    pushBit(samples[s].synchronised);
+  }
+  if (bit)
+    p = putLE16(p, word);
+
+  append(begin, static_cast<size_t>(p - begin));
+  rows_++;
+  return !failed_;
+}
+
+bool ComtradeWriter::close(uint64_t triggerUs) {
+  if (!isOpen())
+    return false;
+  flush();
+  dat_.close();
+  if (failed_) {
+    LOG_ERROR("Failed to write COMTRADE data file {}.dat", path_);
+    return false;
+  }
+  if (!writeConfig(triggerUs ? triggerUs : firstUs_)) {
+    LOG_ERROR("Failed to write COMTRADE config file {}.cfg", path_);
+    return false;
+  }
+  LOG_INFO("Exported COMTRADE {} ({}, {} rows, {} bytes)", path_,
+           comtradeFormatName(config_.format), rows_, bytes_);
+  return true;
+}
+
+bool ComtradeWriter::writeConfig(uint64_t triggerUs) {
+  const size_t streams = config_.streams.size();
+  const size_t analog = streams * kChannels;
+  const size_t digital = streams * kDigitalPerStream;
+
+  std::string cfg;
+  cfg += field(config_.station) + "," + field(config_.device) + ",2013\r\n";
+  cfg += std::to_string(analog + digital) + "," + std::to_string(analog) +
+         "A," + std::to_string(digital) + "D\r\n";
+
+  std::string range;
+  switch (config_.format) {
+  case ComtradeFormat::Binary:
+    range = "-32767,32767";
+    break;
+  case ComtradeFormat::Float32:
+    range = "-3.402823e+38,3.402823e+38";
+    break;
+  default:
+    range = "-2147483647,2147483647";
+    break;
+  }
+
+  // Channel ids carry the stream name only when there are several
+  auto channelId = [&](size_t s, const std::string &channel) {
+    const std::string &name = config_.streams[s].name;
+    return field(streams > 1 && !name.empty() ? name + " " + channel
+                                              : channel);
+  };
+
+  size_t index = 1;
+  for (size_t s = 0; s < streams; ++s) {
+    std::string circuit = field(config_.streams[s].name);
+    for (int ch = 0; ch < kChannels; ++ch) {
+      size_t c = static_cast<size_t>(ch);
+      double multiplier = channelScale(ch);
+      if (config_.format == ComtradeFormat::Binary)
+        multiplier *= static_cast<double>(binaryDivisor(s, ch));
+      else if (config_.format == ComtradeFormat::Float32)
+        multiplier = 1.0;
+      cfg += std::to_string(index++) + "," +
+             channelId(s, kChannelNames[c]) + "," + kPhases[c] + "," +
+             circuit + "," + (ch < kCurrentChannels ? "A" : "V") + "," +
+             formatDouble(multiplier) + ",0,0," + range + ",1,1,P\r\n";
+    }
+  }
+  index = 1;
+  for (size_t s = 0; s < streams; ++s) {
+    std::string circuit = field(config_.streams[s].name);
+    for (size_t ch = 0; ch < kChannelNames.size(); ++ch) {
+      cfg += std::to_string(index++) + "," +
+             channelId(s, std::string(kChannelNames[ch]) + " invalid") + "," +
+             kPhases[ch] + "," + circuit + ",0\r\n";
+    }
+    cfg += std::to_string(index++) + "," + channelId(s, "SmpSynch") + ",," +
+           circuit + ",1\r\n";
+  }
+
+  cfg += std::to_string(config_.nominalFrequency ? config_.nominalFrequency
+                                                 : 50) +
+         "\r\n";
+  cfg += "1\r\n";
+  cfg += std::to_string(config_.sampleRate) + "," + std::to_string(rows_) +
+         "\r\n";
+  cfg += formatTime(firstUs_) + "\r\n";
+  cfg += formatTime(triggerUs) + "\r\n";
+  cfg += std::string(comtradeFormatName(config_.format)) + "\r\n";
+  cfg += "1\r\n";   // Time multiplier: microseconds
+  cfg += "0,0\r\n"; // UTC
+  // Time quality: locked to a source, or unreliable
+  cfg += synchronised_ ? "0,0\r\n" : "F,0\r\n";
+
+  std::ofstream out(path_ + ".cfg", std::ios::binary | std::ios::trunc);
+  out.write(cfg.data(), static_cast<std::streamsize>(cfg.size()));
+  return static_cast<bool>(out);
+}
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
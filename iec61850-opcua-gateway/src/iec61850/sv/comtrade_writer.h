@@ -0,0 +1,109 @@
+#pragma once
+
+#include "sv_sample.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+// DAT file formats of IEEE C37.111-2013
+enum class ComtradeFormat { Ascii, Binary, Binary32, Float32 };
+
+// "ASCII", "BINARY", "BINARY32" or "FLOAT32", as in the CFG
+const char *comtradeFormatName(ComtradeFormat format);
+// Case-insensitive; false leaves @p format alone
+bool parseComtradeFormat(const std::string &name, ComtradeFormat &format);
+
+// One SV stream of a recording: eight analog and nine digital channels
+struct ComtradeStream {
+  std::string name; // Channel id prefix and circuit, e.g. the svID
+  // BINARY only: largest |value| per channel in counts, to fit 16 bits;
+  // 0 keeps the 9-2LE resolution and clips beyond +-32767 counts
+  int64_t peak[kChannels] = {};
+};
+
+struct ComtradeConfig {
+  std::string station = "GATEWAY";
+  std::string device = "SV";
+  ComtradeFormat format = ComtradeFormat::Binary32;
+  uint32_t sampleRate = 4000;
+  uint16_t nominalFrequency = 50;
+  std::vector<ComtradeStream> streams;
+};
+
+/**
+ * @brief Streams SV samples into a COMTRADE 2013 recording
+ *
+ * Rows go straight to the DAT file through a large buffer, so a
+ * recording of any length is written in one pass with a few big writes;
+ * the CFG, which needs the sample count, is written by close(). Each row
+ * holds one sample of every stream, in the order of the config's
+ * streams: per stream the channels Ia .. Un and the digital channels
+ * "<channel> invalid" (quality validity not good) and "SmpSynch".
+ *
+ * Analog values are the 9-2LE counts, scaled by the CFG's multiplier:
+ * 32-bit integers for ASCII and BINARY32, engineering units for FLOAT32,
+ * and counts divided down to 16 bits for BINARY. Times are microseconds
+ * from the first row, UTC; rows past the 32-bit time range carry the
+ * "missing" time and are placed by the sample rate.
+ */
+class ComtradeWriter {
+public:
+  static constexpr size_t kBufferSize = size_t{1} << 20;
+  static constexpr int kDigitalPerStream = kChannels + 1;
+
+  explicit ComtradeWriter(const ComtradeConfig &config);
+  ~ComtradeWriter();
+
+  ComtradeWriter(const ComtradeWriter &) = delete;
+  ComtradeWriter &operator=(const ComtradeWriter &) = delete;
+
+  /**
+   * @brief Create <path>.dat; <path>.cfg follows on close()
+   */
+  bool open(const std::string &path);
+
+  /**
+   * @brief Append one row
+   * @param samples One sample per configured stream, in order
+   */
+  bool write(const SVSample *samples);
+
+  /**
+   * @brief Flush the DAT file and write the CFG
+   * @param triggerUs Trigger time, us since the epoch; 0 = first row
+   */
+  bool close(uint64_t triggerUs = 0);
+
+  bool isOpen() const { return dat_.is_open(); }
+  uint64_t rows() const { return rows_; }
+  uint64_t bytesWritten() const { return bytes_; }
+
+private:
+  void append(const void *data, size_t size);
+  bool flush();
+  bool writeConfig(uint64_t triggerUs);
+  // Counts per BINARY step of a channel, at least 1
+  int64_t binaryDivisor(size_t stream, int channel) const;
+
+  ComtradeConfig config_;
+  std::string path_;
+  std::ofstream dat_;
+  std::vector<char> buffer_;
+  std::vector<char> row_; // One row, formatted
+  bool failed_ = false;
+
+  uint64_t rows_ = 0;
+  uint64_t bytes_ = 0;
+  uint64_t firstUs_ = 0;
+  bool synchronised_ = false; // First row's smpSynch
+};
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
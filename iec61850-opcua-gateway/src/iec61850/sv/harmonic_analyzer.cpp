@@ -0,0 +1,95 @@
+#include "harmonic_analyzer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+} // namespace
+
+HarmonicAnalyzer::HarmonicAnalyzer(const SVStreamFormat &format,
+                                   int maxOrder)
+    : cycles_(format.nominalFrequency == 60 ? 12 : 10),
+      n_(uint32_t{cycles_} * std::max<uint16_t>(format.samplesPerCycle, 4)) {
+  // The subgroup's upper bin must stay below half the sample rate
+  int nyquist = static_cast<int>(n_ / 2 - 1) / cycles_;
+  maxOrder_ = std::max(1, std::min(maxOrder, nyquist));
+}
+
+void HarmonicAnalyzer::binPower(const std::vector<double> &samples,
+                                uint32_t bin, double *power) const {
+  const double coeff = 2.0 * std::cos(2 * kPi * bin / n_);
+  double s1[kChannels] = {};
+  double s2[kChannels] = {};
+  for (uint32_t i = 0; i < n_; ++i) {
+    const double *x = &samples[size_t{i} * kChannels];
+    for (int ch = 0; ch < kChannels; ++ch) {
+      double s = x[ch] + coeff * s1[ch] - s2[ch];
+      s2[ch] = s1[ch];
+      s1[ch] = s;
+    }
+  }
+  for (int ch = 0; ch < kChannels; ++ch)
+    power[ch] = s1[ch] * s1[ch] + s2[ch] * s2[ch] - coeff * s1[ch] * s2[ch];
+}
+
+HarmonicResult
+HarmonicAnalyzer::analyze(const std::vector<SVSample> &window) const {
+  HarmonicResult result;
+  result.windowCycles = cycles_;
+  result.maxOrder = maxOrder_;
+  if (window.size() < n_)
+    return result;
+  result.valid = true;
+  result.timestamp = window.front().timestamp;
+
+  // Sample-major, as the recurrences walk it
+  std::vector<double> samples(size_t{n_} * kChannels);
+  for (uint32_t i = 0; i < n_; ++i) {
+    for (int ch = 0; ch < kChannels; ++ch)
+      samples[size_t{i} * kChannels + static_cast<size_t>(ch)] =
+          window[i].values[ch];
+  }
+
+  double power[kChannels];
+  double subgroup[kChannels];
+  for (int ch = 0; ch < kChannels; ++ch)
+    result.harmonics[ch].assign(static_cast<size_t>(maxOrder_) + 1, 0.0);
+
+  binPower(samples, 0, power);
+  for (int ch = 0; ch < kChannels; ++ch)
+    result.harmonics[ch][0] = std::sqrt(power[ch]) / n_ * channelScale(ch);
+
+  // A bin of amplitude A has |X|^2 = (A N / 2)^2, an RMS of sqrt2 |X| / N
+  const double rmsSquared = 2.0 / (static_cast<double>(n_) * n_);
+  for (int order = 1; order <= maxOrder_; ++order) {
+    std::fill(std::begin(subgroup), std::end(subgroup), 0.0);
+    uint32_t centre = static_cast<uint32_t>(order) * cycles_;
+    for (uint32_t bin = centre - 1; bin <= centre + 1; ++bin) {
+      binPower(samples, bin, power);
+      for (int ch = 0; ch < kChannels; ++ch)
+        subgroup[ch] += power[ch];
+    }
+    for (int ch = 0; ch < kChannels; ++ch) {
+      result.harmonics[ch][static_cast<size_t>(order)] =
+          std::sqrt(std::max(subgroup[ch], 0.0) * rmsSquared) *
+          channelScale(ch);
+    }
+  }
+
+  for (int ch = 0; ch < kChannels; ++ch) {
+    const std::vector<double> &h = result.harmonics[ch];
+    double distortion = 0.0;
+    for (size_t order = 2; order < h.size(); ++order)
+      distortion += h[order] * h[order];
+    result.thd[ch] = h[1] > 0.0 ? 100.0 * std::sqrt(distortion) / h[1] : 0.0;
+  }
+  return result;
+}
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "sample_clock.h"
+#include "sv_sample.h"
+#include <cstdint>
+#include <vector>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+struct HarmonicResult {
+  bool valid = false;
+  uint64_t timestamp = 0; // First sample of the window, us since the epoch
+  uint16_t windowCycles = 0;
+  int maxOrder = 0;
+  // Per channel, RMS of harmonic subgroups 0 (DC) .. maxOrder, A or V
+  std::vector<double> harmonics[kChannels];
+  double thd[kChannels] = {}; // Percent of the fundamental, 0 if none
+};
+
+/**
+ * @brief Harmonic subgroups and THD of one window of a 9-2LE stream,
+ * after IEC 61000-4-7
+ *
+ * The window is 10 nominal cycles at 50 Hz and 12 at 60 Hz, 200 ms
+ * either way, so DFT bin k lies k/10 or k/12 orders up: bin 10 h is
+ * harmonic h and its two neighbours make up the subgroup. Only those
+ * bins are needed, so each is computed with the Goertzel recurrence
+ * rather than a full FFT of a window whose length is seldom a power of
+ * two. The eight channels run side by side through each recurrence.
+ *
+ * Orders stop below the Nyquist rate: 39 at 80 samples per cycle, 50
+ * at 256. THD is that of the subgroups, THDS in 61000-4-7 terms.
+ */
+class HarmonicAnalyzer {
+public:
+  static constexpr int kDefaultMaxOrder = 50;
+
+  explicit HarmonicAnalyzer(const SVStreamFormat &format = {},
+                            int maxOrder = kDefaultMaxOrder);
+
+  uint16_t windowCycles() const { return cycles_; }
+  // Samples per window
+  uint32_t windowSize() const { return n_; }
+  int maxOrder() const { return maxOrder_; }
+
+  /**
+   * @brief Analyse one window
+   * @param window windowSize() consecutive samples, oldest first
+   */
+  HarmonicResult analyze(const std::vector<SVSample> &window) const;
+
+private:
+  // Squared magnitude of bin @p bin of every channel, in counts
+  void binPower(const std::vector<double> &samples, uint32_t bin,
+                double *power) const;
+
+  uint16_t cycles_;
+  uint32_t n_;
+  int maxOrder_;
+};
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,210 @@
+#include "phasor_estimator.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kSqrt2 = 1.41421356237309504880;
+
+// Smallest positive-sequence magnitudes the frequency is measured from
+constexpr double kMinVoltage = 1.0;  // V
+constexpr double kMinCurrent = 0.01; // A
+
+std::complex<double> toComplex(const Phasor &phasor) {
+  return std::polar(phasor.magnitude, phasor.angle);
+}
+
+Phasor toPhasor(std::complex<double> value) {
+  return {std::abs(value), std::arg(value)};
+}
+
+double wrapAngle(double angle) {
+  while (angle > kPi)
+    angle -= 2 * kPi;
+  while (angle <= -kPi)
+    angle += 2 * kPi;
+  return angle;
+}
+
+} // namespace
+
+SequenceComponents sequenceComponents(const Phasor &a, const Phasor &b,
+                                      const Phasor &c) {
+  const std::complex<double> op = std::polar(1.0, 2 * kPi / 3);
+  const std::complex<double> op2 = op * op;
+  std::complex<double> va = toComplex(a), vb = toComplex(b),
+                       vc = toComplex(c);
+
+  SequenceComponents result;
+  result.zero = toPhasor((va + vb + vc) / 3.0);
+  result.positive = toPhasor((va + op * vb + op2 * vc) / 3.0);
+  result.negative = toPhasor((va + op2 * vb + op * vc) / 3.0);
+  return result;
+}
+
+PhasorEstimator::PhasorEstimator(const SVStreamFormat &format)
+    : n_(std::max<uint32_t>(format.samplesPerCycle, 1)),
+      sampleRate_(std::max<uint32_t>(format.sampleRate, 1)),
+      nominalFrequency_(format.nominalFrequency ? format.nominalFrequency
+                                                : 50.0),
+      cos_(n_), sin_(n_), window_(size_t{n_} * kChannels) {
+  for (uint32_t k = 0; k < n_; ++k) {
+    cos_[k] = std::cos(2 * kPi * k / n_);
+    sin_[k] = std::sin(2 * kPi * k / n_);
+  }
+}
+
+void PhasorEstimator::reset() {
+  std::fill(window_.begin(), window_.end(), 0);
+  std::fill(std::begin(re_), std::end(re_), 0.0);
+  std::fill(std::begin(im_), std::end(im_), 0.0);
+  std::fill(std::begin(squares_), std::end(squares_), 0.0);
+  std::fill(std::begin(last_), std::end(last_), 0);
+  pos_ = 0;
+  filled_ = 0;
+  cycles_ = 0;
+  started_ = false;
+  stale_ = 0;
+  timestamp_ = 0;
+  angleSource_ = -1;
+  frequency_ = 0.0;
+}
+
+bool PhasorEstimator::add(const SVSample &sample) {
+  uint32_t position = sample.smpCnt % n_;
+  bool completed = false;
+
+  if (started_) {
+    uint32_t expected = (lastCnt_ + 1u) % sampleRate_;
+    uint32_t gap = (sample.smpCnt + sampleRate_ - expected) % sampleRate_;
+    if (gap >= sampleRate_ / 2 && ++stale_ <= n_) {
+      // A duplicate or late sample: the count did not advance
+      return false;
+    }
+    stale_ = 0;
+    if (gap >= n_) {
+      reset();
+    } else {
+      // Hold the last sample over the lost ones
+      for (uint32_t i = 0; i < gap; ++i)
+        completed |= slide(last_);
+    }
+  }
+  if (!started_) {
+    started_ = true;
+    pos_ = position;
+  }
+
+  lastCnt_ = sample.smpCnt;
+  timestamp_ = sample.timestamp;
+  std::copy(std::begin(sample.values), std::end(sample.values), last_);
+  completed |= slide(sample.values);
+  return completed;
+}
+
+bool PhasorEstimator::slide(const int32_t *values) {
+  int32_t *slot = &window_[size_t{pos_} * kChannels];
+  const double c = cos_[pos_];
+  const double s = sin_[pos_];
+
+  // Fixed width over the channels: one or two vector operations each
+  double delta[kChannels];
+  for (int ch = 0; ch < kChannels; ++ch) {
+    double x = values[ch];
+    double old = slot[ch];
+    delta[ch] = x - old;
+    squares_[ch] += x * x - old * old;
+  }
+  for (int ch = 0; ch < kChannels; ++ch) {
+    re_[ch] += delta[ch] * c;
+    im_[ch] -= delta[ch] * s;
+  }
+  std::copy(values, values + kChannels, slot);
+
+  filled_ = std::min(filled_ + 1, n_);
+  bool endOfCycle = pos_ == n_ - 1;
+  pos_ = endOfCycle ? 0 : pos_ + 1;
+  if (!endOfCycle || filled_ < n_)
+    return false;
+  cycle();
+  return true;
+}
+
+void PhasorEstimator::refresh() {
+  std::fill(std::begin(re_), std::end(re_), 0.0);
+  std::fill(std::begin(im_), std::end(im_), 0.0);
+  std::fill(std::begin(squares_), std::end(squares_), 0.0);
+  for (uint32_t k = 0; k < n_; ++k) {
+    const int32_t *slot = &window_[size_t{k} * kChannels];
+    for (int ch = 0; ch < kChannels; ++ch) {
+      double x = slot[ch];
+      re_[ch] += x * cos_[k];
+      im_[ch] -= x * sin_[k];
+      squares_[ch] += x * x;
+    }
+  }
+}
+
+void PhasorEstimator::cycle() {
+  if (++cycles_ % kRefreshCycles == 0)
+    refresh();
+
+  // Voltage where there is any, else current
+  int source = -1;
+  SequenceComponents sequence;
+  for (int first : {kCurrentChannels, 0}) {
+    sequence = sequenceComponents(phasor(first), phasor(first + 1),
+                                  phasor(first + 2));
+    double minimum = first == 0 ? kMinCurrent : kMinVoltage;
+    if (sequence.positive.magnitude >= minimum) {
+      source = first;
+      break;
+    }
+  }
+
+  if (source < 0) {
+    angleSource_ = -1;
+    return;
+  }
+  double angle = sequence.positive.angle;
+  if (source == angleSource_) {
+    double turned = wrapAngle(angle - lastAngle_);
+    frequency_ = nominalFrequency_ * (1.0 + turned / (2 * kPi));
+  }
+  angleSource_ = source;
+  lastAngle_ = angle;
+}
+
+Phasor PhasorEstimator::phasor(int channel) const {
+  double scale = kSqrt2 / n_ * channelScale(channel);
+  return {std::hypot(re_[channel], im_[channel]) * scale,
+          std::atan2(im_[channel], re_[channel])};
+}
+
+PhasorResult PhasorEstimator::result() const {
+  PhasorResult result;
+  result.valid = filled_ == n_;
+  result.timestamp = timestamp_;
+  result.frequency = frequency_;
+  for (int ch = 0; ch < kChannels; ++ch) {
+    double meanSquare = std::max(squares_[ch], 0.0) / n_;
+    result.rms[ch] = std::sqrt(meanSquare) * channelScale(ch);
+    result.phasors[ch] = phasor(ch);
+  }
+  result.current = sequenceComponents(result.phasors[0], result.phasors[1],
+                                      result.phasors[2]);
+  result.voltage = sequenceComponents(result.phasors[kCurrentChannels],
+                                      result.phasors[kCurrentChannels + 1],
+                                      result.phasors[kCurrentChannels + 2]);
+  return result;
+}
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
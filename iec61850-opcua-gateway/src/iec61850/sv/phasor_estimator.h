@@ -0,0 +1,110 @@
+#pragma once
+
+#include "sample_clock.h"
+#include "sv_sample.h"
+#include <cstdint>
+#include <vector>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+struct Phasor {
+  double magnitude = 0.0; // RMS of the fundamental, A or V
+  double angle = 0.0;     // Radians
+};
+
+struct SequenceComponents {
+  Phasor zero;
+  Phasor positive;
+  Phasor negative;
+};
+
+struct PhasorResult {
+  bool valid = false;         // A full cycle was seen
+  uint64_t timestamp = 0;     // Last sample of the window, us since epoch
+  double frequency = 0.0;     // Hz, 0 = not yet measured
+  double rms[kChannels] = {}; // True RMS over the cycle, A or V
+  Phasor phasors[kChannels];
+  SequenceComponents current; // Ia, Ib, Ic
+  SequenceComponents voltage; // Ua, Ub, Uc
+};
+
+/**
+ * @brief Fundamental phasors, RMS and frequency of one 9-2LE stream,
+ * updated with every sample
+ *
+ * A sliding DFT over one nominal cycle keeps, per channel, the sum of
+ * x(m) e^(-j2pi m/N) over the last N samples. A new sample only adds its
+ * difference to the sample leaving the window, times a fixed
+ * coefficient, so there is no twiddle factor to accumulate error and a
+ * sample costs the same whatever N. The window position is smpCnt
+ * modulo N, which anchors the angles of a synchronised stream to the top
+ * of the second. Lost samples are bridged by holding the last one.
+ * Duplicate and late samples, whose smpCnt does not advance, are
+ * ignored; a cycle of them in a row means the stream restarted.
+ *
+ * Frequency follows from how far the positive-sequence voltage (current
+ * without voltage) turns per nominal cycle: 2pi (f - f0) / f0.
+ */
+class PhasorEstimator {
+public:
+  explicit PhasorEstimator(const SVStreamFormat &format = {});
+
+  // Window length, samples per nominal cycle
+  uint32_t windowSize() const { return n_; }
+
+  /**
+   * @brief Slide the window over one sample
+   * @return true when a nominal cycle completed
+   */
+  bool add(const SVSample &sample);
+
+  PhasorResult result() const;
+
+  void reset();
+
+private:
+  // Window sums are recomputed this often to shed rounding error
+  static constexpr uint32_t kRefreshCycles = 64;
+
+  // Replace the oldest window position; true if that ended a cycle
+  bool slide(const int32_t *values);
+  void cycle();
+  void refresh();
+  Phasor phasor(int channel) const;
+
+  uint32_t n_;
+  uint32_t sampleRate_;
+  double nominalFrequency_;
+  std::vector<double> cos_; // Per window position
+  std::vector<double> sin_;
+  std::vector<int32_t> window_; // n_ rows of kChannels values
+
+  alignas(64) double re_[kChannels] = {};
+  alignas(64) double im_[kChannels] = {};
+  alignas(64) double squares_[kChannels] = {};
+  int32_t last_[kChannels] = {};
+
+  uint32_t pos_ = 0;    // Next window position
+  uint32_t filled_ = 0; // Samples in the window, up to n_
+  uint32_t cycles_ = 0;
+  bool started_ = false;
+  uint16_t lastCnt_ = 0;
+  uint32_t stale_ = 0; // Samples in a row that did not advance smpCnt
+  uint64_t timestamp_ = 0;
+
+  int angleSource_ = -1; // First channel of the phases lastAngle_ is from
+  double lastAngle_ = 0.0;
+  double frequency_ = 0.0;
+};
+
+/**
+ * @brief Zero, positive and negative sequence of phases A, B and C
+ */
+SequenceComponents sequenceComponents(const Phasor &a, const Phasor &b,
+                                      const Phasor &c);
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
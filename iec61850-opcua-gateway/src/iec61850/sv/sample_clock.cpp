@@ -0,0 +1,102 @@
+#include "sample_clock.h"
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+namespace {
+
+constexpr uint64_t kUsPerSecond = 1000000;
+
+// IEC 61850-9-2LE: 80 samples per cycle for protection, 256 for quality
+constexpr SVStreamFormat kNominalFormats[] = {{4000, 80, 50, false},
+                                              {4800, 80, 60, false},
+                                              {12800, 256, 50, false},
+                                              {15360, 256, 60, false}};
+
+// A second whose last few samples were lost still confirms its rate
+constexpr uint32_t kWrapTolerance = 16;
+
+// Smallest nominal rate above @p count, or a non-standard one
+SVStreamFormat fitting(uint32_t count) {
+  for (const auto &format : kNominalFormats) {
+    if (format.sampleRate > count)
+      return format;
+  }
+  return {count + 1, 0, 0, false};
+}
+
+} // namespace
+
+void SampleClock::detect(uint16_t smpCnt) {
+  // Back below half the last count: the counter wrapped, not a late
+  // sample
+  if (started_ && smpCnt < lastCnt_ && smpCnt < lastCnt_ / 2u) {
+    uint32_t period = maxCnt_ + 1u;
+    SVStreamFormat format = fitting(maxCnt_);
+    if (format.sampleRate - period > kWrapTolerance)
+      format = {period, 0, 0, false};
+    format.detected = true;
+    format_ = format;
+    maxCnt_ = smpCnt;
+    return;
+  }
+  if (smpCnt > maxCnt_)
+    maxCnt_ = smpCnt;
+  // Counts beyond the rate: assumed, or the stream changed its rate
+  if (smpCnt >= format_.sampleRate)
+    format_ = fitting(smpCnt);
+}
+
+uint64_t SampleClock::timestamp(uint16_t smpCnt, bool synchronised,
+                                uint64_t arrivalUs) {
+  uint32_t previousRate = format_.sampleRate;
+  detect(smpCnt);
+  uint32_t rate = format_.sampleRate;
+
+  // Sample periods since the previous sample; none if it came late
+  uint64_t advance = 0;
+  if (started_) {
+    uint32_t delta = (smpCnt + rate - lastCnt_ % rate) % rate;
+    if (delta <= rate / 2) {
+      advance = delta;
+      if (delta > 1)
+        lost_ += delta - 1;
+    }
+  }
+
+  bool anchor = !started_ || synchronised_ || rate != previousRate;
+  started_ = true;
+  lastCnt_ = smpCnt;
+  synchronised_ = synchronised;
+
+  uint64_t offsetUs = uint64_t{smpCnt} * kUsPerSecond / rate;
+  if (synchronised) {
+    if (arrivalUs < offsetUs)
+      return arrivalUs;
+    // Network delays are far below half a second
+    uint64_t second = (arrivalUs - offsetUs + kUsPerSecond / 2) / kUsPerSecond;
+    return second * kUsPerSecond + offsetUs;
+  }
+
+  if (anchor) {
+    anchorUs_ = arrivalUs;
+    samples_ = 0;
+  } else {
+    samples_ += advance;
+  }
+  uint64_t time = anchorUs_ + samples_ * kUsPerSecond / rate;
+  uint64_t drift = time > arrivalUs ? time - arrivalUs : arrivalUs - time;
+  if (drift > kMaxDriftUs) {
+    anchorUs_ = arrivalUs;
+    samples_ = 0;
+    time = arrivalUs;
+  }
+  return time;
+}
+
+void SampleClock::reset() { *this = SampleClock(); }
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+// Nominal sampling of a stream, as detected from its smpCnt
+struct SVStreamFormat {
+  uint32_t sampleRate = 4000; // smpCnt wraps here, once per second
+  uint16_t samplesPerCycle = 80;
+  uint16_t nominalFrequency = 50; // Hz, 0 = not a 9-2LE rate
+  bool detected = false;          // false = assumed until smpCnt wraps
+};
+
+/**
+ * @brief Sample times of one SV stream from smpCnt and smpSynch
+ *
+ * smpCnt counts samples within the second and wraps to 0 at the sample
+ * rate, so the rate is where it wraps: 4000 or 4800 for 80 samples per
+ * cycle at 50 or 60 Hz, 12800 or 15360 for 256. Until the first wrap the
+ * smallest rate the counts fit is assumed.
+ *
+ * A synchronised merging unit restarts smpCnt at the top of each second,
+ * so a sample's time is that second, taken from the arrival time, plus
+ * smpCnt sample periods. An unsynchronised one counts freely; its
+ * samples are spaced evenly from the first arrival and re-anchored when
+ * they drift more than kMaxDriftUs from the arrival times.
+ */
+class SampleClock {
+public:
+  static constexpr uint64_t kMaxDriftUs = 100000;
+
+  /**
+   * @brief Time of a sample in microseconds since the epoch
+   * @param arrivalUs When the sample was received, same clock
+   */
+  uint64_t timestamp(uint16_t smpCnt, bool synchronised, uint64_t arrivalUs);
+
+  const SVStreamFormat &format() const { return format_; }
+
+  // Samples skipped by smpCnt since the first one
+  uint64_t lostSamples() const { return lost_; }
+
+  void reset();
+
+private:
+  void detect(uint16_t smpCnt);
+
+  SVStreamFormat format_;
+  bool started_ = false;
+  uint16_t lastCnt_ = 0;
+  uint16_t maxCnt_ = 0; // Highest smpCnt since the last wrap
+  bool synchronised_ = false;
+  uint64_t anchorUs_ = 0; // Unsynchronised: time of samples_ = 0
+  uint64_t samples_ = 0;  // Unsynchronised: sample periods since anchor
+  uint64_t lost_ = 0;
+};
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,109 @@
+#include "sample_ring.h"
+#include <algorithm>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+namespace {
+constexpr auto kRelaxed = std::memory_order_relaxed;
+} // namespace
+
+SampleRing::SampleRing(size_t capacity) {
+  size_t size = 1;
+  while (size < capacity)
+    size <<= 1;
+  mask_ = size - 1;
+  timestamps_ = allocate<uint64_t>(size);
+  smpCnts_ = allocate<uint16_t>(size);
+  synchronised_ = allocate<uint8_t>(size);
+  for (int channel = 0; channel < kChannels; ++channel) {
+    values_[channel] = allocate<int32_t>(size);
+    quality_[channel] = allocate<uint32_t>(size);
+  }
+}
+
+void SampleRing::push(const SVSample &sample) {
+  uint64_t index = written_.load(std::memory_order_relaxed);
+  // Readers that see any of the stores below also see written_ == index,
+  // which tells them this slot's older sample is being replaced
+  std::atomic_thread_fence(std::memory_order_release);
+
+  size_t slot = index & mask_;
+  timestamps_[slot].store(sample.timestamp, kRelaxed);
+  smpCnts_[slot].store(sample.smpCnt, kRelaxed);
+  synchronised_[slot].store(sample.synchronised, kRelaxed);
+  for (int channel = 0; channel < kChannels; ++channel) {
+    values_[channel][slot].store(sample.values[channel], kRelaxed);
+    quality_[channel][slot].store(sample.quality[channel], kRelaxed);
+  }
+  written_.store(index + 1, std::memory_order_release);
+}
+
+uint64_t SampleRing::first(uint64_t from, uint64_t end) const {
+  // The slot of index end - capacity may be being overwritten already
+  uint64_t oldest = end >= capacity() ? end - capacity() + 1 : 0;
+  return std::max(from, oldest);
+}
+
+uint64_t SampleRing::stillValid(uint64_t begin) const {
+  std::atomic_thread_fence(std::memory_order_acquire);
+  uint64_t now = written_.load(std::memory_order_relaxed);
+  uint64_t oldest = now >= capacity() ? now - capacity() + 1 : 0;
+  return std::max(begin, oldest);
+}
+
+uint64_t SampleRing::read(uint64_t from, uint64_t to,
+                          std::vector<SVSample> &out) const {
+  uint64_t end = std::min(to, written());
+  uint64_t begin = first(from, end);
+  out.clear();
+  if (begin >= end)
+    return begin;
+
+  out.resize(end - begin);
+  for (uint64_t index = begin; index < end; ++index) {
+    size_t slot = index & mask_;
+    SVSample &sample = out[index - begin];
+    sample.timestamp = timestamps_[slot].load(kRelaxed);
+    sample.smpCnt = smpCnts_[slot].load(kRelaxed);
+    sample.synchronised = synchronised_[slot].load(kRelaxed) != 0;
+    for (int channel = 0; channel < kChannels; ++channel) {
+      sample.values[channel] = values_[channel][slot].load(kRelaxed);
+      sample.quality[channel] = quality_[channel][slot].load(kRelaxed);
+    }
+  }
+
+  uint64_t valid = std::min(stillValid(begin), end);
+  out.erase(out.begin(),
+            out.begin() + static_cast<std::ptrdiff_t>(valid - begin));
+  return valid;
+}
+
+uint64_t SampleRing::readChannel(int channel, uint64_t from, uint64_t to,
+                                 std::vector<int32_t> &out) const {
+  uint64_t end = std::min(to, written());
+  uint64_t begin = first(from, end);
+  out.clear();
+  if (begin >= end || channel < 0 || channel >= kChannels)
+    return begin;
+
+  // Two contiguous runs at most
+  const std::atomic<int32_t> *values = values_[channel].get();
+  out.resize(end - begin);
+  size_t slot = begin & mask_;
+  size_t run = std::min<uint64_t>(end - begin, capacity() - slot);
+  for (size_t i = 0; i < run; ++i)
+    out[i] = values[slot + i].load(kRelaxed);
+  for (size_t i = run; i < out.size(); ++i)
+    out[i] = values[i - run].load(kRelaxed);
+
+  uint64_t valid = std::min(stillValid(begin), end);
+  out.erase(out.begin(),
+            out.begin() + static_cast<std::ptrdiff_t>(valid - begin));
+  return valid;
+}
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "sv_sample.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+/**
+ * @brief Single-producer ring of SV samples, one array per field
+ *
+ * Timestamps, smpCnt and every channel's values and qualities live in
+ * separate cache-line aligned arrays, so readers of one channel touch
+ * only that channel's memory. The receive thread pushes without locks or
+ * waiting; readers never block it either.
+ *
+ * Readers copy optimistically and check afterwards which samples the
+ * producer may have overwritten meanwhile, as a seqlock would; those are
+ * dropped from the front of the copy. The slots are relaxed atomics, so
+ * a copy racing the producer is torn at worst, never undefined, and the
+ * check discards it. Samples are addressed by a 64-bit index that never
+ * wraps, so a reader can resume where it stopped.
+ */
+class SampleRing {
+public:
+  static constexpr size_t kCacheLine = 64;
+
+  // Capacity rounded up to a power of two
+  explicit SampleRing(size_t capacity);
+
+  size_t capacity() const { return mask_ + 1; }
+
+  /**
+   * @brief Append a sample; producer thread only
+   */
+  void push(const SVSample &sample);
+
+  // Samples pushed so far; the next one gets this index
+  uint64_t written() const {
+    return written_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Copy the samples with index in [from, to) still held
+   * @param out Replaced by the copies, oldest first
+   * @return Index of out[0]; later than @p from if those were overwritten
+   */
+  uint64_t read(uint64_t from, uint64_t to, std::vector<SVSample> &out) const;
+
+  /**
+   * @brief As read(), one channel's values only
+   */
+  uint64_t readChannel(int channel, uint64_t from, uint64_t to,
+                       std::vector<int32_t> &out) const;
+
+private:
+  struct AlignedDelete {
+    void operator()(void *p) const {
+      ::operator delete[](p, std::align_val_t(kCacheLine));
+    }
+  };
+  template <typename T>
+  using Array = std::unique_ptr<std::atomic<T>[], AlignedDelete>;
+
+  template <typename T> static Array<T> allocate(size_t count) {
+    return Array<T>(new (std::align_val_t(kCacheLine))
+                        std::atomic<T>[count]());
+  }
+
+  // First index of [from, to) that may be copied now
+  uint64_t first(uint64_t from, uint64_t end) const;
+  // First index not overwritten while copying began at @p begin
+  uint64_t stillValid(uint64_t begin) const;
+
+  size_t mask_;
+  Array<uint64_t> timestamps_;
+  Array<uint16_t> smpCnts_;
+  Array<uint8_t> synchronised_;
+  Array<int32_t> values_[kChannels];
+  Array<uint32_t> quality_[kChannels];
+
+  alignas(kCacheLine) std::atomic<uint64_t> written_{0};
+};
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,164 @@
+#include "sample_segment.h"
+#include "core/logger.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+namespace {
+
+constexpr char kMagic[8] = {'G', 'W', 'S', 'V', 'S', 'E', 'G', '\0'};
+constexpr uint32_t kVersion = 1;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t recordSize; // sizeof(SVSample)
+  uint64_t firstIndex;
+  uint64_t capacity;
+  std::atomic<uint64_t> count;
+  uint8_t reserved[24];
+};
+
+static_assert(sizeof(Header) == 64, "64-byte file header");
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "The sample count is shared through the mapping");
+
+} // namespace
+
+std::shared_ptr<SampleSegment>
+SampleSegment::create(const std::string &path, uint64_t firstIndex,
+                      size_t capacity) {
+  std::shared_ptr<SampleSegment> segment(
+      new SampleSegment(path, firstIndex, capacity));
+  if (!segment->map()) {
+    segment->retire();
+    return nullptr;
+  }
+  return segment;
+}
+
+SampleSegment::SampleSegment(const std::string &path, uint64_t firstIndex,
+                             size_t capacity)
+    : path_(path), firstIndex_(firstIndex), capacity_(capacity) {}
+
+uint64_t SampleSegment::fileSize() const {
+  return sizeof(Header) + uint64_t{capacity_} * sizeof(SVSample);
+}
+
+bool SampleSegment::map() {
+  const uint64_t size = fileSize();
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path_.c_str(), GENERIC_READ | GENERIC_WRITE,
+                            FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                            CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    LOG_ERROR("SV segment {}: cannot create file", path_);
+    return false;
+  }
+  file_ = file;
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE,
+                                      static_cast<DWORD>(size >> 32),
+                                      static_cast<DWORD>(size), NULL);
+  if (!mapping) {
+    LOG_ERROR("SV segment {}: cannot size to {} bytes", path_, size);
+    return false;
+  }
+  mappingHandle_ = mapping;
+  mapping_ = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0);
+  if (!mapping_) {
+    LOG_ERROR("SV segment {}: mapping failed", path_);
+    return false;
+  }
+#else
+  fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0) {
+    LOG_ERROR("SV segment {}: {}", path_, std::strerror(errno));
+    return false;
+  }
+#ifdef __linux__
+  // Blocks reserved now: a full disk fails here, not as SIGBUS on a store
+  int error = ::posix_fallocate(fd_, 0, static_cast<off_t>(size));
+#else
+  int error = ::ftruncate(fd_, static_cast<off_t>(size)) == 0 ? 0 : errno;
+#endif
+  if (error != 0) {
+    LOG_ERROR("SV segment {}: cannot size to {} bytes: {}", path_, size,
+              std::strerror(error));
+    return false;
+  }
+  int flags = MAP_SHARED;
+#ifdef __linux__
+  flags |= MAP_POPULATE; // No page faults on the appending thread
+#endif
+  void *addr = ::mmap(nullptr, static_cast<size_t>(size),
+                      PROT_READ | PROT_WRITE, flags, fd_, 0);
+  if (addr == MAP_FAILED) {
+    LOG_ERROR("SV segment {}: mmap failed: {}", path_, std::strerror(errno));
+    return false;
+  }
+  mapping_ = addr;
+#endif
+
+  Header *header = new (mapping_) Header();
+  std::memcpy(header->magic, kMagic, sizeof(kMagic));
+  header->version = kVersion;
+  header->recordSize = sizeof(SVSample);
+  header->firstIndex = firstIndex_;
+  header->capacity = capacity_;
+  count_ = &header->count;
+  samples_ = reinterpret_cast<SVSample *>(header + 1);
+  return true;
+}
+
+SampleSegment::~SampleSegment() {
+#ifdef _WIN32
+  if (mapping_)
+    UnmapViewOfFile(mapping_);
+  if (mappingHandle_)
+    CloseHandle(static_cast<HANDLE>(mappingHandle_));
+  if (file_)
+    CloseHandle(static_cast<HANDLE>(file_));
+#else
+  if (mapping_)
+    ::munmap(mapping_, static_cast<size_t>(fileSize()));
+  if (fd_ >= 0)
+    ::close(fd_);
+#endif
+  if (retired_.load(std::memory_order_relaxed))
+    std::remove(path_.c_str());
+}
+
+uint64_t SampleSegment::lowerBound(uint64_t timestampUs) const {
+  size_t lo = 0;
+  size_t hi = size();
+  if (!ordered_.load(std::memory_order_relaxed)) {
+    while (lo < hi && samples_[lo].timestamp < timestampUs)
+      ++lo;
+    return firstIndex_ + lo;
+  }
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (samples_[mid].timestamp < timestampUs)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return firstIndex_ + lo;
+}
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
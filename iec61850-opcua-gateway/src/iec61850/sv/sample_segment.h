@@ -0,0 +1,118 @@
+#pragma once
+
+#include "sv_sample.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+/**
+ * @brief Fixed-size file of SV samples, memory mapped for writing
+ *
+ * The file is a 64-byte header followed by room for capacity samples,
+ * stored as SVSample records in host order; it is sized once, so
+ * appending is a copy into the mapping and never a system call. One
+ * thread appends; any thread may read the samples below size(), which
+ * is published with release order. The header's count follows size(),
+ * so the file describes itself after a crash as far as the page cache
+ * got.
+ *
+ * Samples are addressed by a stream-wide index that continues from
+ * segment to segment. A retired segment deletes its file once the last
+ * reference to it is gone, so readers still cutting a window out of it
+ * keep it alive.
+ */
+class SampleSegment {
+public:
+  static_assert(std::is_trivially_copyable<SVSample>::value,
+                "SV samples are stored as they are in memory");
+
+  /**
+   * @brief Create, size and map @p path, replacing any file there
+   * @param firstIndex Stream index of the segment's first sample
+   * @return nullptr on failure, logged
+   */
+  static std::shared_ptr<SampleSegment>
+  create(const std::string &path, uint64_t firstIndex, size_t capacity);
+
+  ~SampleSegment();
+
+  SampleSegment(const SampleSegment &) = delete;
+  SampleSegment &operator=(const SampleSegment &) = delete;
+
+  /**
+   * @brief Append a sample; writer only
+   * @return false when the segment is full
+   */
+  bool append(const SVSample &sample) {
+    uint64_t count = count_->load(std::memory_order_relaxed);
+    if (count == capacity_)
+      return false;
+    if (count && sample.timestamp < samples_[count - 1].timestamp)
+      ordered_.store(false, std::memory_order_relaxed);
+    samples_[count] = sample;
+    count_->store(count + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t capacity() const { return capacity_; }
+  size_t size() const { return count_->load(std::memory_order_acquire); }
+  bool full() const { return size() == capacity_; }
+
+  uint64_t firstIndex() const { return firstIndex_; }
+  // Index after the last sample appended so far
+  uint64_t endIndex() const { return firstIndex_ + size(); }
+
+  // Sample of stream index @p index, firstIndex() <= index < endIndex()
+  const SVSample &at(uint64_t index) const {
+    return samples_[index - firstIndex_];
+  }
+
+  /**
+   * @brief Index of the first sample at or after @p timestampUs, from
+   * the samples appended so far; endIndex() if there is none
+   *
+   * A binary search while sample times have only risen, a scan once a
+   * sample went back in time.
+   */
+  uint64_t lowerBound(uint64_t timestampUs) const;
+
+  const std::string &path() const { return path_; }
+  // Bytes the file takes on disk once full
+  uint64_t fileSize() const;
+
+  // Delete the file with the last reference
+  void retire() { retired_.store(true, std::memory_order_relaxed); }
+
+private:
+  SampleSegment(const std::string &path, uint64_t firstIndex,
+                size_t capacity);
+  bool map();
+
+  std::string path_;
+  uint64_t firstIndex_;
+  size_t capacity_;
+  std::atomic<bool> retired_{false};
+  // No sample older than the one before it; published by count_
+  std::atomic<bool> ordered_{true};
+
+  void *mapping_ = nullptr;
+  std::atomic<uint64_t> *count_ = nullptr; // In the header
+  SVSample *samples_ = nullptr;
+#ifdef _WIN32
+  void *file_ = nullptr;
+  void *mappingHandle_ = nullptr;
+#else
+  int fd_ = -1;
+#endif
+};
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,419 @@
+#include "sv_analytics.h"
+#include "core/logger.h"
+#include "core/metrics.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+namespace {
+
+constexpr double kDegrees = 180.0 / 3.14159265358979323846;
+constexpr std::array<const char *, 4> kPhases = {"phsA", "phsB", "phsC",
+                                                 "neut"};
+
+std::vector<std::string>
+publishedReferences(const core::SVStreamConfig &config) {
+  std::vector<std::string> refs;
+  refs.push_back(config.reference + ".Hz");
+  for (const char *quantity : {".A.", ".PhV."}) {
+    for (const char *phase : kPhases) {
+      std::string base = config.reference + quantity + phase;
+      refs.push_back(base);
+      refs.push_back(base + ".mag");
+      refs.push_back(base + ".ang");
+    }
+  }
+  if (!config.sequenceReference.empty()) {
+    for (const char *quantity : {".SeqA.", ".SeqV."}) {
+      for (const char *component : {"c1", "c2", "c3"})
+        refs.push_back(config.sequenceReference + quantity + component);
+    }
+  }
+  return refs;
+}
+
+// Values of publishedReferences(), in its order
+void publishedValues(const PhasorResult &result, bool sequence,
+                     std::vector<float> &out) {
+  out.clear();
+  out.push_back(static_cast<float>(result.frequency));
+  for (int ch = 0; ch < kChannels; ++ch) {
+    out.push_back(static_cast<float>(result.rms[ch]));
+    out.push_back(static_cast<float>(result.phasors[ch].magnitude));
+    out.push_back(static_cast<float>(result.phasors[ch].angle * kDegrees));
+  }
+  if (!sequence)
+    return;
+  for (const SequenceComponents *seq : {&result.current, &result.voltage}) {
+    out.push_back(static_cast<float>(seq->positive.magnitude));
+    out.push_back(static_cast<float>(seq->negative.magnitude));
+    out.push_back(static_cast<float>(seq->zero.magnitude));
+  }
+}
+
+} // namespace
+
+SVAnalytics::SVAnalytics(const core::SVConfig &config) : config_(config) {
+  if (config_.routable.enabled)
+    receiver_ = std::make_unique<SVStreamReceiver>(config_.routable);
+  else
+    receiver_ = std::make_unique<SVStreamReceiver>(config_.interfaceName);
+
+  for (const auto &streamConfig : config_.streams) {
+    auto stream = std::make_unique<Stream>();
+    stream->config = streamConfig;
+    stream->index = streams_.size();
+    stream->references = publishedReferences(streamConfig);
+    if (config_.harmonics.enabled)
+      stream->ring = std::make_unique<SampleRing>(kHarmonicRing);
+    byAppId_[streamConfig.appId].push_back(stream.get());
+    streams_.push_back(std::move(stream));
+  }
+
+  if (config_.merge.enabled) {
+    const auto &wanted = config_.merge.streams;
+    std::vector<std::string> names;
+    for (auto &stream : streams_) {
+      std::string name =
+          streamName(stream->config.appId, stream->config.svID);
+      if (!wanted.empty() &&
+          std::find(wanted.begin(), wanted.end(), name) == wanted.end())
+        continue;
+      if (names.size() == SVStreamMerger::kMaxStreams)
+        break;
+      stream->mergeIndex = static_cast<int>(names.size());
+      names.push_back(name);
+    }
+    if (names.size() < 2) {
+      LOG_WARN("SV merge needs two streams or more, found {}", names.size());
+      for (auto &stream : streams_)
+        stream->mergeIndex = -1;
+    } else {
+      merger_ =
+          std::make_unique<SVStreamMerger>(names, config_.merge.maxSkewUs);
+      merger_->setFrameSink(
+          [this](const MergedFrame &frame) { addMergedFrame(frame); });
+    }
+  }
+}
+
+SVAnalytics::~SVAnalytics() { stop(); }
+
+void SVAnalytics::setValueSink(ValueSink sink) { sink_ = std::move(sink); }
+
+void SVAnalytics::setHarmonicSink(HarmonicSink sink) {
+  harmonicSink_ = std::move(sink);
+}
+
+void SVAnalytics::setHealthSink(HealthSink sink) {
+  healthSink_ = std::move(sink);
+}
+
+void SVAnalytics::setRecorder(std::shared_ptr<SVRecorder> recorder) {
+  recorder_ = std::move(recorder);
+}
+
+bool SVAnalytics::start() {
+  if (running_)
+    return true;
+  for (const auto &entry : byAppId_) {
+    const std::vector<Stream *> &streams = entry.second;
+    receiver_->addStream(entry.first, [this, &streams](SVSubscriber_ASDU a) {
+      onASDU(streams, a);
+    });
+  }
+  if (!receiver_->start())
+    return false;
+
+  if (config_.harmonics.enabled) {
+    workers_ = std::make_unique<core::ThreadPool>(
+        static_cast<size_t>(std::max(config_.harmonics.workers, 1)));
+  }
+  running_ = true;
+  publisher_ = std::thread(&SVAnalytics::publishLoop, this);
+  LOG_INFO("SV analytics started for {} stream(s) on {}", streams_.size(),
+           receiver_->getName());
+  return true;
+}
+
+void SVAnalytics::stop() {
+  if (!running_)
+    return;
+  {
+    std::lock_guard<std::mutex> lock(wakeMutex_);
+    running_ = false;
+  }
+  wake_.notify_all();
+  if (publisher_.joinable())
+    publisher_.join();
+  // Finishes the windows already queued
+  workers_.reset();
+  receiver_->stop();
+}
+
+void SVAnalytics::onASDU(const std::vector<Stream *> &streams,
+                         SVSubscriber_ASDU asdu) {
+  const char *svId = SVSubscriber_ASDU_getSvId(asdu);
+  for (Stream *stream : streams) {
+    const std::string &wanted = stream->config.svID;
+    if (!wanted.empty() && (!svId || wanted != svId))
+      continue;
+
+    // Only this thread writes the counters
+    uint64_t count = stream->samples.load(std::memory_order_relaxed);
+    bool timed = count % kCostSampling == 0;
+    auto begin = timed ? std::chrono::steady_clock::now()
+                       : std::chrono::steady_clock::time_point();
+
+    SVSample sample;
+    uint64_t arrivalUs = core::nowUs();
+    if (!decode92LE(asdu, sample)) {
+      stream->health.recordMalformed(arrivalUs);
+      continue;
+    }
+    addSample(*stream, sample, arrivalUs);
+    stream->health.record({arrivalUs, sample.smpCnt, sample.synchronised,
+                           SVSubscriber_ASDU_getConfRev(asdu)},
+                          stream->clock.format().sampleRate);
+    stream->samples.store(count + 1, std::memory_order_relaxed);
+
+    if (timed) {
+      auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - begin)
+                    .count();
+      stream->costNs.store(stream->costNs.load(std::memory_order_relaxed) +
+                               static_cast<uint64_t>(ns),
+                           std::memory_order_relaxed);
+      stream->costSamples.store(
+          stream->costSamples.load(std::memory_order_relaxed) + 1,
+          std::memory_order_relaxed);
+    }
+    return;
+  }
+}
+
+void SVAnalytics::addSample(Stream &stream, SVSample &sample,
+                            uint64_t arrivalUs) {
+  sample.timestamp =
+      stream.clock.timestamp(sample.smpCnt, sample.synchronised, arrivalUs);
+  stream.lost.store(stream.clock.lostSamples(), std::memory_order_relaxed);
+
+  // Only this thread writes stream.format
+  const SVStreamFormat &format = stream.clock.format();
+  if (format.sampleRate != stream.format.sampleRate ||
+      format.samplesPerCycle != stream.format.samplesPerCycle ||
+      format.detected != stream.format.detected) {
+    // The window follows the detected rate
+    if (format.sampleRate != stream.format.sampleRate ||
+        format.samplesPerCycle != stream.format.samplesPerCycle)
+      stream.estimator = PhasorEstimator(format);
+    std::lock_guard<std::mutex> lock(stream.mutex);
+    stream.format = format;
+    if (stream.ring)
+      stream.formatIndex = stream.ring->written();
+  }
+  if (stream.ring)
+    stream.ring->push(sample);
+  if (recorder_)
+    recorder_->record(stream.index, sample, format);
+  if (merger_ && stream.mergeIndex >= 0)
+    merger_->add(static_cast<size_t>(stream.mergeIndex), sample, format,
+                 arrivalUs);
+
+  if (!stream.estimator.add(sample))
+    return;
+  PhasorResult result = stream.estimator.result();
+  std::lock_guard<std::mutex> lock(stream.mutex);
+  stream.latest = result;
+  stream.cycles++;
+}
+
+void SVAnalytics::publishLoop() {
+  auto interval = std::chrono::milliseconds(
+      config_.publishIntervalMs > 0 ? config_.publishIntervalMs : 100);
+  std::vector<uint64_t> published(streams_.size(), 0);
+  auto nextHealth = std::chrono::steady_clock::now() + kHealthInterval;
+
+  std::unique_lock<std::mutex> lock(wakeMutex_);
+  while (running_) {
+    wake_.wait_for(lock, interval, [this] { return !running_; });
+    if (!running_)
+      break;
+    auto now = std::chrono::steady_clock::now();
+    bool health = healthSink_ && now >= nextHealth;
+    if (health)
+      nextHealth = now + kHealthInterval;
+    if (merger_) {
+      merger_->poll(core::nowUs());
+      publishDifferential();
+    }
+    for (size_t i = 0; i < streams_.size(); ++i) {
+      publish(*streams_[i], published[i]);
+      if (workers_)
+        scheduleHarmonics(*streams_[i]);
+      if (health)
+        healthSink_(streams_[i]->config, streams_[i]->health.snapshot());
+    }
+  }
+}
+
+void SVAnalytics::publish(Stream &stream, uint64_t &publishedCycles) {
+  PhasorResult result;
+  {
+    std::lock_guard<std::mutex> lock(stream.mutex);
+    // Nothing new since the last interval
+    if (stream.cycles == publishedCycles)
+      return;
+    publishedCycles = stream.cycles;
+    result = stream.latest;
+  }
+  if (!sink_ || !result.valid || stream.config.reference.empty())
+    return;
+
+  std::vector<float> values;
+  publishedValues(result, !stream.config.sequenceReference.empty(), values);
+  MmsValue *value = MmsValue_newFloat(0.0f);
+  for (size_t i = 0; i < values.size(); ++i) {
+    // Frequency is unknown until two cycles are in
+    if (i == 0 && result.frequency <= 0.0)
+      continue;
+    MmsValue_setFloat(value, values[i]);
+    sink_(stream.references[i], value);
+  }
+  MmsValue_delete(value);
+}
+
+void SVAnalytics::scheduleHarmonics(Stream &stream) {
+  if (!stream.ring || stream.analysing)
+    return;
+  SVStreamFormat format;
+  uint64_t formatIndex;
+  {
+    std::lock_guard<std::mutex> lock(stream.mutex);
+    format = stream.format;
+    formatIndex = stream.formatIndex;
+  }
+
+  HarmonicAnalyzer analyzer(format, config_.harmonics.maxOrder);
+  uint64_t size = analyzer.windowSize();
+  uint64_t written = stream.ring->written();
+  // A window never spans a change of rate
+  uint64_t start = std::max(stream.nextWindow, formatIndex);
+  if (written < start + size)
+    return;
+
+  // Behind by more than a window: go on from the latest whole one
+  uint64_t windows = (written - start) / size;
+  if (windows > 1) {
+    start += (windows - 1) * size;
+    std::lock_guard<std::mutex> lock(stream.mutex);
+    stream.skippedWindows += windows - 1;
+  }
+  stream.nextWindow = start + size;
+  stream.analysing = true;
+  workers_->enqueue([this, &stream, analyzer, start] {
+    analyzeWindow(stream, analyzer, start);
+  });
+}
+
+void SVAnalytics::analyzeWindow(Stream &stream,
+                                const HarmonicAnalyzer &analyzer,
+                                uint64_t start) {
+  std::vector<SVSample> window;
+  uint64_t first =
+      stream.ring->read(start, start + analyzer.windowSize(), window);
+  HarmonicResult result;
+  if (first == start)
+    result = analyzer.analyze(window);
+
+  {
+    std::lock_guard<std::mutex> lock(stream.mutex);
+    if (result.valid) {
+      stream.harmonics = result;
+      stream.harmonicWindows++;
+    } else {
+      // Overwritten before a worker got to it
+      stream.skippedWindows++;
+    }
+  }
+  if (result.valid && harmonicSink_)
+    harmonicSink_(stream.config, result);
+  stream.analysing = false;
+}
+
+void SVAnalytics::addMergedFrame(const MergedFrame &frame) {
+  uint32_t all = frame.streams >= SVStreamMerger::kMaxStreams
+                     ? UINT32_MAX
+                     : (uint32_t{1} << frame.streams) - 1;
+  // A stream left out would show as differential current
+  if (frame.present != all)
+    return;
+  int64_t sums[kCurrentChannels] = {};
+  for (size_t i = 0; i < frame.streams; ++i) {
+    for (int ch = 0; ch < kCurrentChannels; ++ch)
+      sums[ch] += frame.samples[i].values[ch];
+  }
+  for (int ch = 0; ch < kCurrentChannels; ++ch) {
+    double sum = static_cast<double>(sums[ch]);
+    differentialSquares_[ch] += sum * sum;
+  }
+  differentialFrames_++;
+}
+
+void SVAnalytics::publishDifferential() {
+  if (!differentialFrames_)
+    return;
+  std::lock_guard<std::mutex> lock(differentialMutex_);
+  for (int ch = 0; ch < kCurrentChannels; ++ch) {
+    differential_.rms[ch] =
+        std::sqrt(differentialSquares_[ch] /
+                  static_cast<double>(differentialFrames_)) *
+        kCurrentScale;
+    differentialSquares_[ch] = 0.0;
+  }
+  differential_.frames += differentialFrames_;
+  differentialFrames_ = 0;
+}
+
+MergeDifferential SVAnalytics::getDifferential() const {
+  std::lock_guard<std::mutex> lock(differentialMutex_);
+  return differential_;
+}
+
+std::vector<SVStreamStats> SVAnalytics::getStats() const {
+  std::vector<SVStreamStats> stats;
+  for (const auto &stream : streams_) {
+    SVStreamStats s;
+    s.appId = stream->config.appId;
+    s.svID = stream->config.svID;
+    s.reference = stream->config.reference;
+    s.samples = stream->samples.load(std::memory_order_relaxed);
+    s.lostSamples = stream->lost.load(std::memory_order_relaxed);
+    uint64_t timed = stream->costSamples.load(std::memory_order_relaxed);
+    if (timed)
+      s.nsPerSample =
+          static_cast<double>(stream->costNs.load(std::memory_order_relaxed)) /
+          static_cast<double>(timed);
+    s.health = stream->health.snapshot();
+    {
+      std::lock_guard<std::mutex> lock(stream->mutex);
+      s.format = stream->format;
+      s.latest = stream->latest;
+      s.cycles = stream->cycles;
+      s.harmonics = stream->harmonics;
+      s.harmonicWindows = stream->harmonicWindows;
+      s.skippedWindows = stream->skippedWindows;
+    }
+    stats.push_back(std::move(s));
+  }
+  return stats;
+}
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,194 @@
+#pragma once
+
+#include "core/config_parser.h"
+#include "core/thread_pool.h"
+#include "harmonic_analyzer.h"
+#include "phasor_estimator.h"
+#include "sample_clock.h"
+#include "sample_ring.h"
+#include "sv_recorder.h"
+#include "sv_stream_health.h"
+#include "sv_stream_merger.h"
+#include "sv_stream_receiver.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <libiec61850/mms_value.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+struct SVStreamStats {
+  uint16_t appId = 0;
+  std::string svID;
+  std::string reference;
+  SVStreamFormat format;
+  PhasorResult latest; // Last completed cycle
+  uint64_t samples = 0;
+  uint64_t lostSamples = 0;
+  uint64_t cycles = 0;
+  double nsPerSample = 0.0; // Decode, timing and estimation, sampled
+  HarmonicResult harmonics; // Last analysed window
+  uint64_t harmonicWindows = 0;
+  uint64_t skippedWindows = 0; // Overrun or analysis behind
+  SVHealthSnapshot health;
+};
+
+// Sum of the merged streams' currents: the differential current of a zone
+// whose CTs all point into it
+struct MergeDifferential {
+  double rms[kCurrentChannels] = {}; // A, last interval with frames
+  uint64_t frames = 0;               // Complete frames summed so far
+};
+
+/**
+ * @brief Streaming phasors, RMS, sequence components and frequency of
+ * the configured 9-2LE streams
+ *
+ * Each stream is decoded, timed by a SampleClock and fed to a
+ * PhasorEstimator on the receive thread. A publisher thread writes the
+ * latest complete cycle of every stream to the value sink each publish
+ * interval, as floats under the stream's MMXU:
+ *
+ *   Hz                      frequency
+ *   A.phsA .. A.neut        true RMS, PhV.phsA .. PhV.neut likewise
+ *   A.phsA.mag, .ang        fundamental phasor, angle in degrees
+ *
+ * and, with a sequence reference, its MSQI: SeqA.c1, c2, c3 (positive,
+ * negative, zero) and SeqV.c1, c2, c3.
+ *
+ * With harmonics enabled the receive thread also pushes every sample
+ * into a SampleRing, which costs it a few stores and never a lock. Each
+ * publish interval, whole 10/12-cycle windows found in a ring are handed
+ * to a worker pool for a HarmonicAnalyzer; windows are consecutive, and
+ * skipped if the workers fall behind.
+ *
+ * With a recorder every timed sample is also appended to the stream's
+ * recording, on the receive thread.
+ *
+ * Every ASDU also goes through the stream's SVStreamHealth; its snapshot
+ * is in getStats() and handed to the health sink once a second.
+ *
+ * With merging enabled the timed samples of the merged streams are also
+ * handed to an SVStreamMerger, without a lock. The publisher thread polls
+ * it each publish interval and sums Ia .. In of every complete frame; the
+ * RMS of those sums over the interval is in getDifferential().
+ */
+class SVAnalytics {
+public:
+  // Called on the publisher thread; the value is only valid during the call
+  using ValueSink = std::function<void(const std::string &ref, MmsValue *)>;
+  // Called on a worker thread, one window of a stream at a time
+  using HarmonicSink = std::function<void(const core::SVStreamConfig &stream,
+                                          const HarmonicResult &result)>;
+  // Called on the publisher thread, every stream once a second
+  using HealthSink = std::function<void(const core::SVStreamConfig &stream,
+                                        const SVHealthSnapshot &health)>;
+
+  explicit SVAnalytics(const core::SVConfig &config);
+  ~SVAnalytics();
+
+  SVAnalytics(const SVAnalytics &) = delete;
+  SVAnalytics &operator=(const SVAnalytics &) = delete;
+
+  // Set before start()
+  void setValueSink(ValueSink sink);
+  void setHarmonicSink(HarmonicSink sink);
+  void setHealthSink(HealthSink sink);
+  // Stopped after this, if at all
+  void setRecorder(std::shared_ptr<SVRecorder> recorder);
+
+  bool start();
+  void stop();
+  bool isRunning() const { return running_; }
+
+  const SVStreamReceiver &getReceiver() const { return *receiver_; }
+  // nullptr unless merging is enabled for two streams or more
+  const SVStreamMerger *getMerger() const { return merger_.get(); }
+  MergeDifferential getDifferential() const;
+
+  std::vector<SVStreamStats> getStats() const;
+
+private:
+  // Sample cost is measured on one sample in this many
+  static constexpr uint64_t kCostSampling = 64;
+  // Two 12-cycle windows at 256 samples per cycle
+  static constexpr size_t kHarmonicRing = size_t{1} << 13;
+  static constexpr std::chrono::seconds kHealthInterval{1};
+
+  struct Stream {
+    core::SVStreamConfig config;
+    size_t index = 0;                    // In config_.streams
+    int mergeIndex = -1;                 // In merger_, -1 = not merged
+    std::vector<std::string> references; // In publishedValues() order
+
+    // Receive thread only
+    SampleClock clock;
+    PhasorEstimator estimator;
+    std::unique_ptr<SampleRing> ring; // Harmonics enabled only
+    SVStreamHealth health; // Snapshots from any thread
+
+    // Publisher thread only
+    uint64_t nextWindow = 0; // Ring index the next window starts at
+    // Set by the publisher, cleared by the worker analysing the window
+    std::atomic<bool> analysing{false};
+
+    std::atomic<uint64_t> samples{0};
+    std::atomic<uint64_t> lost{0};
+    std::atomic<uint64_t> costNs{0};
+    std::atomic<uint64_t> costSamples{0};
+
+    mutable std::mutex mutex; // Guards the fields below
+    SVStreamFormat format;
+    PhasorResult latest;
+    uint64_t cycles = 0;
+    uint64_t formatIndex = 0; // Ring index of the first sample at format
+    HarmonicResult harmonics;
+    uint64_t harmonicWindows = 0;
+    uint64_t skippedWindows = 0;
+  };
+
+  void onASDU(const std::vector<Stream *> &streams, SVSubscriber_ASDU asdu);
+  void addSample(Stream &stream, SVSample &sample, uint64_t arrivalUs);
+  void publishLoop();
+  void publish(Stream &stream, uint64_t &publishedCycles);
+  void addMergedFrame(const MergedFrame &frame);
+  void publishDifferential();
+  void scheduleHarmonics(Stream &stream);
+  void analyzeWindow(Stream &stream, const HarmonicAnalyzer &analyzer,
+                     uint64_t start);
+
+  core::SVConfig config_;
+  std::unique_ptr<SVStreamReceiver> receiver_;
+  std::vector<std::unique_ptr<Stream>> streams_;
+  std::map<uint16_t, std::vector<Stream *>> byAppId_;
+  ValueSink sink_;
+  HarmonicSink harmonicSink_;
+  HealthSink healthSink_;
+  std::shared_ptr<SVRecorder> recorder_;
+  std::unique_ptr<SVStreamMerger> merger_;
+  // Publisher thread only: sums of squares since the last interval
+  double differentialSquares_[kCurrentChannels] = {};
+  uint64_t differentialFrames_ = 0;
+  mutable std::mutex differentialMutex_; // Guards differential_
+  MergeDifferential differential_;
+  std::unique_ptr<core::ThreadPool> workers_;
+
+  std::atomic<bool> running_{false};
+  std::mutex wakeMutex_;
+  std::condition_variable wake_;
+  std::thread publisher_;
+};
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,447 @@
+#include "sv_recorder.h"
+#include "core/logger.h"
+#include "core/metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+namespace {
+
+constexpr const char *kSegmentExtension = ".svseg";
+
+uint64_t msToUs(int ms) {
+  return static_cast<uint64_t>(std::max(ms, 0)) * 1000;
+}
+
+// 20240131_235959_123, UTC
+std::string fileTime(uint64_t unixUs) {
+  std::time_t seconds = static_cast<std::time_t>(unixUs / 1000000);
+  std::tm utc{};
+  gmtime_r(&seconds, &utc);
+  char text[48];
+  std::snprintf(text, sizeof(text), "%04d%02d%02d_%02d%02d%02d_%03u",
+                utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday, utc.tm_hour,
+                utc.tm_min, utc.tm_sec,
+                static_cast<unsigned>(unixUs / 1000 % 1000));
+  return text;
+}
+
+// Segments holding samples of [fromUs, toUs], oldest first
+std::vector<std::shared_ptr<SampleSegment>>
+overlapping(const std::deque<std::shared_ptr<SampleSegment>> &segments,
+            uint64_t fromUs, uint64_t toUs) {
+  std::vector<std::shared_ptr<SampleSegment>> found;
+  for (const auto &segment : segments) {
+    size_t size = segment->size();
+    if (size == 0)
+      continue;
+    uint64_t first = segment->at(segment->firstIndex()).timestamp;
+    uint64_t last = segment->at(segment->firstIndex() + size - 1).timestamp;
+    if (last >= fromUs && first <= toUs)
+      found.push_back(segment);
+  }
+  return found;
+}
+
+} // namespace
+
+SVRecorder::SVRecorder(const core::SVConfig &config)
+    : config_(config.recording),
+      gooseTriggers_(config.recording.gooseTriggers.begin(),
+                     config.recording.gooseTriggers.end()) {
+  if (!parseComtradeFormat(config_.format, format_))
+    LOG_WARN("SV recording: unknown COMTRADE format {}, using {}",
+             config_.format, comtradeFormatName(format_));
+  std::filesystem::path directory(config_.directory);
+  segmentDirectory_ = (directory / "segments").string();
+  recordDirectory_ = (directory / "records").string();
+
+  for (const auto &streamConfig : config.streams) {
+    auto stream = std::make_unique<Stream>();
+    stream->name = streamName(streamConfig.appId, streamConfig.svID);
+    for (int ch = 0; ch < kChannels; ++ch) {
+      double threshold = ch < kCurrentChannels ? config_.currentThreshold
+                                               : config_.voltageThreshold;
+      if (threshold <= 0.0)
+        continue;
+      stream->thresholdCounts[ch] =
+          static_cast<int64_t>(std::ceil(threshold / channelScale(ch)));
+      stream->thresholds = true;
+    }
+    streams_.push_back(std::move(stream));
+  }
+}
+
+SVRecorder::~SVRecorder() { stop(); }
+
+bool SVRecorder::start() {
+  if (running_)
+    return true;
+  std::error_code error;
+  std::filesystem::create_directories(segmentDirectory_, error);
+  std::filesystem::create_directories(recordDirectory_, error);
+  if (error) {
+    LOG_ERROR("SV recording: cannot create {}: {}", config_.directory,
+              error.message());
+    return false;
+  }
+
+  // Segments of an earlier run are not part of this recording
+  size_t stale = 0;
+  for (const auto &entry :
+       std::filesystem::directory_iterator(segmentDirectory_, error)) {
+    if (entry.path().extension() == kSegmentExtension &&
+        std::filesystem::remove(entry.path(), error))
+      stale++;
+  }
+  if (stale)
+    LOG_INFO("SV recording: removed {} segment(s) of an earlier run", stale);
+
+  for (auto &stream : streams_)
+    prepareSegments(*stream);
+  running_ = true;
+  housekeeper_ = std::thread(&SVRecorder::housekeepLoop, this);
+  LOG_INFO("SV recording of {} stream(s) into {}, {} s segments, {} min "
+           "retention",
+           streams_.size(), config_.directory, config_.segmentSeconds,
+           config_.retentionMinutes);
+  return true;
+}
+
+void SVRecorder::stop() {
+  if (!running_)
+    return;
+  {
+    std::lock_guard<std::mutex> lock(wakeMutex_);
+    running_ = false;
+  }
+  wake_.notify_all();
+  if (housekeeper_.joinable())
+    housekeeper_.join();
+
+  std::vector<PendingTrigger> pending;
+  {
+    std::lock_guard<std::mutex> lock(triggersMutex_);
+    pending.swap(pending_);
+  }
+  for (const PendingTrigger &trigger : pending) {
+    RecordingInfo info = cut(trigger);
+    std::lock_guard<std::mutex> lock(triggersMutex_);
+    recordings_.push_back(info);
+    if (recordings_.size() > kRecordingHistory)
+      recordings_.pop_front();
+  }
+  LOG_INFO("SV recording stopped");
+}
+
+void SVRecorder::record(size_t index, const SVSample &sample,
+                        const SVStreamFormat &format) {
+  Stream &stream = *streams_[index];
+  if (format.sampleRate != stream.sampleRate.load(std::memory_order_relaxed))
+    stream.sampleRate.store(format.sampleRate, std::memory_order_relaxed);
+  if (format.nominalFrequency &&
+      format.nominalFrequency !=
+          stream.nominalFrequency.load(std::memory_order_relaxed))
+    stream.nominalFrequency.store(format.nominalFrequency,
+                                  std::memory_order_relaxed);
+
+  if (!stream.current || !stream.current->append(sample)) {
+    // Full: go on in the segment prepared ahead, if there is one yet
+    std::shared_ptr<SampleSegment> next;
+    {
+      std::lock_guard<std::mutex> lock(stream.mutex);
+      next = std::move(stream.spare);
+      if (next)
+        stream.segments.push_back(next);
+    }
+    if (!next || !next->append(sample)) {
+      stream.dropped.store(stream.dropped.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_relaxed);
+      return;
+    }
+    stream.current = std::move(next);
+  }
+  stream.samples.store(stream.samples.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
+  stream.newestUs.store(sample.timestamp, std::memory_order_release);
+
+  // Threshold trigger, re-armed after the post-trigger window
+  if (!stream.thresholds || sample.timestamp < stream.holdOffUntilUs)
+    return;
+  for (int ch = 0; ch < kChannels; ++ch) {
+    int64_t limit = stream.thresholdCounts[ch];
+    if (limit && std::abs(int64_t{sample.values[ch]}) > limit) {
+      char reason[64];
+      std::snprintf(reason, sizeof(reason), "%s above %g %s",
+                    kChannelNames[static_cast<size_t>(ch)],
+                    static_cast<double>(limit) * channelScale(ch),
+                    ch < kCurrentChannels ? "A" : "V");
+      addTrigger(index, reason, sample.timestamp);
+      stream.holdOffUntilUs = sample.timestamp + msToUs(config_.postTriggerMs);
+      break;
+    }
+  }
+}
+
+size_t SVRecorder::trigger(const std::string &reason,
+                           const std::string &stream, uint64_t timestampUs) {
+  if (timestampUs == 0)
+    timestampUs = core::nowUs();
+  size_t triggered = 0;
+  for (size_t i = 0; i < streams_.size(); ++i) {
+    if (!stream.empty() && streams_[i]->name != stream)
+      continue;
+    addTrigger(i, reason, timestampUs);
+    triggered++;
+  }
+  return triggered;
+}
+
+void SVRecorder::onGooseValue(const std::string &ref, const MmsValue *value) {
+  if (gooseTriggers_.find(ref) == gooseTriggers_.end() || !value ||
+      MmsValue_getType(value) != MMS_BOOLEAN)
+    return;
+  bool state = MmsValue_getBoolean(value);
+  {
+    std::lock_guard<std::mutex> lock(gooseMutex_);
+    bool &last = gooseStates_[ref];
+    bool rising = state && !last;
+    last = state;
+    if (!rising)
+      return;
+  }
+  trigger("GOOSE " + ref);
+}
+
+void SVRecorder::addTrigger(size_t stream, const std::string &reason,
+                            uint64_t timestampUs) {
+  LOG_INFO("SV recording: trigger on {}: {}", streams_[stream]->name,
+           reason);
+  std::lock_guard<std::mutex> lock(triggersMutex_);
+  pending_.push_back(
+      {stream, reason, timestampUs, std::chrono::steady_clock::now()});
+  triggers_++;
+}
+
+void SVRecorder::prepareSegments(Stream &stream) {
+  uint64_t newest = stream.newestUs.load(std::memory_order_acquire);
+  uint64_t retention = msToUs(std::max(config_.retentionMinutes, 1) * 60000);
+
+  std::unique_lock<std::mutex> lock(stream.mutex);
+  // Past the retention; the segment written to always stays
+  while (stream.segments.size() > 1) {
+    const auto &oldest = stream.segments.front();
+    size_t size = oldest->size();
+    uint64_t last =
+        size ? oldest->at(oldest->firstIndex() + size - 1).timestamp : 0;
+    if (last + retention >= newest)
+      break;
+    oldest->retire();
+    stream.segments.pop_front();
+  }
+  if (stream.spare)
+    return;
+
+  uint64_t firstIndex = 0;
+  if (!stream.segments.empty()) {
+    const auto &last = stream.segments.back();
+    firstIndex = last->firstIndex() + last->capacity();
+  }
+  char name[32];
+  std::snprintf(name, sizeof(name), "_%08llu",
+                static_cast<unsigned long long>(stream.files++));
+  std::string path = (std::filesystem::path(segmentDirectory_) /
+                      (stream.name + name + kSegmentExtension))
+                         .string();
+  size_t capacity = std::max<size_t>(
+      kMinSegment, size_t{stream.sampleRate.load(std::memory_order_relaxed)} *
+                       static_cast<size_t>(
+                           std::max(config_.segmentSeconds, 1)));
+  // Creating and sizing the file can take a while; not under the lock
+  lock.unlock();
+  std::shared_ptr<SampleSegment> spare =
+      SampleSegment::create(path, firstIndex, capacity);
+  lock.lock();
+  stream.spare = std::move(spare);
+}
+
+void SVRecorder::housekeepLoop() {
+  std::unique_lock<std::mutex> lock(wakeMutex_);
+  while (running_) {
+    wake_.wait_for(lock, std::chrono::milliseconds(100),
+                   [this] { return !running_; });
+    if (!running_)
+      break;
+    lock.unlock();
+
+    for (auto &stream : streams_)
+      prepareSegments(*stream);
+
+    // Triggers whose post-trigger window is in, or will not come
+    std::vector<PendingTrigger> due;
+    auto now = std::chrono::steady_clock::now();
+    auto post = std::chrono::milliseconds(config_.postTriggerMs);
+    {
+      std::lock_guard<std::mutex> triggersLock(triggersMutex_);
+      auto ready = [&](const PendingTrigger &t) {
+        const Stream &stream = *streams_[t.stream];
+        uint64_t end = t.timestampUs + msToUs(config_.postTriggerMs);
+        return stream.newestUs.load(std::memory_order_acquire) >= end ||
+               now >= t.added + post + kStall;
+      };
+      auto split = std::stable_partition(
+          pending_.begin(), pending_.end(),
+          [&](const PendingTrigger &t) { return !ready(t); });
+      due.assign(split, pending_.end());
+      pending_.erase(split, pending_.end());
+    }
+    for (const PendingTrigger &trigger : due) {
+      RecordingInfo info = cut(trigger);
+      std::lock_guard<std::mutex> triggersLock(triggersMutex_);
+      recordings_.push_back(info);
+      if (recordings_.size() > kRecordingHistory)
+        recordings_.pop_front();
+    }
+    lock.lock();
+  }
+}
+
+RecordingInfo SVRecorder::cut(const PendingTrigger &trigger) {
+  Stream &stream = *streams_[trigger.stream];
+  RecordingInfo info;
+  info.stream = stream.name;
+  info.reason = trigger.reason;
+  info.triggerUs = trigger.timestampUs;
+  info.path = (std::filesystem::path(recordDirectory_) /
+               (fileTime(trigger.timestampUs) + "_" + stream.name))
+                  .string();
+
+  uint64_t pre = msToUs(config_.preTriggerMs);
+  uint64_t post = msToUs(config_.postTriggerMs);
+  uint64_t from = trigger.timestampUs > pre ? trigger.timestampUs - pre : 0;
+  uint64_t to = trigger.timestampUs + post;
+
+  // References only: the samples are read from the mappings
+  std::vector<std::shared_ptr<SampleSegment>> segments;
+  {
+    std::lock_guard<std::mutex> lock(stream.mutex);
+    segments = overlapping(stream.segments, from, to);
+  }
+  if (segments.empty()) {
+    LOG_WARN("SV recording: nothing recorded of {} around {}", stream.name,
+             trigger.reason);
+    return info;
+  }
+
+  // Visits the samples of the window, in order
+  auto forEach = [&](auto visit) {
+    for (const auto &segment : segments) {
+      uint64_t end = segment->lowerBound(to + 1);
+      for (uint64_t i = segment->lowerBound(from); i < end; ++i)
+        visit(segment->at(i));
+    }
+  };
+
+  ComtradeConfig config;
+  config.device = stream.name;
+  config.format = format_;
+  config.sampleRate = stream.sampleRate.load(std::memory_order_relaxed);
+  config.nominalFrequency =
+      stream.nominalFrequency.load(std::memory_order_relaxed);
+  ComtradeStream channels;
+  channels.name = stream.name;
+  if (format_ == ComtradeFormat::Binary) {
+    forEach([&](const SVSample &sample) {
+      for (int ch = 0; ch < kChannels; ++ch)
+        channels.peak[ch] = std::max(
+            channels.peak[ch], std::abs(int64_t{sample.values[ch]}));
+    });
+  }
+  config.streams.push_back(channels);
+
+  // Two triggers of a stream in the same millisecond get one record each
+  std::string path = info.path;
+  for (int n = 2; std::filesystem::exists(path + ".cfg"); ++n)
+    path = info.path + "_" + std::to_string(n);
+  info.path = path;
+
+  ComtradeWriter writer(config);
+  if (!writer.open(info.path))
+    return info;
+  forEach([&](const SVSample &sample) { writer.write(&sample); });
+  info.rows = writer.rows();
+  info.written = writer.close(trigger.timestampUs) && info.rows > 0;
+
+  // The reason goes into the COMTRADE header file
+  std::ofstream hdr(info.path + ".hdr", std::ios::binary | std::ios::trunc);
+  hdr << "Trigger: " << trigger.reason << "\r\n"
+      << "Stream: " << stream.name << "\r\n";
+  return info;
+}
+
+bool SVRecorder::waveform(const std::string &name, uint64_t fromUs,
+                          uint64_t toUs, size_t buckets,
+                          WaveformEnvelope &out) const {
+  auto it = std::find_if(streams_.begin(), streams_.end(),
+                         [&](const auto &s) { return s->name == name; });
+  if (it == streams_.end())
+    return false;
+  const Stream &stream = **it;
+
+  if (toUs == 0)
+    toUs = stream.newestUs.load(std::memory_order_acquire) + 1;
+  if (fromUs == 0 || fromUs >= toUs)
+    fromUs = toUs > core::kUsPerSecond ? toUs - core::kUsPerSecond : 0;
+  uint64_t periods = (toUs - fromUs) *
+                     stream.sampleRate.load(std::memory_order_relaxed) /
+                     core::kUsPerSecond;
+  buckets = static_cast<size_t>(
+      std::max<uint64_t>(std::min<uint64_t>(buckets, periods), 1));
+
+  // Kept alive while read, whatever retention does meanwhile
+  std::vector<std::shared_ptr<SampleSegment>> segments;
+  {
+    std::lock_guard<std::mutex> lock(stream.mutex);
+    segments = overlapping(stream.segments, fromUs, toUs);
+  }
+  out = envelope(segments, fromUs, toUs, buckets);
+  return true;
+}
+
+RecorderStats SVRecorder::getStats() const {
+  RecorderStats stats;
+  for (const auto &stream : streams_) {
+    RecorderStreamStats s;
+    s.name = stream->name;
+    s.samples = stream->samples.load(std::memory_order_relaxed);
+    s.dropped = stream->dropped.load(std::memory_order_relaxed);
+    s.newestUs = stream->newestUs.load(std::memory_order_acquire);
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    s.segments = stream->segments.size();
+    for (const auto &segment : stream->segments) {
+      s.diskBytes += segment->fileSize();
+      if (!s.oldestUs && segment->size())
+        s.oldestUs = segment->at(segment->firstIndex()).timestamp;
+    }
+    if (stream->spare)
+      s.diskBytes += stream->spare->fileSize();
+    stats.streams.push_back(s);
+  }
+  std::lock_guard<std::mutex> lock(triggersMutex_);
+  stats.triggers = triggers_;
+  stats.pendingTriggers = pending_.size();
+  stats.recordings.assign(recordings_.begin(), recordings_.end());
+  return stats;
+}
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
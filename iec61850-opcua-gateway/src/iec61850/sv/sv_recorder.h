@@ -0,0 +1,186 @@
+#pragma once
+
+#include "comtrade_writer.h"
+#include "core/config_parser.h"
+#include "sample_clock.h"
+#include "sample_segment.h"
+#include "waveform_envelope.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <libiec61850/mms_value.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+// One COMTRADE record cut around a trigger
+struct RecordingInfo {
+  std::string path; // Without the .cfg / .dat / .hdr extension
+  std::string stream;
+  std::string reason;
+  uint64_t triggerUs = 0;
+  uint64_t rows = 0;
+  bool written = false; // false: no samples in the window, or I/O failed
+};
+
+struct RecorderStreamStats {
+  std::string name;
+  size_t segments = 0;
+  uint64_t samples = 0; // Recorded since start
+  uint64_t dropped = 0; // No segment ready to take them
+  uint64_t oldestUs = 0;
+  uint64_t newestUs = 0;
+  uint64_t diskBytes = 0;
+};
+
+struct RecorderStats {
+  std::vector<RecorderStreamStats> streams;
+  uint64_t triggers = 0; // Per stream
+  size_t pendingTriggers = 0;
+  std::vector<RecordingInfo> recordings; // Latest last
+};
+
+/**
+ * @brief Continuous recording of the configured SV streams, cut into
+ * COMTRADE records around triggers
+ *
+ * Each stream is appended, on its receive thread, to a memory-mapped
+ * SampleSegment of segmentSeconds; the next segment is created ahead by
+ * a housekeeping thread, so the receive thread only copies samples and
+ * swaps a pointer when a segment fills. Segments older than the
+ * retention are deleted.
+ *
+ * Triggers come from the current and voltage thresholds, GOOSE members
+ * rising to true, or trigger() (REST). Any number may be pending at
+ * once, overlapping or not; each waits until its post-trigger time has
+ * been recorded and is then written by the housekeeping thread straight
+ * from the segments that hold its window, which stay alive while
+ * they are read even if retention drops them meanwhile. A threshold
+ * re-arms once the post-trigger window of its last trigger is over.
+ */
+class SVRecorder {
+public:
+  static constexpr size_t kRecordingHistory = 100;
+
+  explicit SVRecorder(const core::SVConfig &config);
+  ~SVRecorder();
+
+  SVRecorder(const SVRecorder &) = delete;
+  SVRecorder &operator=(const SVRecorder &) = delete;
+
+  bool start();
+  // Writes the pending triggers with what has been recorded
+  void stop();
+  bool isRunning() const { return running_; }
+
+  /**
+   * @brief Append a timed sample; receive thread of the stream only
+   * @param stream Index of the stream in the configuration
+   */
+  void record(size_t stream, const SVSample &sample,
+              const SVStreamFormat &format);
+
+  /**
+   * @brief Cut a record of one stream or all of them
+   * @param stream Stream name (svID or APPID_xxxx), empty = every stream
+   * @param timestampUs Trigger time, us since the epoch; 0 = now
+   * @return Streams triggered
+   */
+  size_t trigger(const std::string &reason, const std::string &stream = {},
+                 uint64_t timestampUs = 0);
+
+  /**
+   * @brief Trigger every stream when a configured GOOSE member rises to
+   * true; any thread
+   */
+  void onGooseValue(const std::string &ref, const MmsValue *value);
+
+  /**
+   * @brief Min/max envelope of a recorded stream, read straight from its
+   * segments; any thread
+   * @param stream Stream name, as for trigger()
+   * @param toUs End of the range, 0 = just after the newest sample
+   * @param fromUs Start of the range, 0 = a second before toUs
+   * @param buckets At most this many; fewer if the range holds fewer
+   *                sample periods, so none is left empty by sampling
+   * @return false if there is no such stream
+   */
+  bool waveform(const std::string &stream, uint64_t fromUs, uint64_t toUs,
+                size_t buckets, WaveformEnvelope &out) const;
+
+  RecorderStats getStats() const;
+
+private:
+  // Segments are always at least this long, in samples
+  static constexpr size_t kMinSegment = 1000;
+  // A trigger whose stream stopped is written this long after its window
+  static constexpr std::chrono::seconds kStall{2};
+
+  struct Stream {
+    std::string name;
+
+    // Receive thread only
+    std::shared_ptr<SampleSegment> current;
+    bool thresholds = false;                 // Any set
+    int64_t thresholdCounts[kChannels] = {}; // 0 = none
+    uint64_t holdOffUntilUs = 0;
+
+    std::atomic<uint32_t> sampleRate{4000};
+    std::atomic<uint16_t> nominalFrequency{50};
+    std::atomic<uint64_t> samples{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> newestUs{0};
+
+    mutable std::mutex mutex; // Guards the fields below
+    std::deque<std::shared_ptr<SampleSegment>> segments; // current last
+    std::shared_ptr<SampleSegment> spare;
+    uint64_t files = 0; // Segment files created, names the next one
+  };
+
+  struct PendingTrigger {
+    size_t stream = 0;
+    std::string reason;
+    uint64_t timestampUs = 0;
+    std::chrono::steady_clock::time_point added;
+  };
+
+  void addTrigger(size_t stream, const std::string &reason,
+                  uint64_t timestampUs);
+  void housekeepLoop();
+  void prepareSegments(Stream &stream);
+  RecordingInfo cut(const PendingTrigger &trigger);
+
+  core::SVRecordingConfig config_;
+  ComtradeFormat format_ = ComtradeFormat::Binary32;
+  std::string segmentDirectory_;
+  std::string recordDirectory_;
+  std::vector<std::unique_ptr<Stream>> streams_;
+  const std::unordered_set<std::string> gooseTriggers_;
+
+  std::mutex gooseMutex_;
+  std::map<std::string, bool> gooseStates_; // Last value of each member
+
+  mutable std::mutex triggersMutex_; // Guards the fields below
+  std::vector<PendingTrigger> pending_;
+  std::deque<RecordingInfo> recordings_;
+  uint64_t triggers_ = 0;
+
+  std::atomic<bool> running_{false};
+  std::mutex wakeMutex_;
+  std::condition_variable wake_;
+  std::thread housekeeper_;
+};
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
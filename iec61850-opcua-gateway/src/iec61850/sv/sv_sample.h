@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+// IEC 61850-9-2LE data set: Ia, Ib, Ic, In, Ua, Ub, Uc, Un, each an
+// INT32 value followed by a 32-bit quality. The analytics loop over the
+// channels with this fixed count, which the compiler vectorises.
+constexpr int kChannels = 8;
+constexpr int kCurrentChannels = 4;
+constexpr int k92LEDataSize = kChannels * 8;
+constexpr double kCurrentScale = 0.001; // A per count
+constexpr double kVoltageScale = 0.01;  // V per count
+constexpr std::array<const char *, kChannels> kChannelNames = {
+    "Ia", "Ib", "Ic", "In", "Ua", "Ub", "Uc", "Un"};
+
+struct SVSample {
+  uint64_t timestamp = 0; // Microseconds since the epoch
+  uint16_t smpCnt = 0;
+  bool synchronised = false;  // smpSynch: merging unit on a time source
+  int32_t values[kChannels] = {};   // Counts
+  uint32_t quality[kChannels] = {}; // 0 = good
+};
+
+inline double channelScale(int channel) {
+  return channel < kCurrentChannels ? kCurrentScale : kVoltageScale;
+}
+
+// Channel value in amperes or volts
+inline double scaledValue(const SVSample &sample, int channel) {
+  return sample.values[channel] * channelScale(channel);
+}
+
+// svID, or the APPID in hex when the stream has none configured
+inline std::string streamName(uint16_t appId, const std::string &svID) {
+  if (!svID.empty())
+    return svID;
+  char name[16];
+  std::snprintf(name, sizeof(name), "APPID_%04X", appId);
+  return name;
+}
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
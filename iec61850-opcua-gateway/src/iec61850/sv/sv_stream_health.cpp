@@ -0,0 +1,120 @@
+#include "sv_stream_health.h"
+#include "core/metrics.h"
+#include <algorithm>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+namespace {
+
+constexpr auto kRelaxed = std::memory_order_relaxed;
+
+} // namespace
+
+void SVStreamHealth::record(const SVFrameInfo &frame, uint32_t sampleRate) {
+  uint32_t rate = sampleRate ? sampleRate : 1;
+  core::increment(samples_);
+  lastArrivalUs_.store(frame.arrivalUs, kRelaxed);
+
+  if (seen_ && frame.synchronised != synchronised_.load(kRelaxed)) {
+    core::increment(synchChanges_);
+    lastSynchChangeUs_.store(frame.arrivalUs, kRelaxed);
+  }
+  synchronised_.store(frame.synchronised, kRelaxed);
+  if (seen_ && frame.confRev != confRev_.load(kRelaxed)) {
+    core::increment(confRevChanges_);
+    lastConfRevChangeUs_.store(frame.arrivalUs, kRelaxed);
+  }
+  confRev_.store(frame.confRev, kRelaxed);
+
+  if (!seen_) {
+    seen_ = true;
+    lastCnt_ = frame.smpCnt;
+    lastInOrderUs_ = frame.arrivalUs;
+    received_ = 1;
+    return;
+  }
+
+  uint32_t delta = (frame.smpCnt + rate - lastCnt_ % rate) % rate;
+  if (delta == 0) {
+    core::increment(duplicates_);
+    return;
+  }
+
+  if (delta > rate / 2) {
+    // Behind the last count: a late sample, unless it arrived before
+    uint32_t behind = rate - delta;
+    if (behind < kWindow) {
+      uint64_t bit = uint64_t{1} << behind;
+      if (received_ & bit) {
+        core::increment(duplicates_);
+        return;
+      }
+      received_ |= bit;
+      // Counted missing when the count after it arrived
+      uint64_t missing = missing_.load(kRelaxed);
+      if (missing)
+        missing_.store(missing - 1, kRelaxed);
+    }
+    core::increment(outOfOrder_);
+    return;
+  }
+
+  if (delta > 1) {
+    core::increment(missing_, delta - 1);
+    core::increment(gaps_);
+  }
+
+  // Deviation from the sample periods between the two, in ns
+  if (frame.arrivalUs >= lastInOrderUs_) {
+    int64_t intervalNs =
+        static_cast<int64_t>(frame.arrivalUs - lastInOrderUs_) * 1000;
+    int64_t expectedNs =
+        static_cast<int64_t>(uint64_t{delta} * 1000000000 / rate);
+    int64_t deviationNs = intervalNs - expectedNs;
+    uint64_t deviationUs =
+        static_cast<uint64_t>(deviationNs < 0 ? -deviationNs : deviationNs) /
+        1000;
+    uint32_t jitterUs =
+        static_cast<uint32_t>(std::min<uint64_t>(deviationUs, UINT32_MAX));
+    core::increment(
+        jitter_[core::histogramBucket(kArrivalJitterBoundsUs, jitterUs)]);
+    if (jitterUs > maxJitterUs_.load(kRelaxed))
+      maxJitterUs_.store(jitterUs, kRelaxed);
+  }
+
+  received_ = delta >= kWindow ? 1 : received_ << delta | 1;
+  lastCnt_ = frame.smpCnt;
+  lastInOrderUs_ = frame.arrivalUs;
+}
+
+void SVStreamHealth::recordMalformed(uint64_t arrivalUs) {
+  core::increment(malformed_);
+  lastArrivalUs_.store(arrivalUs, kRelaxed);
+}
+
+SVHealthSnapshot SVStreamHealth::snapshot() const {
+  SVHealthSnapshot s;
+  s.samples = samples_.load(kRelaxed);
+  s.missingSamples = missing_.load(kRelaxed);
+  s.gaps = gaps_.load(kRelaxed);
+  s.duplicates = duplicates_.load(kRelaxed);
+  s.outOfOrder = outOfOrder_.load(kRelaxed);
+  s.malformed = malformed_.load(kRelaxed);
+  s.synchronised = synchronised_.load(kRelaxed);
+  s.synchChanges = synchChanges_.load(kRelaxed);
+  s.lastSynchChangeUs = lastSynchChangeUs_.load(kRelaxed);
+  s.confRev = confRev_.load(kRelaxed);
+  s.confRevChanges = confRevChanges_.load(kRelaxed);
+  s.lastConfRevChangeUs = lastConfRevChangeUs_.load(kRelaxed);
+  s.lastArrivalUs = lastArrivalUs_.load(kRelaxed);
+  s.maxJitterUs = maxJitterUs_.load(kRelaxed);
+  for (size_t i = 0; i < kArrivalJitterBuckets; ++i)
+    s.jitter[i] = jitter_[i].load(kRelaxed);
+  return s;
+}
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+constexpr size_t kArrivalJitterBuckets = 8;
+
+// Upper bounds (us) of the arrival jitter buckets; the last is open
+constexpr std::array<uint32_t, kArrivalJitterBuckets - 1>
+    kArrivalJitterBoundsUs = {10, 25, 50, 100, 250, 500, 1000};
+
+// Supervision-relevant fields of one received SV ASDU
+struct SVFrameInfo {
+  uint64_t arrivalUs = 0;
+  uint16_t smpCnt = 0;
+  bool synchronised = false; // smpSynch
+  uint32_t confRev = 0;
+};
+
+struct SVHealthSnapshot {
+  uint64_t samples = 0;
+  uint64_t missingSamples = 0; // Skipped by smpCnt, not arrived late
+  uint64_t gaps = 0;           // Runs of missing samples
+  uint64_t duplicates = 0;     // smpCnt already received
+  uint64_t outOfOrder = 0;     // Arrived after a later smpCnt
+  uint64_t malformed = 0;      // ASDUs too short for the 9-2LE data set
+  bool synchronised = false;
+  uint64_t synchChanges = 0;       // smpSynch transitions
+  uint64_t lastSynchChangeUs = 0;  // Arrival time, 0 = never changed
+  uint32_t confRev = 0;
+  uint64_t confRevChanges = 0;
+  uint64_t lastConfRevChangeUs = 0;
+  uint64_t lastArrivalUs = 0;
+  uint32_t maxJitterUs = 0;
+  std::array<uint64_t, kArrivalJitterBuckets> jitter{};
+};
+
+/**
+ * @brief Stream quality of one merging unit's SV stream
+ *
+ * Same threading as GooseStreamStats: record() runs on the stream's
+ * receive thread only, snapshot() from any thread, and everything shared
+ * is a relaxed atomic.
+ *
+ * smpCnt is compared with the last one modulo the sample rate: ahead by
+ * up to half the rate is progress (any skipped counts missing), behind is
+ * a late sample. The last kWindow counts are remembered, so a late
+ * sample that fills a gap is told apart from a duplicate and no longer
+ * counted missing.
+ *
+ * Arrival jitter is how far the time between consecutive arrivals is
+ * from the sample periods between them, for in-order samples only.
+ */
+class SVStreamHealth {
+public:
+  static constexpr uint32_t kWindow = 64;
+
+  /**
+   * @param sampleRate Where smpCnt wraps, as detected by the SampleClock
+   */
+  void record(const SVFrameInfo &frame, uint32_t sampleRate);
+
+  /**
+   * @brief Count an ASDU of the stream that could not be decoded; it
+   * still counts as an arrival
+   */
+  void recordMalformed(uint64_t arrivalUs);
+  SVHealthSnapshot snapshot() const;
+
+private:
+  std::atomic<uint64_t> samples_{0};
+  std::atomic<uint64_t> missing_{0};
+  std::atomic<uint64_t> gaps_{0};
+  std::atomic<uint64_t> duplicates_{0};
+  std::atomic<uint64_t> outOfOrder_{0};
+  std::atomic<uint64_t> malformed_{0};
+  std::atomic<bool> synchronised_{false};
+  std::atomic<uint64_t> synchChanges_{0};
+  std::atomic<uint64_t> lastSynchChangeUs_{0};
+  std::atomic<uint32_t> confRev_{0};
+  std::atomic<uint64_t> confRevChanges_{0};
+  std::atomic<uint64_t> lastConfRevChangeUs_{0};
+  std::atomic<uint64_t> lastArrivalUs_{0};
+  std::atomic<uint32_t> maxJitterUs_{0};
+  std::array<std::atomic<uint64_t>, kArrivalJitterBuckets> jitter_{};
+
+  // Writer-only state
+  bool seen_ = false;
+  uint16_t lastCnt_ = 0;
+  uint64_t lastInOrderUs_ = 0;
+  uint64_t received_ = 0; // Bit n: smpCnt lastCnt_ - n has arrived
+};
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
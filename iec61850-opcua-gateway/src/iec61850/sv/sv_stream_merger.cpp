@@ -0,0 +1,242 @@
+#include "sv_stream_merger.h"
+#include "core/logger.h"
+#include "core/metrics.h"
+#include <algorithm>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+namespace {
+
+uint32_t saturate(uint64_t us) {
+  return static_cast<uint32_t>(std::min<uint64_t>(us, UINT32_MAX));
+}
+
+} // namespace
+
+SVStreamMerger::SVStreamMerger(const std::vector<std::string> &names,
+                               int maxSkewUs)
+    : maxSkewUs_(static_cast<uint64_t>(std::max(maxSkewUs, 0))),
+      all_(names.size() >= kMaxStreams
+               ? UINT32_MAX
+               : (uint32_t{1} << names.size()) - 1) {
+  if (names.size() > kMaxStreams)
+    LOG_WARN("SV merge: only the first {} of {} streams are merged",
+             kMaxStreams, names.size());
+  for (size_t i = 0; i < names.size() && i < kMaxStreams; ++i) {
+    Stream stream;
+    stream.name = names[i];
+    streams_.push_back(stream);
+    handOffs_.push_back(std::make_unique<HandOff>());
+  }
+}
+
+void SVStreamMerger::configure(uint32_t sampleRate) {
+  sampleRate_ = sampleRate;
+  skewSamples_ =
+      std::max<uint64_t>(maxSkewUs_ * sampleRate / core::kUsPerSecond, 1);
+  // Room for the skew and the frame being filled past it
+  size_t capacity = 16;
+  while (capacity < 2 * (skewSamples_ + 2))
+    capacity *= 2;
+  mask_ = capacity - 1;
+  slots_.assign(capacity, Slot());
+  samples_.assign(capacity * streams_.size(), SVSample());
+  LOG_INFO("SV merge: aligning {} stream(s) at {} Hz, up to {} samples "
+           "of skew",
+           streams_.size(), sampleRate, skewSamples_);
+}
+
+void SVStreamMerger::add(size_t stream, const SVSample &sample,
+                         const SVStreamFormat &format, uint64_t arrivalUs) {
+  if (stream >= handOffs_.size())
+    return;
+  HandOff &handOff = *handOffs_[stream];
+  uint64_t written = handOff.written.load(std::memory_order_relaxed);
+  if (written - handOff.read.load(std::memory_order_acquire) == kHandOff) {
+    core::increment(handOff.dropped);
+    return;
+  }
+  Pending &pending = handOff.entries[written % kHandOff];
+  pending.sample = sample;
+  pending.format = format;
+  pending.arrivalUs = arrivalUs;
+  handOff.written.store(written + 1, std::memory_order_release);
+}
+
+void SVStreamMerger::poll(uint64_t nowUs) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Only what was handed over by now, oldest arrival first across streams
+  std::array<uint64_t, kMaxStreams> next{};
+  std::array<uint64_t, kMaxStreams> end{};
+  for (size_t i = 0; i < handOffs_.size(); ++i) {
+    next[i] = handOffs_[i]->read.load(std::memory_order_relaxed);
+    end[i] = handOffs_[i]->written.load(std::memory_order_acquire);
+  }
+  for (;;) {
+    size_t oldest = handOffs_.size();
+    uint64_t oldestUs = UINT64_MAX;
+    for (size_t i = 0; i < handOffs_.size(); ++i) {
+      if (next[i] == end[i])
+        continue;
+      uint64_t arrivalUs =
+          handOffs_[i]->entries[next[i] % kHandOff].arrivalUs;
+      if (arrivalUs < oldestUs) {
+        oldest = i;
+        oldestUs = arrivalUs;
+      }
+    }
+    if (oldest == handOffs_.size())
+      break;
+    HandOff &handOff = *handOffs_[oldest];
+    align(oldest, handOff.entries[next[oldest] % kHandOff]);
+    handOff.read.store(++next[oldest], std::memory_order_release);
+  }
+  if (started_)
+    advance(nowUs);
+}
+
+void SVStreamMerger::align(size_t stream, const Pending &pending) {
+  const SVSample &sample = pending.sample;
+  const SVStreamFormat &format = pending.format;
+  uint64_t arrivalUs = pending.arrivalUs;
+  Stream &s = streams_[stream];
+  s.samples++;
+  if (!sample.synchronised || !format.detected ||
+      (sampleRate_ && format.sampleRate != sampleRate_)) {
+    s.unaligned++;
+    return;
+  }
+  if (!sampleRate_)
+    configure(format.sampleRate);
+
+  // The same instant in every synchronised stream of this rate
+  uint64_t key =
+      sample.timestamp / core::kUsPerSecond * sampleRate_ + sample.smpCnt;
+  if (started_ && (arrivalUs > lastAlignedUs_ + kResyncUs ||
+                   key >= nextKey_ + slots_.size())) {
+    flush(arrivalUs);
+    resyncs_++;
+  }
+  if (!started_) {
+    started_ = true;
+    nextKey_ = key;
+    newestKey_ = key;
+  }
+  if (key < nextKey_) {
+    s.late++;
+    return;
+  }
+  lastAlignedUs_ = arrivalUs;
+
+  Slot &slot = slotFor(key);
+  if (!slot.present) {
+    slot.key = key;
+    slot.firstArrivalUs = arrivalUs;
+  }
+  uint32_t bit = uint32_t{1} << stream;
+  // A duplicate smpCnt; the health monitor counts those
+  if (slot.present & bit)
+    return;
+  samples_[(key & mask_) * streams_.size() + stream] = sample;
+  slot.present |= bit;
+
+  uint64_t lagUs =
+      arrivalUs > slot.firstArrivalUs ? arrivalUs - slot.firstArrivalUs : 0;
+  s.lagSumUs += lagUs;
+  s.lagCount++;
+  s.maxLagUs = std::max(s.maxLagUs, saturate(lagUs));
+
+  newestKey_ = std::max(newestKey_, key);
+  advance(arrivalUs);
+}
+
+void SVStreamMerger::advance(uint64_t nowUs) {
+  while (nextKey_ <= newestKey_) {
+    Slot &slot = slotFor(nextKey_);
+    bool behind = newestKey_ - nextKey_ > skewSamples_;
+    if (slot.present) {
+      bool expired = nowUs >= slot.firstArrivalUs + maxSkewUs_;
+      if (slot.present != all_ && !behind && !expired)
+        break;
+      emit(slot, nowUs);
+    } else if (!behind) {
+      // Lost by every stream so far: skip once the frame after is whole
+      if (nextKey_ == newestKey_ || slotFor(nextKey_ + 1).present != all_)
+        break;
+    }
+    nextKey_++;
+  }
+}
+
+void SVStreamMerger::emit(Slot &slot, uint64_t nowUs) {
+  MergedFrame frame;
+  frame.sampleIndex = slot.key;
+  frame.sampleRate = sampleRate_;
+  frame.timestampUs = slot.key / sampleRate_ * core::kUsPerSecond +
+                      slot.key % sampleRate_ * core::kUsPerSecond / sampleRate_;
+  frame.present = slot.present;
+  frame.streams = streams_.size();
+  frame.samples = &samples_[(slot.key & mask_) * streams_.size()];
+
+  frames_++;
+  if (slot.present == all_)
+    completeFrames_++;
+  for (size_t i = 0; i < streams_.size(); ++i) {
+    if (!(slot.present & (uint32_t{1} << i)))
+      streams_[i].missing++;
+  }
+  uint64_t latencyUs =
+      nowUs > slot.firstArrivalUs ? nowUs - slot.firstArrivalUs : 0;
+  latencySumUs_ += latencyUs;
+  maxLatencyUs_ = std::max(maxLatencyUs_, saturate(latencyUs));
+  latency_[core::histogramBucket(kAlignmentLatencyBoundsUs, latencyUs)]++;
+
+  if (sink_)
+    sink_(frame);
+  slot.present = 0;
+}
+
+void SVStreamMerger::flush(uint64_t nowUs) {
+  for (uint64_t key = nextKey_; key <= newestKey_; ++key) {
+    Slot &slot = slotFor(key);
+    if (slot.present)
+      emit(slot, nowUs);
+  }
+  started_ = false;
+}
+
+MergeStats SVStreamMerger::getStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  MergeStats stats;
+  stats.sampleRate = sampleRate_;
+  stats.frames = frames_;
+  stats.completeFrames = completeFrames_;
+  stats.resyncs = resyncs_;
+  if (frames_)
+    stats.avgLatencyUs = static_cast<double>(latencySumUs_) /
+                         static_cast<double>(frames_);
+  stats.maxLatencyUs = maxLatencyUs_;
+  stats.latency = latency_;
+  for (size_t i = 0; i < streams_.size(); ++i) {
+    const Stream &stream = streams_[i];
+    MergeStreamStats s;
+    s.name = stream.name;
+    s.samples = stream.samples;
+    s.dropped = handOffs_[i]->dropped.load(std::memory_order_relaxed);
+    s.late = stream.late;
+    s.unaligned = stream.unaligned;
+    s.missing = stream.missing;
+    if (stream.lagCount)
+      s.avgLagUs = static_cast<double>(stream.lagSumUs) /
+                   static_cast<double>(stream.lagCount);
+    s.maxLagUs = stream.maxLagUs;
+    stats.streams.push_back(s);
+  }
+  return stats;
+}
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
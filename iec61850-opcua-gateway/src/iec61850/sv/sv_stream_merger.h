@@ -0,0 +1,191 @@
+#pragma once
+
+#include "sample_clock.h"
+#include "sv_sample.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+constexpr size_t kAlignmentLatencyBuckets = 8;
+
+// Upper bounds (us) of the alignment latency buckets; the last is open
+constexpr std::array<uint32_t, kAlignmentLatencyBuckets - 1>
+    kAlignmentLatencyBoundsUs = {50, 100, 250, 500, 1000, 2000, 5000};
+
+// Samples of the same instant from every merged stream
+struct MergedFrame {
+  uint64_t sampleIndex = 0; // Sample periods since the epoch
+  uint64_t timestampUs = 0;
+  uint32_t sampleRate = 0;
+  uint32_t present = 0; // Bit n: samples[n] was received
+  size_t streams = 0;
+  // One per stream in merge order; only those in present are valid
+  const SVSample *samples = nullptr;
+};
+
+struct MergeStreamStats {
+  std::string name;
+  uint64_t samples = 0;
+  uint64_t dropped = 0;   // Hand-off full: not polled in time
+  uint64_t late = 0;      // Its frame had already been emitted
+  uint64_t unaligned = 0; // Unsynchronised, or at another sample rate
+  uint64_t missing = 0;   // Frames emitted without it
+  double avgLagUs = 0.0;  // Behind the first stream of the same frame
+  uint32_t maxLagUs = 0;
+};
+
+struct MergeStats {
+  uint32_t sampleRate = 0; // 0 until the first aligned sample
+  uint64_t frames = 0;
+  uint64_t completeFrames = 0;
+  uint64_t resyncs = 0;     // Restarts after a time jump or silence
+  double avgLatencyUs = 0.0; // First sample in to frame out
+  uint32_t maxLatencyUs = 0;
+  std::array<uint64_t, kAlignmentLatencyBuckets> latency{};
+  std::vector<MergeStreamStats> streams;
+};
+
+/**
+ * @brief Aligns synchronised SV streams of several merging units into
+ * multi-stream frames, one per sample instant
+ *
+ * A synchronised merging unit restarts smpCnt at the top of each second,
+ * so second * sampleRate + smpCnt names the same instant in every stream
+ * of the same rate; samples are matched on it, never on their arrival
+ * times. Unsynchronised samples, or those at a rate other than the first
+ * aligned stream's, cannot be matched and are only counted.
+ *
+ * Frames wait in a ring sized for the skew and are emitted in order, as
+ * soon as every stream is in, or once the first sample of the frame is
+ * maxSkewUs old, or the newest frame is that far ahead; missing streams
+ * are left out of present. A sample whose frame is gone counts as late.
+ * After a second with nothing aligned, or a jump past the ring, merging
+ * restarts from the next sample.
+ *
+ * add() only hands a sample over: each stream has its own single-producer
+ * ring, so receive threads never lock or wait, and a sample that finds
+ * its ring full is dropped. poll() takes what was handed over, in arrival
+ * order across the streams, aligns it and emits the frames; it and
+ * getStats() serialise on a mutex held while the sink runs, so the sink
+ * must not call back in. Latency is counted up to the arrival that let a
+ * frame out; the hand-off adds up to one poll interval.
+ */
+class SVStreamMerger {
+public:
+  static constexpr size_t kMaxStreams = 32;
+  // Samples a stream may hand over between polls
+  static constexpr size_t kHandOff = size_t{1} << 12;
+  // Called for every frame, in sample order, on the polling thread; valid
+  // during the call
+  using FrameSink = std::function<void(const MergedFrame &frame)>;
+
+  /**
+   * @param names Merged streams, at most kMaxStreams; indexes for add()
+   */
+  SVStreamMerger(const std::vector<std::string> &names, int maxSkewUs);
+
+  SVStreamMerger(const SVStreamMerger &) = delete;
+  SVStreamMerger &operator=(const SVStreamMerger &) = delete;
+
+  // Set before the first poll()
+  void setFrameSink(FrameSink sink) { sink_ = std::move(sink); }
+
+  size_t streams() const { return streams_.size(); }
+
+  /**
+   * @brief Hand over a timed sample of merged stream @p stream; one thread
+   * per stream
+   * @param arrivalUs When it was received, us since the epoch
+   */
+  void add(size_t stream, const SVSample &sample, const SVStreamFormat &format,
+           uint64_t arrivalUs);
+
+  /**
+   * @brief Align the samples handed over so far and emit the frames whose
+   * wait is over; call periodically, from one thread at a time
+   */
+  void poll(uint64_t nowUs);
+
+  MergeStats getStats() const;
+
+private:
+  // Nothing aligned for this long: start over
+  static constexpr uint64_t kResyncUs = 1000000;
+
+  struct Stream {
+    std::string name;
+    uint64_t samples = 0;
+    uint64_t late = 0;
+    uint64_t unaligned = 0;
+    uint64_t missing = 0;
+    uint64_t lagSumUs = 0;
+    uint64_t lagCount = 0;
+    uint32_t maxLagUs = 0;
+  };
+
+  struct Pending {
+    SVSample sample;
+    SVStreamFormat format;
+    uint64_t arrivalUs = 0;
+  };
+
+  // Single producer, the stream's receive thread; single consumer, poll()
+  struct HandOff {
+    std::vector<Pending> entries = std::vector<Pending>(kHandOff);
+    alignas(64) std::atomic<uint64_t> written{0};
+    alignas(64) std::atomic<uint64_t> read{0};
+    std::atomic<uint64_t> dropped{0};
+  };
+
+  struct Slot {
+    uint64_t key = 0;
+    uint32_t present = 0;
+    uint64_t firstArrivalUs = 0;
+  };
+
+  // Caller holds mutex_ for all of these
+  void align(size_t stream, const Pending &pending);
+  void configure(uint32_t sampleRate);
+  Slot &slotFor(uint64_t key) { return slots_[key & mask_]; }
+  void advance(uint64_t nowUs);
+  void emit(Slot &slot, uint64_t nowUs);
+  void flush(uint64_t nowUs);
+
+  const uint64_t maxSkewUs_;
+  const uint32_t all_; // present of a complete frame
+  FrameSink sink_;
+  std::vector<std::unique_ptr<HandOff>> handOffs_; // One per stream
+
+  mutable std::mutex mutex_; // Guards everything below
+  std::vector<Stream> streams_;
+  uint32_t sampleRate_ = 0;
+  uint64_t skewSamples_ = 0;
+  uint64_t mask_ = 0;
+  std::vector<Slot> slots_;
+  std::vector<SVSample> samples_; // [slot * streams + stream]
+  bool started_ = false;
+  uint64_t nextKey_ = 0;   // Next frame to emit
+  uint64_t newestKey_ = 0; // Latest frame with a sample
+  uint64_t lastAlignedUs_ = 0;
+
+  uint64_t frames_ = 0;
+  uint64_t completeFrames_ = 0;
+  uint64_t resyncs_ = 0;
+  uint64_t latencySumUs_ = 0;
+  uint32_t maxLatencyUs_ = 0;
+  std::array<uint64_t, kAlignmentLatencyBuckets> latency_{};
+};
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
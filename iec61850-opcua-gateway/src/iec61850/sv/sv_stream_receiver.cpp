@@ -0,0 +1,134 @@
+#include "sv_stream_receiver.h"
+#include "core/logger.h"
+#include <algorithm>
+#include <chrono>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+namespace {
+// Neither the Ethernet nor the session socket is exposed to wait on;
+// poll while idle. SV cannot use the packet ring: the receiver decodes
+// only frames it reads from its own socket
+constexpr auto kIdlePoll = std::chrono::microseconds(200);
+} // namespace
+
+bool decode92LE(SVSubscriber_ASDU asdu, SVSample &sample) {
+  if (SVSubscriber_ASDU_getDataSize(asdu) < k92LEDataSize)
+    return false;
+  sample.smpCnt = SVSubscriber_ASDU_getSmpCnt(asdu);
+  sample.synchronised = SVSubscriber_ASDU_getSmpSynch(asdu) != 0;
+  for (int channel = 0; channel < kChannels; ++channel) {
+    sample.values[channel] = SVSubscriber_ASDU_getINT32(asdu, channel * 8);
+    sample.quality[channel] =
+        SVSubscriber_ASDU_getINT32U(asdu, channel * 8 + 4);
+  }
+  return true;
+}
+
+SVStreamReceiver::SVStreamReceiver(const std::string &interfaceName)
+    : name_(interfaceName), receiver_(SVReceiver_create()) {
+  SVReceiver_setInterfaceId(receiver_, name_.c_str());
+}
+
+SVStreamReceiver::SVStreamReceiver(const core::RSessionConfig &session)
+    : name_(capture::describeRSession(session)), routable_(true) {
+  session_ = capture::openRSession(session, &unknownKeys_);
+  if (session_)
+    receiver_ = SVReceiver_createRemote(session_.get());
+}
+
+SVStreamReceiver::~SVStreamReceiver() {
+  stop();
+  // The receiver destroys the subscribers still added to it
+  if (receiver_)
+    SVReceiver_destroy(receiver_);
+}
+
+bool SVStreamReceiver::start() {
+  if (running_)
+    return true;
+  if (!receiver_ || !SVReceiver_startThreadless(receiver_)) {
+    LOG_ERROR("Failed to start SV Receiver on {}", name_);
+    return false;
+  }
+  running_ = true;
+  thread_ = std::thread(&SVStreamReceiver::receiveLoop, this);
+  LOG_INFO("SV Receiver started on {}", name_);
+  return true;
+}
+
+void SVStreamReceiver::stop() {
+  if (!running_)
+    return;
+  running_ = false;
+  if (thread_.joinable())
+    thread_.join();
+  SVReceiver_stopThreadless(receiver_);
+  LOG_INFO("SV Receiver stopped on {}", name_);
+}
+
+bool SVStreamReceiver::addStream(uint16_t appId, Listener listener) {
+  if (!receiver_)
+    return false;
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = std::find_if(streams_.begin(), streams_.end(),
+                         [&](const auto &s) { return s->appId == appId; });
+  if (it != streams_.end()) {
+    (*it)->listener = std::move(listener);
+    return true;
+  }
+
+  auto stream = std::make_unique<Stream>();
+  stream->owner = this;
+  stream->appId = appId;
+  stream->listener = std::move(listener);
+  // Any destination: routed streams carry no Ethernet address
+  stream->subscriber = SVSubscriber_create(nullptr, appId);
+  if (!stream->subscriber)
+    return false;
+  SVSubscriber_setListener(stream->subscriber, &SVStreamReceiver::onASDU,
+                           stream.get());
+  SVReceiver_addSubscriber(receiver_, stream->subscriber);
+  streams_.push_back(std::move(stream));
+  return true;
+}
+
+void SVStreamReceiver::removeStream(uint16_t appId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = std::find_if(streams_.begin(), streams_.end(),
+                         [&](const auto &s) { return s->appId == appId; });
+  if (it == streams_.end())
+    return;
+  SVReceiver_removeSubscriber(receiver_, (*it)->subscriber);
+  SVSubscriber_destroy((*it)->subscriber);
+  streams_.erase(it);
+}
+
+void SVStreamReceiver::onASDU(SVSubscriber, void *parameter,
+                              SVSubscriber_ASDU asdu) {
+  auto *stream = static_cast<Stream *>(parameter);
+  // Only the receive thread writes
+  std::atomic<uint64_t> &messages = stream->owner->messages_;
+  messages.store(messages.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_relaxed);
+  if (stream->listener)
+    stream->listener(asdu);
+}
+
+void SVStreamReceiver::receiveLoop() {
+  while (running_) {
+    bool parsed;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      parsed = SVReceiver_tick(receiver_);
+    }
+    if (!parsed)
+      std::this_thread::sleep_for(kIdlePoll);
+  }
+}
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
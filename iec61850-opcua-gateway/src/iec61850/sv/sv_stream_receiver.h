@@ -0,0 +1,102 @@
+#pragma once
+
+#include "core/config_parser.h"
+#include "iec61850/capture/r_session.h"
+#include "sv_sample.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <libiec61850/sv_subscriber.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+/**
+ * @brief Read the 9-2LE data set, smpCnt and smpSynch of an ASDU into
+ * @p sample, leaving its timestamp alone
+ * @return false if the ASDU is too short for the data set
+ */
+bool decode92LE(SVSubscriber_ASDU asdu, SVSample &sample);
+
+/**
+ * @brief Receives sampled value streams by APPID and hands each ASDU to
+ * a listener
+ *
+ * Frames come from an interface (IEC 61850-9-2) or, for a routable
+ * receiver, from an R-SV session over UDP (IEC 61850-90-5); listeners
+ * see the same ASDUs either way. One thread ticks the libiec61850
+ * receiver; streams may be added and removed while it runs.
+ */
+class SVStreamReceiver {
+public:
+  // Called on the receive thread; the ASDU is only valid during the call
+  using Listener = std::function<void(SVSubscriber_ASDU asdu)>;
+
+  explicit SVStreamReceiver(const std::string &interfaceName);
+
+  /**
+   * @brief R-SV over UDP, unicast or multicast
+   */
+  explicit SVStreamReceiver(const core::RSessionConfig &session);
+  ~SVStreamReceiver();
+
+  SVStreamReceiver(const SVStreamReceiver &) = delete;
+  SVStreamReceiver &operator=(const SVStreamReceiver &) = delete;
+
+  bool start();
+  void stop();
+  bool isRunning() const { return running_; }
+
+  /**
+   * @brief Deliver the stream with @p appId, replacing its listener if
+   * already added
+   */
+  bool addStream(uint16_t appId, Listener listener);
+  void removeStream(uint16_t appId);
+
+  bool isRoutable() const { return routable_; }
+
+  // Interface name, or the session's address
+  const std::string &getName() const { return name_; }
+
+  // ASDUs decoded, whichever stream they carried
+  uint64_t getMessages() const { return messages_.load(); }
+  // Routable only: messages secured with a key not configured
+  uint64_t getUnknownKeyMessages() const { return unknownKeys_.load(); }
+
+private:
+  struct Stream {
+    SVStreamReceiver *owner = nullptr;
+    uint16_t appId = 0;
+    SVSubscriber subscriber = nullptr;
+    Listener listener;
+  };
+
+  static void onASDU(SVSubscriber subscriber, void *parameter,
+                     SVSubscriber_ASDU asdu);
+  void receiveLoop();
+
+  std::string name_;
+  bool routable_ = false;
+  capture::RSessionHandle session_;
+  SVReceiver receiver_ = nullptr;
+
+  // Serialises ticking with stream changes
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<Stream>> streams_;
+
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+  std::atomic<uint64_t> messages_{0};
+  std::atomic<uint64_t> unknownKeys_{0};
+};
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
@@ -1,43 +1,60 @@
 #include "sv_waveform_capture.h"
 #include "core/logger.h"
+#include "core/metrics.h"
+#include <algorithm>
 #include <cmath>
-#include <fstream>
-#include <iomanip>
 
 namespace gateway {
 namespace iec61850 {
 namespace sv {
 
-SVWaveformCapture::SVWaveformCapture() {
-  // Initialize buffer with default size (e.g., 10 seconds @ 4kHz = 40000
-  // samples) Real size will be set in start()
-  buffer_.resize(40000);
+namespace {
+
+uint64_t packFormat(const SVStreamFormat &format) {
+  return uint64_t{format.sampleRate} << 32 |
+         uint64_t{format.samplesPerCycle} << 16 |
+         uint64_t{format.nominalFrequency} << 1 | (format.detected ? 1 : 0);
+}
+
+SVStreamFormat unpackFormat(uint64_t packed) {
+  SVStreamFormat format;
+  format.sampleRate = static_cast<uint32_t>(packed >> 32);
+  format.samplesPerCycle = static_cast<uint16_t>(packed >> 16);
+  format.nominalFrequency = static_cast<uint16_t>((packed & 0xFFFF) >> 1);
+  format.detected = (packed & 1) != 0;
+  return format;
 }
 
+} // namespace
+
+SVWaveformCapture::SVWaveformCapture(size_t capacity)
+    : ring_(capacity), format_(packFormat(SVStreamFormat())) {}
+
 SVWaveformCapture::~SVWaveformCapture() { stop(); }
 
 void SVWaveformCapture::start(const CaptureConfig &config) {
-  std::lock_guard<std::mutex> lock(mutex_);
   if (capturing_)
     return;
 
   config_ = config;
-
-  // Calculate buffer size: (duration + preTrigger) * sampleRate
-  // Assuming 4000Hz sample rate for 50Hz system (80 samples/cycle)
-  // TODO: Get sample rate from SV stream
-  int sampleRate = 4000;
-  size_t totalSamples =
-      (size_t)((config.durationMs + config.preTriggerMs) * sampleRate / 1000);
-
-  buffer_.resize(totalSamples);
-  head_ = 0;
-  full_ = false;
+  for (int channel = 0; channel < kChannels; ++channel) {
+    thresholdCounts_[channel] = static_cast<int64_t>(
+        std::ceil(config.triggerThreshold / channelScale(channel)));
+  }
+  startIndex_ = ring_.written();
   triggered_ = false;
   capturing_ = true;
 
-  LOG_INFO("Started SV Capture for ID: {}, Buffer: {} samples", config.svID,
-           totalSamples);
+  LOG_INFO("Started SV Capture for ID: {}, {} samples at {} Hz", config.svID,
+           samplesIn(config.preTriggerMs + config.durationMs),
+           getFormat().sampleRate);
+}
+
+uint64_t SVWaveformCapture::samplesIn(int ms) const {
+  // The slot the receive thread writes next is not readable
+  uint64_t samples =
+      uint64_t{getFormat().sampleRate} * static_cast<uint64_t>(ms) / 1000;
+  return std::min<uint64_t>(samples, ring_.capacity() - 1);
 }
 
 void SVWaveformCapture::stop() {
@@ -50,99 +67,96 @@ void SVWaveformCapture::trigger() {
   if (!capturing_ || triggered_)
     return;
 
+  triggerIndex_ = ring_.written();
+  triggerTimestamp_ = core::nowUs();
   triggered_ = true;
-  triggerTimestamp_ = std::chrono::duration_cast<std::chrono::milliseconds>(
-                          std::chrono::system_clock::now().time_since_epoch())
-                          .count();
 
   LOG_INFO("SV Capture Triggered!");
-
-  // Schedule stop after post-trigger duration
-  // In a real implementation, we would use a timer or check in the callback
 }
 
 bool SVWaveformCapture::isCapturing() const { return capturing_; }
 
 bool SVWaveformCapture::isTriggered() const { return triggered_; }
 
-void SVWaveformCapture::onSVMessage(SVSubscriber subscriber, void *parameter,
-                                    SVSubscriber_ASDU asdu) {
+void SVWaveformCapture::addSample(SVSample sample, uint64_t arrivalUs) {
   if (!capturing_)
     return;
 
-  // Extract value (assuming float for simplicity, real SV is complex)
-  // This is a placeholder for actual libiec61850 SV parsing
-  double val = 0.0;
-  // val = SVSubscriber_ASDU_getFLOAT32(asdu, 0);
-
-  std::lock_guard<std::mutex> lock(mutex_);
-
-  SVSample sample;
-  sample.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
-                         std::chrono::system_clock::now().time_since_epoch())
-                         .count();
-  sample.value = val;
-  sample.quality = 0; // Good
+  sample.timestamp =
+      clock_.timestamp(sample.smpCnt, sample.synchronised, arrivalUs);
+  uint64_t format = packFormat(clock_.format());
+  if (format != format_.load(std::memory_order_relaxed))
+    format_.store(format, std::memory_order_relaxed);
+  lost_.store(clock_.lostSamples(), std::memory_order_relaxed);
 
-  buffer_[head_] = sample;
-  head_ = (head_ + 1) % buffer_.size();
-  if (head_ == 0)
-    full_ = true;
+  ring_.push(sample);
 
   // Check trigger condition (threshold)
-  if (!triggered_ && config_.triggerThreshold > 0.0) {
-    if (std::abs(val) > config_.triggerThreshold) {
-      trigger();
+  if (!triggered_ && thresholdCounts_[0] > 0) {
+    for (int channel = 0; channel < kChannels; ++channel) {
+      if (std::abs(int64_t{sample.values[channel]}) >
+          thresholdCounts_[channel]) {
+        triggerIndex_ = ring_.written() - 1;
+        triggerTimestamp_ = sample.timestamp;
+        triggered_ = true;
+        LOG_INFO("SV Capture Triggered on {}",
+                 kChannelNames[static_cast<size_t>(channel)]);
+        break;
+      }
     }
   }
 
-  // If triggered, check if we have captured enough post-trigger samples
-  if (triggered_) {
-    // Logic to stop after duration...
+  // Enough post-trigger samples: keep the capture as it is
+  if (triggered_ &&
+      ring_.written() - triggerIndex_ >= samplesIn(config_.durationMs)) {
+    capturing_ = false;
+    LOG_INFO("SV Capture complete");
   }
 }
 
-bool SVWaveformCapture::exportCOMTRADE(const std::string &filename) {
-  std::lock_guard<std::mutex> lock(mutex_);
-
-  if (buffer_.empty())
-    return false;
+SVStreamFormat SVWaveformCapture::getFormat() const {
+  return unpackFormat(format_.load(std::memory_order_relaxed));
+}
 
-  std::ofstream cfg(filename + ".cfg");
-  std::ofstream dat(filename + ".dat");
+std::vector<SVSample> SVWaveformCapture::getSamples() const {
+  uint64_t end = ring_.written();
+  uint64_t window = samplesIn(config_.preTriggerMs + config_.durationMs);
+  uint64_t from = std::max(startIndex_.load(), end > window ? end - window : 0);
+  std::vector<SVSample> samples;
+  ring_.read(from, end, samples);
+  return samples;
+}
 
-  if (!cfg.is_open() || !dat.is_open()) {
-    LOG_ERROR("Failed to open files for COMTRADE export: {}", filename);
+bool SVWaveformCapture::exportCOMTRADE(const std::string &filename,
+                                       ComtradeFormat format) {
+  // A copy, so the receive thread goes on meanwhile
+  std::vector<SVSample> samples = getSamples();
+  if (samples.empty())
     return false;
-  }
 
-  // Write CFG (Simplified)
-  cfg << "STATION,DEVICE,1999" << std::endl;
-  cfg << "1,1A,0D" << std::endl; // 1 channel, 1 analog, 0 digital
-  cfg << "1,Ia,A,,V,1.0,0.0,0.0,-32768,32767,1.0,1.0,S" << std::endl;
-  cfg << "50" << std::endl;                         // Frequency
-  cfg << "1" << std::endl;                          // Sampling rates count
-  cfg << "4000," << buffer_.size() << std::endl;    // Rate, Last sample
-  cfg << "01/01/2023,00:00:00.000000" << std::endl; // Start time
-  cfg << "01/01/2023,00:00:01.000000" << std::endl; // Trigger time
-  cfg << "BINARY" << std::endl;
-  cfg << "1.0" << std::endl;
-
-  // Write DAT (ASCII for simplicity here, though CFG says BINARY, let's match
-  // CFG to ASCII for debug) Correcting CFG to ASCII cfg << "ASCII" <<
-  // std::endl;
-
-  size_t start = full_ ? head_ : 0;
-  size_t count = full_ ? buffer_.size() : head_;
-
-  for (size_t i = 0; i < count; ++i) {
-    size_t idx = (start + i) % buffer_.size();
-    const auto &s = buffer_[idx];
-    dat << (i + 1) << "," << s.timestamp << "," << s.value << std::endl;
+  SVStreamFormat streamFormat = getFormat();
+  ComtradeConfig config;
+  config.format = format;
+  config.sampleRate = streamFormat.sampleRate;
+  config.nominalFrequency = streamFormat.nominalFrequency;
+  ComtradeStream stream;
+  stream.name = config_.svID.empty() ? "SV" : config_.svID;
+  if (format == ComtradeFormat::Binary) {
+    for (const SVSample &sample : samples) {
+      for (int channel = 0; channel < kChannels; ++channel) {
+        stream.peak[channel] = std::max(
+            stream.peak[channel], std::abs(int64_t{sample.values[channel]}));
+      }
+    }
   }
+  config.streams.push_back(stream);
 
-  LOG_INFO("Exported COMTRADE to {}", filename);
-  return true;
+  ComtradeWriter writer(config);
+  if (!writer.open(filename))
+    return false;
+  for (const SVSample &sample : samples)
+    writer.write(&sample);
+  return writer.close(triggered_ ? triggerTimestamp_.load() : 0);
 }
 
 } // namespace sv
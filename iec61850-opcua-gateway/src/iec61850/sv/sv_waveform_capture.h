@@ -1,8 +1,12 @@
 #pragma once
 
+#include "comtrade_writer.h"
+#include "sample_clock.h"
+#include "sample_ring.h"
+#include "sv_sample.h"
 #include <atomic>
-#include <libiec61850/sv_subscriber.h>
-#include <mutex>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -10,22 +14,28 @@ namespace gateway {
 namespace iec61850 {
 namespace sv {
 
-struct SVSample {
-  uint64_t timestamp;
-  double value;
-  int quality;
-};
-
 struct CaptureConfig {
-  std::string svID;
+  std::string svID;              // Stream name in the COMTRADE export
   int durationMs = 1000;         // Capture duration
   int preTriggerMs = 200;        // Pre-trigger buffer
-  double triggerThreshold = 0.0; // 0 = manual trigger
+  double triggerThreshold = 0.0; // 0 = manual trigger, else A or V
 };
 
+/**
+ * @brief Pre- and post-trigger capture of one 9-2LE stream
+ *
+ * The caller decodes the stream and hands each sample to addSample().
+ * Samples go into a SampleRing that the receive thread fills without
+ * locks; exports and UI readers copy from it without holding the
+ * receive thread up. The capture completes, and stops taking samples,
+ * durationMs after the trigger.
+ */
 class SVWaveformCapture {
 public:
-  SVWaveformCapture();
+  // 4.2 s at 15360 Hz, 16 s at 4000 Hz
+  static constexpr size_t kDefaultCapacity = size_t{1} << 16;
+
+  explicit SVWaveformCapture(size_t capacity = kDefaultCapacity);
   ~SVWaveformCapture();
 
   void start(const CaptureConfig &config);
@@ -35,26 +45,49 @@ public:
   bool isCapturing() const;
   bool isTriggered() const;
 
-  // Export captured data to COMTRADE (CFG + DAT)
-  bool exportCOMTRADE(const std::string &filename);
+  /**
+   * @brief Export the captured samples to COMTRADE 2013, <filename>.cfg
+   * and <filename>.dat, from a copy taken without stopping the capture
+   */
+  bool exportCOMTRADE(const std::string &filename,
+                      ComtradeFormat format = ComtradeFormat::Binary32);
+
+  /**
+   * @brief Time and store a decoded sample; receive thread only
+   * @param arrivalUs Receive time, microseconds since the epoch
+   */
+  void addSample(SVSample sample, uint64_t arrivalUs);
+
+  // Nominal rate of the stream, detected from smpCnt
+  SVStreamFormat getFormat() const;
 
-  // Callback for libiec61850
-  void onSVMessage(SVSubscriber subscriber, void *parameter,
-                   SVSubscriber_ASDU asdu);
+  // Captured samples, oldest first: up to preTriggerMs + durationMs
+  std::vector<SVSample> getSamples() const;
+
+  uint64_t getLostSamples() const { return lost_.load(); }
 
 private:
+  // Samples in @p ms at the detected rate, as many as the ring holds
+  uint64_t samplesIn(int ms) const;
+
+  // Written by start() while not capturing, then read-only
   CaptureConfig config_;
-  std::vector<SVSample> buffer_;
-  size_t head_ = 0;
-  bool full_ = false;
+  int64_t thresholdCounts_[kChannels] = {}; // 0 = no threshold
+
+  // Receive thread only
+  SampleClock clock_;
+  SampleRing ring_;
+
+  // Published by the receive thread
+  std::atomic<uint64_t> format_;
+  std::atomic<uint64_t> lost_{0};
 
   std::atomic<bool> capturing_{false};
   std::atomic<bool> triggered_{false};
-  uint64_t triggerTimestamp_ = 0;
-
-  mutable std::mutex mutex_;
-  SVSubscriber subscriber_{nullptr};
-  SVReceiver receiver_{nullptr};
+  std::atomic<uint64_t> startIndex_{0};   // Ring index the capture began at
+  std::atomic<uint64_t> triggerIndex_{0}; // First sample from the trigger on
+  // Trigger time, microseconds since the epoch
+  std::atomic<uint64_t> triggerTimestamp_{0};
 };
 
 } // namespace sv
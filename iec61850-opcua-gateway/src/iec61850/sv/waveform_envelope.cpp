@@ -0,0 +1,129 @@
+#include "waveform_envelope.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+namespace {
+
+constexpr char kMagic[4] = {'G', 'W', 'W', 'F'};
+constexpr uint16_t kVersion = 1;
+constexpr size_t kHeaderSize = 32;
+
+// Start of bucket @p b of @p buckets over [fromUs, toUs)
+uint64_t edge(uint64_t fromUs, uint64_t toUs, size_t buckets, size_t b) {
+  // span * b / buckets, without overflowing span * b
+  return fromUs + (toUs - fromUs) / buckets * b +
+         (toUs - fromUs) % buckets * b / buckets;
+}
+
+template <typename T> void put(std::string &out, size_t &at, T value) {
+  std::memcpy(&out[at], &value, sizeof(value));
+  at += sizeof(value);
+}
+
+} // namespace
+
+void accumulateMinMax(const SVSample *samples, size_t count, int32_t *min,
+                      int32_t *max) {
+  int32_t lo[kChannels], hi[kChannels];
+  std::memcpy(lo, min, sizeof(lo));
+  std::memcpy(hi, max, sizeof(hi));
+  for (size_t i = 0; i < count; ++i) {
+    const int32_t *values = samples[i].values;
+    for (int ch = 0; ch < kChannels; ++ch) {
+      lo[ch] = values[ch] < lo[ch] ? values[ch] : lo[ch];
+      hi[ch] = values[ch] > hi[ch] ? values[ch] : hi[ch];
+    }
+  }
+  std::memcpy(min, lo, sizeof(lo));
+  std::memcpy(max, hi, sizeof(hi));
+}
+
+WaveformEnvelope
+envelope(const std::vector<std::shared_ptr<SampleSegment>> &segments,
+         uint64_t fromUs, uint64_t toUs, size_t buckets) {
+  WaveformEnvelope result;
+  result.fromUs = fromUs;
+  result.toUs = std::max(toUs, fromUs + 1);
+  result.buckets = std::max<size_t>(buckets, 1);
+  result.counts.assign(result.buckets, 0);
+  result.min.assign(result.buckets * kChannels,
+                    std::numeric_limits<int32_t>::max());
+  result.max.assign(result.buckets * kChannels,
+                    std::numeric_limits<int32_t>::min());
+
+  size_t b = 0;
+  uint64_t next = edge(result.fromUs, result.toUs, result.buckets, 1);
+  for (const auto &segment : segments) {
+    // The current segment grows meanwhile; take what it has now
+    uint64_t end = segment->endIndex();
+    if (end == segment->firstIndex() ||
+        segment->at(end - 1).timestamp < result.fromUs)
+      continue;
+    uint64_t i = std::min(segment->lowerBound(result.fromUs), end);
+    while (i < end) {
+      uint64_t j = std::min(segment->lowerBound(next), end);
+      if (j > i) {
+        accumulateMinMax(&segment->at(i), j - i,
+                         &result.min[b * kChannels],
+                         &result.max[b * kChannels]);
+        result.counts[b] += static_cast<uint32_t>(j - i);
+        result.samples += j - i;
+      }
+      i = j;
+      if (i == end)
+        break;
+      // Sample i is at or past the next edge
+      if (++b == result.buckets)
+        return result;
+      next = edge(result.fromUs, result.toUs, result.buckets, b + 1);
+    }
+  }
+  return result;
+}
+
+std::string encodeEnvelope(const WaveformEnvelope &envelope,
+                           uint16_t channelMask) {
+  size_t channels = 0;
+  for (int ch = 0; ch < kChannels; ++ch)
+    channels += (channelMask >> ch) & 1u;
+  const size_t n = envelope.buckets;
+  std::string out(kHeaderSize + channels * 2 * n * sizeof(float), '\0');
+
+  size_t at = 0;
+  std::memcpy(&out[at], kMagic, sizeof(kMagic));
+  at += sizeof(kMagic);
+  put(out, at, kVersion);
+  put(out, at, channelMask);
+  put(out, at, static_cast<uint32_t>(n));
+  put(out, at, static_cast<uint32_t>(
+                   std::min<uint64_t>(envelope.samples, UINT32_MAX)));
+  put(out, at, envelope.fromUs);
+  put(out, at, envelope.toUs);
+
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  std::vector<float> column(2 * n);
+  for (int ch = 0; ch < kChannels; ++ch) {
+    if (!((channelMask >> ch) & 1u))
+      continue;
+    const double scale = channelScale(ch);
+    for (size_t b = 0; b < n; ++b) {
+      bool empty = envelope.counts[b] == 0;
+      size_t k = b * kChannels + static_cast<size_t>(ch);
+      column[b] = empty ? nan : static_cast<float>(envelope.min[k] * scale);
+      column[n + b] =
+          empty ? nan : static_cast<float>(envelope.max[k] * scale);
+    }
+    std::memcpy(&out[at], column.data(), column.size() * sizeof(float));
+    at += column.size() * sizeof(float);
+  }
+  return out;
+}
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
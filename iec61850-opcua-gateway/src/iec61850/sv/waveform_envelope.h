@@ -0,0 +1,67 @@
+#pragma once
+
+#include "sample_segment.h"
+#include "sv_sample.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gateway {
+namespace iec61850 {
+namespace sv {
+
+/**
+ * @brief Min/max of every channel over equal time buckets of a range,
+ * as a waveform display needs one pixel column each
+ */
+struct WaveformEnvelope {
+  uint64_t fromUs = 0; // Range [fromUs, toUs), us since the epoch
+  uint64_t toUs = 0;
+  size_t buckets = 0;
+  uint64_t samples = 0; // In the range
+  std::vector<uint32_t> counts; // Samples per bucket, 0 = none there
+  // Counts, [bucket * kChannels + channel]; undefined where counts is 0
+  std::vector<int32_t> min;
+  std::vector<int32_t> max;
+};
+
+/**
+ * @brief Widen @p min / @p max, kChannels each, by @p count samples
+ */
+void accumulateMinMax(const SVSample *samples, size_t count, int32_t *min,
+                      int32_t *max);
+
+/**
+ * @brief Envelope of the samples of @p segments, oldest first, in
+ * [fromUs, toUs) split into @p buckets
+ *
+ * Bucket edges are found by binary search, so only the samples in the
+ * range are read, each once, in order.
+ */
+WaveformEnvelope
+envelope(const std::vector<std::shared_ptr<SampleSegment>> &segments,
+         uint64_t fromUs, uint64_t toUs, size_t buckets);
+
+/**
+ * @brief Binary encoding of the channels in @p channelMask (bit n =
+ * kChannelNames[n]) for a browser typed array, host byte order
+ *
+ *   0   char[4]  "GWWF"
+ *   4   uint16   version, 1
+ *   6   uint16   channel mask
+ *   8   uint32   buckets
+ *   12  uint32   samples in the range, saturated
+ *   16  uint64   fromUs
+ *   24  uint64   toUs
+ *   32  float32  per channel in mask order: min[buckets], max[buckets]
+ *
+ * Values are in A or V; buckets without samples are NaN.
+ */
+std::string encodeEnvelope(const WaveformEnvelope &envelope,
+                           uint16_t channelMask);
+
+} // namespace sv
+} // namespace iec61850
+} // namespace gateway
@@ -9,7 +9,12 @@ namespace opcua {
 DataBinder::DataBinder(std::shared_ptr<OPCUAServer> server)
     : server_(server), mmsConnections_(nullptr) {}
 
-DataBinder::~DataBinder() {}
+DataBinder::~DataBinder() {
+  std::lock_guard<std::mutex> lock(mapMutex_);
+  for (auto &pair : refToNodeMap_) {
+    UA_NodeId_clear(&pair.second);
+  }
+}
 
 void DataBinder::setMMSConnections(
     std::map<std::string,
@@ -19,14 +24,85 @@ void DataBinder::setMMSConnections(
 }
 
 bool DataBinder::bindDataPoint(const std::string &iec61850Ref,
-                               const UA_NodeId &opcuaNodeId) {
+                               const UA_NodeId &opcuaNodeId,
+                               const ReadPlan &plan) {
+  std::lock_guard<std::mutex> lock(mapMutex_);
+  bindLocked(iec61850Ref, opcuaNodeId, plan);
+  generation_++;
+
+  LOG_DEBUG("Bound {} to OPC UA Node", iec61850Ref);
+  return true;
+}
+
+size_t DataBinder::bindDataPoints(const std::vector<Binding> &bindings) {
+  std::lock_guard<std::mutex> lock(mapMutex_);
+
+  refToNodeMap_.reserve(refToNodeMap_.size() + bindings.size());
+  nodeToRefMap_.reserve(nodeToRefMap_.size() + bindings.size());
+  readPlans_.reserve(readPlans_.size() + bindings.size());
+
+  for (const auto &binding : bindings) {
+    bindLocked(binding.iec61850Ref, binding.nodeId, binding.plan);
+  }
+
+  generation_++;
+  LOG_INFO("Bound {} data points to OPC UA Nodes", bindings.size());
+  return bindings.size();
+}
+
+size_t
+DataBinder::unbindDataPoints(const std::vector<std::string> &iec61850Refs) {
   std::lock_guard<std::mutex> lock(mapMutex_);
 
+  size_t removed = 0;
+  for (const auto &ref : iec61850Refs) {
+    auto it = refToNodeMap_.find(ref);
+    if (it == refToNodeMap_.end())
+      continue;
+
+    UA_String nodeIdStr = UA_STRING_NULL;
+    UA_NodeId_print(&it->second, &nodeIdStr);
+    if (nodeIdStr.data) {
+      nodeToRefMap_.erase(
+          std::string((char *)nodeIdStr.data, nodeIdStr.length));
+      UA_String_clear(&nodeIdStr);
+    }
+
+    UA_NodeId_clear(&it->second);
+    refToNodeMap_.erase(it);
+    readPlans_.erase(ref);
+    removed++;
+  }
+
+  generation_++;
+  LOG_DEBUG("Unbound {} data points", removed);
+  return removed;
+}
+
+void DataBinder::bindLocked(const std::string &iec61850Ref,
+                            const UA_NodeId &opcuaNodeId,
+                            const ReadPlan &plan) {
   // Deep copy NodeId
   UA_NodeId nodeIdCopy;
   UA_NodeId_copy(&opcuaNodeId, &nodeIdCopy);
 
-  refToNodeMap_[iec61850Ref] = nodeIdCopy;
+  auto result = refToNodeMap_.emplace(iec61850Ref, nodeIdCopy);
+  if (!result.second) {
+    // Rebinding an existing reference: drop the previous node's reverse
+    // entry, so writes through it no longer reach this reference, and
+    // release the previous copy
+    UA_String oldNodeIdStr = UA_STRING_NULL;
+    UA_NodeId_print(&result.first->second, &oldNodeIdStr);
+    if (oldNodeIdStr.data) {
+      auto it = nodeToRefMap_.find(
+          std::string((char *)oldNodeIdStr.data, oldNodeIdStr.length));
+      if (it != nodeToRefMap_.end() && it->second == iec61850Ref)
+        nodeToRefMap_.erase(it);
+      UA_String_clear(&oldNodeIdStr);
+    }
+    UA_NodeId_clear(&result.first->second);
+    result.first->second = nodeIdCopy;
+  }
 
   // Also create reverse mapping for writes (NodeId string -> IEC61850 Ref)
   UA_String nodeIdStr = UA_STRING_NULL;
@@ -37,8 +113,7 @@ bool DataBinder::bindDataPoint(const std::string &iec61850Ref,
     UA_String_clear(&nodeIdStr);
   }
 
-  LOG_INFO("Bound {} to OPC UA Node", iec61850Ref);
-  return true;
+  readPlans_[iec61850Ref] = plan;
 }
 
 void DataBinder::updateValue(const std::string &iec61850Ref, MmsValue *value) {
@@ -126,18 +201,114 @@ std::vector<std::string> DataBinder::getBoundReferences() {
   return refs;
 }
 
+std::string DataBinder::getReference(const UA_NodeId &opcuaNodeId) {
+  UA_String nodeIdStr = UA_STRING_NULL;
+  UA_NodeId_print(&opcuaNodeId, &nodeIdStr);
+  if (!nodeIdStr.data)
+    return std::string();
+  std::string key((char *)nodeIdStr.data, nodeIdStr.length);
+  UA_String_clear(&nodeIdStr);
+
+  std::lock_guard<std::mutex> lock(mapMutex_);
+  auto it = nodeToRefMap_.find(key);
+  return it == nodeToRefMap_.end() ? std::string() : it->second;
+}
+
+bool DataBinder::getReadPlan(const std::string &iec61850Ref,
+                             ReadPlan *plan) {
+  std::lock_guard<std::mutex> lock(mapMutex_);
+  auto it = readPlans_.find(iec61850Ref);
+  if (it == readPlans_.end())
+    return false;
+  *plan = it->second;
+  return true;
+}
+
+bool DataBinder::getNodeId(const std::string &iec61850Ref,
+                           UA_NodeId *nodeId) {
+  std::lock_guard<std::mutex> lock(mapMutex_);
+  auto it = refToNodeMap_.find(iec61850Ref);
+  if (it == refToNodeMap_.end())
+    return false;
+  return UA_NodeId_copy(&it->second, nodeId) == UA_STATUSCODE_GOOD;
+}
+
 void DataBinder::setWriteCallback(const UA_NodeId &opcuaNodeId) {
+  UA_String nodeIdStr = UA_STRING_NULL;
+  UA_NodeId_print(&opcuaNodeId, &nodeIdStr);
+  if (nodeIdStr.data) {
+    std::lock_guard<std::mutex> lock(mapMutex_);
+    writableNodes_.emplace((char *)nodeIdStr.data, nodeIdStr.length);
+    UA_String_clear(&nodeIdStr);
+  }
+  installCallbacks(opcuaNodeId, true);
+}
+
+void DataBinder::setSampleHook(SampleHook hook) {
+  std::lock_guard<std::mutex> lock(hookMutex_);
+  sampleHook_ = std::move(hook);
+}
+
+void DataBinder::setWriteHook(WriteHook hook) {
+  std::lock_guard<std::mutex> lock(hookMutex_);
+  writeHook_ = std::move(hook);
+}
+
+void DataBinder::trackSampling(const UA_NodeId &opcuaNodeId) {
+  bool writable = false;
+  UA_String nodeIdStr = UA_STRING_NULL;
+  UA_NodeId_print(&opcuaNodeId, &nodeIdStr);
+  if (nodeIdStr.data) {
+    std::lock_guard<std::mutex> lock(mapMutex_);
+    writable = writableNodes_.count(
+                   std::string((char *)nodeIdStr.data, nodeIdStr.length)) > 0;
+    UA_String_clear(&nodeIdStr);
+  }
+  installCallbacks(opcuaNodeId, writable);
+}
+
+void DataBinder::installCallbacks(const UA_NodeId &opcuaNodeId,
+                                  bool writable) {
   UA_Server *uaServer = server_->getNativeServer();
 
   UA_ValueCallback callback;
-  callback.onRead = nullptr;
-  callback.onWrite = writeCallback;
+  callback.onRead = readCallback;
+  callback.onWrite = writable ? writeCallback : nullptr;
 
   // Pass this DataBinder instance as node context
   UA_Server_setNodeContext(uaServer, opcuaNodeId, this);
   UA_Server_setVariableNode_valueCallback(uaServer, opcuaNodeId, callback);
 }
 
+void DataBinder::readCallback(UA_Server *server, const UA_NodeId *sessionId,
+                              void *sessionContext, const UA_NodeId *nodeId,
+                              void *nodeContext, const UA_NumericRange *range,
+                              const UA_DataValue *data) {
+  (void)server;
+  (void)sessionId;
+  (void)sessionContext;
+  (void)range;
+  (void)data;
+
+  // Invoked for monitored item sampling as well as Read requests
+  DataBinder *binder = static_cast<DataBinder *>(nodeContext);
+  if (!binder || !nodeId) {
+    return;
+  }
+
+  SampleHook hook;
+  {
+    std::lock_guard<std::mutex> lock(binder->hookMutex_);
+    hook = binder->sampleHook_;
+  }
+  if (!hook)
+    return;
+
+  std::string ref = binder->getReference(*nodeId);
+  if (!ref.empty())
+    hook(ref);
+}
+
 void DataBinder::writeCallback(UA_Server *server, const UA_NodeId *sessionId,
                                void *sessionContext, const UA_NodeId *nodeId,
                                void *nodeContext, const UA_NumericRange *range,
@@ -160,13 +331,14 @@ void DataBinder::writeCallback(UA_Server *server, const UA_NodeId *sessionId,
 
 void DataBinder::handleWrite(const std::string &nodeIdStr,
                              const UA_Variant *value) {
-  if (!value || !mmsConnections_) {
-    LOG_WARN("Write failed: no value or no MMS connections");
+  if (!value) {
+    LOG_WARN("Write failed: no value");
     return;
   }
 
-  // Find IEC61850 reference
+  // Find IEC61850 reference and the plan it was bound with
   std::string iec61850Ref;
+  ReadPlan plan;
   {
     std::lock_guard<std::mutex> lock(mapMutex_);
     auto it = nodeToRefMap_.find(nodeIdStr);
@@ -175,6 +347,71 @@ void DataBinder::handleWrite(const std::string &nodeIdStr,
       return;
     }
     iec61850Ref = it->second;
+    auto planIt = readPlans_.find(iec61850Ref);
+    if (planIt != readPlans_.end())
+      plan = planIt->second;
+  }
+
+  // A DPC stVal node is a UInt32 Dbpos (0 intermediate, 1 off, 2 on,
+  // 3 bad); any other UInt32 is a plain unsigned value
+  bool scalar = UA_Variant_isScalar(value);
+  bool dbpos = scalar && plan.cdc == "DPC" &&
+               value->type == &UA_TYPES[UA_TYPES_UINT32];
+  if (dbpos && *(UA_UInt32 *)value->data > 3) {
+    LOG_WARN("Write of Dbpos {} to {} rejected", *(UA_UInt32 *)value->data,
+             iec61850Ref);
+    return;
+  }
+
+  // Points the gateway publishes itself (GOOSE) never reach MMS. The hook
+  // gets the value as written, a Dbpos as its 2-bit string.
+  WriteHook hook;
+  {
+    std::lock_guard<std::mutex> lock(hookMutex_);
+    hook = writeHook_;
+  }
+  if (hook && scalar) {
+    MmsValue *hookValue = nullptr;
+    if (value->type == &UA_TYPES[UA_TYPES_BOOLEAN]) {
+      hookValue = MmsValue_newBoolean(*(UA_Boolean *)value->data);
+    } else if (value->type == &UA_TYPES[UA_TYPES_FLOAT]) {
+      hookValue = MmsValue_newFloat(*(UA_Float *)value->data);
+    } else if (value->type == &UA_TYPES[UA_TYPES_DOUBLE]) {
+      hookValue = MmsValue_newDouble(*(UA_Double *)value->data);
+    } else if (value->type == &UA_TYPES[UA_TYPES_INT32]) {
+      hookValue = MmsValue_newIntegerFromInt32(*(UA_Int32 *)value->data);
+    } else if (dbpos) {
+      hookValue = MmsValue_newBitString(2);
+      MmsValue_setBitStringFromInteger(hookValue, *(UA_UInt32 *)value->data);
+    } else if (value->type == &UA_TYPES[UA_TYPES_UINT32]) {
+      hookValue = MmsValue_newUnsignedFromUint32(*(UA_UInt32 *)value->data);
+    }
+    bool handled = hookValue && hook(iec61850Ref, hookValue);
+    if (hookValue)
+      MmsValue_delete(hookValue);
+    if (handled)
+      return;
+  }
+
+  // A DPC is operated like a Boolean: DBPOS_ON (2) closes, DBPOS_OFF (1)
+  // opens; the intermediate and bad states cannot be commanded.
+  UA_Boolean dbposOn = false;
+  UA_Variant dbposValue;
+  if (dbpos) {
+    UA_UInt32 state = *(UA_UInt32 *)value->data;
+    if (state != 1 && state != 2) {
+      LOG_WARN("Control of Dbpos {} to {} rejected: only off (1) or on (2)",
+               state, iec61850Ref);
+      return;
+    }
+    dbposOn = state == 2;
+    UA_Variant_setScalar(&dbposValue, &dbposOn, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    value = &dbposValue;
+  }
+
+  if (!mmsConnections_) {
+    LOG_WARN("Write failed: no MMS connections");
+    return;
   }
 
   // Parse reference: "IEDName/LD/LN.DO"
@@ -1,11 +1,16 @@
 #pragma once
 
 #include "opcua_server.h"
+#include <atomic>
+#include <functional>
 #include <libiec61850/mms_value.h>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 // Forward declaration
 namespace gateway {
@@ -24,11 +29,40 @@ public:
   DataBinder(std::shared_ptr<OPCUAServer> server);
   ~DataBinder();
 
+  /**
+   * @brief How a bound point is read from and written to its IED
+   */
+  struct ReadPlan {
+    std::string attribute; // DA below the DO, e.g. "stVal", "cVal.mag.f"
+    std::string fc;        // Functional constraint of that DA, e.g. "MX"
+    std::string cdc;       // CDC of the DO, e.g. "DPC"
+  };
+
   // Bind IEC61850 data point to OPC UA variable
-  // iec61850Ref: "IEDName/LD/LN.DO.DA" (e.g.
-  // "TestIED/simpleIO/GGIO1.SPCSO1.stVal")
+  // iec61850Ref: "IEDName/LD/LN.DO" (e.g. "TestIED/simpleIO/GGIO1.SPCSO1")
   bool bindDataPoint(const std::string &iec61850Ref,
-                     const UA_NodeId &opcuaNodeId);
+                     const UA_NodeId &opcuaNodeId,
+                     const ReadPlan &plan = ReadPlan());
+
+  struct Binding {
+    std::string iec61850Ref;
+    UA_NodeId nodeId; // Deep-copied by bindDataPoints()
+    ReadPlan plan;
+  };
+
+  /**
+   * @brief Bind a batch of data points under a single lock
+   * @param bindings Points to bind; maps are grown once for the whole batch
+   * @return Number of points bound
+   */
+  size_t bindDataPoints(const std::vector<Binding> &bindings);
+
+  /**
+   * @brief Remove bindings, e.g. for nodes deleted from the address space
+   * @param iec61850Refs References to unbind; unknown ones are ignored
+   * @return Number of points actually unbound
+   */
+  size_t unbindDataPoints(const std::vector<std::string> &iec61850Refs);
 
   // Update OPC UA variable from IEC61850 value
   void updateValue(const std::string &iec61850Ref, MmsValue *value);
@@ -39,11 +73,68 @@ public:
    */
   std::vector<std::string> getBoundReferences();
 
+  /**
+   * @brief Bumped on every bind/unbind, so pollers can tell when to refresh
+   * their copy of getBoundReferences()
+   */
+  uint64_t getGeneration() const { return generation_.load(); }
+
+  /**
+   * @brief Get the IEC61850 reference bound to a node
+   * @return Reference, or empty if the node is not bound
+   */
+  std::string getReference(const UA_NodeId &opcuaNodeId);
+
+  /**
+   * @brief Get the read plan a reference was bound with
+   * @return false if the reference is not bound
+   */
+  bool getReadPlan(const std::string &iec61850Ref, ReadPlan *plan);
+
+  /**
+   * @brief Get the node bound to an IEC61850 reference
+   * @param nodeId Receives a deep copy of the NodeId
+   * @return false if the reference is not bound
+   */
+  bool getNodeId(const std::string &iec61850Ref, UA_NodeId *nodeId);
+
   /**
    * @brief Set write callback for a controllable node
    */
   void setWriteCallback(const UA_NodeId &opcuaNodeId);
 
+  using SampleHook = std::function<void(const std::string &iec61850Ref)>;
+
+  /**
+   * @brief Install a hook called whenever the server reads a tracked node
+   */
+  void setSampleHook(SampleHook hook);
+
+  /**
+   * @brief Offered every OPC UA write before it becomes an MMS control
+   * @param iec61850Ref Reference of the written node
+   * @param value The written value
+   * @return true if the write was handled, e.g. published as GOOSE
+   */
+  using WriteHook =
+      std::function<bool(const std::string &iec61850Ref,
+                         const MmsValue *value)>;
+
+  void setWriteHook(WriteHook hook);
+
+  /**
+   * @brief Report server-side reads of a bound node to the sample hook.
+   * Keeps the write callback if one was set.
+   */
+  void trackSampling(const UA_NodeId &opcuaNodeId);
+
+  /**
+   * @brief Apply a client write of a bound node: offered to the write hook,
+   * else sent to the IED as an MMS control or write
+   * @param nodeIdStr Printed NodeId of the written node
+   */
+  void handleWrite(const std::string &nodeIdStr, const UA_Variant *value);
+
   /**
    * @brief Set MMS connections map for write operations
    */
@@ -56,21 +147,40 @@ private:
   std::shared_ptr<OPCUAServer> server_;
 
   // Map IEC61850 Ref -> OPC UA NodeId
-  std::map<std::string, UA_NodeId> refToNodeMap_;
+  std::unordered_map<std::string, UA_NodeId> refToNodeMap_;
 
   // Reverse map: NodeId string -> IEC61850 Ref (for writes)
-  std::map<std::string, std::string> nodeToRefMap_;
+  std::unordered_map<std::string, std::string> nodeToRefMap_;
+
+  // IEC61850 Ref -> read plan, for polling and writes
+  std::unordered_map<std::string, ReadPlan> readPlans_;
 
   // Pointer to MMS connections (owned by RESTApi)
   std::map<std::string, std::shared_ptr<gateway::iec61850::mms::MMSConnection>>
       *mmsConnections_;
 
   std::mutex mapMutex_;
+  std::atomic<uint64_t> generation_{0};
 
-  // Write callback handler
-  void handleWrite(const std::string &nodeIdStr, const UA_Variant *value);
+  // Printed NodeIds with a write callback, so trackSampling() keeps it
+  std::unordered_set<std::string> writableNodes_;
+
+  std::mutex hookMutex_;
+  SampleHook sampleHook_;
+  WriteHook writeHook_;
+
+  // Install the value callbacks for a node; caller does not hold mapMutex_
+  void installCallbacks(const UA_NodeId &opcuaNodeId, bool writable);
+
+  // Insert one binding; caller holds mapMutex_
+  void bindLocked(const std::string &iec61850Ref, const UA_NodeId &opcuaNodeId,
+                  const ReadPlan &plan);
 
-  // Static callback wrapper
+  // Static callback wrappers
+  static void readCallback(UA_Server *server, const UA_NodeId *sessionId,
+                           void *sessionContext, const UA_NodeId *nodeId,
+                           void *nodeContext, const UA_NumericRange *range,
+                           const UA_DataValue *data);
   static void writeCallback(UA_Server *server, const UA_NodeId *sessionId,
                             void *sessionContext, const UA_NodeId *nodeId,
                             void *nodeContext, const UA_NumericRange *range,
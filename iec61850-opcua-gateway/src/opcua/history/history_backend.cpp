@@ -0,0 +1,377 @@
+#include "history_backend.h"
+#include "core/logger.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace gateway {
+namespace opcua {
+namespace history {
+
+namespace {
+
+// Upper bound on values returned per node and request
+constexpr UA_UInt32 kMaxReturnValues = 10000;
+
+// Continuation point: timestamp of the last returned sample and the number of
+// samples already returned at exactly that timestamp
+constexpr size_t kContinuationSize = sizeof(int64_t) + sizeof(uint32_t);
+
+int64_t toUnixMs(UA_DateTime t) {
+  return (t - UA_DATETIME_UNIX_EPOCH) / UA_DATETIME_MSEC;
+}
+
+UA_DateTime fromUnixMs(int64_t ms) {
+  return ms * UA_DATETIME_MSEC + UA_DATETIME_UNIX_EPOCH;
+}
+
+// Unset (zero) bounds mean "open ended"
+int64_t startBound(UA_DateTime t) {
+  return t == 0 ? std::numeric_limits<int64_t>::min() : toUnixMs(t);
+}
+
+int64_t endBound(UA_DateTime t) {
+  return t == 0 ? std::numeric_limits<int64_t>::max() : toUnixMs(t);
+}
+
+bool toDouble(const UA_Variant &v, double *out) {
+  if (!v.data || !UA_Variant_isScalar(&v))
+    return false;
+  if (v.type == &UA_TYPES[UA_TYPES_BOOLEAN]) {
+    *out = *static_cast<const UA_Boolean *>(v.data) ? 1.0 : 0.0;
+  } else if (v.type == &UA_TYPES[UA_TYPES_INT32]) {
+    *out = *static_cast<const UA_Int32 *>(v.data);
+  } else if (v.type == &UA_TYPES[UA_TYPES_UINT32]) {
+    *out = *static_cast<const UA_UInt32 *>(v.data);
+  } else if (v.type == &UA_TYPES[UA_TYPES_FLOAT]) {
+    *out = *static_cast<const UA_Float *>(v.data);
+  } else if (v.type == &UA_TYPES[UA_TYPES_DOUBLE]) {
+    *out = *static_cast<const UA_Double *>(v.data);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Write @p value back as the node's own data type
+void setVariant(UA_Variant &v, double value, const UA_DataType *type) {
+  if (type == &UA_TYPES[UA_TYPES_BOOLEAN]) {
+    UA_Boolean b = value != 0.0;
+    UA_Variant_setScalarCopy(&v, &b, type);
+  } else if (type == &UA_TYPES[UA_TYPES_INT32]) {
+    UA_Int32 i = static_cast<UA_Int32>(value);
+    UA_Variant_setScalarCopy(&v, &i, type);
+  } else if (type == &UA_TYPES[UA_TYPES_UINT32]) {
+    UA_UInt32 u = static_cast<UA_UInt32>(value);
+    UA_Variant_setScalarCopy(&v, &u, type);
+  } else if (type == &UA_TYPES[UA_TYPES_FLOAT]) {
+    UA_Float f = static_cast<UA_Float>(value);
+    UA_Variant_setScalarCopy(&v, &f, type);
+  } else {
+    UA_Variant_setScalarCopy(&v, &value, &UA_TYPES[UA_TYPES_DOUBLE]);
+  }
+}
+
+const UA_DataType *nodeDataType(UA_Server *server, const UA_NodeId &nodeId) {
+  static const UA_DataType *const kTypes[] = {
+      &UA_TYPES[UA_TYPES_BOOLEAN], &UA_TYPES[UA_TYPES_INT32],
+      &UA_TYPES[UA_TYPES_UINT32], &UA_TYPES[UA_TYPES_FLOAT]};
+
+  UA_NodeId typeId;
+  if (UA_Server_readDataType(server, nodeId, &typeId) != UA_STATUSCODE_GOOD)
+    return &UA_TYPES[UA_TYPES_DOUBLE];
+  const UA_DataType *result = &UA_TYPES[UA_TYPES_DOUBLE];
+  for (const UA_DataType *type : kTypes) {
+    if (UA_NodeId_equal(&typeId, &type->typeId)) {
+      result = type;
+      break;
+    }
+  }
+  UA_NodeId_clear(&typeId);
+  return result;
+}
+
+void fillHistoryData(UA_HistoryData *data,
+                     const std::vector<storage::HistorySample> &samples,
+                     const UA_DataType *type,
+                     UA_TimestampsToReturn timestampsToReturn) {
+  data->dataValuesSize = 0;
+  data->dataValues = nullptr;
+  if (samples.empty())
+    return;
+
+  data->dataValues = static_cast<UA_DataValue *>(
+      UA_Array_new(samples.size(), &UA_TYPES[UA_TYPES_DATAVALUE]));
+  if (!data->dataValues)
+    return;
+  data->dataValuesSize = samples.size();
+
+  bool source = timestampsToReturn == UA_TIMESTAMPSTORETURN_SOURCE ||
+                timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH;
+  bool server = timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER ||
+                timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH;
+  for (size_t i = 0; i < samples.size(); ++i) {
+    UA_DataValue &dv = data->dataValues[i];
+    const storage::HistorySample &s = samples[i];
+    UA_DateTime ts = fromUnixMs(s.timestampMs);
+    if ((s.status & 0x80000000u) == 0) {
+      setVariant(dv.value, s.value, type);
+      dv.hasValue = true;
+    }
+    dv.status = s.status;
+    dv.hasStatus = s.status != UA_STATUSCODE_GOOD;
+    dv.sourceTimestamp = ts;
+    dv.hasSourceTimestamp = source;
+    dv.serverTimestamp = ts;
+    dv.hasServerTimestamp = server;
+  }
+}
+
+bool decodeContinuation(const UA_ByteString &cp, int64_t *ts,
+                        uint32_t *skip) {
+  if (cp.length != kContinuationSize)
+    return false;
+  std::memcpy(ts, cp.data, sizeof(int64_t));
+  std::memcpy(skip, cp.data + sizeof(int64_t), sizeof(uint32_t));
+  return true;
+}
+
+void encodeContinuation(UA_ByteString &cp, int64_t ts, uint32_t skip) {
+  if (UA_ByteString_allocBuffer(&cp, kContinuationSize) != UA_STATUSCODE_GOOD)
+    return;
+  std::memcpy(cp.data, &ts, sizeof(int64_t));
+  std::memcpy(cp.data + sizeof(int64_t), &skip, sizeof(uint32_t));
+}
+
+bool toAggregate(const UA_NodeId &id, storage::HistoryAggregate *out) {
+  if (id.namespaceIndex != 0 || id.identifierType != UA_NODEIDTYPE_NUMERIC)
+    return false;
+  switch (id.identifier.numeric) {
+  case UA_NS0ID_AGGREGATEFUNCTION_AVERAGE:
+    *out = storage::HistoryAggregate::Average;
+    return true;
+  case UA_NS0ID_AGGREGATEFUNCTION_MINIMUM:
+    *out = storage::HistoryAggregate::Minimum;
+    return true;
+  case UA_NS0ID_AGGREGATEFUNCTION_MAXIMUM:
+    *out = storage::HistoryAggregate::Maximum;
+    return true;
+  case UA_NS0ID_AGGREGATEFUNCTION_COUNT:
+    *out = storage::HistoryAggregate::Count;
+    return true;
+  default:
+    return false;
+  }
+}
+
+} // namespace
+
+HistoryBackend::HistoryBackend(std::shared_ptr<OPCUAServer> server,
+                               std::shared_ptr<storage::HistoryStore> store)
+    : server_(server), store_(store) {
+  if (!server_ || !server_->getNativeServer() || !store_)
+    return;
+
+  UA_ServerConfig *config = UA_Server_getConfig(server_->getNativeServer());
+  UA_HistoryDatabase &hdb = config->historyDatabase;
+  if (hdb.clear)
+    hdb.clear(&hdb);
+  std::memset(&hdb, 0, sizeof(hdb));
+  hdb.context = this;
+  hdb.clear = &HistoryBackend::clear;
+  hdb.setValue = &HistoryBackend::setValue;
+  hdb.readRaw = &HistoryBackend::readRaw;
+  hdb.readProcessed = &HistoryBackend::readProcessed;
+
+  config->accessHistoryDataCapability = true;
+  config->maxReturnDataValues = kMaxReturnValues;
+  config->insertDataCapability = false;
+
+  LOG_INFO("OPC UA history backend installed");
+}
+
+HistoryBackend::~HistoryBackend() {
+  if (!server_ || !server_->getNativeServer())
+    return;
+  UA_ServerConfig *config = UA_Server_getConfig(server_->getNativeServer());
+  if (config->historyDatabase.context == this) {
+    std::memset(&config->historyDatabase, 0, sizeof(UA_HistoryDatabase));
+    config->accessHistoryDataCapability = false;
+  }
+}
+
+std::string HistoryBackend::nodeKey(const UA_NodeId &nodeId) {
+  UA_String printed = UA_STRING_NULL;
+  if (UA_NodeId_print(&nodeId, &printed) != UA_STATUSCODE_GOOD)
+    return std::string();
+  std::string key(reinterpret_cast<const char *>(printed.data),
+                  printed.length);
+  UA_String_clear(&printed);
+  return key;
+}
+
+void HistoryBackend::clear(UA_HistoryDatabase *hdb) {
+  // The backend is owned by the gateway, not by the server
+  hdb->context = nullptr;
+}
+
+void HistoryBackend::setValue(UA_Server *server, void *hdbContext,
+                              const UA_NodeId *sessionId, void *sessionContext,
+                              const UA_NodeId *nodeId, UA_Boolean historizing,
+                              const UA_DataValue *value) {
+  (void)server;
+  (void)sessionId;
+  (void)sessionContext;
+  auto *self = static_cast<HistoryBackend *>(hdbContext);
+  if (!self || !historizing || !nodeId || !value || !value->hasValue)
+    return;
+
+  double v;
+  if (!toDouble(value->value, &v))
+    return;
+
+  UA_DateTime ts = value->hasSourceTimestamp   ? value->sourceTimestamp
+                   : value->hasServerTimestamp ? value->serverTimestamp
+                                               : UA_DateTime_now();
+  UA_StatusCode status = value->hasStatus ? value->status : UA_STATUSCODE_GOOD;
+  self->store_->append(nodeKey(*nodeId), toUnixMs(ts), v, status);
+}
+
+void HistoryBackend::readRaw(
+    UA_Server *server, void *hdbContext, const UA_NodeId *sessionId,
+    void *sessionContext, const UA_RequestHeader *requestHeader,
+    const UA_ReadRawModifiedDetails *details,
+    UA_TimestampsToReturn timestampsToReturn,
+    UA_Boolean releaseContinuationPoints, size_t nodesToReadSize,
+    const UA_HistoryReadValueId *nodesToRead, UA_HistoryReadResponse *response,
+    UA_HistoryData *const *const historyData) {
+  (void)sessionId;
+  (void)sessionContext;
+  (void)requestHeader;
+  auto *self = static_cast<HistoryBackend *>(hdbContext);
+  if (!self) {
+    response->responseHeader.serviceResult = UA_STATUSCODE_BADINTERNALERROR;
+    return;
+  }
+  if (details->isReadModified) {
+    response->responseHeader.serviceResult =
+        UA_STATUSCODE_BADHISTORYOPERATIONUNSUPPORTED;
+    return;
+  }
+  if (releaseContinuationPoints)
+    return; // Continuation points carry no server-side state
+
+  int64_t start = startBound(details->startTime);
+  int64_t end = endBound(details->endTime);
+  // startTime after endTime asks for reverse order
+  bool reverse = details->startTime != 0 && details->endTime != 0 &&
+                 details->startTime > details->endTime;
+  if (reverse)
+    std::swap(start, end);
+
+  size_t limit = details->numValuesPerNode ? details->numValuesPerNode
+                                           : kMaxReturnValues;
+  limit = std::min<size_t>(limit, kMaxReturnValues);
+
+  for (size_t i = 0; i < nodesToReadSize; ++i) {
+    UA_HistoryReadResult &result = response->results[i];
+    const UA_HistoryReadValueId &node = nodesToRead[i];
+    std::string key = nodeKey(node.nodeId);
+    std::vector<storage::HistorySample> samples;
+
+    if (reverse) {
+      // Newest first; the ring is short, so no continuation is offered
+      self->store_->readRaw(key, start, end, 0, 0, samples);
+      std::reverse(samples.begin(), samples.end());
+      if (samples.size() > limit)
+        samples.resize(limit);
+    } else {
+      int64_t from = start;
+      uint32_t skip = 0;
+      if (node.continuationPoint.length > 0 &&
+          !decodeContinuation(node.continuationPoint, &from, &skip)) {
+        result.statusCode = UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+        continue;
+      }
+
+      bool more = self->store_->readRaw(key, from, end, skip, limit, samples);
+      if (more && !samples.empty()) {
+        int64_t last = samples.back().timestampMs;
+        uint32_t atLast = last == from ? skip : 0;
+        for (auto it = samples.rbegin();
+             it != samples.rend() && it->timestampMs == last; ++it)
+          atLast++;
+        encodeContinuation(result.continuationPoint, last, atLast);
+      }
+    }
+
+    fillHistoryData(historyData[i], samples,
+                    nodeDataType(server, node.nodeId), timestampsToReturn);
+    result.statusCode =
+        samples.empty() ? UA_STATUSCODE_GOODNODATA : UA_STATUSCODE_GOOD;
+    if (result.continuationPoint.length > 0)
+      result.statusCode = UA_STATUSCODE_GOODMOREDATA;
+  }
+}
+
+void HistoryBackend::readProcessed(
+    UA_Server *server, void *hdbContext, const UA_NodeId *sessionId,
+    void *sessionContext, const UA_RequestHeader *requestHeader,
+    const UA_ReadProcessedDetails *details,
+    UA_TimestampsToReturn timestampsToReturn,
+    UA_Boolean releaseContinuationPoints, size_t nodesToReadSize,
+    const UA_HistoryReadValueId *nodesToRead, UA_HistoryReadResponse *response,
+    UA_HistoryData *const *const historyData) {
+  (void)server;
+  (void)sessionId;
+  (void)sessionContext;
+  (void)requestHeader;
+  auto *self = static_cast<HistoryBackend *>(hdbContext);
+  if (!self) {
+    response->responseHeader.serviceResult = UA_STATUSCODE_BADINTERNALERROR;
+    return;
+  }
+  if (releaseContinuationPoints)
+    return;
+  // One aggregate per node to read
+  if (details->aggregateTypeSize != nodesToReadSize) {
+    response->responseHeader.serviceResult = UA_STATUSCODE_BADINVALIDARGUMENT;
+    return;
+  }
+  if (details->startTime == 0 || details->endTime == 0 ||
+      details->startTime >= details->endTime) {
+    response->responseHeader.serviceResult =
+        UA_STATUSCODE_BADHISTORYOPERATIONINVALID;
+    return;
+  }
+
+  int64_t start = toUnixMs(details->startTime);
+  int64_t end = toUnixMs(details->endTime);
+  auto interval = static_cast<int64_t>(details->processingInterval);
+
+  for (size_t i = 0; i < nodesToReadSize; ++i) {
+    UA_HistoryReadResult &result = response->results[i];
+    storage::HistoryAggregate aggregate;
+    if (!toAggregate(details->aggregateType[i], &aggregate)) {
+      result.statusCode = UA_STATUSCODE_BADAGGREGATENOTSUPPORTED;
+      continue;
+    }
+
+    std::vector<storage::HistorySample> samples;
+    self->store_->readProcessed(nodeKey(nodesToRead[i].nodeId), start, end,
+                                interval, aggregate, UA_STATUSCODE_BADNODATA,
+                                samples);
+
+    // Count is an Int32; the other aggregates are computed as Double
+    const UA_DataType *type = aggregate == storage::HistoryAggregate::Count
+                                  ? &UA_TYPES[UA_TYPES_INT32]
+                                  : &UA_TYPES[UA_TYPES_DOUBLE];
+    fillHistoryData(historyData[i], samples, type, timestampsToReturn);
+    result.statusCode = UA_STATUSCODE_GOOD;
+  }
+}
+
+} // namespace history
+} // namespace opcua
+} // namespace gateway
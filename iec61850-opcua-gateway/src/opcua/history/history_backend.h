@@ -0,0 +1,63 @@
+#pragma once
+
+#include "opcua/opcua_server.h"
+#include "storage/history_store.h"
+#include <memory>
+#include <string>
+
+namespace gateway {
+namespace opcua {
+namespace history {
+
+/**
+ * @brief OPC UA history database backed by the gateway-local HistoryStore
+ *
+ * Installed as the server's history database plug-in: every value written
+ * to a node with Historizing set is appended to the store, and HistoryRead
+ * (raw and processed) requests are answered from it without any external
+ * database.
+ */
+class HistoryBackend {
+public:
+  HistoryBackend(std::shared_ptr<OPCUAServer> server,
+                 std::shared_ptr<storage::HistoryStore> store);
+  ~HistoryBackend();
+
+  /** @brief Store key of a node */
+  static std::string nodeKey(const UA_NodeId &nodeId);
+
+private:
+  std::shared_ptr<OPCUAServer> server_;
+  std::shared_ptr<storage::HistoryStore> store_;
+
+  // UA_HistoryDatabase callbacks; hdbContext is the HistoryBackend
+  static void clear(UA_HistoryDatabase *hdb);
+  static void setValue(UA_Server *server, void *hdbContext,
+                       const UA_NodeId *sessionId, void *sessionContext,
+                       const UA_NodeId *nodeId, UA_Boolean historizing,
+                       const UA_DataValue *value);
+  static void readRaw(UA_Server *server, void *hdbContext,
+                      const UA_NodeId *sessionId, void *sessionContext,
+                      const UA_RequestHeader *requestHeader,
+                      const UA_ReadRawModifiedDetails *details,
+                      UA_TimestampsToReturn timestampsToReturn,
+                      UA_Boolean releaseContinuationPoints,
+                      size_t nodesToReadSize,
+                      const UA_HistoryReadValueId *nodesToRead,
+                      UA_HistoryReadResponse *response,
+                      UA_HistoryData *const *const historyData);
+  static void readProcessed(UA_Server *server, void *hdbContext,
+                            const UA_NodeId *sessionId, void *sessionContext,
+                            const UA_RequestHeader *requestHeader,
+                            const UA_ReadProcessedDetails *details,
+                            UA_TimestampsToReturn timestampsToReturn,
+                            UA_Boolean releaseContinuationPoints,
+                            size_t nodesToReadSize,
+                            const UA_HistoryReadValueId *nodesToRead,
+                            UA_HistoryReadResponse *response,
+                            UA_HistoryData *const *const historyData);
+};
+
+} // namespace history
+} // namespace opcua
+} // namespace gateway
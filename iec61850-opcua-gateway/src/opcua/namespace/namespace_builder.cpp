@@ -1,17 +1,115 @@
 #include "namespace_builder.h"
 #include "core/logger.h"
+#include "namespace_snapshot.h"
 #include "iec61850/scl/scl_parser.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
 #include <string>
+#include <unordered_set>
 
 namespace gateway {
 namespace opcua {
 namespace ns {
 
-// Helper function to convert UA_String to std::string
 namespace {
-std::string UA_String_to_std_string(const UA_String &uaStr) {
-  return std::string((char *)uaStr.data, uaStr.length);
+
+// Errors beyond this count are only reflected in BuildStats::failedNodes
+constexpr size_t kMaxReportedFailures = 10;
+
+// Descriptions shared by every node of a kind instead of built per node
+const UA_LocalizedText kLDDescription =
+    UA_LOCALIZEDTEXT((char *)"en", (char *)"Logical Device");
+const UA_LocalizedText kLNDescription =
+    UA_LOCALIZEDTEXT((char *)"en", (char *)"Logical Node");
+const UA_LocalizedText kDODescription =
+    UA_LOCALIZEDTEXT((char *)"en", (char *)"Data Object");
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+bool isControllable(const std::string &cdc) {
+  return cdc == "SPC" || cdc == "DPC" || cdc == "APC";
+}
+
+// Nodes whose value is fed by the DataBinder
+bool isBindingTarget(const NodePlan &node) {
+  return (node.kind == NodePlan::Kind::DataObject ||
+          node.kind == NodePlan::Kind::DataAttribute) &&
+         !node.ref.empty();
+}
+
+// Leaves are replaced rather than patched when they change
+bool isLeaf(NodePlan::Kind kind) {
+  return kind == NodePlan::Kind::DataObject ||
+         kind == NodePlan::Kind::TypedDataObject ||
+         kind == NodePlan::Kind::DataAttribute;
 }
+
+// CDC ObjectType NodeIds use ':' which can't occur in SCL names, so they
+// never collide with IED subtrees
+std::string cdcTypeNodeId(const std::string &cdc) { return "CDC:" + cdc; }
+
+// Functional constraints instantiated per DO; the rest is only declared on
+// the CDC ObjectType
+bool isInstantiatedFc(const std::string &fc) {
+  return fc == "ST" || fc == "MX";
+}
+
+// OPC UA data type for an SCL basic type, matching what
+// DataBinder::updateValue() writes for the corresponding MMS type
+const UA_DataType *attributeDataType(const std::string &bType) {
+  if (bType == "BOOLEAN")
+    return &UA_TYPES[UA_TYPES_BOOLEAN];
+  if (bType == "FLOAT32" || bType == "FLOAT64")
+    return &UA_TYPES[UA_TYPES_FLOAT];
+  if (bType == "INT8" || bType == "INT16" || bType == "INT32" ||
+      bType == "INT64" || bType == "Enum")
+    return &UA_TYPES[UA_TYPES_INT32];
+  if (bType == "INT8U" || bType == "INT16U" || bType == "INT32U" ||
+      bType == "Dbpos" || bType == "Tcmd" || bType == "Quality" ||
+      bType == "Check")
+    return &UA_TYPES[UA_TYPES_UINT32];
+  return &UA_TYPES[UA_TYPES_STRING];
+}
+
+// Numeric bound values are recorded by the history backend; strings are
+// placeholders only
+void setHistorizing(UA_VariableAttributes &attr) {
+  if (UA_NodeId_equal(&attr.dataType, &UA_TYPES[UA_TYPES_STRING].typeId))
+    return;
+  attr.historizing = true;
+  attr.accessLevel |= UA_ACCESSLEVELMASK_HISTORYREAD;
+}
+
+// Fill @p attr with the data type and a "no data yet" value for @p bType
+void setAttributeValue(UA_VariableAttributes &attr, const std::string &bType) {
+  static UA_Boolean boolVal = false;
+  static UA_Float floatVal = std::numeric_limits<float>::quiet_NaN();
+  static UA_Int32 intVal = 0;
+  static UA_UInt32 uintVal = 0;
+  static UA_String strVal = UA_STRING_NULL;
+
+  const UA_DataType *type = attributeDataType(bType);
+  void *value = &strVal;
+  if (type == &UA_TYPES[UA_TYPES_BOOLEAN])
+    value = &boolVal;
+  else if (type == &UA_TYPES[UA_TYPES_FLOAT])
+    value = &floatVal;
+  else if (type == &UA_TYPES[UA_TYPES_INT32])
+    value = &intVal;
+  else if (type == &UA_TYPES[UA_TYPES_UINT32])
+    value = &uintVal;
+
+  // Copied by the server on insertion
+  UA_Variant_setScalar(&attr.value, value, type);
+  attr.dataType = type->typeId;
+  attr.valueRank = UA_VALUERANK_SCALAR;
+}
+
 } // namespace
 
 NamespaceBuilder::NamespaceBuilder(std::shared_ptr<OPCUAServer> server,
@@ -29,73 +127,769 @@ void NamespaceBuilder::buildAddressSpace(
   }
 }
 
-void NamespaceBuilder::buildFromSCD(const std::string &scdPath) {
+BuildStats
+NamespaceBuilder::buildFromSCD(const std::string &scdPath,
+                               const std::vector<iec61850::IEDConfig> *ieds) {
   using namespace gateway::iec61850;
 
   LOG_INFO("Building OPC UA namespace from SCD: {}", scdPath);
 
+  BuildStats stats;
   try {
-    // Parse SCD file
-    SCLParser parser;
-    std::vector<IEDConfig> ieds = parser.parse(scdPath);
-
-    LOG_INFO("Parsed {} IEDs from SCD", ieds.size());
-
-    UA_Server *uaServer = server_->getNativeServer();
-    UA_NodeId objectsFolder = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
-
-    // Create IED objects from parsed SCD
-    for (const auto &ied : ieds) {
-      // Create IED folder
-      UA_NodeId iedNodeId = UA_NODEID_STRING(nsIdx_, (char *)ied.name.c_str());
-
-      UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
-      oAttr.displayName =
-          UA_LOCALIZEDTEXT((char *)"en", (char *)ied.name.c_str());
-      std::string desc = ied.manufacturer + " - " + ied.type;
-      oAttr.description = UA_LOCALIZEDTEXT((char *)"en", (char *)desc.c_str());
-
-      UA_StatusCode retval = UA_Server_addObjectNode(
-          uaServer, iedNodeId, objectsFolder,
-          UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
-          UA_QUALIFIEDNAME(nsIdx_, (char *)ied.name.c_str()),
-          UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE), oAttr, NULL, NULL);
-
-      if (retval != UA_STATUSCODE_GOOD &&
-          retval != UA_STATUSCODE_BADNODEIDEXISTS) {
-        LOG_ERROR("Failed to add IED object for {}: {}", ied.name, retval);
-        continue;
+    // Phase 1: Load the compiled snapshot if it matches the SCD, otherwise
+    // parse the SCD file unless the caller already did
+    auto parseStart = std::chrono::steady_clock::now();
+    uint64_t scdHash = 0;
+    bool hashed = !snapshotPath_.empty() &&
+                  NamespaceSnapshot::hashFile(scdPath, &scdHash);
+
+    IEDPlan cachedTypes;
+    std::vector<NamespaceSnapshot::Entry> cached;
+    if (hashed && NamespaceSnapshot::load(snapshotPath_, scdHash, &cachedTypes,
+                                          &cached)) {
+      double parseMs = elapsedMs(parseStart);
+      LOG_INFO("Loaded {} IEDs from namespace snapshot {}", cached.size(),
+               snapshotPath_);
+
+      // Phase 2 + 3: Build and bind
+      stats = buildFromPlans(std::move(cachedTypes), std::move(cached));
+      stats.parseMs = parseMs;
+      stats.fromSnapshot = true;
+    } else {
+      std::vector<IEDConfig> parsed;
+      if (!ieds) {
+        SCLParser parser;
+        parsed = parser.parse(scdPath);
+        ieds = &parsed;
       }
+      double parseMs = elapsedMs(parseStart);
 
-      // Add IP Address variable
-      std::string ipVarName = "IPAddress";
-      UA_VariableAttributes ipAttr = UA_VariableAttributes_default;
-      UA_String ipValue = UA_STRING((char *)ied.ip.c_str());
-      UA_Variant_setScalar(&ipAttr.value, &ipValue, &UA_TYPES[UA_TYPES_STRING]);
-      ipAttr.displayName =
-          UA_LOCALIZEDTEXT((char *)"en", (char *)ipVarName.c_str());
-      ipAttr.accessLevel = UA_ACCESSLEVELMASK_READ;
-
-      UA_Server_addVariableNode(
-          uaServer,
-          UA_NODEID_STRING(nsIdx_, (char *)(ied.name + ".IPAddress").c_str()),
-          iedNodeId, UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
-          UA_QUALIFIEDNAME(nsIdx_, (char *)ipVarName.c_str()),
-          UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE), ipAttr, NULL,
-          NULL);
-
-      // Create Logical Devices
-      for (const auto &ld : ied.logicalDevices) {
-        createLogicalDevice(iedNodeId, ied.name, ld);
-      }
+      LOG_INFO("Parsed {} IEDs from SCD", ieds->size());
+
+      // Phase 2 + 3: Build and bind
+      stats = buildFromModel(*ieds);
+      stats.parseMs = parseMs;
 
-      LOG_INFO("Created OPC UA node for IED: {} ({}) with {} LDs", ied.name,
-               ied.ip, ied.logicalDevices.size());
+      if (hashed)
+        saveSnapshot(scdHash);
     }
 
   } catch (const std::exception &e) {
     LOG_ERROR("Failed to build namespace from SCD: {}", e.what());
   }
+
+  LOG_INFO("Namespace startup timing: {} {:.1f} ms, build {:.1f} ms "
+           "({} nodes, {} failed), bind {:.1f} ms ({} points)",
+           stats.fromSnapshot ? "snapshot load" : "parse", stats.parseMs,
+           stats.buildMs, stats.nodeCount, stats.failedNodes, stats.bindMs,
+           stats.bindingCount);
+  return stats;
+}
+
+BuildStats NamespaceBuilder::buildFromModel(
+    const std::vector<iec61850::IEDConfig> &ieds) {
+  auto compileStart = std::chrono::steady_clock::now();
+
+  IEDPlan types;
+  compileTypes(ieds, types);
+
+  std::vector<std::pair<std::string, IEDPlan>> plans;
+  plans.reserve(ieds.size());
+  for (const auto &ied : ieds) {
+    plans.emplace_back(ied.name, compileIED(ied));
+  }
+  double compileMs = elapsedMs(compileStart);
+
+  BuildStats stats = buildFromPlans(std::move(types), std::move(plans));
+  stats.buildMs += compileMs;
+  return stats;
+}
+
+BuildStats NamespaceBuilder::buildFromPlans(
+    IEDPlan types, std::vector<std::pair<std::string, IEDPlan>> plans) {
+  std::lock_guard<std::mutex> lock(buildMutex_);
+
+  BuildStats stats;
+  stats.iedCount = plans.size();
+
+  // Phase 2: Insert the flattened model in one pass, CDC types first since
+  // DOs reference them. No logging per node here; failures are counted and
+  // only the first few are reported.
+  auto buildStart = std::chrono::steady_clock::now();
+  insertTypes(std::move(types), stats);
+
+  size_t dataObjectCount = 0;
+  for (const auto &entry : plans) {
+    for (const auto &node : entry.second) {
+      if (node.kind == NodePlan::Kind::DataObject)
+        dataObjectCount++;
+    }
+  }
+
+  std::vector<DataBinder::Binding> bindings;
+  std::vector<const NodePlan *> writable;
+  bindings.reserve(dataObjectCount);
+
+  for (const auto &entry : plans) {
+    insertPlan(entry.second, nullptr, stats, bindings, writable);
+  }
+  stats.buildMs = elapsedMs(buildStart);
+
+  // Phase 3: Bind all data points under a single DataBinder lock
+  auto bindStart = std::chrono::steady_clock::now();
+  bindCollected(bindings, writable, stats);
+  stats.bindMs = elapsedMs(bindStart);
+
+  // Remember what was built so later updates can be diffed against it
+  for (auto &entry : plans) {
+    builtIEDs_[entry.first] = std::move(entry.second);
+  }
+
+  LOG_INFO("CDC types: {} ObjectTypes, {} DA variables instantiated",
+           stats.typeCount, stats.attributeNodes);
+  return stats;
+}
+
+void NamespaceBuilder::setSnapshotPath(const std::string &path) {
+  snapshotPath_ = path;
+}
+
+void NamespaceBuilder::setRemovedNodeHook(RemovedNodeHook hook) {
+  removedNodeHook_ = std::move(hook);
+}
+
+void NamespaceBuilder::saveSnapshot(uint64_t scdHash) {
+  std::vector<NamespaceSnapshot::Entry> entries;
+  IEDPlan types;
+  {
+    std::lock_guard<std::mutex> lock(buildMutex_);
+    types = typePlan_;
+    entries.reserve(builtIEDs_.size());
+    for (const auto &entry : builtIEDs_) {
+      entries.emplace_back(entry.first, entry.second);
+    }
+  }
+  NamespaceSnapshot::save(snapshotPath_, scdHash, types, entries);
+}
+
+BuildStats
+NamespaceBuilder::updateFromSCD(const std::string &scdPath,
+                                const std::vector<iec61850::IEDConfig> *ieds) {
+  using namespace gateway::iec61850;
+
+  LOG_INFO("Updating OPC UA namespace from SCD: {}", scdPath);
+
+  BuildStats stats;
+  try {
+    auto parseStart = std::chrono::steady_clock::now();
+    std::vector<IEDConfig> parsed;
+    if (!ieds) {
+      SCLParser parser;
+      parsed = parser.parse(scdPath);
+      ieds = &parsed;
+    }
+    double parseMs = elapsedMs(parseStart);
+
+    stats = updateFromModel(*ieds);
+    stats.parseMs = parseMs;
+
+    // Keep the snapshot in step so the next restart skips the XML
+    uint64_t scdHash = 0;
+    if (!snapshotPath_.empty() &&
+        NamespaceSnapshot::hashFile(scdPath, &scdHash)) {
+      saveSnapshot(scdHash);
+    }
+
+  } catch (const std::exception &e) {
+    LOG_ERROR("Failed to update namespace from SCD: {}", e.what());
+  }
+
+  LOG_INFO("Namespace update: IEDs +{} -{} ~{} ({} unchanged), nodes +{} -{} "
+           "~{}, bindings +{} -{}; parse {:.1f} ms, diff+build {:.1f} ms, "
+           "bind {:.1f} ms",
+           stats.iedsAdded, stats.iedsRemoved, stats.iedsModified,
+           stats.iedsUnchanged, stats.nodeCount, stats.removedNodes,
+           stats.updatedNodes, stats.bindingCount, stats.unboundCount,
+           stats.parseMs, stats.buildMs, stats.bindMs);
+  return stats;
+}
+
+BuildStats NamespaceBuilder::updateFromModel(
+    const std::vector<iec61850::IEDConfig> &ieds) {
+  std::lock_guard<std::mutex> lock(buildMutex_);
+
+  BuildStats stats;
+  stats.iedCount = ieds.size();
+
+  auto buildStart = std::chrono::steady_clock::now();
+  UA_Server *uaServer = server_->getNativeServer();
+
+  // New CDC types go in before any DO that instantiates them
+  IEDPlan types = typePlan_;
+  compileTypes(ieds, types);
+  insertTypes(std::move(types), stats);
+
+  // New plans are kept alive until binding is done, since the collected
+  // bindings point into their NodeId strings
+  std::vector<std::pair<std::string, IEDPlan>> pending;
+  std::vector<DataBinder::Binding> bindings;
+  std::vector<const NodePlan *> writable;
+  std::vector<std::string> unbound;
+  std::vector<std::string> removed; // NodeIds of deleted bound nodes
+  std::unordered_map<std::string, bool> present;
+  pending.reserve(ieds.size());
+
+  for (const auto &ied : ieds) {
+    present[ied.name] = true;
+    pending.emplace_back(ied.name, compileIED(ied));
+    const IEDPlan &newPlan = pending.back().second;
+
+    auto it = builtIEDs_.find(ied.name);
+    if (it == builtIEDs_.end()) {
+      insertPlan(newPlan, nullptr, stats, bindings, writable);
+      stats.iedsAdded++;
+    } else if (patchIED(it->second, newPlan, stats, bindings, writable,
+                        unbound, removed)) {
+      stats.iedsModified++;
+    } else {
+      stats.iedsUnchanged++;
+    }
+  }
+
+  // IEDs that disappeared: deleting the IED object removes its whole subtree
+  for (auto it = builtIEDs_.begin(); it != builtIEDs_.end();) {
+    if (present.count(it->first)) {
+      ++it;
+      continue;
+    }
+
+    UA_NodeId iedNodeId = UA_NODEID_STRING(nsIdx_, (char *)it->first.c_str());
+    UA_StatusCode retval = UA_Server_deleteNode(uaServer, iedNodeId, true);
+    if (retval != UA_STATUSCODE_GOOD &&
+        retval != UA_STATUSCODE_BADNODEIDUNKNOWN) {
+      LOG_ERROR("Failed to delete IED subtree {}: 0x{:x}", it->first, retval);
+    }
+    for (const auto &node : it->second) {
+      if (isBindingTarget(node)) {
+        unbound.push_back(node.ref);
+        removed.push_back(node.nodeId);
+      }
+    }
+    stats.removedNodes++;
+    stats.iedsRemoved++;
+    it = builtIEDs_.erase(it);
+  }
+  stats.buildMs = elapsedMs(buildStart);
+
+  auto bindStart = std::chrono::steady_clock::now();
+  if (binder_ && !unbound.empty()) {
+    stats.unboundCount = binder_->unbindDataPoints(unbound);
+  }
+  if (removedNodeHook_) {
+    for (const auto &nodeId : removed)
+      removedNodeHook_(UA_NODEID_STRING(nsIdx_, (char *)nodeId.c_str()));
+  }
+  bindCollected(bindings, writable, stats);
+  stats.bindMs = elapsedMs(bindStart);
+
+  for (auto &entry : pending) {
+    builtIEDs_[entry.first] = std::move(entry.second);
+  }
+
+  return stats;
+}
+
+IEDPlan NamespaceBuilder::compileIED(const iec61850::IEDConfig &ied) {
+  using Kind = NodePlan::Kind;
+
+  // Size the plan up front: IED + IPAddress + one node per LD/LN/DO
+  size_t total = 2;
+  for (const auto &ld : ied.logicalDevices) {
+    total++;
+    for (const auto &ln : ld.logicalNodes) {
+      total += 1 + ln.dataObjects.size();
+    }
+  }
+
+  IEDPlan plan;
+  plan.reserve(total);
+
+  plan.push_back({Kind::IED, NodePlan::npos, ied.name, ied.name, ied.name,
+                  ied.manufacturer + " - " + ied.type, "", "", "", ""});
+  plan.push_back({Kind::IPAddress, 0, ied.name + ".IPAddress", "IPAddress",
+                  "IPAddress", ied.ip, "", "", "", ""});
+
+  for (const auto &ld : ied.logicalDevices) {
+    size_t ldIdx = plan.size();
+    std::string ldId = ied.name + "." + ld.name;
+    plan.push_back({Kind::LogicalDevice, 0, ldId, ld.name, ld.name, "", "",
+                    "", "", ""});
+
+    for (const auto &ln : ld.logicalNodes) {
+      size_t lnIdx = plan.size();
+      std::string lnId = ldId + "." + ln.name;
+      plan.push_back({Kind::LogicalNode, ldIdx, lnId, ln.name,
+                      ln.name + " [" + ln.lnClass + "]", "", "", "", "",
+                      ""});
+
+      // IEC61850 Reference: IED/LD/LN.DO
+      std::string refPrefix = ied.name + "/" + ld.name + "/" + ln.name + ".";
+      for (const auto &dobj : ln.dataObjects) {
+        std::string doId = lnId + "." + dobj.name;
+        std::string displayName = dobj.name + " [" + dobj.type + "]";
+        if (!dobj.typeTemplate) {
+          // No DOType to consult: read the CDC's primary DA
+          auto primary = iec61850::primaryAttribute(dobj.type);
+          plan.push_back({Kind::DataObject, lnIdx, doId, dobj.name,
+                          displayName, "", dobj.type, refPrefix + dobj.name,
+                          primary.name, primary.fc});
+          continue;
+        }
+
+        // Instance of the CDC ObjectType. Only ST/MX attributes get nodes;
+        // the value is bound to the CDC's primary DA (stVal, mag.f,
+        // cVal.mag.f, ...), which is read with the FC the DOType gives it.
+        const auto &attributes = dobj.typeTemplate->attributes;
+        std::string primary = iec61850::primaryAttribute(*dobj.typeTemplate);
+
+        size_t doIdx = plan.size();
+        plan.push_back({Kind::TypedDataObject, lnIdx, doId, dobj.name,
+                        displayName, "", dobj.type, refPrefix + dobj.name, "",
+                        ""});
+        for (const auto &da : attributes) {
+          if (!isInstantiatedFc(da.fc))
+            continue;
+          bool bound = da.name == primary;
+          plan.push_back({Kind::DataAttribute, doIdx, doId + "." + da.name,
+                          da.name, da.name, da.bType, dobj.type,
+                          bound ? refPrefix + dobj.name : "",
+                          bound ? da.name : "", bound ? da.fc : ""});
+        }
+      }
+    }
+  }
+
+  return plan;
+}
+
+void NamespaceBuilder::compileTypes(
+    const std::vector<iec61850::IEDConfig> &ieds, IEDPlan &types) {
+  using Kind = NodePlan::Kind;
+
+  std::unordered_map<std::string, size_t> index;
+  index.reserve(types.size());
+  for (size_t i = 0; i < types.size(); ++i) {
+    index.emplace(types[i].nodeId, i);
+  }
+
+  // Many DOs share a DOType; merge each template into its CDC only once
+  std::unordered_set<const iec61850::DOTypeTemplate *> merged;
+
+  for (const auto &ied : ieds) {
+    for (const auto &ld : ied.logicalDevices) {
+      for (const auto &ln : ld.logicalNodes) {
+        for (const auto &dobj : ln.dataObjects) {
+          const auto *tmpl = dobj.typeTemplate.get();
+          if (!tmpl || !merged.insert(tmpl).second)
+            continue;
+
+          // The CDC type declares the union of the DAs of all its DOTypes
+          std::string typeId = cdcTypeNodeId(tmpl->cdc);
+          auto typeIt = index.find(typeId);
+          if (typeIt == index.end()) {
+            typeIt = index.emplace(typeId, types.size()).first;
+            types.push_back({Kind::ObjectType, NodePlan::npos, typeId,
+                             tmpl->cdc + "Type", tmpl->cdc + "Type", "",
+                             tmpl->cdc, "", "", ""});
+          }
+          size_t typeIdx = typeIt->second;
+
+          for (const auto &da : tmpl->attributes) {
+            std::string attrId = typeId + "." + da.name;
+            if (index.count(attrId))
+              continue;
+            index.emplace(attrId, types.size());
+            types.push_back({Kind::TypeAttribute, typeIdx, attrId, da.name,
+                             da.name, da.bType, da.fc, "", "", ""});
+          }
+        }
+      }
+    }
+  }
+}
+
+void NamespaceBuilder::insertTypes(IEDPlan types, BuildStats &stats) {
+  if (types.size() > typePlan_.size()) {
+    // Types are append-only, so everything past the known prefix is new
+    std::vector<char> wanted(typePlan_.size(), 0);
+    wanted.resize(types.size(), 1);
+
+    std::vector<DataBinder::Binding> noBindings;
+    std::vector<const NodePlan *> noWritable;
+    insertPlan(types, &wanted, stats, noBindings, noWritable);
+    typePlan_ = std::move(types);
+  }
+
+  for (const auto &node : typePlan_) {
+    if (node.kind == NodePlan::Kind::ObjectType)
+      stats.typeCount++;
+  }
+}
+
+void NamespaceBuilder::insertPlan(const IEDPlan &plan,
+                                  const std::vector<char> *wanted,
+                                  BuildStats &stats,
+                                  std::vector<DataBinder::Binding> &bindings,
+                                  std::vector<const NodePlan *> &writable) {
+  // Tracks whether each planned node made it into the address space so that
+  // children of a rejected parent are skipped instead of failing one by one
+  std::vector<char> added(plan.size(), 0);
+  UA_NodeId objectsFolder = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+
+  for (size_t i = 0; i < plan.size(); ++i) {
+    if (wanted && !(*wanted)[i])
+      continue;
+    const NodePlan &node = plan[i];
+
+    UA_NodeId parentId = objectsFolder;
+    if (node.parent != NodePlan::npos) {
+      bool parentSelected = !wanted || (*wanted)[node.parent];
+      if (parentSelected && !added[node.parent]) {
+        stats.failedNodes++;
+        continue;
+      }
+      parentId =
+          UA_NODEID_STRING(nsIdx_, (char *)plan[node.parent].nodeId.c_str());
+    }
+
+    UA_StatusCode retval = addPlannedNode(node, parentId);
+    if (retval != UA_STATUSCODE_GOOD &&
+        retval != UA_STATUSCODE_BADNODEIDEXISTS) {
+      if (stats.failedNodes < kMaxReportedFailures) {
+        LOG_ERROR("Failed to add node {}: 0x{:x}", node.nodeId, retval);
+      }
+      stats.failedNodes++;
+      continue;
+    }
+
+    added[i] = 1;
+    stats.nodeCount++;
+    if (node.kind == NodePlan::Kind::DataAttribute)
+      stats.attributeNodes++;
+
+    if (isBindingTarget(node)) {
+      bindings.push_back(
+          {node.ref, UA_NODEID_STRING(nsIdx_, (char *)node.nodeId.c_str()),
+           {node.attribute, node.fc, node.cdc}});
+      if (isControllable(node.cdc)) {
+        writable.push_back(&node);
+      }
+    }
+  }
+}
+
+PlanDiff NamespaceBuilder::diffPlans(const IEDPlan &oldPlan,
+                                     const IEDPlan &newPlan) {
+  std::unordered_map<std::string, size_t> oldIndex;
+  oldIndex.reserve(oldPlan.size());
+  for (size_t i = 0; i < oldPlan.size(); ++i) {
+    oldIndex.emplace(oldPlan[i].nodeId, i);
+  }
+
+  PlanDiff diff;
+  diff.wanted.assign(newPlan.size(), 0);
+  std::vector<char> kept(oldPlan.size(), 0);
+
+  for (size_t i = 0; i < newPlan.size(); ++i) {
+    const NodePlan &node = newPlan[i];
+    auto it = oldIndex.find(node.nodeId);
+
+    // Children of a replaced node went away with it and are re-added too
+    if (node.parent != NodePlan::npos && diff.wanted[node.parent]) {
+      if (it != oldIndex.end())
+        kept[it->second] = 1;
+      diff.wanted[i] = 1;
+      continue;
+    }
+
+    if (it == oldIndex.end()) {
+      diff.wanted[i] = 1;
+      diff.changed = true;
+      continue;
+    }
+
+    const NodePlan &oldNode = oldPlan[it->second];
+    kept[it->second] = 1;
+    if (samePlannedNode(oldPlan, oldNode, newPlan, node))
+      continue;
+
+    diff.changed = true;
+    if (isLeaf(node.kind) || node.kind != oldNode.kind) {
+      // Leaf whose type changed: replace it. Its binding is refreshed when
+      // the new node is bound, so nothing needs unbinding here.
+      diff.replaced.push_back(i);
+      diff.wanted[i] = 1;
+    } else {
+      // Containers are patched in place so their children stay untouched
+      diff.updated.push_back(i);
+    }
+  }
+
+  // Vanished nodes. A node whose parent also vanished goes away with the
+  // parent's subtree and needs no delete of its own.
+  for (size_t i = 0; i < oldPlan.size(); ++i) {
+    if (kept[i])
+      continue;
+    diff.changed = true;
+
+    const NodePlan &node = oldPlan[i];
+    if (isBindingTarget(node))
+      diff.unbound.push_back(i);
+    if (node.parent == NodePlan::npos || kept[node.parent])
+      diff.removed.push_back(i);
+  }
+
+  return diff;
+}
+
+bool NamespaceBuilder::patchIED(const IEDPlan &oldPlan, const IEDPlan &newPlan,
+                                BuildStats &stats,
+                                std::vector<DataBinder::Binding> &bindings,
+                                std::vector<const NodePlan *> &writable,
+                                std::vector<std::string> &unbound,
+                                std::vector<std::string> &removed) {
+  UA_Server *uaServer = server_->getNativeServer();
+  PlanDiff diff = diffPlans(oldPlan, newPlan);
+
+  for (size_t i : diff.replaced) {
+    UA_Server_deleteNode(
+        uaServer, UA_NODEID_STRING(nsIdx_, (char *)newPlan[i].nodeId.c_str()),
+        true);
+    stats.removedNodes++;
+  }
+  for (size_t i : diff.updated) {
+    updatePlannedNode(newPlan[i]);
+    stats.updatedNodes++;
+  }
+
+  for (size_t i : diff.unbound) {
+    unbound.push_back(oldPlan[i].ref);
+    removed.push_back(oldPlan[i].nodeId);
+  }
+  for (size_t i : diff.removed) {
+    UA_Server_deleteNode(
+        uaServer, UA_NODEID_STRING(nsIdx_, (char *)oldPlan[i].nodeId.c_str()),
+        true);
+    stats.removedNodes++;
+  }
+
+  if (diff.changed) {
+    insertPlan(newPlan, &diff.wanted, stats, bindings, writable);
+  }
+  return diff.changed;
+}
+
+void NamespaceBuilder::bindCollected(
+    const std::vector<DataBinder::Binding> &bindings,
+    const std::vector<const NodePlan *> &writable, BuildStats &stats) {
+  if (!binder_)
+    return;
+
+  if (!bindings.empty()) {
+    stats.bindingCount = binder_->bindDataPoints(bindings);
+  }
+
+  // Register write callbacks for controllable points
+  for (const NodePlan *node : writable) {
+    binder_->setWriteCallback(
+        UA_NODEID_STRING(nsIdx_, (char *)node->nodeId.c_str()));
+  }
+  LOG_DEBUG("Registered {} write callbacks", writable.size());
+}
+
+bool NamespaceBuilder::samePlannedNode(const IEDPlan &oldPlan,
+                                       const NodePlan &oldNode,
+                                       const IEDPlan &newPlan,
+                                       const NodePlan &newNode) {
+  if (oldNode.kind != newNode.kind ||
+      oldNode.displayName != newNode.displayName ||
+      oldNode.value != newNode.value || oldNode.cdc != newNode.cdc ||
+      oldNode.ref != newNode.ref || oldNode.attribute != newNode.attribute ||
+      oldNode.fc != newNode.fc) {
+    return false;
+  }
+  if ((oldNode.parent == NodePlan::npos) !=
+      (newNode.parent == NodePlan::npos)) {
+    return false;
+  }
+  return oldNode.parent == NodePlan::npos ||
+         oldPlan[oldNode.parent].nodeId == newPlan[newNode.parent].nodeId;
+}
+
+UA_StatusCode NamespaceBuilder::addPlannedNode(const NodePlan &node,
+                                               const UA_NodeId &parentId) {
+  using Kind = NodePlan::Kind;
+  UA_Server *uaServer = server_->getNativeServer();
+
+  UA_NodeId nodeId = UA_NODEID_STRING(nsIdx_, (char *)node.nodeId.c_str());
+  UA_QualifiedName browseName =
+      UA_QUALIFIEDNAME(nsIdx_, (char *)node.browseName.c_str());
+  UA_LocalizedText displayName =
+      UA_LOCALIZEDTEXT((char *)"en", (char *)node.displayName.c_str());
+
+  switch (node.kind) {
+  case Kind::IED: {
+    UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
+    oAttr.displayName = displayName;
+    oAttr.description =
+        UA_LOCALIZEDTEXT((char *)"en", (char *)node.value.c_str());
+    return UA_Server_addObjectNode(
+        uaServer, nodeId, parentId, UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+        browseName, UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE), oAttr, NULL,
+        NULL);
+  }
+  case Kind::LogicalDevice:
+  case Kind::LogicalNode: {
+    UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
+    oAttr.displayName = displayName;
+    oAttr.description = node.kind == Kind::LogicalDevice ? kLDDescription
+                                                         : kLNDescription;
+    return UA_Server_addObjectNode(
+        uaServer, nodeId, parentId,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT), browseName,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE), oAttr, NULL, NULL);
+  }
+  case Kind::IPAddress: {
+    UA_VariableAttributes ipAttr = UA_VariableAttributes_default;
+    UA_String ipValue = UA_STRING((char *)node.value.c_str());
+    UA_Variant_setScalar(&ipAttr.value, &ipValue, &UA_TYPES[UA_TYPES_STRING]);
+    ipAttr.displayName = displayName;
+    ipAttr.accessLevel = UA_ACCESSLEVELMASK_READ;
+    return UA_Server_addVariableNode(
+        uaServer, nodeId, parentId,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT), browseName,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE), ipAttr, NULL,
+        NULL);
+  }
+  case Kind::DataObject: {
+    UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+    vAttr.displayName = displayName;
+    vAttr.description = kDODescription;
+    vAttr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+
+    // Determine OPC UA type based on IEC61850 CDC
+    // Set initial values with BAD quality to indicate no connection yet
+    UA_Boolean boolVal = false;
+    UA_Float floatVal = std::numeric_limits<float>::quiet_NaN();
+    UA_Int32 intVal = 0;
+    UA_String strVal = UA_STRING((char *)"<No IED Connection>");
+    const std::string &cdc = node.cdc;
+    if (cdc == "SPS" || cdc == "SPC" || cdc == "DPS" || cdc == "DPC") {
+      UA_Variant_setScalar(&vAttr.value, &boolVal,
+                           &UA_TYPES[UA_TYPES_BOOLEAN]);
+      vAttr.dataType = UA_TYPES[UA_TYPES_BOOLEAN].typeId;
+    } else if (cdc == "MV" || cdc == "CMV") {
+      // Use NaN to indicate uninitialized analog value
+      UA_Variant_setScalar(&vAttr.value, &floatVal, &UA_TYPES[UA_TYPES_FLOAT]);
+      vAttr.dataType = UA_TYPES[UA_TYPES_FLOAT].typeId;
+    } else if (cdc == "INS" || cdc == "ENS" || cdc == "ENC") {
+      UA_Variant_setScalar(&vAttr.value, &intVal, &UA_TYPES[UA_TYPES_INT32]);
+      vAttr.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+    } else {
+      // Default to String indicating no connection
+      UA_Variant_setScalar(&vAttr.value, &strVal, &UA_TYPES[UA_TYPES_STRING]);
+      vAttr.dataType = UA_TYPES[UA_TYPES_STRING].typeId;
+    }
+    setHistorizing(vAttr);
+
+    return UA_Server_addVariableNode(
+        uaServer, nodeId, parentId,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT), browseName,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE), vAttr, NULL,
+        NULL);
+  }
+  case Kind::ObjectType: {
+    std::string description = "IEC 61850-7-3 CDC " + node.cdc;
+    UA_ObjectTypeAttributes tAttr = UA_ObjectTypeAttributes_default;
+    tAttr.displayName = displayName;
+    tAttr.description =
+        UA_LOCALIZEDTEXT((char *)"en", (char *)description.c_str());
+    return UA_Server_addObjectTypeNode(
+        uaServer, nodeId, UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+        UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE), browseName, tAttr, NULL,
+        NULL);
+  }
+  case Kind::TypeAttribute: {
+    // DA metadata lives here once per CDC instead of on every instance
+    std::string description = "FC=" + node.cdc + ", " + node.value;
+    UA_VariableAttributes aAttr = UA_VariableAttributes_default;
+    aAttr.displayName = displayName;
+    aAttr.description =
+        UA_LOCALIZEDTEXT((char *)"en", (char *)description.c_str());
+    setAttributeValue(aAttr, node.value);
+    UA_StatusCode retval = UA_Server_addVariableNode(
+        uaServer, nodeId, parentId,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT), browseName,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE), aAttr, NULL,
+        NULL);
+    if (retval != UA_STATUSCODE_GOOD)
+      return retval;
+
+    // Optional, so the server never auto-instantiates it: instances carry
+    // only the ST/MX attributes the builder adds itself
+    return UA_Server_addReference(
+        uaServer, nodeId, UA_NODEID_NUMERIC(0, UA_NS0ID_HASMODELLINGRULE),
+        UA_EXPANDEDNODEID_NUMERIC(0, UA_NS0ID_MODELLINGRULE_OPTIONAL), true);
+  }
+  case Kind::TypedDataObject: {
+    std::string typeId = cdcTypeNodeId(node.cdc);
+    UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
+    oAttr.displayName = displayName;
+    oAttr.description = kDODescription;
+    return UA_Server_addObjectNode(
+        uaServer, nodeId, parentId,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT), browseName,
+        UA_NODEID_STRING(nsIdx_, (char *)typeId.c_str()), oAttr, NULL, NULL);
+  }
+  case Kind::DataAttribute: {
+    UA_VariableAttributes aAttr = UA_VariableAttributes_default;
+    aAttr.displayName = displayName;
+    aAttr.accessLevel = UA_ACCESSLEVELMASK_READ;
+    if (!node.ref.empty() && isControllable(node.cdc)) {
+      aAttr.accessLevel |= UA_ACCESSLEVELMASK_WRITE;
+    }
+    setAttributeValue(aAttr, node.value);
+    if (!node.ref.empty())
+      setHistorizing(aAttr);
+    return UA_Server_addVariableNode(
+        uaServer, nodeId, parentId,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT), browseName,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE), aAttr, NULL,
+        NULL);
+  }
+  }
+  return UA_STATUSCODE_BADINTERNALERROR;
+}
+
+void NamespaceBuilder::updatePlannedNode(const NodePlan &node) {
+  using Kind = NodePlan::Kind;
+  UA_Server *uaServer = server_->getNativeServer();
+  UA_NodeId nodeId = UA_NODEID_STRING(nsIdx_, (char *)node.nodeId.c_str());
+
+  UA_Server_writeDisplayName(
+      uaServer, nodeId,
+      UA_LOCALIZEDTEXT((char *)"en", (char *)node.displayName.c_str()));
+
+  if (node.kind == Kind::IED) {
+    UA_Server_writeDescription(
+        uaServer, nodeId,
+        UA_LOCALIZEDTEXT((char *)"en", (char *)node.value.c_str()));
+  } else if (node.kind == Kind::IPAddress) {
+    UA_Variant value;
+    UA_String ipValue = UA_STRING((char *)node.value.c_str());
+    UA_Variant_setScalar(&value, &ipValue, &UA_TYPES[UA_TYPES_STRING]);
+    UA_Server_writeValue(uaServer, nodeId, value);
+  }
 }
 
 void NamespaceBuilder::createIEDObject(
@@ -151,142 +945,6 @@ void NamespaceBuilder::createConnectionStatusVariable(
       UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE), attr, NULL, NULL);
 }
 
-void NamespaceBuilder::createLogicalDevice(const UA_NodeId &iedNode,
-                                           const std::string &iedName,
-                                           const iec61850::LogicalDevice &ld) {
-  UA_Server *uaServer = server_->getNativeServer();
-
-  // Create LD folder
-  std::string ldNodeIdStr =
-      UA_String_to_std_string(iedNode.identifier.string) + "." + ld.name;
-  UA_NodeId ldNodeId = UA_NODEID_STRING(nsIdx_, (char *)ldNodeIdStr.c_str());
-
-  UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
-  oAttr.displayName = UA_LOCALIZEDTEXT((char *)"en", (char *)ld.name.c_str());
-  oAttr.description = UA_LOCALIZEDTEXT((char *)"en", (char *)"Logical Device");
-
-  UA_StatusCode retval = UA_Server_addObjectNode(
-      uaServer, ldNodeId, iedNode, UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
-      UA_QUALIFIEDNAME(nsIdx_, (char *)ld.name.c_str()),
-      UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE), oAttr, NULL, NULL);
-
-  if (retval != UA_STATUSCODE_GOOD && retval != UA_STATUSCODE_BADNODEIDEXISTS) {
-    LOG_ERROR("Failed to create LD: {}", ld.name);
-    return;
-  }
-
-  // Create Logical Nodes under this LD
-  for (const auto &ln : ld.logicalNodes) {
-    createLogicalNode(ldNodeId, iedName, ld.name, ln);
-  }
-
-  LOG_INFO("Created LD: {} with {} LNs", ld.name, ld.logicalNodes.size());
-}
-
-void NamespaceBuilder::createLogicalNode(const UA_NodeId &ldNode,
-                                         const std::string &iedName,
-                                         const std::string &ldName,
-                                         const iec61850::LogicalNode &ln) {
-  UA_Server *uaServer = server_->getNativeServer();
-
-  // Create LN folder
-  std::string lnNodeIdStr =
-      UA_String_to_std_string(ldNode.identifier.string) + "." + ln.name;
-  UA_NodeId lnNodeId = UA_NODEID_STRING(nsIdx_, (char *)lnNodeIdStr.c_str());
-
-  UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
-  std::string displayName = ln.name + " [" + ln.lnClass + "]";
-  oAttr.displayName =
-      UA_LOCALIZEDTEXT((char *)"en", (char *)displayName.c_str());
-  oAttr.description = UA_LOCALIZEDTEXT((char *)"en", (char *)"Logical Node");
-
-  UA_StatusCode retval = UA_Server_addObjectNode(
-      uaServer, lnNodeId, ldNode, UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
-      UA_QUALIFIEDNAME(nsIdx_, (char *)ln.name.c_str()),
-      UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE), oAttr, NULL, NULL);
-
-  if (retval != UA_STATUSCODE_GOOD && retval != UA_STATUSCODE_BADNODEIDEXISTS) {
-    LOG_ERROR("Failed to create LN: {}", ln.name);
-    return;
-  }
-
-  // Create Data Objects under this LN
-  for (const auto &dobj : ln.dataObjects) {
-    createDataObject(lnNodeId, iedName, ldName, ln.name, dobj);
-  }
-
-  LOG_INFO("Created LN: {} with {} DOs", ln.name, ln.dataObjects.size());
-}
-
-void NamespaceBuilder::createDataObject(const UA_NodeId &lnNode,
-                                        const std::string &iedName,
-                                        const std::string &ldName,
-                                        const std::string &lnName,
-                                        const iec61850::DataObject &dobj) {
-  UA_Server *uaServer = server_->getNativeServer();
-
-  // Create DO variable
-  std::string doNodeIdStr =
-      UA_String_to_std_string(lnNode.identifier.string) + "." + dobj.name;
-  UA_NodeId doNodeId = UA_NODEID_STRING(nsIdx_, (char *)doNodeIdStr.c_str());
-
-  UA_VariableAttributes vAttr = UA_VariableAttributes_default;
-  std::string displayName = dobj.name + " [" + dobj.type + "]";
-  vAttr.displayName =
-      UA_LOCALIZEDTEXT((char *)"en", (char *)displayName.c_str());
-  vAttr.description = UA_LOCALIZEDTEXT((char *)"en", (char *)"Data Object");
-  vAttr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
-
-  // Determine OPC UA type based on IEC61850 CDC
-  // Set initial values with BAD quality to indicate no connection yet
-  LOG_INFO("Creating DO: {} Type: {}", dobj.name, dobj.type);
-  if (dobj.type == "SPS" || dobj.type == "SPC" || dobj.type == "DPS" ||
-      dobj.type == "DPC") {
-    UA_Boolean val = false;
-    UA_Variant_setScalar(&vAttr.value, &val, &UA_TYPES[UA_TYPES_BOOLEAN]);
-    vAttr.dataType = UA_TYPES[UA_TYPES_BOOLEAN].typeId;
-  } else if (dobj.type == "MV" || dobj.type == "CMV") {
-    // Use NaN to indicate uninitialized analog value
-    UA_Float val = std::numeric_limits<float>::quiet_NaN();
-    UA_Variant_setScalar(&vAttr.value, &val, &UA_TYPES[UA_TYPES_FLOAT]);
-    vAttr.dataType = UA_TYPES[UA_TYPES_FLOAT].typeId;
-  } else if (dobj.type == "INS" || dobj.type == "ENS" || dobj.type == "ENC") {
-    UA_Int32 val = 0;
-    UA_Variant_setScalar(&vAttr.value, &val, &UA_TYPES[UA_TYPES_INT32]);
-    vAttr.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
-  } else {
-    // Default to String indicating no connection
-    UA_String val = UA_STRING((char *)"<No IED Connection>");
-    UA_Variant_setScalar(&vAttr.value, &val, &UA_TYPES[UA_TYPES_STRING]);
-    vAttr.dataType = UA_TYPES[UA_TYPES_STRING].typeId;
-  }
-
-  UA_StatusCode retval = UA_Server_addVariableNode(
-      uaServer, doNodeId, lnNode, UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
-      UA_QUALIFIEDNAME(nsIdx_, (char *)dobj.name.c_str()),
-      UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE), vAttr, NULL, NULL);
-
-  if (retval != UA_STATUSCODE_GOOD && retval != UA_STATUSCODE_BADNODEIDEXISTS) {
-    LOG_ERROR("Failed to create DO: {} (0x{:x})", dobj.name, retval);
-  } else {
-    // Bind to DataBinder
-    // Construct IEC61850 Reference: IED/LD/LN.DO
-    // Use explicit names passed down
-    std::string ref = iedName + "/" + ldName + "/" + lnName + "." + dobj.name;
-
-    if (binder_) {
-      // Only bind the base DO reference
-      binder_->bindDataPoint(ref, doNodeId);
-
-      // Register write callback for controllable points
-      if (dobj.type == "SPC" || dobj.type == "DPC" || dobj.type == "APC") {
-        binder_->setWriteCallback(doNodeId);
-        LOG_INFO("Registered write callback for {}", ref);
-      }
-    }
-  }
-}
-
 } // namespace ns
 } // namespace opcua
 } // namespace gateway
@@ -3,15 +3,18 @@
 #include "data/models/ied_device.h"
 #include "opcua/data_binder.h"
 #include "opcua/opcua_server.h"
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 // Forward declarations for IEC61850 data model
 namespace gateway {
 namespace iec61850 {
-struct LogicalDevice;
-struct LogicalNode;
-struct DataObject;
+struct IEDConfig;
 } // namespace iec61850
 } // namespace gateway
 
@@ -19,6 +22,80 @@ namespace gateway {
 namespace opcua {
 namespace ns {
 
+/**
+ * @brief Per-phase timing of a namespace build or incremental update
+ */
+struct BuildStats {
+  size_t iedCount = 0;
+  size_t nodeCount = 0;    // Nodes successfully added to the address space
+  size_t failedNodes = 0;  // Nodes rejected by the server
+  size_t bindingCount = 0; // Data points handed to the DataBinder
+  double parseMs = 0.0;
+  double buildMs = 0.0;
+  double bindMs = 0.0;
+
+  // Incremental updates only
+  size_t iedsAdded = 0;
+  size_t iedsRemoved = 0;
+  size_t iedsModified = 0;
+  size_t iedsUnchanged = 0;
+  size_t removedNodes = 0; // Subtree roots deleted from the address space
+  size_t updatedNodes = 0; // Nodes whose attributes were rewritten in place
+  size_t unboundCount = 0; // Data points removed from the DataBinder
+
+  // CDC ObjectTypes in the address space and DA variables instantiated
+  size_t typeCount = 0;
+  size_t attributeNodes = 0;
+
+  // True if parseMs is the snapshot load time rather than an XML parse
+  bool fromSnapshot = false;
+};
+
+// One entry of the flattened IED/LD/LN/DO tree. Parents always precede
+// their children, so a plan can be inserted in a single forward pass.
+struct NodePlan {
+  enum class Kind : uint8_t {
+    IED,
+    IPAddress,
+    LogicalDevice,
+    LogicalNode,
+    DataObject,      // Flat variable, used when the DOType is unresolved
+    ObjectType,      // One per CDC, built from DataTypeTemplates
+    TypeAttribute,   // DA declaration on a CDC ObjectType
+    TypedDataObject, // Object instance of a CDC ObjectType
+    DataAttribute    // Instantiated ST/MX DA of a TypedDataObject
+  };
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  Kind kind;
+  size_t parent;      // Index into the plan, npos for ObjectsFolder
+  std::string nodeId; // String identifier in the gateway namespace
+  std::string browseName;
+  std::string displayName;
+  std::string value; // IPAddress value / IED description / DA basic type
+  std::string cdc;   // DO CDC / type DA FC
+  std::string ref;   // IEC61850 reference; on a DataAttribute only if bound
+
+  // Read plan of a bound node: the DA polled below ref and its FC, e.g.
+  // "cVal.mag.f" / "MX" for a CMV. Empty on nodes without a binding.
+  std::string attribute;
+  std::string fc;
+};
+
+// Flattened subtree of one IED; parent indices are local to the plan
+using IEDPlan = std::vector<NodePlan>;
+
+// Node-level difference between the old and new plan of one IED, as
+// applied by an incremental update. Indices are into the plan named.
+struct PlanDiff {
+  std::vector<char> wanted;     // Per new node: to be inserted
+  std::vector<size_t> replaced; // New leaves deleted first, then re-added
+  std::vector<size_t> updated;  // New containers patched in place
+  std::vector<size_t> removed;  // Old subtree roots deleted
+  std::vector<size_t> unbound;  // Old bound nodes that vanished
+  bool changed = false;
+};
+
 class NamespaceBuilder {
 public:
   NamespaceBuilder(std::shared_ptr<OPCUAServer> server,
@@ -36,9 +113,73 @@ public:
   /**
    * @brief Build the address space from an SCD file
    * @param scdPath Path to the SCD file
-   * @return true if successful
+   * @param ieds Content of @p scdPath if the caller already parsed it; used
+   * instead of parsing again when there is no matching snapshot
+   * @return Timing breakdown for the parse, build and bind phases
+   */
+  BuildStats
+  buildFromSCD(const std::string &scdPath,
+               const std::vector<iec61850::IEDConfig> *ieds = nullptr);
+
+  /**
+   * @brief Build the address space from already parsed IED configurations
+   * @param ieds IEDs as returned by SCLParser::parse()
+   * @return Timing breakdown for the build and bind phases
+   */
+  BuildStats buildFromModel(const std::vector<iec61850::IEDConfig> &ieds);
+
+  /**
+   * @brief Bring the address space in line with an SCD file, touching only
+   * the IED subtrees that differ from what this builder last built
+   * @param scdPath Path to the SCD file
+   * @param ieds Content of @p scdPath if the caller already parsed it
+   * @return Diff and timing summary
+   */
+  BuildStats
+  updateFromSCD(const std::string &scdPath,
+                const std::vector<iec61850::IEDConfig> *ieds = nullptr);
+
+  /**
+   * @brief Incremental counterpart of buildFromModel()
+   *
+   * IEDs missing from @p ieds are deleted together with their bindings, new
+   * IEDs are inserted, and changed IEDs are patched node by node. Nodes that
+   * did not change are never deleted, so monitored items on them survive.
    */
-  void buildFromSCD(const std::string &scdPath);
+  BuildStats updateFromModel(const std::vector<iec61850::IEDConfig> &ieds);
+
+  /**
+   * @brief Enable the compiled namespace snapshot
+   *
+   * When set, buildFromSCD() loads the snapshot instead of parsing the SCD if
+   * its content hash matches, and builds/updates from an SCD rewrite it.
+   * @param path Snapshot file path (empty disables the snapshot)
+   */
+  void setSnapshotPath(const std::string &path);
+
+  using RemovedNodeHook = std::function<void(const UA_NodeId &nodeId)>;
+
+  /**
+   * @brief Install a hook called for every bound node an incremental update
+   * deletes, e.g. to drop its history
+   */
+  void setRemovedNodeHook(RemovedNodeHook hook);
+
+  /**
+   * @brief Flatten one parsed IED into an insertion plan (no server calls)
+   *
+   * Bound nodes carry their read plan: the DO's primary DA and its FC.
+   */
+  static IEDPlan compileIED(const iec61850::IEDConfig &ied);
+
+  /**
+   * @brief Work out how to patch an IED subtree from @p oldPlan to
+   * @p newPlan (no server calls)
+   *
+   * Unchanged nodes are kept. Changed containers are updated in place, and
+   * changed leaves are replaced together with their children.
+   */
+  static PlanDiff diffPlans(const IEDPlan &oldPlan, const IEDPlan &newPlan);
 
 private:
   std::shared_ptr<OPCUAServer> server_;
@@ -50,15 +191,56 @@ private:
       UA_NodeId parentNodeId,
       const std::shared_ptr<data::models::IEDDevice> &device);
 
-  // NEW: Methods for creating IEC61850 data model nodes
-  void createLogicalDevice(const UA_NodeId &iedNode, const std::string &iedName,
-                           const iec61850::LogicalDevice &ld);
-  void createLogicalNode(const UA_NodeId &ldNode, const std::string &iedName,
-                         const std::string &ldName,
-                         const iec61850::LogicalNode &ln);
-  void createDataObject(const UA_NodeId &lnNode, const std::string &iedName,
-                        const std::string &ldName, const std::string &lnName,
-                        const iec61850::DataObject &dobj);
+  // What is currently in the address space, per IED name
+  std::unordered_map<std::string, IEDPlan> builtIEDs_;
+  std::mutex buildMutex_;
+  std::string snapshotPath_;
+  RemovedNodeHook removedNodeHook_;
+
+  // CDC ObjectTypes currently in the address space. Append-only: types are
+  // never removed, since an unused type costs nothing per instance.
+  IEDPlan typePlan_;
+
+  // Insert and bind already compiled plans, then record them as built
+  BuildStats buildFromPlans(IEDPlan types,
+                            std::vector<std::pair<std::string, IEDPlan>> plans);
+
+  // Extend @p types with the CDC ObjectTypes used by @p ieds
+  static void compileTypes(const std::vector<iec61850::IEDConfig> &ieds,
+                           IEDPlan &types);
+
+  // Insert the part of @p types not yet in typePlan_ and adopt it
+  void insertTypes(IEDPlan types, BuildStats &stats);
+
+  // Write builtIEDs_ to the snapshot file under @p scdHash
+  void saveSnapshot(uint64_t scdHash);
+
+  // Insert the nodes of @p plan selected by @p wanted (all if null). Parents
+  // that are not selected are assumed to exist already.
+  void insertPlan(const IEDPlan &plan, const std::vector<char> *wanted,
+                  BuildStats &stats, std::vector<DataBinder::Binding> &bindings,
+                  std::vector<const NodePlan *> &writable);
+
+  // Patch an existing IED subtree from @p oldPlan to @p newPlan
+  bool patchIED(const IEDPlan &oldPlan, const IEDPlan &newPlan,
+                BuildStats &stats, std::vector<DataBinder::Binding> &bindings,
+                std::vector<const NodePlan *> &writable,
+                std::vector<std::string> &unbound,
+                std::vector<std::string> &removed);
+
+  // Bind collected data points and register write callbacks
+  void bindCollected(const std::vector<DataBinder::Binding> &bindings,
+                     const std::vector<const NodePlan *> &writable,
+                     BuildStats &stats);
+
+  // Insert a single planned node; returns the open62541 status code
+  UA_StatusCode addPlannedNode(const NodePlan &node, const UA_NodeId &parentId);
+
+  // Rewrite the attributes of an existing node in place
+  void updatePlannedNode(const NodePlan &node);
+
+  static bool samePlannedNode(const IEDPlan &oldPlan, const NodePlan &oldNode,
+                              const IEDPlan &newPlan, const NodePlan &newNode);
 };
 
 } // namespace ns
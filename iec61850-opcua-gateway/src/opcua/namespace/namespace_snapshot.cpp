@@ -0,0 +1,328 @@
+#include "namespace_snapshot.h"
+#include "core/logger.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gateway {
+namespace opcua {
+namespace ns {
+
+namespace {
+
+constexpr char kMagic[4] = {'I', 'G', 'N', 'S'};
+constexpr uint32_t kVersion = 3;
+constexpr uint32_t kNoParent = 0xFFFFFFFFu;
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+uint64_t fnv1a(const uint8_t *data, size_t size,
+               uint64_t hash = kFnvOffset) {
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= data[i];
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+// Read-only memory map of a whole file
+class MappedFile {
+public:
+  explicit MappedFile(const std::string &path) {
+#ifdef _WIN32
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file_ == INVALID_HANDLE_VALUE)
+      return;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0)
+      return;
+    mapping_ = CreateFileMappingA(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping_)
+      return;
+    void *view = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+      return;
+    data_ = static_cast<const uint8_t *>(view);
+    size_ = static_cast<size_t>(size.QuadPart);
+#else
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0)
+      return;
+    struct stat st;
+    if (::fstat(fd_, &st) != 0 || st.st_size == 0)
+      return;
+    void *addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                        MAP_PRIVATE, fd_, 0);
+    if (addr == MAP_FAILED)
+      return;
+    data_ = static_cast<const uint8_t *>(addr);
+    size_ = static_cast<size_t>(st.st_size);
+#endif
+  }
+
+  ~MappedFile() {
+#ifdef _WIN32
+    if (data_)
+      UnmapViewOfFile(data_);
+    if (mapping_)
+      CloseHandle(mapping_);
+    if (file_ != INVALID_HANDLE_VALUE)
+      CloseHandle(file_);
+#else
+    if (data_)
+      ::munmap(const_cast<uint8_t *>(data_), size_);
+    if (fd_ >= 0)
+      ::close(fd_);
+#endif
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const uint8_t *data() const { return data_; }
+  size_t size() const { return size_; }
+
+private:
+  const uint8_t *data_{nullptr};
+  size_t size_{0};
+#ifdef _WIN32
+  HANDLE file_{INVALID_HANDLE_VALUE};
+  HANDLE mapping_{NULL};
+#else
+  int fd_{-1};
+#endif
+};
+
+// Bounds-checked cursor over the mapped snapshot
+class Reader {
+public:
+  Reader(const uint8_t *data, size_t size) : data_(data), size_(size) {}
+
+  bool ok() const { return ok_; }
+
+  template <typename T> T read() {
+    T value{};
+    if (!ok_ || size_ - pos_ < sizeof(T)) {
+      ok_ = false;
+      return value;
+    }
+    std::memcpy(&value, data_ + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return value;
+  }
+
+  std::string readString() {
+    uint32_t len = read<uint32_t>();
+    if (!ok_ || size_ - pos_ < len) {
+      ok_ = false;
+      return std::string();
+    }
+    std::string s(reinterpret_cast<const char *>(data_ + pos_), len);
+    pos_ += len;
+    return s;
+  }
+
+private:
+  const uint8_t *data_;
+  size_t size_;
+  size_t pos_{0};
+  bool ok_{true};
+};
+
+class Writer {
+public:
+  template <typename T> void write(const T &value) {
+    const auto *p = reinterpret_cast<const char *>(&value);
+    buffer_.append(p, sizeof(T));
+  }
+
+  void writeString(const std::string &s) {
+    write(static_cast<uint32_t>(s.size()));
+    buffer_.append(s);
+  }
+
+  std::string &buffer() { return buffer_; }
+
+private:
+  std::string buffer_;
+};
+
+void writePlan(Writer &w, const IEDPlan &plan) {
+  w.write(static_cast<uint32_t>(plan.size()));
+  for (const auto &node : plan) {
+    w.write(static_cast<uint8_t>(node.kind));
+    w.write(node.parent == NodePlan::npos ? kNoParent
+                                          : static_cast<uint32_t>(node.parent));
+    w.writeString(node.nodeId);
+    w.writeString(node.browseName);
+    w.writeString(node.displayName);
+    w.writeString(node.value);
+    w.writeString(node.cdc);
+    w.writeString(node.ref);
+    w.writeString(node.attribute);
+    w.writeString(node.fc);
+  }
+}
+
+bool readPlan(Reader &r, IEDPlan *plan) {
+  uint32_t nodeCount = r.read<uint32_t>();
+  if (!r.ok())
+    return false;
+  plan->reserve(nodeCount);
+
+  for (uint32_t n = 0; n < nodeCount && r.ok(); ++n) {
+    NodePlan node;
+    uint8_t kind = r.read<uint8_t>();
+    uint32_t parent = r.read<uint32_t>();
+    node.parent = parent == kNoParent ? NodePlan::npos : parent;
+    node.nodeId = r.readString();
+    node.browseName = r.readString();
+    node.displayName = r.readString();
+    node.value = r.readString();
+    node.cdc = r.readString();
+    node.ref = r.readString();
+    node.attribute = r.readString();
+    node.fc = r.readString();
+
+    // Parents must precede children for single-pass insertion
+    if (kind > static_cast<uint8_t>(NodePlan::Kind::DataAttribute) ||
+        (node.parent != NodePlan::npos && node.parent >= n)) {
+      return false;
+    }
+    node.kind = static_cast<NodePlan::Kind>(kind);
+    plan->push_back(std::move(node));
+  }
+  return r.ok();
+}
+
+} // namespace
+
+bool NamespaceSnapshot::hashFile(const std::string &path, uint64_t *hash) {
+  MappedFile file(path);
+  if (!file.data())
+    return false;
+  *hash = fnv1a(file.data(), file.size());
+  return true;
+}
+
+bool NamespaceSnapshot::save(const std::string &path, uint64_t scdHash,
+                             const IEDPlan &types,
+                             const std::vector<Entry> &ieds) {
+  Writer w;
+  w.buffer().reserve(1 << 20);
+
+  w.buffer().append(kMagic, sizeof(kMagic));
+  w.write(kVersion);
+  w.write(scdHash);
+  writePlan(w, types);
+
+  w.write(static_cast<uint32_t>(ieds.size()));
+  for (const auto &entry : ieds) {
+    w.writeString(entry.first);
+    writePlan(w, entry.second);
+  }
+
+  const std::string &buf = w.buffer();
+  uint64_t checksum =
+      fnv1a(reinterpret_cast<const uint8_t *>(buf.data()), buf.size());
+  w.write(checksum);
+
+  // Write to a temp file and rename, so a crash never leaves a torn snapshot
+  std::string tmpPath = path + ".tmp";
+  {
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      LOG_WARN("Cannot write namespace snapshot: {}", tmpPath);
+      return false;
+    }
+    out.write(w.buffer().data(),
+              static_cast<std::streamsize>(w.buffer().size()));
+    if (!out) {
+      LOG_WARN("Failed writing namespace snapshot: {}", tmpPath);
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmpPath, path, ec);
+  if (ec) {
+    LOG_WARN("Failed to install namespace snapshot {}: {}", path, ec.message());
+    std::filesystem::remove(tmpPath, ec);
+    return false;
+  }
+
+  LOG_INFO("Saved namespace snapshot {} ({} IEDs, {} bytes)", path,
+           ieds.size(), w.buffer().size());
+  return true;
+}
+
+bool NamespaceSnapshot::load(const std::string &path, uint64_t scdHash,
+                             IEDPlan *types, std::vector<Entry> *ieds) {
+  MappedFile file(path);
+  if (!file.data())
+    return false;
+
+  const size_t headerSize =
+      sizeof(kMagic) + sizeof(uint32_t) + sizeof(uint64_t);
+  if (file.size() < headerSize + sizeof(uint64_t) ||
+      std::memcmp(file.data(), kMagic, sizeof(kMagic)) != 0) {
+    LOG_WARN("Ignoring invalid namespace snapshot: {}", path);
+    return false;
+  }
+
+  Reader r(file.data() + sizeof(kMagic), file.size() - sizeof(kMagic));
+  uint32_t version = r.read<uint32_t>();
+  uint64_t hash = r.read<uint64_t>();
+  if (version != kVersion || hash != scdHash) {
+    LOG_INFO("Namespace snapshot {} is stale, rebuilding from SCD", path);
+    return false;
+  }
+
+  // Verify the trailer before trusting any length field
+  size_t payloadSize = file.size() - sizeof(uint64_t);
+  uint64_t storedChecksum;
+  std::memcpy(&storedChecksum, file.data() + payloadSize, sizeof(uint64_t));
+  if (fnv1a(file.data(), payloadSize) != storedChecksum) {
+    LOG_WARN("Namespace snapshot {} is corrupt, rebuilding from SCD", path);
+    return false;
+  }
+
+  IEDPlan typePlan;
+  std::vector<Entry> result;
+  bool ok = readPlan(r, &typePlan);
+
+  uint32_t iedCount = ok ? r.read<uint32_t>() : 0;
+  if (ok && r.ok())
+    result.reserve(iedCount);
+  for (uint32_t i = 0; i < iedCount && ok; ++i) {
+    Entry entry;
+    entry.first = r.readString();
+    ok = readPlan(r, &entry.second);
+    result.push_back(std::move(entry));
+  }
+
+  if (!ok || !r.ok()) {
+    LOG_WARN("Namespace snapshot {} is malformed, rebuilding from SCD", path);
+    return false;
+  }
+
+  *types = std::move(typePlan);
+  *ieds = std::move(result);
+  return true;
+}
+
+} // namespace ns
+} // namespace opcua
+} // namespace gateway
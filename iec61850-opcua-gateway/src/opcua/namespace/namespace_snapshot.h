@@ -0,0 +1,59 @@
+#pragma once
+
+#include "namespace_builder.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gateway {
+namespace opcua {
+namespace ns {
+
+/**
+ * @brief Binary snapshot of a compiled address space
+ *
+ * Holds the CDC ObjectTypes and the flattened IED plans (nodes, NodeIds,
+ * bindings and each bound point's read plan: DA path and FC), keyed by a
+ * hash of the SCD content. On a restart with an unchanged SCD the snapshot
+ * is memory-mapped instead of parsing the XML; only the GOOSE services,
+ * which need the full model, still parse it.
+ *
+ * Layout (native byte order):
+ *   Header  magic "IGNS", u32 version, u64 scdHash
+ *   Types   u32 nodeCount, nodes
+ *   IEDs    u32 iedCount, then per IED string name, u32 nodeCount, nodes
+ *   Per node u8 kind, u32 parent, 8 x string
+ *   Trailer u64 FNV-1a of everything before it
+ * Strings are a u32 length followed by the raw bytes.
+ */
+class NamespaceSnapshot {
+public:
+  using Entry = std::pair<std::string, IEDPlan>;
+
+  /**
+   * @brief Hash a file's content (64-bit FNV-1a)
+   * @param path File to hash
+   * @param hash Receives the hash
+   * @return false if the file can't be read
+   */
+  static bool hashFile(const std::string &path, uint64_t *hash);
+
+  /**
+   * @brief Write a snapshot atomically (temp file + rename)
+   * @return true if successful
+   */
+  static bool save(const std::string &path, uint64_t scdHash,
+                   const IEDPlan &types, const std::vector<Entry> &ieds);
+
+  /**
+   * @brief Load a snapshot if it exists, is intact and matches @p scdHash
+   * @return true if @p types and @p ieds were filled from the snapshot
+   */
+  static bool load(const std::string &path, uint64_t scdHash, IEDPlan *types,
+                   std::vector<Entry> *ieds);
+};
+
+} // namespace ns
+} // namespace opcua
+} // namespace gateway
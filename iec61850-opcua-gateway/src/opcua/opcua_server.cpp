@@ -28,6 +28,10 @@ bool OPCUAServer::init(const ServerConfig &config) {
   // Enable anonymous access by default
   setAnonymousAccess(true);
 
+  if (config.pubsub.enabled) {
+    pubsub_ = std::make_shared<pubsub::PubSubPublisher>(server_, config.pubsub);
+  }
+
   LOG_INFO("OPC UA Server initialized on port {}", config.port);
   return true;
 }
@@ -37,6 +41,9 @@ bool OPCUAServer::start() {
     return true;
 
   running_ = true;
+  if (pubsub_) {
+    pubsub_->start();
+  }
   serverThread_ = std::thread(&OPCUAServer::runServerLoop, this);
 
   LOG_INFO("OPC UA Server started");
@@ -49,6 +56,9 @@ void OPCUAServer::stop() {
     if (serverThread_.joinable()) {
       serverThread_.join();
     }
+    if (pubsub_) {
+      pubsub_->stop();
+    }
     LOG_INFO("OPC UA Server stopped");
   }
 }
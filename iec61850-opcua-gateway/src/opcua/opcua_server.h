@@ -1,5 +1,6 @@
 #pragma once
 
+#include "pubsub/pubsub_publisher.h"
 #include <atomic>
 #include <map>
 #include <memory>
@@ -16,6 +17,7 @@ struct ServerConfig {
   std::string endpointUrl = "opc.tcp://0.0.0.0:4840";
   bool enableSecurity = false;
   std::string appName = "IEC61850 Gateway";
+  pubsub::PublisherConfig pubsub; // Optional UADP multicast publisher
 };
 
 class OPCUAServer {
@@ -47,12 +49,18 @@ public:
   // Access control
   void setAnonymousAccess(bool allow);
 
+  // PubSub publisher, null unless enabled in the configuration
+  std::shared_ptr<pubsub::PubSubPublisher> getPubSubPublisher() const {
+    return pubsub_;
+  }
+
 private:
   UA_Server *server_{nullptr};
   volatile UA_Boolean running_{false};
   std::thread serverThread_;
   ServerConfig config_;
   std::map<std::string, UA_UInt16> namespaces_;
+  std::shared_ptr<pubsub::PubSubPublisher> pubsub_;
 
   void runServerLoop();
 };
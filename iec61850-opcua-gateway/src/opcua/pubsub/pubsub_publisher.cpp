@@ -0,0 +1,259 @@
+#include "pubsub_publisher.h"
+#include "core/logger.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace gateway {
+namespace opcua {
+namespace pubsub {
+
+namespace {
+
+// Largest payload of a single UDP datagram
+constexpr size_t kMaxDatagram = 65507;
+
+} // namespace
+
+PubSubPublisher::PubSubPublisher(UA_Server *server,
+                                 const PublisherConfig &config)
+    : server_(server), config_(config) {
+  for (const auto &ds : config_.dataSets) {
+    auto group = std::make_unique<WriterGroup>();
+    group->owner = this;
+    group->config = ds;
+    group->config.intervalMs = std::max(1, ds.intervalMs);
+    group->config.keyFrameCount = std::max(1, ds.keyFrameCount);
+    group->fields.resize(ds.points.size());
+    for (size_t i = 0; i < ds.points.size(); ++i)
+      group->fields[i].ref = ds.points[i];
+    groups_.push_back(std::move(group));
+  }
+}
+
+PubSubPublisher::~PubSubPublisher() {
+  stop();
+  for (auto &group : groups_) {
+    for (auto &field : group->fields)
+      UA_NodeId_clear(&field.nodeId);
+  }
+}
+
+void PubSubPublisher::setResolver(Resolver resolver) {
+  std::lock_guard<std::mutex> lock(resolverMutex_);
+  resolver_ = std::move(resolver);
+}
+
+bool PubSubPublisher::start() {
+  if (running_)
+    return true;
+  if (!server_ || groups_.empty()) {
+    LOG_WARN("PubSub publisher has no data sets configured");
+    return false;
+  }
+  if (!openSocket())
+    return false;
+
+  for (auto &group : groups_) {
+    UA_StatusCode retval = UA_Server_addRepeatedCallback(
+        server_, &PubSubPublisher::publishCallback, group.get(),
+        group->config.intervalMs, &group->callbackId);
+    if (retval != UA_STATUSCODE_GOOD) {
+      LOG_ERROR("Failed to schedule PubSub data set {}: 0x{:x}",
+                group->config.name, retval);
+    }
+  }
+
+  running_ = true;
+  LOG_INFO("PubSub publisher {} started on opc.udp://{}:{} ({} data sets)",
+           config_.publisherId, config_.address, config_.port,
+           groups_.size());
+  return true;
+}
+
+void PubSubPublisher::stop() {
+  if (!running_)
+    return;
+  running_ = false;
+  for (auto &group : groups_) {
+    if (group->callbackId) {
+      UA_Server_removeCallback(server_, group->callbackId);
+      group->callbackId = 0;
+    }
+  }
+  closeSocket();
+  LOG_INFO("PubSub publisher {} stopped", config_.publisherId);
+}
+
+std::vector<PublisherStats> PubSubPublisher::getStats() const {
+  std::vector<PublisherStats> result;
+  for (const auto &group : groups_) {
+    PublisherStats s;
+    s.dataSet = group->config.name;
+    s.messages = group->messages.load();
+    s.keyFrames = group->keyFrames.load();
+    s.deltaFrames = group->deltaFrames.load();
+    s.keepAlives = group->keepAlives.load();
+    s.fieldsSent = group->fieldsSent.load();
+    s.bytesSent = group->bytesSent.load();
+    s.sendErrors = group->sendErrors.load();
+    s.resolvedPoints = group->resolved.load();
+    s.points = group->fields.size();
+    result.push_back(std::move(s));
+  }
+  return result;
+}
+
+bool PubSubPublisher::openSocket() {
+  in_addr group{};
+  if (inet_pton(AF_INET, config_.address.c_str(), &group) != 1) {
+    LOG_ERROR("Invalid PubSub address: {}", config_.address);
+    return false;
+  }
+  destAddr_ = group.s_addr;
+  destPort_ = htons(static_cast<uint16_t>(config_.port));
+
+  Socket fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (fd == kNoSocket) {
+    LOG_ERROR("Failed to create PubSub socket");
+    return false;
+  }
+
+  unsigned char ttl = static_cast<unsigned char>(config_.ttl);
+  unsigned char loop = config_.loopback ? 1 : 0;
+  if (setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL,
+                 reinterpret_cast<const char *>(&ttl), sizeof(ttl)) != 0)
+    LOG_WARN("Cannot set PubSub multicast TTL {}, using the default",
+             config_.ttl);
+  if (setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP,
+                 reinterpret_cast<const char *>(&loop), sizeof(loop)) != 0)
+    LOG_WARN("Cannot {} PubSub multicast loopback",
+             config_.loopback ? "enable" : "disable");
+
+  if (!config_.interfaceAddress.empty()) {
+    in_addr iface{};
+    if (inet_pton(AF_INET, config_.interfaceAddress.c_str(), &iface) != 1 ||
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF,
+                   reinterpret_cast<const char *>(&iface),
+                   sizeof(iface)) != 0) {
+      LOG_WARN("Cannot use PubSub interface {}, using default route",
+               config_.interfaceAddress);
+    }
+  }
+
+  socket_ = fd;
+  return true;
+}
+
+void PubSubPublisher::closeSocket() {
+  if (socket_ == kNoSocket)
+    return;
+#ifdef _WIN32
+  closesocket(socket_);
+#else
+  close(socket_);
+#endif
+  socket_ = kNoSocket;
+}
+
+void PubSubPublisher::publish(WriterGroup &group) {
+  // Sample every field on the server thread
+  size_t resolved = 0;
+  for (auto &field : group.fields) {
+    if (!field.resolved) {
+      std::lock_guard<std::mutex> lock(resolverMutex_);
+      field.resolved = resolver_ && resolver_(field.ref, &field.nodeId);
+    }
+
+    field.current.clear();
+    UA_Variant value;
+    UA_Variant_init(&value);
+    if (field.resolved &&
+        UA_Server_readValue(server_, field.nodeId, &value) !=
+            UA_STATUSCODE_GOOD) {
+      // Node went away, e.g. after an SCD update; resolve again next time
+      UA_NodeId_clear(&field.nodeId);
+      field.resolved = false;
+    }
+    if (field.resolved)
+      resolved++;
+    UadpEncoder::encodeVariant(value, field.current);
+    UA_Variant_clear(&value);
+  }
+  group.resolved = resolved;
+
+  DataSetMessage msg;
+  msg.writerId = group.config.writerId;
+  msg.sequenceNumber = group.dataSetSequence++;
+  bool keyFrame = group.sinceKeyFrame == 0;
+  msg.type =
+      keyFrame ? DataSetMessageType::KeyFrame : DataSetMessageType::DeltaFrame;
+  for (size_t i = 0; i < group.fields.size(); ++i) {
+    Field &field = group.fields[i];
+    if (keyFrame || field.current != field.sent) {
+      msg.fields.emplace_back(static_cast<uint16_t>(i), &field.current);
+    }
+  }
+  if (!keyFrame && msg.fields.empty())
+    msg.type = DataSetMessageType::KeepAlive;
+  auto keyFrameCount = static_cast<uint32_t>(group.config.keyFrameCount);
+  group.sinceKeyFrame = (group.sinceKeyFrame + 1) % keyFrameCount;
+
+  UadpEncoder::encodeNetworkMessage(config_.publisherId, group.config.writerId,
+                                    group.networkSequence++, UA_DateTime_now(),
+                                    {msg}, group.buffer);
+  for (const auto &field : msg.fields)
+    group.fields[field.first].sent = *field.second;
+
+  if (group.buffer.size() > kMaxDatagram) {
+    group.sendErrors++;
+    return;
+  }
+
+  sockaddr_in dest{};
+  dest.sin_family = AF_INET;
+  dest.sin_addr.s_addr = destAddr_;
+  dest.sin_port = destPort_;
+  auto sent = sendto(socket_,
+                     reinterpret_cast<const char *>(group.buffer.data()),
+                     group.buffer.size(), 0,
+                     reinterpret_cast<const sockaddr *>(&dest), sizeof(dest));
+  if (sent < 0) {
+    group.sendErrors++;
+    return;
+  }
+
+  group.messages++;
+  group.bytesSent += group.buffer.size();
+  group.fieldsSent += msg.fields.size();
+  switch (msg.type) {
+  case DataSetMessageType::KeyFrame:
+    group.keyFrames++;
+    break;
+  case DataSetMessageType::DeltaFrame:
+    group.deltaFrames++;
+    break;
+  case DataSetMessageType::KeepAlive:
+    group.keepAlives++;
+    break;
+  }
+}
+
+void PubSubPublisher::publishCallback(UA_Server *server, void *data) {
+  (void)server;
+  auto *group = static_cast<WriterGroup *>(data);
+  if (group && group->owner->running_)
+    group->owner->publish(*group);
+}
+
+} // namespace pubsub
+} // namespace opcua
+} // namespace gateway
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "uadp_encoder.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <open62541/server.h>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#endif
+
+namespace gateway {
+namespace opcua {
+namespace pubsub {
+
+/**
+ * @brief One published DataSet, sent by its own writer group
+ */
+struct DataSetConfig {
+  std::string name;
+  uint16_t writerId = 1; // Also used as WriterGroupId
+  int intervalMs = 100;
+  int keyFrameCount = 10; // Every Nth message is a key frame; 1 = no deltas
+  std::vector<std::string> points; // IEC61850 references
+};
+
+struct PublisherConfig {
+  bool enabled = false;
+  std::string address = "239.0.0.1"; // Multicast group
+  int port = 4840;
+  std::string interfaceAddress; // Outgoing interface IPv4, empty = default
+  int ttl = 1;
+  bool loopback = true; // Deliver to receivers on this host
+  uint16_t publisherId = 1;
+  std::vector<DataSetConfig> dataSets;
+};
+
+struct PublisherStats {
+  std::string dataSet;
+  uint64_t messages = 0;
+  uint64_t keyFrames = 0;
+  uint64_t deltaFrames = 0;
+  uint64_t keepAlives = 0;
+  uint64_t fieldsSent = 0;
+  uint64_t bytesSent = 0;
+  uint64_t sendErrors = 0;
+  size_t resolvedPoints = 0;
+  size_t points = 0;
+};
+
+/**
+ * @brief OPC UA PubSub publisher: UADP NetworkMessages over UDP multicast
+ *
+ * Each DataSet is published on a repeated server callback, so values are
+ * read from the address space on the server thread. Between key frames
+ * only fields whose encoded value changed are sent (delta frames); an
+ * interval without changes sends a keep-alive.
+ */
+class PubSubPublisher {
+public:
+  /** Map an IEC61850 reference to the NodeId of the bound variable */
+  using Resolver =
+      std::function<bool(const std::string &ref, UA_NodeId *nodeId)>;
+
+  PubSubPublisher(UA_Server *server, const PublisherConfig &config);
+  ~PubSubPublisher();
+
+  void setResolver(Resolver resolver);
+
+  /**
+   * @brief Open the socket and register the publishing callbacks
+   */
+  bool start();
+  void stop();
+  bool isRunning() const { return running_; }
+
+  std::vector<PublisherStats> getStats() const;
+
+private:
+  struct Field {
+    std::string ref;
+    UA_NodeId nodeId = UA_NODEID_NULL;
+    bool resolved = false;
+    std::vector<uint8_t> current;
+    std::vector<uint8_t> sent;
+  };
+
+  struct WriterGroup {
+    PubSubPublisher *owner = nullptr;
+    DataSetConfig config;
+    std::vector<Field> fields;
+    UA_UInt64 callbackId = 0;
+    uint16_t networkSequence = 0;
+    uint16_t dataSetSequence = 0;
+    uint32_t sinceKeyFrame = 0;
+    std::vector<uint8_t> buffer;
+
+    std::atomic<uint64_t> messages{0};
+    std::atomic<uint64_t> keyFrames{0};
+    std::atomic<uint64_t> deltaFrames{0};
+    std::atomic<uint64_t> keepAlives{0};
+    std::atomic<uint64_t> fieldsSent{0};
+    std::atomic<uint64_t> bytesSent{0};
+    std::atomic<uint64_t> sendErrors{0};
+    std::atomic<size_t> resolved{0};
+  };
+
+  UA_Server *server_;
+  PublisherConfig config_;
+  std::vector<std::unique_ptr<WriterGroup>> groups_;
+  std::atomic<bool> running_{false};
+#ifdef _WIN32
+  using Socket = SOCKET;
+  static constexpr Socket kNoSocket = INVALID_SOCKET;
+#else
+  using Socket = int;
+  static constexpr Socket kNoSocket = -1;
+#endif
+  Socket socket_ = kNoSocket;
+  uint32_t destAddr_ = 0; // Network byte order
+  uint16_t destPort_ = 0; // Network byte order
+
+  std::mutex resolverMutex_;
+  Resolver resolver_;
+
+  bool openSocket();
+  void closeSocket();
+  void publish(WriterGroup &group);
+
+  static void publishCallback(UA_Server *server, void *data);
+};
+
+} // namespace pubsub
+} // namespace opcua
+} // namespace gateway
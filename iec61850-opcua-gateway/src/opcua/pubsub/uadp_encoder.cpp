@@ -0,0 +1,297 @@
+#include "uadp_encoder.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace gateway {
+namespace opcua {
+namespace pubsub {
+
+namespace {
+
+// NetworkMessage header bits (Part 14, 7.2.2.2)
+constexpr uint8_t kUadpVersion = 0x01;
+constexpr uint8_t kPublisherIdEnabled = 0x10;
+constexpr uint8_t kGroupHeaderEnabled = 0x20;
+constexpr uint8_t kPayloadHeaderEnabled = 0x40;
+constexpr uint8_t kExtendedFlags1Enabled = 0x80;
+constexpr uint8_t kPublisherIdUInt16 = 0x01;
+constexpr uint8_t kTimestampEnabled = 0x20;
+constexpr uint8_t kWriterGroupIdEnabled = 0x01;
+constexpr uint8_t kSequenceNumberEnabled = 0x08;
+
+constexpr uint8_t kNetworkFlags = kUadpVersion | kPublisherIdEnabled |
+                                  kGroupHeaderEnabled | kPayloadHeaderEnabled |
+                                  kExtendedFlags1Enabled;
+constexpr uint8_t kExtendedFlags1 = kPublisherIdUInt16 | kTimestampEnabled;
+constexpr uint8_t kGroupFlags = kWriterGroupIdEnabled | kSequenceNumberEnabled;
+
+// DataSetMessage header bits (Part 14, 7.2.2.3)
+constexpr uint8_t kDataSetValid = 0x01;
+constexpr uint8_t kDataSetSequenceNumberEnabled = 0x08;
+constexpr uint8_t kConfigVersionMajorEnabled = 0x20;
+constexpr uint8_t kDataSetFlags2Enabled = 0x80;
+constexpr uint8_t kDataSetFlags1 = kDataSetValid |
+                                   kDataSetSequenceNumberEnabled |
+                                   kConfigVersionMajorEnabled |
+                                   kDataSetFlags2Enabled;
+
+// Built-in type ids used in the Variant encoding byte
+enum : uint8_t {
+  kTypeNull = 0,
+  kTypeBoolean = 1,
+  kTypeInt32 = 6,
+  kTypeUInt32 = 7,
+  kTypeFloat = 10,
+  kTypeDouble = 11,
+  kTypeString = 12
+};
+
+template <typename T> void put(std::vector<uint8_t> &out, T value) {
+  uint8_t bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  // Wire format is little endian
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  for (size_t i = sizeof(T); i > 0; --i)
+    out.push_back(bytes[i - 1]);
+#else
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+#endif
+}
+
+class Reader {
+public:
+  Reader(const uint8_t *data, size_t length) : data_(data), length_(length) {}
+
+  template <typename T> bool get(T *value) {
+    if (length_ - pos_ < sizeof(T))
+      return false;
+    uint8_t bytes[sizeof(T)];
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (size_t i = 0; i < sizeof(T); ++i)
+      bytes[i] = data_[pos_ + sizeof(T) - 1 - i];
+#else
+    std::memcpy(bytes, data_ + pos_, sizeof(T));
+#endif
+    std::memcpy(value, bytes, sizeof(T));
+    pos_ += sizeof(T);
+    return true;
+  }
+
+  bool skip(size_t n) {
+    if (length_ - pos_ < n)
+      return false;
+    pos_ += n;
+    return true;
+  }
+
+private:
+  const uint8_t *data_;
+  size_t length_;
+  size_t pos_ = 0;
+};
+
+bool decodeVariant(Reader &in, double *value) {
+  uint8_t type;
+  if (!in.get(&type))
+    return false;
+  *value = std::numeric_limits<double>::quiet_NaN();
+  switch (type) {
+  case kTypeNull:
+    return true;
+  case kTypeBoolean: {
+    uint8_t b;
+    if (!in.get(&b))
+      return false;
+    *value = b ? 1.0 : 0.0;
+    return true;
+  }
+  case kTypeInt32: {
+    int32_t i;
+    if (!in.get(&i))
+      return false;
+    *value = i;
+    return true;
+  }
+  case kTypeUInt32: {
+    uint32_t u;
+    if (!in.get(&u))
+      return false;
+    *value = u;
+    return true;
+  }
+  case kTypeFloat: {
+    float f;
+    if (!in.get(&f))
+      return false;
+    *value = f;
+    return true;
+  }
+  case kTypeDouble: {
+    double d;
+    if (!in.get(&d))
+      return false;
+    *value = d;
+    return true;
+  }
+  case kTypeString: {
+    int32_t len;
+    if (!in.get(&len))
+      return false;
+    return len <= 0 || in.skip(static_cast<size_t>(len));
+  }
+  default:
+    return false;
+  }
+}
+
+bool decodeDataSetMessage(Reader &in, DecodedNetworkMessage::Message &msg) {
+  uint8_t flags1, flags2;
+  uint32_t configVersion;
+  if (!in.get(&flags1) || flags1 != kDataSetFlags1 || !in.get(&flags2) ||
+      !in.get(&msg.sequenceNumber) || !in.get(&configVersion))
+    return false;
+
+  msg.type = static_cast<DataSetMessageType>(flags2 & 0x0F);
+  if (msg.type == DataSetMessageType::KeepAlive)
+    return true;
+  if (msg.type != DataSetMessageType::KeyFrame &&
+      msg.type != DataSetMessageType::DeltaFrame)
+    return false;
+
+  uint16_t count;
+  if (!in.get(&count))
+    return false;
+  for (uint16_t i = 0; i < count; ++i) {
+    uint16_t index = i;
+    if (msg.type == DataSetMessageType::DeltaFrame && !in.get(&index))
+      return false;
+    double value;
+    if (!decodeVariant(in, &value))
+      return false;
+    msg.fieldIndexes.push_back(index);
+    msg.values.push_back(value);
+  }
+  return true;
+}
+
+} // namespace
+
+void UadpEncoder::encodeVariant(const UA_Variant &value,
+                                std::vector<uint8_t> &out) {
+  if (!value.data || !UA_Variant_isScalar(&value)) {
+    out.push_back(kTypeNull);
+  } else if (value.type == &UA_TYPES[UA_TYPES_BOOLEAN]) {
+    out.push_back(kTypeBoolean);
+    out.push_back(*static_cast<const UA_Boolean *>(value.data) ? 1 : 0);
+  } else if (value.type == &UA_TYPES[UA_TYPES_INT32]) {
+    out.push_back(kTypeInt32);
+    put(out, *static_cast<const UA_Int32 *>(value.data));
+  } else if (value.type == &UA_TYPES[UA_TYPES_UINT32]) {
+    out.push_back(kTypeUInt32);
+    put(out, *static_cast<const UA_UInt32 *>(value.data));
+  } else if (value.type == &UA_TYPES[UA_TYPES_FLOAT]) {
+    out.push_back(kTypeFloat);
+    put(out, *static_cast<const UA_Float *>(value.data));
+  } else if (value.type == &UA_TYPES[UA_TYPES_DOUBLE]) {
+    out.push_back(kTypeDouble);
+    put(out, *static_cast<const UA_Double *>(value.data));
+  } else if (value.type == &UA_TYPES[UA_TYPES_STRING]) {
+    const auto *s = static_cast<const UA_String *>(value.data);
+    out.push_back(kTypeString);
+    if (!s->data) {
+      put(out, static_cast<int32_t>(-1));
+    } else {
+      put(out, static_cast<int32_t>(s->length));
+      out.insert(out.end(), s->data, s->data + s->length);
+    }
+  } else {
+    out.push_back(kTypeNull);
+  }
+}
+
+void UadpEncoder::encodeNetworkMessage(
+    uint16_t publisherId, uint16_t writerGroupId, uint16_t sequenceNumber,
+    UA_DateTime timestamp, const std::vector<DataSetMessage> &messages,
+    std::vector<uint8_t> &out) {
+  out.clear();
+  out.push_back(kNetworkFlags);
+  out.push_back(kExtendedFlags1);
+  put(out, publisherId);
+
+  out.push_back(kGroupFlags);
+  put(out, writerGroupId);
+  put(out, sequenceNumber);
+
+  out.push_back(static_cast<uint8_t>(messages.size()));
+  for (const auto &msg : messages)
+    put(out, msg.writerId);
+
+  put(out, static_cast<int64_t>(timestamp));
+
+  // With more than one DataSetMessage the payload starts with their sizes,
+  // patched in once each message is encoded
+  size_t sizesPos = out.size();
+  if (messages.size() > 1)
+    out.resize(out.size() + 2 * messages.size());
+
+  for (size_t m = 0; m < messages.size(); ++m) {
+    const DataSetMessage &msg = messages[m];
+    size_t start = out.size();
+
+    out.push_back(kDataSetFlags1);
+    out.push_back(static_cast<uint8_t>(msg.type));
+    put(out, msg.sequenceNumber);
+    put(out, msg.configVersion);
+
+    if (msg.type != DataSetMessageType::KeepAlive) {
+      put(out, static_cast<uint16_t>(msg.fields.size()));
+      for (const auto &field : msg.fields) {
+        if (msg.type == DataSetMessageType::DeltaFrame)
+          put(out, field.first);
+        out.insert(out.end(), field.second->begin(), field.second->end());
+      }
+    }
+
+    if (messages.size() > 1) {
+      std::vector<uint8_t> size;
+      put(size, static_cast<uint16_t>(out.size() - start));
+      out[sizesPos + 2 * m] = size[0];
+      out[sizesPos + 2 * m + 1] = size[1];
+    }
+  }
+}
+
+bool UadpEncoder::decodeNetworkMessage(const uint8_t *data, size_t length,
+                                       DecodedNetworkMessage &out) {
+  Reader in(data, length);
+  uint8_t flags, extFlags1, groupFlags, count;
+  if (!in.get(&flags) || flags != kNetworkFlags || !in.get(&extFlags1) ||
+      extFlags1 != kExtendedFlags1 || !in.get(&out.publisherId) ||
+      !in.get(&groupFlags) || groupFlags != kGroupFlags ||
+      !in.get(&out.writerGroupId) || !in.get(&out.sequenceNumber) ||
+      !in.get(&count))
+    return false;
+
+  out.messages.assign(count, DecodedNetworkMessage::Message{});
+  for (auto &msg : out.messages) {
+    if (!in.get(&msg.writerId))
+      return false;
+  }
+  int64_t timestamp;
+  if (!in.get(&timestamp))
+    return false;
+  out.timestamp = timestamp;
+  if (count > 1 && !in.skip(2u * count))
+    return false;
+
+  for (auto &msg : out.messages) {
+    if (!decodeDataSetMessage(in, msg))
+      return false;
+  }
+  return true;
+}
+
+} // namespace pubsub
+} // namespace opcua
+} // namespace gateway
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <open62541/types.h>
+#include <utility>
+#include <vector>
+
+namespace gateway {
+namespace opcua {
+namespace pubsub {
+
+enum class DataSetMessageType : uint8_t {
+  KeyFrame = 0,
+  DeltaFrame = 1,
+  KeepAlive = 3
+};
+
+/**
+ * @brief One DataSetMessage of a UADP NetworkMessage
+ */
+struct DataSetMessage {
+  uint16_t writerId = 0;
+  uint16_t sequenceNumber = 0;
+  DataSetMessageType type = DataSetMessageType::KeyFrame;
+  uint32_t configVersion = 0; // ConfigurationVersion.MajorVersion
+  // (field index, binary encoded Variant). Key frames carry every field in
+  // index order; delta frames only the changed ones.
+  std::vector<std::pair<uint16_t, const std::vector<uint8_t> *>> fields;
+};
+
+/**
+ * @brief Decoded view of a NetworkMessage, used by receivers and tests
+ */
+struct DecodedNetworkMessage {
+  uint16_t publisherId = 0;
+  uint16_t writerGroupId = 0;
+  uint16_t sequenceNumber = 0;
+  UA_DateTime timestamp = 0;
+  struct Message {
+    uint16_t writerId = 0;
+    uint16_t sequenceNumber = 0;
+    DataSetMessageType type = DataSetMessageType::KeyFrame;
+    std::vector<uint16_t> fieldIndexes;
+    std::vector<double> values; // Numeric fields, NaN otherwise
+  };
+  std::vector<Message> messages;
+};
+
+/**
+ * @brief OPC UA Part 14 UADP message mapping (unsecured, Variant field
+ * encoding)
+ *
+ * NetworkMessages carry a UInt16 PublisherId, a group header with
+ * WriterGroupId and SequenceNumber, a payload header listing the
+ * DataSetWriterIds and a timestamp.
+ */
+class UadpEncoder {
+public:
+  /**
+   * @brief Binary-encode a scalar Variant (Boolean, Int32, UInt32, Float,
+   * Double, String); anything else is encoded as an empty Variant
+   */
+  static void encodeVariant(const UA_Variant &value, std::vector<uint8_t> &out);
+
+  /**
+   * @brief Encode a NetworkMessage into @p out (cleared first)
+   */
+  static void encodeNetworkMessage(uint16_t publisherId,
+                                   uint16_t writerGroupId,
+                                   uint16_t sequenceNumber,
+                                   UA_DateTime timestamp,
+                                   const std::vector<DataSetMessage> &messages,
+                                   std::vector<uint8_t> &out);
+
+  /**
+   * @brief Decode a NetworkMessage produced by encodeNetworkMessage()
+   * @return false if the buffer is malformed or uses unsupported options
+   */
+  static bool decodeNetworkMessage(const uint8_t *data, size_t length,
+                                   DecodedNetworkMessage &out);
+};
+
+} // namespace pubsub
+} // namespace opcua
+} // namespace gateway
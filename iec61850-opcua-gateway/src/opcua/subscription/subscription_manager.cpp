@@ -1,11 +1,322 @@
 #include "subscription_manager.h"
+#include "core/logger.h"
+#include <algorithm>
+#include <map>
+#include <unordered_set>
 
 namespace gateway {
 namespace opcua {
 namespace subscription {
 
-SubscriptionManager::SubscriptionManager(std::shared_ptr<OPCUAServer> server)
-    : server_(server) {}
+namespace {
+
+// Weight of the newest sampling gap in the smoothed sampling interval
+constexpr double kSampleSmoothing = 0.25;
+
+// open62541 keeps no user context for the monitored item callback, so
+// managers are looked up by server
+std::mutex g_registryMutex;
+std::map<UA_Server *, SubscriptionManager *> g_registry;
+
+double toMs(SubscriptionManager::Clock::duration d) {
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+
+SubscriptionManager::Clock::duration fromMs(double ms) {
+  return std::chrono::duration_cast<SubscriptionManager::Clock::duration>(
+      std::chrono::duration<double, std::milli>(ms));
+}
+
+} // namespace
+
+SubscriptionManager::SubscriptionManager(std::shared_ptr<OPCUAServer> server,
+                                         std::shared_ptr<DataBinder> binder)
+    : server_(server), binder_(binder) {
+  if (!server_ || !server_->getNativeServer())
+    return;
+
+  UA_Server *uaServer = server_->getNativeServer();
+  {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    g_registry[uaServer] = this;
+  }
+  UA_ServerConfig *config = UA_Server_getConfig(uaServer);
+  config->monitoredItemRegisterCallback = &monitoredItemCallback;
+
+  if (binder_) {
+    binder_->setSampleHook(
+        [this](const std::string &ref) { this->onSample(ref); });
+  }
+}
+
+SubscriptionManager::~SubscriptionManager() {
+  if (binder_) {
+    binder_->setSampleHook(nullptr);
+  }
+  if (!server_ || !server_->getNativeServer())
+    return;
+
+  UA_Server *uaServer = server_->getNativeServer();
+  UA_Server_getConfig(uaServer)->monitoredItemRegisterCallback = nullptr;
+  std::lock_guard<std::mutex> lock(g_registryMutex);
+  g_registry.erase(uaServer);
+}
+
+void SubscriptionManager::setIntervals(int defaultMs, int backgroundMs,
+                                       int minMs) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  minMs_ = std::max(1, minMs);
+  defaultMs_ = std::max<double>(minMs_, defaultMs);
+  backgroundMs_ = std::max<double>(defaultMs_, backgroundMs);
+}
+
+uint64_t SubscriptionManager::addWatcher(const std::vector<std::string> &refs,
+                                         int intervalMs, int ttlMs) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto now = Clock::now();
+
+  uint64_t id = nextWatcherId_++;
+  Watcher &w = watchers_[id];
+  w.refs = refs;
+  w.intervalMs = intervalMs;
+  w.expires = now + std::chrono::milliseconds(ttlMs);
+
+  for (const auto &ref : refs) {
+    auto it = demand_.find(ref);
+    if (it == demand_.end())
+      continue; // Not bound; nothing to poll
+    it->second.watcherIntervals.insert(intervalMs);
+    rescheduleLocked(ref, it->second, now);
+  }
+
+  LOG_DEBUG("REST watcher {} added for {} references at {} ms", id,
+            refs.size(), intervalMs);
+  return id;
+}
+
+bool SubscriptionManager::renewWatcher(uint64_t id, int ttlMs) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = watchers_.find(id);
+  if (it == watchers_.end())
+    return false;
+  it->second.expires = Clock::now() + std::chrono::milliseconds(ttlMs);
+  return true;
+}
+
+bool SubscriptionManager::removeWatcher(uint64_t id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = watchers_.find(id);
+  if (it == watchers_.end())
+    return false;
+  dropWatcherLocked(it->second);
+  watchers_.erase(it);
+  return true;
+}
+
+double SubscriptionManager::pollIntervalMs(const std::string &ref) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = demand_.find(ref);
+  return it == demand_.end() ? backgroundMs_ : intervalLocked(it->second);
+}
+
+std::vector<std::string>
+SubscriptionManager::collectDue(Clock::time_point now,
+                                Clock::time_point *nextDue) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  expireWatchersLocked(now);
+
+  std::vector<std::string> due;
+  while (!schedule_.empty() && schedule_.top().first <= now) {
+    DueEntry entry = schedule_.top();
+    schedule_.pop();
+
+    auto it = demand_.find(entry.second);
+    if (it == demand_.end() || it->second.nextDue != entry.first)
+      continue; // Stale entry
+
+    Demand &d = it->second;
+    d.nextDue = now + fromMs(intervalLocked(d));
+    schedule_.emplace(d.nextDue, entry.second);
+    due.push_back(std::move(entry.second));
+  }
+
+  if (nextDue) {
+    *nextDue = schedule_.empty() ? now + fromMs(backgroundMs_)
+                                 : schedule_.top().first;
+  }
+  return due;
+}
+
+void SubscriptionManager::setReferences(const std::vector<std::string> &refs) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto now = Clock::now();
+
+  std::unordered_set<std::string> wanted(refs.begin(), refs.end());
+  for (auto it = demand_.begin(); it != demand_.end();) {
+    if (wanted.count(it->first)) {
+      ++it;
+    } else {
+      it = demand_.erase(it);
+    }
+  }
+
+  // Rebuild the schedule; surviving references keep their due time
+  decltype(schedule_) schedule;
+  for (const auto &ref : refs) {
+    auto result = demand_.emplace(ref, Demand{});
+    Demand &d = result.first->second;
+    if (result.second) {
+      d.nextDue = now;
+      // Watchers registered before the reference was bound
+      for (const auto &entry : watchers_) {
+        const auto &wrefs = entry.second.refs;
+        if (std::find(wrefs.begin(), wrefs.end(), ref) != wrefs.end())
+          d.watcherIntervals.insert(entry.second.intervalMs);
+      }
+    }
+    schedule.emplace(d.nextDue, ref);
+  }
+  schedule_.swap(schedule);
+}
+
+std::vector<DemandInfo> SubscriptionManager::getDemand() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  expireWatchersLocked(Clock::now());
+
+  std::vector<DemandInfo> result;
+  for (const auto &entry : demand_) {
+    const Demand &d = entry.second;
+    if (d.monitoredItems == 0 && d.watcherIntervals.empty())
+      continue;
+    DemandInfo info;
+    info.reference = entry.first;
+    info.monitoredItems = d.monitoredItems;
+    info.restWatchers = d.watcherIntervals.size();
+    info.samplingMs = d.samplingMs;
+    info.pollIntervalMs = intervalLocked(d);
+    result.push_back(std::move(info));
+  }
+  return result;
+}
+
+void SubscriptionManager::onMonitoredItem(const std::string &ref,
+                                          bool removed) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = demand_.find(ref);
+  if (it == demand_.end())
+    return;
+
+  Demand &d = it->second;
+  if (removed) {
+    if (d.monitoredItems > 0)
+      d.monitoredItems--;
+    if (d.monitoredItems == 0) {
+      d.samplingMs = 0.0;
+      d.lastSample = Clock::time_point{};
+    }
+  } else {
+    d.monitoredItems++;
+    rescheduleLocked(ref, d, Clock::now()); // Serve the new item right away
+  }
+  LOG_DEBUG("Monitored items on {}: {}", ref, d.monitoredItems);
+}
+
+void SubscriptionManager::onSample(const std::string &ref) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = demand_.find(ref);
+  if (it == demand_.end())
+    return;
+
+  Demand &d = it->second;
+  if (d.monitoredItems == 0)
+    return; // Plain Read requests don't express demand
+
+  auto now = Clock::now();
+  if (d.lastSample != Clock::time_point{}) {
+    double gap = toMs(now - d.lastSample);
+    d.samplingMs = d.samplingMs == 0.0
+                       ? gap
+                       : d.samplingMs + kSampleSmoothing * (gap - d.samplingMs);
+    rescheduleLocked(ref, d, now + fromMs(intervalLocked(d)));
+  }
+  d.lastSample = now;
+}
+
+double SubscriptionManager::intervalLocked(const Demand &d) const {
+  double interval = backgroundMs_;
+  if (d.monitoredItems > 0) {
+    interval = d.samplingMs > 0.0 ? d.samplingMs : defaultMs_;
+  }
+  if (!d.watcherIntervals.empty()) {
+    interval = std::min<double>(interval, *d.watcherIntervals.begin());
+  }
+  return std::max(interval, minMs_);
+}
+
+void SubscriptionManager::rescheduleLocked(const std::string &ref, Demand &d,
+                                           Clock::time_point due) {
+  // Only pull a poll forward; a slower interval takes effect after the next
+  // poll anyway
+  if (due < d.nextDue) {
+    d.nextDue = due;
+    schedule_.emplace(d.nextDue, ref);
+  }
+}
+
+void SubscriptionManager::expireWatchersLocked(Clock::time_point now) {
+  for (auto it = watchers_.begin(); it != watchers_.end();) {
+    if (it->second.expires <= now) {
+      LOG_DEBUG("REST watcher {} expired", it->first);
+      dropWatcherLocked(it->second);
+      it = watchers_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void SubscriptionManager::dropWatcherLocked(const Watcher &w) {
+  for (const auto &ref : w.refs) {
+    auto it = demand_.find(ref);
+    if (it == demand_.end())
+      continue;
+    auto &intervals = it->second.watcherIntervals;
+    auto pos = intervals.find(w.intervalMs);
+    if (pos != intervals.end())
+      intervals.erase(pos);
+  }
+}
+
+void SubscriptionManager::monitoredItemCallback(
+    UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+    const UA_NodeId *nodeId, void *nodeContext, UA_UInt32 attributeId,
+    UA_Boolean removed) {
+  (void)sessionId;
+  (void)sessionContext;
+  (void)nodeContext;
+  if (attributeId != UA_ATTRIBUTEID_VALUE || !nodeId)
+    return;
+
+  SubscriptionManager *self = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    auto it = g_registry.find(server);
+    if (it != g_registry.end())
+      self = it->second;
+  }
+  if (!self || !self->binder_)
+    return;
+
+  std::string ref = self->binder_->getReference(*nodeId);
+  if (ref.empty())
+    return; // Not a polled node
+
+  // Sampling a bound node then reports back through onSample()
+  if (!removed) {
+    self->binder_->trackSampling(*nodeId);
+  }
+  self->onMonitoredItem(ref, removed);
+}
 
 } // namespace subscription
 } // namespace opcua
@@ -1,22 +1,156 @@
 #pragma once
 
+#include "opcua/data_binder.h"
 #include "opcua/opcua_server.h"
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace gateway {
 namespace opcua {
 namespace subscription {
 
+/**
+ * @brief Current demand for one IEC61850 reference
+ */
+struct DemandInfo {
+  std::string reference;
+  size_t monitoredItems = 0; // Live OPC UA monitored items on the bound node
+  size_t restWatchers = 0;   // Unexpired REST watchers
+  double samplingMs = 0.0;   // Observed OPC UA sampling interval, 0 if none
+  double pollIntervalMs = 0.0;
+};
+
+/**
+ * @brief Tracks who is watching which data point and schedules polls
+ *
+ * Demand comes from OPC UA monitored items (registered through the server's
+ * monitored item callback) and from REST watchers. The sampling interval of
+ * an OPC UA item is observed from the cadence at which the server samples
+ * the bound node. Each reference is polled at the fastest interval anyone
+ * asked for; unobserved references fall back to a slow background rate.
+ */
 class SubscriptionManager {
 public:
-  SubscriptionManager(std::shared_ptr<OPCUAServer> server);
+  using Clock = std::chrono::steady_clock;
+
+  SubscriptionManager(std::shared_ptr<OPCUAServer> server,
+                      std::shared_ptr<DataBinder> binder);
+  ~SubscriptionManager();
+
+  /**
+   * @brief Configure poll intervals
+   * @param defaultMs Interval for monitored points until their sampling
+   * interval has been observed
+   * @param backgroundMs Interval for points nobody is watching
+   * @param minMs Lower bound for any poll interval
+   */
+  void setIntervals(int defaultMs, int backgroundMs, int minMs);
+
+  /**
+   * @brief Register a REST watcher for a set of references
+   * @param refs IEC61850 references ("IED/LD/LN.DO")
+   * @param intervalMs Requested update interval
+   * @param ttlMs Lifetime; the watcher expires unless renewed
+   * @return Watcher id
+   */
+  uint64_t addWatcher(const std::vector<std::string> &refs, int intervalMs,
+                      int ttlMs);
+
+  /**
+   * @brief Extend a watcher's lifetime
+   * @return false if the watcher does not exist (e.g. expired)
+   */
+  bool renewWatcher(uint64_t id, int ttlMs);
+
+  /**
+   * @brief Remove a watcher
+   * @return false if the watcher does not exist
+   */
+  bool removeWatcher(uint64_t id);
+
+  /**
+   * @brief Poll interval currently in effect for a reference
+   */
+  double pollIntervalMs(const std::string &ref);
+
+  /**
+   * @brief Pop the references whose poll is due and schedule their next poll
+   * @param now Current time
+   * @param nextDue Receives the time of the earliest remaining poll
+   * @return References to poll now
+   */
+  std::vector<std::string> collectDue(Clock::time_point now,
+                                      Clock::time_point *nextDue);
 
-  // TODO: Implement subscription logic
-  // open62541 handles subscriptions automatically for Variables.
-  // This class will be used for more advanced event-driven updates if needed.
+  /**
+   * @brief Set the references that can be polled
+   *
+   * New references are polled immediately, removed ones are forgotten.
+   */
+  void setReferences(const std::vector<std::string> &refs);
+
+  /**
+   * @brief Demand for every reference that has an observer
+   */
+  std::vector<DemandInfo> getDemand();
+
+  // Called from the OPC UA server thread
+  void onMonitoredItem(const std::string &ref, bool removed);
+  void onSample(const std::string &ref);
 
 private:
+  struct Demand {
+    size_t monitoredItems = 0;
+    double samplingMs = 0.0;
+    Clock::time_point lastSample{};
+    std::multiset<int> watcherIntervals;
+    Clock::time_point nextDue{};
+  };
+
+  struct Watcher {
+    std::vector<std::string> refs;
+    int intervalMs;
+    Clock::time_point expires;
+  };
+
   std::shared_ptr<OPCUAServer> server_;
+  std::shared_ptr<DataBinder> binder_;
+
+  double defaultMs_ = 1000.0;
+  double backgroundMs_ = 10000.0;
+  double minMs_ = 100.0;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, Demand> demand_;
+  std::unordered_map<uint64_t, Watcher> watchers_;
+  uint64_t nextWatcherId_ = 1;
+
+  // Min-heap of (due time, reference). Entries whose time no longer matches
+  // Demand::nextDue are stale and skipped when popped.
+  using DueEntry = std::pair<Clock::time_point, std::string>;
+  std::priority_queue<DueEntry, std::vector<DueEntry>, std::greater<DueEntry>>
+      schedule_;
+
+  // Caller holds mutex_
+  double intervalLocked(const Demand &d) const;
+  void rescheduleLocked(const std::string &ref, Demand &d,
+                        Clock::time_point due);
+  void expireWatchersLocked(Clock::time_point now);
+  void dropWatcherLocked(const Watcher &w);
+
+  // open62541 monitored item callback, dispatched by server
+  static void monitoredItemCallback(UA_Server *server,
+                                    const UA_NodeId *sessionId,
+                                    void *sessionContext,
+                                    const UA_NodeId *nodeId, void *nodeContext,
+                                    UA_UInt32 attributeId, UA_Boolean removed);
 };
 
 } // namespace subscription
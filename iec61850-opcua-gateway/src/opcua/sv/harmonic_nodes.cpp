@@ -0,0 +1,118 @@
+#include "harmonic_nodes.h"
+#include "core/logger.h"
+#include <vector>
+
+namespace gateway {
+namespace opcua {
+namespace sv {
+
+namespace {
+
+using iec61850::sv::kChannelNames;
+using iec61850::sv::kChannels;
+
+void setFloats(UA_Variant &variant, const std::vector<float> &values) {
+  UA_Variant_setArrayCopy(&variant, values.data(), values.size(),
+                          &UA_TYPES[UA_TYPES_FLOAT]);
+}
+
+UA_DateTime toDateTime(uint64_t unixUs) {
+  return UA_DATETIME_UNIX_EPOCH +
+         static_cast<UA_DateTime>(unixUs) * UA_DATETIME_USEC;
+}
+
+} // namespace
+
+HarmonicNodes::HarmonicNodes(std::shared_ptr<OPCUAServer> server)
+    : server_(std::move(server)) {
+  UA_NodeId_init(&root_);
+}
+
+HarmonicNodes::~HarmonicNodes() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &entry : streams_) {
+    for (UA_NodeId &node : entry.second.channels)
+      UA_NodeId_clear(&node);
+    UA_NodeId_clear(&entry.second.thd);
+    UA_NodeId_clear(&entry.second.windowStart);
+  }
+  UA_NodeId_clear(&root_);
+}
+
+HarmonicNodes::StreamNodes *HarmonicNodes::nodesFor(const std::string &stream,
+                                                    int maxOrder) {
+  auto it = streams_.find(stream);
+  if (it != streams_.end())
+    return &it->second;
+
+  if (UA_NodeId_isNull(&root_)) {
+    root_ = server_->createFolder(UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  "Harmonics", "SV Harmonics");
+    if (UA_NodeId_isNull(&root_))
+      return nullptr;
+  }
+  UA_NodeId folder = server_->createFolder(root_, stream, stream);
+  if (UA_NodeId_isNull(&folder))
+    return nullptr;
+
+  StreamNodes nodes;
+  UA_Variant value;
+  UA_Variant_init(&value);
+  setFloats(value,
+            std::vector<float>(static_cast<size_t>(maxOrder) + 1, 0.0f));
+  for (int ch = 0; ch < kChannels; ++ch) {
+    const char *name = kChannelNames[static_cast<size_t>(ch)];
+    nodes.channels[ch] = server_->createVariable(folder, name, value, name);
+  }
+  UA_Variant_clear(&value);
+
+  setFloats(value, std::vector<float>(kChannels, 0.0f));
+  nodes.thd = server_->createVariable(folder, "THD", value, "THD %");
+  UA_Variant_clear(&value);
+
+  UA_DateTime start = 0;
+  UA_Variant_setScalarCopy(&value, &start, &UA_TYPES[UA_TYPES_DATETIME]);
+  nodes.windowStart =
+      server_->createVariable(folder, "WindowStart", value, "Window Start");
+  UA_Variant_clear(&value);
+  UA_NodeId_clear(&folder);
+
+  LOG_INFO("Created OPC UA harmonic nodes for SV stream {}", stream);
+  return &streams_.emplace(stream, nodes).first->second;
+}
+
+void HarmonicNodes::update(const std::string &stream,
+                           const iec61850::sv::HarmonicResult &result) {
+  if (!server_ || !result.valid)
+    return;
+  UA_Server *uaServer = server_->getNativeServer();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  StreamNodes *nodes = nodesFor(stream, result.maxOrder);
+  if (!nodes)
+    return;
+
+  UA_Variant value;
+  UA_Variant_init(&value);
+  std::vector<float> floats;
+  for (int ch = 0; ch < kChannels; ++ch) {
+    floats.assign(result.harmonics[ch].begin(), result.harmonics[ch].end());
+    setFloats(value, floats);
+    UA_Server_writeValue(uaServer, nodes->channels[ch], value);
+    UA_Variant_clear(&value);
+  }
+
+  floats.assign(std::begin(result.thd), std::end(result.thd));
+  setFloats(value, floats);
+  UA_Server_writeValue(uaServer, nodes->thd, value);
+  UA_Variant_clear(&value);
+
+  UA_DateTime start = toDateTime(result.timestamp);
+  UA_Variant_setScalarCopy(&value, &start, &UA_TYPES[UA_TYPES_DATETIME]);
+  UA_Server_writeValue(uaServer, nodes->windowStart, value);
+  UA_Variant_clear(&value);
+}
+
+} // namespace sv
+} // namespace opcua
+} // namespace gateway
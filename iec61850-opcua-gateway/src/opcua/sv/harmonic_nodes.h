@@ -0,0 +1,55 @@
+#pragma once
+
+#include "iec61850/sv/harmonic_analyzer.h"
+#include "opcua/opcua_server.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace gateway {
+namespace opcua {
+namespace sv {
+
+/**
+ * @brief OPC UA variables holding the harmonic analysis of SV streams
+ *
+ * Each stream gets a folder under Objects/Harmonics with one Float array
+ * per channel (Ia .. Un), the RMS of harmonic orders 0 .. maxOrder, a
+ * Float array THD of the eight channels in percent, and the DateTime
+ * WindowStart. Nodes are created on a stream's first result.
+ */
+class HarmonicNodes {
+public:
+  explicit HarmonicNodes(std::shared_ptr<OPCUAServer> server);
+  ~HarmonicNodes();
+
+  HarmonicNodes(const HarmonicNodes &) = delete;
+  HarmonicNodes &operator=(const HarmonicNodes &) = delete;
+
+  /**
+   * @brief Write the result of one window
+   * @param stream Folder name, e.g. the svID
+   */
+  void update(const std::string &stream,
+              const iec61850::sv::HarmonicResult &result);
+
+private:
+  struct StreamNodes {
+    UA_NodeId channels[iec61850::sv::kChannels];
+    UA_NodeId thd;
+    UA_NodeId windowStart;
+  };
+
+  // Caller holds mutex_
+  StreamNodes *nodesFor(const std::string &stream, int maxOrder);
+
+  std::shared_ptr<OPCUAServer> server_;
+  std::mutex mutex_;
+  UA_NodeId root_;
+  std::map<std::string, StreamNodes> streams_;
+};
+
+} // namespace sv
+} // namespace opcua
+} // namespace gateway
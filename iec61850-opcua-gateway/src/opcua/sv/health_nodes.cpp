@@ -0,0 +1,170 @@
+#include "health_nodes.h"
+#include "core/logger.h"
+
+namespace gateway {
+namespace opcua {
+namespace sv {
+
+namespace {
+
+using iec61850::sv::kArrivalJitterBoundsUs;
+using iec61850::sv::kArrivalJitterBuckets;
+using iec61850::sv::SVHealthSnapshot;
+
+// Browse names of HealthNodes::StreamNodes::counters, in order
+constexpr const char *kCounterNames[] = {
+    "Samples",    "MissingSamples",  "Gaps",           "Duplicates",
+    "OutOfOrder", "SmpSynchChanges", "ConfRevChanges", "MalformedASDUs"};
+
+void counterValues(const SVHealthSnapshot &health, UA_UInt64 *out) {
+  out[0] = health.samples;
+  out[1] = health.missingSamples;
+  out[2] = health.gaps;
+  out[3] = health.duplicates;
+  out[4] = health.outOfOrder;
+  out[5] = health.synchChanges;
+  out[6] = health.confRevChanges;
+  out[7] = health.malformed;
+}
+
+UA_DateTime toDateTime(uint64_t unixUs) {
+  return UA_DATETIME_UNIX_EPOCH +
+         static_cast<UA_DateTime>(unixUs) * UA_DATETIME_USEC;
+}
+
+} // namespace
+
+HealthNodes::HealthNodes(std::shared_ptr<OPCUAServer> server)
+    : server_(std::move(server)) {
+  static_assert(sizeof(kCounterNames) / sizeof(kCounterNames[0]) ==
+                    kCounters,
+                "One browse name per counter");
+  UA_NodeId_init(&root_);
+}
+
+HealthNodes::~HealthNodes() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &entry : streams_) {
+    StreamNodes &nodes = entry.second;
+    for (UA_NodeId &node : nodes.counters)
+      UA_NodeId_clear(&node);
+    UA_NodeId_clear(&nodes.synchronised);
+    UA_NodeId_clear(&nodes.confRev);
+    UA_NodeId_clear(&nodes.maxJitter);
+    UA_NodeId_clear(&nodes.jitter);
+    UA_NodeId_clear(&nodes.lastArrival);
+  }
+  UA_NodeId_clear(&root_);
+}
+
+HealthNodes::StreamNodes *HealthNodes::nodesFor(const std::string &stream) {
+  auto it = streams_.find(stream);
+  if (it != streams_.end())
+    return &it->second;
+
+  if (UA_NodeId_isNull(&root_)) {
+    root_ = server_->createFolder(UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  "SVDiagnostics", "SV Diagnostics");
+    if (UA_NodeId_isNull(&root_))
+      return nullptr;
+  }
+  UA_NodeId folder = server_->createFolder(root_, stream, stream);
+  if (UA_NodeId_isNull(&folder))
+    return nullptr;
+
+  StreamNodes nodes;
+  UA_Variant value;
+  UA_Variant_init(&value);
+  UA_UInt64 zero = 0;
+  UA_Variant_setScalarCopy(&value, &zero, &UA_TYPES[UA_TYPES_UINT64]);
+  for (int i = 0; i < kCounters; ++i) {
+    nodes.counters[i] = server_->createVariable(folder, kCounterNames[i],
+                                                value, kCounterNames[i]);
+  }
+  UA_Variant_clear(&value);
+
+  UA_Boolean synchronised = false;
+  UA_Variant_setScalarCopy(&value, &synchronised,
+                           &UA_TYPES[UA_TYPES_BOOLEAN]);
+  nodes.synchronised =
+      server_->createVariable(folder, "SmpSynch", value, "SmpSynch");
+  UA_Variant_clear(&value);
+
+  UA_UInt32 zero32 = 0;
+  UA_Variant_setScalarCopy(&value, &zero32, &UA_TYPES[UA_TYPES_UINT32]);
+  nodes.confRev = server_->createVariable(folder, "ConfRev", value, "ConfRev");
+  nodes.maxJitter =
+      server_->createVariable(folder, "MaxJitterUs", value, "Max Jitter us");
+  UA_Variant_clear(&value);
+
+  UA_UInt64 buckets[kArrivalJitterBuckets] = {};
+  UA_Variant_setArrayCopy(&value, buckets, kArrivalJitterBuckets,
+                          &UA_TYPES[UA_TYPES_UINT64]);
+  nodes.jitter = server_->createVariable(folder, "JitterHistogram", value,
+                                         "Jitter Histogram");
+  UA_Variant_clear(&value);
+
+  UA_Variant_setArrayCopy(&value, kArrivalJitterBoundsUs.data(),
+                          kArrivalJitterBoundsUs.size(),
+                          &UA_TYPES[UA_TYPES_UINT32]);
+  UA_NodeId bounds = server_->createVariable(folder, "JitterBoundsUs", value,
+                                             "Jitter Bucket Bounds us");
+  UA_NodeId_clear(&bounds);
+  UA_Variant_clear(&value);
+
+  UA_DateTime never = 0;
+  UA_Variant_setScalarCopy(&value, &never, &UA_TYPES[UA_TYPES_DATETIME]);
+  nodes.lastArrival =
+      server_->createVariable(folder, "LastArrival", value, "Last Arrival");
+  UA_Variant_clear(&value);
+  UA_NodeId_clear(&folder);
+
+  LOG_INFO("Created OPC UA diagnostics nodes for SV stream {}", stream);
+  return &streams_.emplace(stream, nodes).first->second;
+}
+
+void HealthNodes::update(const std::string &stream,
+                         const SVHealthSnapshot &health) {
+  if (!server_ || !health.samples)
+    return;
+  UA_Server *uaServer = server_->getNativeServer();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  StreamNodes *nodes = nodesFor(stream);
+  if (!nodes)
+    return;
+
+  UA_Variant value;
+  UA_UInt64 counters[kCounters];
+  counterValues(health, counters);
+  for (int i = 0; i < kCounters; ++i) {
+    UA_Variant_setScalar(&value, &counters[i], &UA_TYPES[UA_TYPES_UINT64]);
+    UA_Server_writeValue(uaServer, nodes->counters[i], value);
+  }
+
+  UA_Boolean synchronised = health.synchronised;
+  UA_Variant_setScalar(&value, &synchronised, &UA_TYPES[UA_TYPES_BOOLEAN]);
+  UA_Server_writeValue(uaServer, nodes->synchronised, value);
+
+  UA_UInt32 confRev = health.confRev;
+  UA_Variant_setScalar(&value, &confRev, &UA_TYPES[UA_TYPES_UINT32]);
+  UA_Server_writeValue(uaServer, nodes->confRev, value);
+  UA_UInt32 maxJitter = health.maxJitterUs;
+  UA_Variant_setScalar(&value, &maxJitter, &UA_TYPES[UA_TYPES_UINT32]);
+  UA_Server_writeValue(uaServer, nodes->maxJitter, value);
+
+  UA_UInt64 buckets[kArrivalJitterBuckets];
+  for (size_t i = 0; i < kArrivalJitterBuckets; ++i)
+    buckets[i] = health.jitter[i];
+  UA_Variant_setArray(&value, buckets, kArrivalJitterBuckets,
+                      &UA_TYPES[UA_TYPES_UINT64]);
+  UA_Server_writeValue(uaServer, nodes->jitter, value);
+
+  UA_DateTime lastArrival = toDateTime(health.lastArrivalUs);
+  UA_Variant_setScalar(&value, &lastArrival, &UA_TYPES[UA_TYPES_DATETIME]);
+  UA_Server_writeValue(uaServer, nodes->lastArrival, value);
+}
+
+} // namespace sv
+} // namespace opcua
+} // namespace gateway
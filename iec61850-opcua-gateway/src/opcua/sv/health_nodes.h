@@ -0,0 +1,63 @@
+#pragma once
+
+#include "iec61850/sv/sv_stream_health.h"
+#include "opcua/opcua_server.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace gateway {
+namespace opcua {
+namespace sv {
+
+/**
+ * @brief OPC UA diagnostics of SV stream quality
+ *
+ * Each stream gets a folder under Objects/SVDiagnostics with the UInt64
+ * counters Samples, MissingSamples, Gaps, Duplicates, OutOfOrder,
+ * SmpSynchChanges, ConfRevChanges and MalformedASDUs, the Boolean
+ * SmpSynch, the UInt32 ConfRev and MaxJitterUs, the UInt64 array
+ * JitterHistogram with the UInt32 array JitterBoundsUs of its buckets,
+ * and the DateTime LastArrival. Nodes are created on a stream's first
+ * update.
+ */
+class HealthNodes {
+public:
+  explicit HealthNodes(std::shared_ptr<OPCUAServer> server);
+  ~HealthNodes();
+
+  HealthNodes(const HealthNodes &) = delete;
+  HealthNodes &operator=(const HealthNodes &) = delete;
+
+  /**
+   * @brief Write the current state of one stream
+   * @param stream Folder name, e.g. the svID
+   */
+  void update(const std::string &stream,
+              const iec61850::sv::SVHealthSnapshot &health);
+
+private:
+  static constexpr int kCounters = 8;
+
+  struct StreamNodes {
+    UA_NodeId counters[kCounters];
+    UA_NodeId synchronised;
+    UA_NodeId confRev;
+    UA_NodeId maxJitter;
+    UA_NodeId jitter;
+    UA_NodeId lastArrival;
+  };
+
+  // Caller holds mutex_
+  StreamNodes *nodesFor(const std::string &stream);
+
+  std::shared_ptr<OPCUAServer> server_;
+  std::mutex mutex_;
+  UA_NodeId root_;
+  std::map<std::string, StreamNodes> streams_;
+};
+
+} // namespace sv
+} // namespace opcua
+} // namespace gateway
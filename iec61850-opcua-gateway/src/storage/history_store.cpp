@@ -0,0 +1,412 @@
+#include "history_store.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace gateway {
+namespace storage {
+
+namespace {
+
+// Worst case size of one encoded sample: 4+32 bits timestamp, 2+5+6+64 bits
+// value, 1+32 bits status
+constexpr size_t kMaxSampleBits = 160;
+
+// Upper bound on the number of processed intervals per request
+constexpr int64_t kMaxIntervals = 100000;
+
+uint64_t doubleBits(double v) {
+  uint64_t bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  return bits;
+}
+
+double bitsDouble(uint64_t bits) {
+  double v;
+  std::memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+int leadingZeros(uint64_t v) {
+  int n = 0;
+  for (uint64_t mask = 1ull << 63; mask && !(v & mask); mask >>= 1)
+    n++;
+  return n;
+}
+
+int trailingZeros(uint64_t v) {
+  int n = 0;
+  for (uint64_t mask = 1; mask && !(v & mask); mask <<= 1)
+    n++;
+  return n;
+}
+
+bool isGood(uint32_t status) { return (status & 0xC0000000u) == 0; }
+
+} // namespace
+
+struct HistoryStore::Segment {
+  std::vector<uint8_t> data;
+  size_t bitPos = 0;
+  uint32_t count = 0;
+  int64_t firstTs = 0;
+  int64_t lastTs = 0;
+
+  // Encoder state
+  int64_t prevDelta = 0;
+  uint64_t prevValue = 0;
+  int prevLeading = -1;
+  int prevTrailing = 0;
+  uint32_t prevStatus = 0;
+
+  explicit Segment(size_t bytes) : data(bytes, 0) {}
+
+  bool hasRoom() const { return bitPos + kMaxSampleBits <= data.size() * 8; }
+
+  void writeBits(uint64_t value, int nbits) {
+    for (int i = nbits - 1; i >= 0; --i) {
+      if ((value >> i) & 1)
+        data[bitPos >> 3] |= static_cast<uint8_t>(0x80 >> (bitPos & 7));
+      bitPos++;
+    }
+  }
+
+  void append(int64_t ts, double value, uint32_t status) {
+    uint64_t bits = doubleBits(value);
+    if (count == 0) {
+      writeBits(static_cast<uint64_t>(ts), 64);
+      writeBits(bits, 64);
+      writeBits(status, 32);
+      firstTs = lastTs = ts;
+      prevValue = bits;
+      prevStatus = status;
+      count = 1;
+      return;
+    }
+
+    // Timestamp: delta of delta in variable-width buckets
+    int64_t delta = ts - lastTs;
+    int64_t dod = delta - prevDelta;
+    if (dod == 0) {
+      writeBits(0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+      writeBits(0x2, 2);
+      writeBits(static_cast<uint64_t>(dod + 63), 7);
+    } else if (dod >= -255 && dod <= 256) {
+      writeBits(0x6, 3);
+      writeBits(static_cast<uint64_t>(dod + 255), 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+      writeBits(0xE, 4);
+      writeBits(static_cast<uint64_t>(dod + 2047), 12);
+    } else {
+      writeBits(0xF, 4);
+      writeBits(static_cast<uint64_t>(delta), 32);
+    }
+    prevDelta = delta;
+    lastTs = ts;
+
+    // Value: XOR with the previous value, reusing the previous window
+    uint64_t x = bits ^ prevValue;
+    if (x == 0) {
+      writeBits(0, 1);
+    } else {
+      writeBits(1, 1);
+      int leading = std::min(leadingZeros(x), 31);
+      int trailing = trailingZeros(x);
+      if (prevLeading >= 0 && leading >= prevLeading &&
+          trailing >= prevTrailing) {
+        writeBits(0, 1);
+        writeBits(x >> prevTrailing, 64 - prevLeading - prevTrailing);
+      } else {
+        int length = 64 - leading - trailing;
+        writeBits(1, 1);
+        writeBits(static_cast<uint64_t>(leading), 5);
+        writeBits(static_cast<uint64_t>(length - 1), 6);
+        writeBits(x >> trailing, length);
+        prevLeading = leading;
+        prevTrailing = trailing;
+      }
+    }
+    prevValue = bits;
+
+    // Status: usually unchanged
+    if (status == prevStatus) {
+      writeBits(0, 1);
+    } else {
+      writeBits(1, 1);
+      writeBits(status, 32);
+      prevStatus = status;
+    }
+    count++;
+  }
+
+  // Decode samples in order; @p f returns false to stop early
+  template <typename F> bool decode(F &&f) const {
+    size_t pos = 0;
+    auto readBits = [&](int nbits) {
+      uint64_t v = 0;
+      for (int i = 0; i < nbits; ++i) {
+        v = (v << 1) | ((data[pos >> 3] >> (7 - (pos & 7))) & 1);
+        pos++;
+      }
+      return v;
+    };
+
+    int64_t ts = 0;
+    int64_t delta = 0;
+    uint64_t value = 0;
+    int leading = 0;
+    int trailing = 0;
+    uint32_t status = 0;
+
+    for (uint32_t i = 0; i < count; ++i) {
+      if (i == 0) {
+        ts = static_cast<int64_t>(readBits(64));
+        value = readBits(64);
+        status = static_cast<uint32_t>(readBits(32));
+      } else {
+        if (readBits(1) == 0) {
+          // dod == 0
+        } else if (readBits(1) == 0) {
+          delta += static_cast<int64_t>(readBits(7)) - 63;
+        } else if (readBits(1) == 0) {
+          delta += static_cast<int64_t>(readBits(9)) - 255;
+        } else if (readBits(1) == 0) {
+          delta += static_cast<int64_t>(readBits(12)) - 2047;
+        } else {
+          delta = static_cast<int64_t>(readBits(32));
+        }
+        ts += delta;
+
+        if (readBits(1) == 1) {
+          if (readBits(1) == 1) {
+            leading = static_cast<int>(readBits(5));
+            int length = static_cast<int>(readBits(6)) + 1;
+            trailing = 64 - leading - length;
+          }
+          value ^= readBits(64 - leading - trailing) << trailing;
+        }
+
+        if (readBits(1) == 1)
+          status = static_cast<uint32_t>(readBits(32));
+      }
+
+      if (!f(HistorySample{ts, bitsDouble(value), status}))
+        return false;
+    }
+    return true;
+  }
+};
+
+struct HistoryStore::Series {
+  mutable std::mutex mutex;
+  std::deque<Segment> segments;
+  size_t samples = 0;
+};
+
+HistoryStore::HistoryStore(size_t segmentBytes, size_t maxSegments)
+    : segmentBytes_(std::max<size_t>(segmentBytes, 64)),
+      maxSegments_(std::max<size_t>(maxSegments, 1)) {}
+
+HistoryStore::~HistoryStore() = default;
+
+std::shared_ptr<HistoryStore::Series>
+HistoryStore::find(const std::string &key) const {
+  std::shared_lock<std::shared_mutex> lock(mapMutex_);
+  auto it = series_.find(key);
+  return it == series_.end() ? nullptr : it->second;
+}
+
+void HistoryStore::append(const std::string &key, int64_t timestampMs,
+                          double value, uint32_t status) {
+  std::shared_ptr<Series> series = find(key);
+  if (!series) {
+    std::unique_lock<std::shared_mutex> lock(mapMutex_);
+    auto &slot = series_[key];
+    if (!slot)
+      slot = std::make_shared<Series>();
+    series = slot;
+  }
+
+  std::lock_guard<std::mutex> lock(series->mutex);
+  auto &segments = series->segments;
+  if (!segments.empty() && segments.back().count > 0 &&
+      timestampMs < segments.back().lastTs) {
+    return; // Out of order
+  }
+
+  // A gap that does not fit the 32 bit delta starts a new segment
+  bool gap = !segments.empty() && segments.back().count > 0 &&
+             timestampMs - segments.back().lastTs > 0xFFFFFFFFll;
+  if (segments.empty() || !segments.back().hasRoom() || gap) {
+    if (segments.size() >= maxSegments_) {
+      series->samples -= segments.front().count;
+      segments.pop_front();
+    }
+    segments.emplace_back(segmentBytes_);
+  }
+  segments.back().append(timestampMs, value, status);
+  series->samples++;
+}
+
+bool HistoryStore::readRaw(const std::string &key, int64_t startMs,
+                           int64_t endMs, size_t skip, size_t maxValues,
+                           std::vector<HistorySample> &out) const {
+  std::shared_ptr<Series> series = find(key);
+  if (!series)
+    return false;
+
+  std::lock_guard<std::mutex> lock(series->mutex);
+  size_t returned = 0;
+  bool more = false;
+
+  for (const auto &segment : series->segments) {
+    if (segment.count == 0 || segment.lastTs < startMs)
+      continue;
+    if (segment.firstTs > endMs)
+      break;
+
+    bool finished = !segment.decode([&](const HistorySample &s) {
+      if (s.timestampMs < startMs)
+        return true;
+      if (s.timestampMs > endMs)
+        return false;
+      if (s.timestampMs == startMs && skip > 0) {
+        skip--;
+        return true;
+      }
+      if (maxValues && returned == maxValues) {
+        more = true;
+        return false;
+      }
+      out.push_back(s);
+      returned++;
+      return true;
+    });
+    if (finished)
+      break;
+  }
+  return more;
+}
+
+void HistoryStore::readProcessed(const std::string &key, int64_t startMs,
+                                 int64_t endMs, int64_t intervalMs,
+                                 HistoryAggregate aggregate,
+                                 uint32_t noDataStatus,
+                                 std::vector<HistorySample> &out) const {
+  if (endMs <= startMs)
+    return;
+  if (intervalMs <= 0)
+    intervalMs = endMs - startMs;
+  int64_t intervals = std::min((endMs - startMs + intervalMs - 1) / intervalMs,
+                               kMaxIntervals);
+
+  struct Bucket {
+    size_t count = 0;
+    double sum = 0.0;
+    double min = std::numeric_limits<double>::max();
+    double max = std::numeric_limits<double>::lowest();
+    double first = 0.0;
+    double last = 0.0;
+  };
+  std::vector<Bucket> buckets(static_cast<size_t>(intervals));
+
+  std::shared_ptr<Series> series = find(key);
+  if (series) {
+    std::lock_guard<std::mutex> lock(series->mutex);
+    for (const auto &segment : series->segments) {
+      if (segment.count == 0 || segment.lastTs < startMs)
+        continue;
+      if (segment.firstTs >= endMs)
+        break;
+
+      segment.decode([&](const HistorySample &s) {
+        if (s.timestampMs < startMs)
+          return true;
+        if (s.timestampMs >= endMs)
+          return false;
+        if (!isGood(s.status))
+          return true;
+
+        auto idx = static_cast<size_t>((s.timestampMs - startMs) / intervalMs);
+        if (idx >= buckets.size())
+          return false;
+        Bucket &b = buckets[idx];
+        if (b.count == 0)
+          b.first = s.value;
+        b.count++;
+        b.sum += s.value;
+        b.min = std::min(b.min, s.value);
+        b.max = std::max(b.max, s.value);
+        b.last = s.value;
+        return true;
+      });
+    }
+  }
+
+  out.reserve(out.size() + buckets.size());
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    const Bucket &b = buckets[i];
+    HistorySample s{startMs + static_cast<int64_t>(i) * intervalMs, 0.0, 0};
+    if (aggregate == HistoryAggregate::Count) {
+      s.value = static_cast<double>(b.count);
+    } else if (b.count == 0) {
+      s.status = noDataStatus;
+    } else {
+      switch (aggregate) {
+      case HistoryAggregate::Average:
+        s.value = b.sum / static_cast<double>(b.count);
+        break;
+      case HistoryAggregate::Minimum:
+        s.value = b.min;
+        break;
+      case HistoryAggregate::Maximum:
+        s.value = b.max;
+        break;
+      case HistoryAggregate::Start:
+        s.value = b.first;
+        break;
+      case HistoryAggregate::End:
+        s.value = b.last;
+        break;
+      case HistoryAggregate::Count:
+        break;
+      }
+    }
+    out.push_back(s);
+  }
+}
+
+void HistoryStore::remove(const std::string &key) {
+  std::unique_lock<std::shared_mutex> lock(mapMutex_);
+  series_.erase(key);
+}
+
+size_t HistoryStore::pointCount() const {
+  std::shared_lock<std::shared_mutex> lock(mapMutex_);
+  return series_.size();
+}
+
+size_t HistoryStore::memoryBytes() const {
+  std::shared_lock<std::shared_mutex> lock(mapMutex_);
+  size_t bytes = 0;
+  for (const auto &entry : series_) {
+    std::lock_guard<std::mutex> seriesLock(entry.second->mutex);
+    for (const auto &segment : entry.second->segments)
+      bytes += (segment.bitPos + 7) / 8;
+  }
+  return bytes;
+}
+
+size_t HistoryStore::sampleCount() const {
+  std::shared_lock<std::shared_mutex> lock(mapMutex_);
+  size_t samples = 0;
+  for (const auto &entry : series_) {
+    std::lock_guard<std::mutex> seriesLock(entry.second->mutex);
+    samples += entry.second->samples;
+  }
+  return samples;
+}
+
+} // namespace storage
+} // namespace gateway
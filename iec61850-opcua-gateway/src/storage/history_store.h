@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gateway {
+namespace storage {
+
+struct HistorySample {
+  int64_t timestampMs; // Unix epoch milliseconds
+  double value;
+  uint32_t status; // OPC UA status code
+};
+
+enum class HistoryAggregate { Average, Minimum, Maximum, Count, Start, End };
+
+/**
+ * @brief Gateway-local short-term history, one compressed ring per point
+ *
+ * Samples are appended to fixed-size segments using delta-of-delta
+ * timestamps and XOR-compressed values (Gorilla encoding), so a regularly
+ * polled point costs a few bits per sample. Each point keeps a bounded ring
+ * of segments; the oldest segment is dropped when the ring is full.
+ */
+class HistoryStore {
+public:
+  /**
+   * @param segmentBytes Capacity of one compressed segment
+   * @param maxSegments Segments kept per point (ring size)
+   */
+  explicit HistoryStore(size_t segmentBytes = 4096, size_t maxSegments = 4);
+  ~HistoryStore();
+
+  /**
+   * @brief Append a sample. Samples older than the newest one of the point
+   * are dropped, since segments are strictly time ordered.
+   */
+  void append(const std::string &key, int64_t timestampMs, double value,
+              uint32_t status);
+
+  /**
+   * @brief Read raw samples with startMs <= t <= endMs in time order
+   * @param skip Samples at exactly @p startMs to skip (for continuation)
+   * @param maxValues Stop after this many samples (0 = unlimited)
+   * @param out Receives the samples
+   * @return true if more samples remain in range
+   */
+  bool readRaw(const std::string &key, int64_t startMs, int64_t endMs,
+               size_t skip, size_t maxValues,
+               std::vector<HistorySample> &out) const;
+
+  /**
+   * @brief Aggregate samples over [startMs, endMs) in intervals of
+   * @p intervalMs (one bucket for the whole range if 0)
+   * @param out Receives one sample per interval, stamped with its start;
+   * intervals without data carry @p noDataStatus
+   */
+  void readProcessed(const std::string &key, int64_t startMs, int64_t endMs,
+                     int64_t intervalMs, HistoryAggregate aggregate,
+                     uint32_t noDataStatus,
+                     std::vector<HistorySample> &out) const;
+
+  /** @brief Drop a point's history */
+  void remove(const std::string &key);
+
+  size_t pointCount() const;
+  size_t memoryBytes() const; // Compressed payload of all segments
+  size_t sampleCount() const;
+
+private:
+  struct Segment;
+  struct Series;
+
+  size_t segmentBytes_;
+  size_t maxSegments_;
+
+  mutable std::shared_mutex mapMutex_;
+  // Shared so readers keep a series alive across remove()
+  std::unordered_map<std::string, std::shared_ptr<Series>> series_;
+
+  std::shared_ptr<Series> find(const std::string &key) const;
+};
+
+} // namespace storage
+} // namespace gateway
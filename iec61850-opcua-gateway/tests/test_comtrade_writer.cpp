@@ -0,0 +1,215 @@
+#include "iec61850/sv/comtrade_writer.h"
+#include "iec61850/sv/sv_waveform_capture.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <vector>
+
+using namespace gateway::iec61850::sv;
+
+namespace {
+
+// 14/11/2023 22:13:20 UTC
+constexpr uint64_t kT0 = 1700000000ull * 1000000;
+
+std::string tempPath(const char *name) {
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+std::vector<std::string> readLines(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(in, line)) {
+    EXPECT_FALSE(line.empty() || line.back() != '\r') << line;
+    if (!line.empty())
+      line.pop_back();
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+std::vector<uint8_t> readBytes(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in), {}};
+}
+
+uint32_t le32(const std::vector<uint8_t> &bytes, size_t at) {
+  return bytes[at] | bytes[at + 1] << 8 | bytes[at + 2] << 16 |
+         uint32_t{bytes[at + 3]} << 24;
+}
+
+uint16_t le16(const std::vector<uint8_t> &bytes, size_t at) {
+  return static_cast<uint16_t>(bytes[at] | bytes[at + 1] << 8);
+}
+
+SVSample sample(uint64_t timestamp, int32_t base) {
+  SVSample s;
+  s.timestamp = timestamp;
+  s.synchronised = true;
+  for (int ch = 0; ch < kChannels; ++ch)
+    s.values[ch] = base * (ch + 1);
+  return s;
+}
+
+} // namespace
+
+TEST(ComtradeWriterTest, WritesBinary32WithConfig) {
+  ComtradeConfig config;
+  config.station = "Sub,A";
+  config.streams.push_back({"MU01", {}});
+  ComtradeWriter writer(config);
+  const std::string path = tempPath("comtrade_binary32");
+  ASSERT_TRUE(writer.open(path));
+
+  for (int i = 0; i < 3; ++i) {
+    SVSample s = sample(kT0 + i * 250, i - 1);
+    if (i == 1)
+      s.quality[2] = 0x1; // Invalid
+    ASSERT_TRUE(writer.write(&s));
+  }
+  ASSERT_TRUE(writer.close(kT0 + 250));
+  EXPECT_EQ(writer.rows(), 3u);
+
+  std::vector<std::string> cfg = readLines(path + ".cfg");
+  ASSERT_EQ(cfg.size(), 2u + 8 + 9 + 9);
+  EXPECT_EQ(cfg[0], "Sub_A,SV,2013");
+  EXPECT_EQ(cfg[1], "17,8A,9D");
+  EXPECT_EQ(cfg[2], "1,Ia,A,MU01,A,0.001,0,0,-2147483647,2147483647,1,1,P");
+  EXPECT_EQ(cfg[9], "8,Un,N,MU01,V,0.01,0,0,-2147483647,2147483647,1,1,P");
+  EXPECT_EQ(cfg[10], "1,Ia invalid,A,MU01,0");
+  EXPECT_EQ(cfg[18], "9,SmpSynch,,MU01,1");
+  EXPECT_EQ(cfg[19], "50");
+  EXPECT_EQ(cfg[20], "1");
+  EXPECT_EQ(cfg[21], "4000,3");
+  EXPECT_EQ(cfg[22], "14/11/2023,22:13:20.000000");
+  EXPECT_EQ(cfg[23], "14/11/2023,22:13:20.000250");
+  EXPECT_EQ(cfg[24], "BINARY32");
+  EXPECT_EQ(cfg[25], "1");
+  EXPECT_EQ(cfg[26], "0,0");
+  EXPECT_EQ(cfg[27], "0,0");
+
+  // Number, time, eight values and one word of nine digital channels
+  std::vector<uint8_t> dat = readBytes(path + ".dat");
+  const size_t row = 4 + 4 + 8 * 4 + 2;
+  ASSERT_EQ(dat.size(), 3 * row);
+  EXPECT_EQ(writer.bytesWritten(), dat.size());
+  EXPECT_EQ(le32(dat, 0), 1u);
+  EXPECT_EQ(le32(dat, 4), 0u);
+  EXPECT_EQ(static_cast<int32_t>(le32(dat, 8)), -1);
+  EXPECT_EQ(static_cast<int32_t>(le32(dat, 36)), -8);
+  EXPECT_EQ(le16(dat, 40), 0x100); // SmpSynch
+  EXPECT_EQ(le32(dat, row), 2u);
+  EXPECT_EQ(le32(dat, row + 4), 250u);
+  EXPECT_EQ(le16(dat, row + 40), 0x104); // Ic invalid
+  EXPECT_EQ(le32(dat, 2 * row + 4), 500u);
+  EXPECT_EQ(le32(dat, 2 * row + 8 + 4 * 7), 8u);
+}
+
+TEST(ComtradeWriterTest, ScalesBinaryToPeak) {
+  ComtradeConfig config;
+  config.format = ComtradeFormat::Binary;
+  ComtradeStream stream;
+  stream.name = "MU01";
+  stream.peak[0] = 100000; // 4 counts a step
+  config.streams.push_back(stream);
+  ComtradeWriter writer(config);
+  const std::string path = tempPath("comtrade_binary");
+  ASSERT_TRUE(writer.open(path));
+
+  SVSample s = sample(kT0, 0);
+  s.values[0] = -100000;
+  s.values[1] = 40000; // Beyond 16 bits, clipped
+  s.synchronised = false;
+  ASSERT_TRUE(writer.write(&s));
+  ASSERT_TRUE(writer.close());
+
+  std::vector<std::string> cfg = readLines(path + ".cfg");
+  EXPECT_EQ(cfg[2], "1,Ia,A,MU01,A,0.004,0,0,-32767,32767,1,1,P");
+  EXPECT_EQ(cfg[3], "2,Ib,B,MU01,A,0.001,0,0,-32767,32767,1,1,P");
+  EXPECT_EQ(cfg[24], "BINARY");
+  EXPECT_EQ(cfg.back(), "F,0"); // Not synchronised
+
+  std::vector<uint8_t> dat = readBytes(path + ".dat");
+  ASSERT_EQ(dat.size(), 4 + 4 + 8 * 2 + 2u);
+  EXPECT_EQ(static_cast<int16_t>(le16(dat, 8)), -25000);
+  EXPECT_EQ(static_cast<int16_t>(le16(dat, 10)), 32767);
+}
+
+TEST(ComtradeWriterTest, WritesFloat32OfSeveralStreams) {
+  ComtradeConfig config;
+  config.format = ComtradeFormat::Float32;
+  config.sampleRate = 4800;
+  config.nominalFrequency = 60;
+  config.streams.push_back({"MU01", {}});
+  config.streams.push_back({"MU02", {}});
+  ComtradeWriter writer(config);
+  const std::string path = tempPath("comtrade_float32");
+  ASSERT_TRUE(writer.open(path));
+
+  SVSample rows[2] = {sample(kT0, 1000), sample(kT0, -2000)};
+  rows[1].quality[7] = 0x3;
+  ASSERT_TRUE(writer.write(rows));
+  ASSERT_TRUE(writer.close());
+
+  std::vector<std::string> cfg = readLines(path + ".cfg");
+  EXPECT_EQ(cfg[1], "34,16A,18D");
+  EXPECT_EQ(cfg[2],
+            "1,MU01 Ia,A,MU01,A,1,0,0,-3.402823e+38,3.402823e+38,1,1,P");
+  EXPECT_EQ(cfg[10].substr(0, 12), "9,MU02 Ia,A,");
+  EXPECT_EQ(cfg[35], "18,MU02 SmpSynch,,MU02,1");
+  EXPECT_EQ(cfg[36], "60");
+  EXPECT_EQ(cfg[38], "4800,1");
+  EXPECT_EQ(cfg[41], "FLOAT32");
+
+  // Sixteen floats, then two words of eighteen digital channels
+  std::vector<uint8_t> dat = readBytes(path + ".dat");
+  ASSERT_EQ(dat.size(), 4 + 4 + 16 * 4 + 4u);
+  float ia;
+  uint32_t bits = le32(dat, 8);
+  std::memcpy(&ia, &bits, sizeof(ia));
+  EXPECT_FLOAT_EQ(ia, 1.0f);
+  float un2;
+  bits = le32(dat, 8 + 15 * 4);
+  std::memcpy(&un2, &bits, sizeof(un2));
+  EXPECT_FLOAT_EQ(un2, -160.0f);
+  EXPECT_EQ(le16(dat, 72), 0x100);     // MU01 SmpSynch
+  EXPECT_EQ(le16(dat, 74), 0x1 | 0x2); // MU02 Un invalid, SmpSynch
+}
+
+TEST(ComtradeWriterTest, ParsesFormatNames) {
+  ComtradeFormat format = ComtradeFormat::Ascii;
+  EXPECT_TRUE(parseComtradeFormat("float32", format));
+  EXPECT_EQ(format, ComtradeFormat::Float32);
+  EXPECT_STREQ(comtradeFormatName(format), "FLOAT32");
+  EXPECT_FALSE(parseComtradeFormat("BINARY64", format));
+  EXPECT_EQ(format, ComtradeFormat::Float32);
+}
+
+TEST(ComtradeWriterTest, ExportsCaptureWithTriggerTime) {
+  SVWaveformCapture capture;
+  CaptureConfig config;
+  config.svID = "MU01";
+  config.durationMs = 100;
+  config.preTriggerMs = 50;
+  config.triggerThreshold = 100.0; // A or V
+  capture.start(config);
+
+  for (uint16_t smpCnt = 0; smpCnt < 1000; ++smpCnt) {
+    SVSample s = sample(0, smpCnt < 600 ? 1 : 20000);
+    s.smpCnt = smpCnt;
+    capture.addSample(s, kT0 + smpCnt * 250ull);
+  }
+  ASSERT_TRUE(capture.isTriggered());
+
+  const std::string path = tempPath("comtrade_capture");
+  ASSERT_TRUE(capture.exportCOMTRADE(path));
+  std::vector<std::string> cfg = readLines(path + ".cfg");
+  EXPECT_EQ(cfg[2].substr(0, 13), "1,Ia,A,MU01,A");
+  EXPECT_EQ(cfg[21], "4000,600");
+  EXPECT_EQ(cfg[22], "14/11/2023,22:13:20.100000");
+  EXPECT_EQ(cfg[23], "14/11/2023,22:13:20.150000");
+  EXPECT_EQ(cfg[24], "BINARY32");
+}
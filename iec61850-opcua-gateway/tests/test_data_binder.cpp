@@ -0,0 +1,81 @@
+#include "opcua/data_binder.h"
+#include <gtest/gtest.h>
+
+using namespace gateway::opcua;
+
+TEST(DataBinderTest, RebindMovesTheReverseMapping) {
+  DataBinder binder(nullptr);
+  UA_NodeId oldNode = UA_NODEID_STRING(1, (char *)"IED1.LD0.GGIO1.Ind1");
+  UA_NodeId newNode = UA_NODEID_STRING(1, (char *)"IED1.LD0.GGIO1.Ind1.stVal");
+
+  binder.bindDataPoint("IED1/LD0/GGIO1.Ind1", oldNode);
+  binder.bindDataPoint("IED1/LD0/GGIO1.Ind1", newNode);
+
+  // The stale node no longer resolves to the reference
+  EXPECT_EQ(binder.getReference(oldNode), "");
+  EXPECT_EQ(binder.getReference(newNode), "IED1/LD0/GGIO1.Ind1");
+
+  UA_NodeId bound;
+  ASSERT_TRUE(binder.getNodeId("IED1/LD0/GGIO1.Ind1", &bound));
+  EXPECT_TRUE(UA_NodeId_equal(&bound, &newNode));
+  UA_NodeId_clear(&bound);
+}
+
+namespace {
+
+std::string printed(const UA_NodeId &node) {
+  UA_String str = UA_STRING_NULL;
+  UA_NodeId_print(&node, &str);
+  std::string result((char *)str.data, str.length);
+  UA_String_clear(&str);
+  return result;
+}
+
+} // namespace
+
+TEST(DataBinderTest, DpcWritesReachTheHookAsDbpos) {
+  DataBinder binder(nullptr);
+  UA_NodeId node = UA_NODEID_STRING(1, (char *)"IED1.LD0.CSWI1.Pos.stVal");
+  binder.bindDataPoint("IED1/LD0/CSWI1.Pos", node, {"stVal", "ST", "DPC"});
+
+  std::vector<uint32_t> published;
+  binder.setWriteHook([&](const std::string &ref, const MmsValue *value) {
+    EXPECT_EQ(ref, "IED1/LD0/CSWI1.Pos");
+    EXPECT_EQ(MmsValue_getType(value), MMS_BIT_STRING);
+    EXPECT_EQ(MmsValue_getBitStringSize(value), 2);
+    published.push_back(MmsValue_getBitStringAsInteger(value));
+    return true;
+  });
+
+  // The stVal node of a DPC is a UInt32 Dbpos
+  for (UA_UInt32 dbpos : {2u, 1u, 0u, 3u, 4u}) {
+    UA_Variant value;
+    UA_Variant_setScalar(&value, &dbpos, &UA_TYPES[UA_TYPES_UINT32]);
+    binder.handleWrite(printed(node), &value);
+  }
+
+  // A published DPC may take any of the four states; 4 is no Dbpos
+  EXPECT_EQ(published, std::vector<uint32_t>({2, 1, 0, 3}));
+}
+
+TEST(DataBinderTest, OtherUnsignedWritesKeepTheirValue) {
+  DataBinder binder(nullptr);
+  UA_NodeId node = UA_NODEID_STRING(1, (char *)"IED1.LD0.GGIO1.IntIn1");
+  binder.bindDataPoint("IED1/LD0/GGIO1.IntIn1", node, {"stVal", "ST", "INS"});
+
+  std::vector<uint32_t> published;
+  binder.setWriteHook([&](const std::string &, const MmsValue *value) {
+    EXPECT_EQ(MmsValue_getType(value), MMS_UNSIGNED);
+    published.push_back(MmsValue_toUint32(value));
+    return true;
+  });
+
+  // Not a Dbpos: neither limited to 1/2 nor turned into a Boolean
+  for (UA_UInt32 count : {7u, 0u, 1000u}) {
+    UA_Variant value;
+    UA_Variant_setScalar(&value, &count, &UA_TYPES[UA_TYPES_UINT32]);
+    binder.handleWrite(printed(node), &value);
+  }
+
+  EXPECT_EQ(published, std::vector<uint32_t>({7, 0, 1000}));
+}
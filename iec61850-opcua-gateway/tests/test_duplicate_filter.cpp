@@ -0,0 +1,64 @@
+#include "iec61850/goose/duplicate_filter.h"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace gateway::iec61850::goose;
+
+namespace {
+const uint8_t kMac[6] = {0x00, 0x1A, 0x2B, 0x3C, 0x4D, 0x5E};
+}
+
+TEST(DuplicateFilterTest, FirstCopyWins) {
+  DuplicateFilter filter(2);
+
+  EXPECT_TRUE(filter.accept(1, 0x1001, kMac, 5, 0, 1000));
+  EXPECT_FALSE(filter.accept(0, 0x1001, kMac, 5, 0, 1250));
+  // Retransmissions are distinct frames
+  EXPECT_TRUE(filter.accept(0, 0x1001, kMac, 5, 1, 2000));
+  EXPECT_FALSE(filter.accept(1, 0x1001, kMac, 5, 1, 2100));
+  // So are other publishers with the same counters
+  uint8_t other[6] = {0x00, 0x1A, 0x2B, 0x3C, 0x4D, 0x5F};
+  EXPECT_TRUE(filter.accept(0, 0x1001, other, 5, 1, 2200));
+
+  LanStats a = filter.getStats(0);
+  LanStats b = filter.getStats(1);
+  EXPECT_EQ(a.arrivals, 3u);
+  EXPECT_EQ(a.accepted, 2u);
+  EXPECT_EQ(a.duplicates, 1u);
+  EXPECT_EQ(a.lastSkewUs, 250u);
+  EXPECT_EQ(b.accepted, 1u);
+  EXPECT_EQ(b.duplicates, 1u);
+  EXPECT_EQ(b.maxSkewUs, 100u);
+
+  // The third frame never arrived on LAN B
+  EXPECT_EQ(a.missing, 0u);
+  EXPECT_EQ(b.missing, 1u);
+}
+
+TEST(DuplicateFilterTest, ConcurrentLansDeliverEachFrameOnce) {
+  constexpr uint32_t kFrames = 100000;
+  DuplicateFilter filter(2, 4096);
+  std::atomic<uint32_t> delivered{0};
+  std::atomic<uint32_t> progress[2] = {{0}, {0}};
+
+  // The table covers the skew between the LANs; keep them within it
+  auto lan = [&](int index) {
+    for (uint32_t i = 0; i < kFrames; ++i) {
+      while (i > progress[1 - index].load() + 100)
+        std::this_thread::yield();
+      if (filter.accept(index, 0x1001, kMac, i / 8, i % 8))
+        delivered++;
+      progress[index] = i;
+    }
+    progress[index] = kFrames + 100;
+  };
+  std::thread a(lan, 0);
+  std::thread b(lan, 1);
+  a.join();
+  b.join();
+
+  EXPECT_EQ(delivered.load(), kFrames);
+  EXPECT_EQ(filter.getStats(0).accepted + filter.getStats(1).accepted,
+            kFrames);
+}
@@ -0,0 +1,147 @@
+#include "iec61850/capture/frame_dispatcher.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+
+using namespace gateway::iec61850::capture;
+
+namespace {
+
+std::vector<uint8_t> frame(uint8_t macLast, uint16_t appId, bool vlan,
+                           uint16_t etherType = kEtherTypeGoose) {
+  std::vector<uint8_t> f = {0x01, 0x0C, 0xCD, 0x01, 0x00, macLast,
+                            0x00, 0x1A, 0x2B, 0x3C, 0x4D, 0x5E};
+  if (vlan)
+    f.insert(f.end(), {0x81, 0x00, 0x80, 0x00});
+  f.push_back(etherType >> 8);
+  f.push_back(etherType & 0xFF);
+  f.push_back(appId >> 8);
+  f.push_back(appId & 0xFF);
+  f.resize(f.size() + 40, 0);
+  return f;
+}
+
+DispatchKey key(int appId, int macLast, uint16_t etherType = kEtherTypeGoose) {
+  DispatchKey k;
+  k.etherType = etherType;
+  k.appId = appId;
+  if (macLast >= 0) {
+    const uint8_t mac[6] = {0x01, 0x0C, 0xCD, 0x01, 0x00,
+                            static_cast<uint8_t>(macLast)};
+    k.hasMac = true;
+    std::copy(mac, mac + 6, k.mac);
+  }
+  return k;
+}
+
+// Routes that record which of them took each frame
+struct Recorder {
+  std::vector<int> hits;
+
+  FrameDispatcher::Route route(const DispatchKey &k, int id) {
+    return {k, [this, id](const uint8_t *, size_t) { hits.push_back(id); }};
+  }
+
+  std::vector<int> take(FrameDispatcher &dispatcher,
+                        const std::vector<uint8_t> &f) {
+    hits.clear();
+    dispatcher.dispatch(f.data(), f.size());
+    return hits;
+  }
+};
+
+using Hits = std::vector<int>;
+
+} // namespace
+
+TEST(FrameDispatcherTest, RoutesByMacAndAppId) {
+  FrameDispatcher dispatcher;
+  Recorder r;
+  EXPECT_EQ(r.take(dispatcher, frame(0x01, 0x1001, false)), Hits{});
+
+  dispatcher.setRoutes({r.route(key(0x1001, 0x01), 1),
+                        r.route(key(0x1002, 0x01), 2),
+                        r.route(key(0x4001, 0x01, kEtherTypeSV), 3)});
+  EXPECT_EQ(r.take(dispatcher, frame(0x01, 0x1001, false)), Hits{1});
+  EXPECT_EQ(r.take(dispatcher, frame(0x01, 0x1001, true)), Hits{1});
+  EXPECT_EQ(r.take(dispatcher, frame(0x01, 0x1002, false)), Hits{2});
+  EXPECT_EQ(r.take(dispatcher, frame(0x02, 0x1001, false)), Hits{});
+  EXPECT_EQ(r.take(dispatcher, frame(0x01, 0x1003, false)), Hits{});
+  // Sampled values on the same multicast address
+  EXPECT_EQ(r.take(dispatcher, frame(0x01, 0x4001, false, kEtherTypeSV)),
+            Hits{3});
+  EXPECT_EQ(r.take(dispatcher, frame(0x01, 0x1001, false, kEtherTypeSV)),
+            Hits{});
+  // Too short to carry an APPID
+  auto f = frame(0x01, 0x1001, true);
+  r.hits.clear();
+  EXPECT_EQ(dispatcher.dispatch(f.data(), 19), 0u);
+
+  DispatchStats stats = dispatcher.getStats();
+  EXPECT_EQ(stats.frames, 9u);
+  EXPECT_EQ(stats.routed, 4u);
+  EXPECT_EQ(stats.unrouted, 5u);
+  EXPECT_EQ(stats.routes, 3u);
+  EXPECT_GT(stats.avgLookupNs, 0.0); // The first frame is always timed
+}
+
+TEST(FrameDispatcherTest, WildcardsReachEveryMatchingRoute) {
+  FrameDispatcher dispatcher;
+  Recorder r;
+  dispatcher.setRoutes({r.route(key(-1, 0x05), 1),
+                        r.route(key(0x3000, -1), 2),
+                        r.route(key(0x3000, 0x05), 3)});
+  EXPECT_EQ(r.take(dispatcher, frame(0x05, 0x1234, false)), Hits{1});
+  EXPECT_EQ(r.take(dispatcher, frame(0x06, 0x3000, false)), Hits{2});
+  EXPECT_EQ(r.take(dispatcher, frame(0x06, 0x3001, false)), Hits{});
+  // Most specific first
+  EXPECT_EQ(r.take(dispatcher, frame(0x05, 0x3000, false)), (Hits{3, 1, 2}));
+  EXPECT_TRUE(dispatcher.appIds(kEtherTypeGoose).empty());
+
+  // A subscription by reference alone needs every GOOSE frame
+  dispatcher.setRoutes({r.route(key(-1, -1), 4)});
+  EXPECT_EQ(r.take(dispatcher, frame(0x06, 0x3001, false)), Hits{4});
+  EXPECT_EQ(r.take(dispatcher, frame(0x06, 0x3001, false, kEtherTypeSV)),
+            Hits{});
+}
+
+TEST(FrameDispatcherTest, LookupCostIndependentOfRouteCount) {
+  // A 60-IED substation with several GoCBs per IED
+  constexpr int kRoutes = 480;
+  FrameDispatcher dispatcher;
+  std::map<int, int> taken;
+  std::vector<FrameDispatcher::Route> routes;
+  for (int i = 0; i < kRoutes; ++i) {
+    routes.push_back({key(0x0100 + i, i & 0xFF), [&taken, i](const uint8_t *,
+                                                             size_t) {
+                        taken[i]++;
+                      }});
+  }
+  uint64_t generation = dispatcher.generation();
+  dispatcher.setRoutes(std::move(routes));
+  EXPECT_EQ(dispatcher.generation(), generation + 1);
+  EXPECT_EQ(dispatcher.appIds(kEtherTypeGoose).size(),
+            static_cast<size_t>(kRoutes));
+  EXPECT_TRUE(dispatcher.appIds(kEtherTypeSV).empty());
+
+  std::vector<std::vector<uint8_t>> frames;
+  for (int i = 0; i < kRoutes; ++i)
+    frames.push_back(frame(i & 0xFF, 0x0100 + i, i % 2 == 0));
+  std::vector<CapturedFrame> batch(frames.size());
+  for (size_t i = 0; i < frames.size(); ++i) {
+    batch[i].data = frames[i].data();
+    batch[i].length = static_cast<uint32_t>(frames[i].size());
+  }
+  EXPECT_EQ(dispatcher.dispatch(batch.data(), batch.size()),
+            static_cast<size_t>(kRoutes));
+
+  ASSERT_EQ(taken.size(), static_cast<size_t>(kRoutes));
+  for (const auto &pair : taken)
+    EXPECT_EQ(pair.second, 1) << "route " << pair.first;
+
+  DispatchStats stats = dispatcher.getStats();
+  EXPECT_GE(stats.slots, 2u * kRoutes);
+  // Linear probing in a table at most half full
+  EXPECT_LT(stats.avgProbes, 2.5);
+}
@@ -0,0 +1,149 @@
+#include "iec61850/goose/goose_dataset_map.h"
+#include <gtest/gtest.h>
+
+using namespace gateway::iec61850;
+using namespace gateway::iec61850::goose;
+
+namespace {
+
+DataSetMember fcda(const std::string &ln, const std::string &doName,
+                   const std::string &daName, const std::string &fc) {
+  DataSetMember member;
+  member.ldInst = "LD0";
+  member.lnClass = ln;
+  member.lnInst = "1";
+  member.doName = doName;
+  member.daName = daName;
+  member.fc = fc;
+  return member;
+}
+
+IEDConfig makeIED() {
+  auto sps = std::make_shared<DOTypeTemplate>();
+  sps->cdc = "SPS";
+  sps->attributes = {{"stVal", "ST", "BOOLEAN"},
+                     {"q", "ST", "Quality"},
+                     {"t", "ST", "Timestamp"},
+                     {"d", "DC", "VisString255"}};
+  auto mv = std::make_shared<DOTypeTemplate>();
+  mv->cdc = "MV";
+  mv->attributes = {{"mag.i", "MX", "INT32"},
+                    {"mag.f", "MX", "FLOAT32"},
+                    {"q", "MX", "Quality"}};
+  auto wye = std::make_shared<DOTypeTemplate>();
+  wye->cdc = "WYE";
+  wye->attributes = {{"phsA.cVal.mag.f", "MX", "FLOAT32"},
+                     {"phsA.q", "MX", "Quality"},
+                     {"phsB.cVal.mag.f", "MX", "FLOAT32"},
+                     {"phsB.q", "MX", "Quality"}};
+
+  LogicalNode ggio;
+  ggio.name = "GGIO1";
+  ggio.lnClass = "GGIO";
+  ggio.inst = "1";
+  ggio.dataObjects = {
+      {"Ind1", "SPS", sps}, {"AnIn1", "MV", mv}, {"PhV", "WYE", wye}};
+
+  LogicalDevice ld;
+  ld.name = "LD0";
+  ld.inst = "LD0";
+  ld.logicalNodes = {ggio};
+
+  IEDConfig ied;
+  ied.name = "IED1";
+  ied.logicalDevices = {ld};
+  return ied;
+}
+
+} // namespace
+
+TEST(GooseDataSetMapTest, BindsMembersInFcdaOrder) {
+  GOOSEControlBlock gcb;
+  gcb.members = {fcda("GGIO", "Ind1", "stVal", "ST"),
+                 fcda("GGIO", "Ind1", "q", "ST"),
+                 fcda("GGIO", "AnIn1", "mag.f", "MX"),
+                 fcda("GGIO", "Ind1", "", "ST"),
+                 fcda("GGIO", "AnIn1", "", "MX"),
+                 fcda("GGIO", "AnIn1", "mag", "MX"),
+                 fcda("GGIO", "Missing", "stVal", "ST"),
+                 fcda("XCBR", "Pos", "stVal", "ST")};
+
+  GooseDataSetMap map(makeIED(), gcb);
+  const auto &members = map.members();
+  ASSERT_EQ(members.size(), 8u);
+  EXPECT_EQ(map.boundCount(), 5u);
+
+  EXPECT_EQ(members[0].reference, "IED1/LD0/GGIO1.Ind1");
+  EXPECT_TRUE(members[0].path.empty());
+  EXPECT_TRUE(members[1].reference.empty()); // Quality is not bound
+  EXPECT_EQ(members[2].reference, "IED1/LD0/GGIO1.AnIn1");
+  EXPECT_TRUE(members[2].path.empty());
+
+  // Whole DOs: structure components follow the DOType order for the FC
+  EXPECT_EQ(members[3].reference, "IED1/LD0/GGIO1.Ind1");
+  EXPECT_EQ(members[3].path, std::vector<int>({0}));
+  EXPECT_EQ(members[4].path, std::vector<int>({0, 1}));
+  EXPECT_EQ(members[5].path, std::vector<int>({1}));
+
+  EXPECT_TRUE(members[6].reference.empty());
+  EXPECT_TRUE(members[7].reference.empty());
+}
+
+TEST(GooseDataSetMapTest, BindsTheCdcPrimaryAttribute) {
+  GOOSEControlBlock gcb;
+  gcb.members = {fcda("GGIO", "PhV", "", "MX"),
+                 fcda("GGIO", "PhV.phsA", "cVal", "MX"),
+                 fcda("GGIO", "PhV.phsB", "", "MX")};
+
+  // A WYE is bound through phsA.cVal.mag.f, not stVal or mag.f
+  GooseDataSetMap map(makeIED(), gcb);
+  const auto &members = map.members();
+  EXPECT_EQ(map.boundCount(), 2u);
+  EXPECT_EQ(members[0].reference, "IED1/LD0/GGIO1.PhV");
+  EXPECT_EQ(members[0].path, std::vector<int>({0, 0, 0, 0}));
+  EXPECT_EQ(members[1].path, std::vector<int>({0, 0}));
+  EXPECT_TRUE(members[2].reference.empty());
+
+  DOTypeTemplate apc;
+  apc.cdc = "APC";
+  apc.attributes = {{"mxVal.f", "MX", "FLOAT32"}, {"q", "MX", "Quality"}};
+  EXPECT_EQ(primaryAttribute(apc), "mxVal.f");
+  DOTypeTemplate custom;
+  custom.cdc = "XYZ";
+  custom.attributes = {{"q", "ST", "Quality"}, {"stVal", "ST", "INT32"}};
+  EXPECT_EQ(primaryAttribute(custom), "stVal");
+  custom.attributes.pop_back();
+  EXPECT_EQ(primaryAttribute(custom), "");
+}
+
+TEST(GooseDataSetMapTest, CreatesPublishableMemberValues) {
+  IEDConfig ied = makeIED();
+
+  std::vector<int> timePath;
+  MmsValue *ind = createMemberValue(ied, fcda("GGIO", "Ind1", "", "ST"),
+                                    &timePath);
+  ASSERT_NE(ind, nullptr);
+  ASSERT_EQ(MmsValue_getType(ind), MMS_STRUCTURE);
+  ASSERT_EQ(MmsValue_getArraySize(ind), 3u); // stVal, q, t; not d (DC)
+  EXPECT_EQ(MmsValue_getType(MmsValue_getElement(ind, 0)), MMS_BOOLEAN);
+  EXPECT_EQ(MmsValue_getType(MmsValue_getElement(ind, 1)), MMS_BIT_STRING);
+  EXPECT_EQ(MmsValue_getType(MmsValue_getElement(ind, 2)), MMS_UTC_TIME);
+  EXPECT_EQ(timePath, std::vector<int>({2}));
+  MmsValue_delete(ind);
+
+  MmsValue *mag = createMemberValue(ied, fcda("GGIO", "AnIn1", "mag", "MX"));
+  ASSERT_NE(mag, nullptr);
+  ASSERT_EQ(MmsValue_getArraySize(mag), 2u);
+  EXPECT_EQ(MmsValue_getType(MmsValue_getElement(mag, 0)), MMS_INTEGER);
+  EXPECT_EQ(MmsValue_getType(MmsValue_getElement(mag, 1)), MMS_FLOAT);
+  MmsValue_delete(mag);
+
+  MmsValue *stVal =
+      createMemberValue(ied, fcda("GGIO", "Ind1", "stVal", "ST"), &timePath);
+  ASSERT_NE(stVal, nullptr);
+  EXPECT_EQ(MmsValue_getType(stVal), MMS_BOOLEAN);
+  MmsValue_delete(stVal);
+
+  EXPECT_EQ(createMemberValue(ied, fcda("GGIO", "Missing", "stVal", "ST")),
+            nullptr);
+}
@@ -0,0 +1,105 @@
+#include "iec61850/goose/goose_statistics.h"
+#include <gtest/gtest.h>
+
+using namespace gateway::iec61850::goose;
+
+namespace {
+GooseFrameInfo frame(uint64_t nowUs, uint32_t stNum, uint32_t sqNum,
+                     uint32_t talMs = 2000) {
+  GooseFrameInfo f;
+  f.nowUs = nowUs;
+  f.stNum = stNum;
+  f.sqNum = sqNum;
+  f.timeAllowedToLiveMs = talMs;
+  return f;
+}
+} // namespace
+
+TEST(GooseStatisticsTest, HeartbeatRateAndLiveness) {
+  GooseStreamStats stats;
+  // 1 s heartbeat for 5 s
+  for (uint32_t i = 0; i <= 5; ++i)
+    stats.record(frame(i * 1000000ULL, 1, i));
+
+  GooseStreamSnapshot s = stats.snapshot(5500000);
+  EXPECT_EQ(s.messages, 6u);
+  EXPECT_EQ(s.sqNumGaps, 0u);
+  EXPECT_EQ(s.talExpiries, 0u);
+  EXPECT_TRUE(s.alive);
+  EXPECT_EQ(s.msSinceLast, 500u);
+  EXPECT_NEAR(s.messageRate, 1.0, 0.01);
+
+  // Silent past TimeAllowedToLive
+  s = stats.snapshot(8000000);
+  EXPECT_FALSE(s.alive);
+}
+
+TEST(GooseStatisticsTest, CountsSequenceGaps) {
+  GooseStreamStats stats;
+  stats.record(frame(0, 1, 0));
+  stats.record(frame(1000, 1, 1));
+  stats.record(frame(2000, 1, 4)); // sqNum 2 and 3 lost
+  stats.record(frame(3000, 2, 0)); // Next state
+  // States 3 and 4 lost; sqNum 1 lost, as either edition may start at 0
+  stats.record(frame(4000, 5, 2));
+
+  GooseStreamSnapshot s = stats.snapshot(4000);
+  EXPECT_EQ(s.stateChanges, 2u);
+  EXPECT_EQ(s.sqNumGaps, 3u);
+  EXPECT_EQ(s.stNumGaps, 2u);
+}
+
+TEST(GooseStatisticsTest, CountsTimeAllowedToLiveExpiry) {
+  GooseStreamStats stats;
+  stats.record(frame(0, 1, 0, 100));
+  stats.record(frame(50000, 1, 1, 100));
+  stats.record(frame(400000, 1, 2, 100)); // 350 ms silence, TAL 100 ms
+
+  GooseStreamSnapshot s = stats.snapshot(400000);
+  EXPECT_EQ(s.talExpiries, 1u);
+  EXPECT_EQ(s.timeAllowedToLiveMs, 100u);
+}
+
+TEST(GooseStatisticsTest, JitterOnlyOnSteadyHeartbeat) {
+  GooseStreamStats stats;
+  // Retransmission backoff after a state change: 2, 4, 8 ms
+  stats.record(frame(0, 1, 0));
+  stats.record(frame(2000, 1, 1));
+  stats.record(frame(6000, 1, 2));
+  stats.record(frame(14000, 1, 3));
+  GooseStreamSnapshot s = stats.snapshot(14000);
+  uint64_t total = 0;
+  for (uint64_t n : s.jitter)
+    total += n;
+  EXPECT_EQ(total, 0u);
+
+  // Heartbeat of 1 s arriving 300 us late, then on time
+  stats.record(frame(1014000, 1, 4));
+  stats.record(frame(2014300, 1, 5));
+  stats.record(frame(3014300, 1, 6));
+  s = stats.snapshot(3014300);
+  EXPECT_EQ(s.jitter[2], 2u); // 250 < 300 <= 500 us
+  EXPECT_EQ(s.messages, 7u);
+}
+
+TEST(GooseStatisticsTest, PublishLatencyPercentile) {
+  PublishLatencyStats stats;
+  EXPECT_EQ(stats.snapshot().samples, 0u);
+
+  // 99 fast publishes and one stalled by 3 ms
+  for (int i = 0; i < 99; ++i)
+    stats.record(80);
+  stats.record(3000);
+
+  PublishLatencySnapshot s = stats.snapshot();
+  EXPECT_EQ(s.samples, 100u);
+  EXPECT_EQ(s.lastUs, 3000u);
+  EXPECT_EQ(s.maxUs, 3000u);
+  EXPECT_NEAR(s.avgUs, 109.2, 0.01);
+  EXPECT_EQ(s.p99Us, 100u);
+  EXPECT_EQ(s.buckets[1], 99u);
+  EXPECT_EQ(s.buckets[6], 1u);
+
+  stats.record(4000);
+  EXPECT_EQ(stats.snapshot().p99Us, 4000u);
+}
@@ -0,0 +1,80 @@
+#include "iec61850/sv/harmonic_analyzer.h"
+#include <cmath>
+#include <gtest/gtest.h>
+
+using namespace gateway::iec61850::sv;
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+struct Component {
+  int order;
+  double rms; // A
+};
+
+// One window of Ia made of @p components of @p frequency
+std::vector<SVSample> window(const HarmonicAnalyzer &analyzer,
+                             const SVStreamFormat &format, double frequency,
+                             std::initializer_list<Component> components) {
+  std::vector<SVSample> samples(analyzer.windowSize());
+  for (size_t i = 0; i < samples.size(); ++i) {
+    double t = static_cast<double>(i) / format.sampleRate;
+    double x = 0.0;
+    for (const Component &c : components)
+      x += std::sqrt(2.0) * c.rms *
+           std::cos(2 * kPi * c.order * frequency * t + 0.2 * c.order);
+    samples[i].values[0] = static_cast<int32_t>(std::lround(x / kCurrentScale));
+  }
+  return samples;
+}
+
+} // namespace
+
+TEST(HarmonicAnalyzerTest, MeasuresHarmonicsAndThd) {
+  SVStreamFormat format; // 4000 Hz, 80 per cycle, 50 Hz
+  HarmonicAnalyzer analyzer(format);
+  EXPECT_EQ(analyzer.windowCycles(), 10);
+  EXPECT_EQ(analyzer.windowSize(), 800u);
+  EXPECT_EQ(analyzer.maxOrder(), 39);
+
+  HarmonicResult result =
+      analyzer.analyze(window(analyzer, format, 50.0,
+                              {{1, 100.0}, {5, 10.0}, {7, 5.0}, {0, 2.0}}));
+  ASSERT_TRUE(result.valid);
+  ASSERT_EQ(result.harmonics[0].size(), 40u);
+  // A DC component of "rms" r as generated is sqrt2 r
+  EXPECT_NEAR(result.harmonics[0][0], 2.0 * std::sqrt(2.0), 0.01);
+  EXPECT_NEAR(result.harmonics[0][1], 100.0, 0.01);
+  EXPECT_NEAR(result.harmonics[0][5], 10.0, 0.01);
+  EXPECT_NEAR(result.harmonics[0][7], 5.0, 0.01);
+  EXPECT_NEAR(result.harmonics[0][3], 0.0, 0.01);
+  EXPECT_NEAR(result.thd[0], 100.0 * std::sqrt(125.0) / 100.0, 0.01);
+  EXPECT_EQ(result.thd[1], 0.0);
+}
+
+TEST(HarmonicAnalyzerTest, SubgroupsAbsorbFrequencyDeviation) {
+  SVStreamFormat format;
+  format.sampleRate = 15360;
+  format.samplesPerCycle = 256;
+  format.nominalFrequency = 60;
+  HarmonicAnalyzer analyzer(format);
+  EXPECT_EQ(analyzer.windowCycles(), 12);
+  EXPECT_EQ(analyzer.windowSize(), 3072u);
+  EXPECT_EQ(analyzer.maxOrder(), 50);
+
+  // 0.05 % off nominal leaks into the neighbouring bins, which the
+  // subgroup sums back up
+  HarmonicResult result = analyzer.analyze(
+      window(analyzer, format, 60.03, {{1, 50.0}, {3, 5.0}, {50, 1.0}}));
+  EXPECT_NEAR(result.harmonics[0][1], 50.0, 0.5);
+  EXPECT_NEAR(result.harmonics[0][3], 5.0, 0.1);
+  EXPECT_NEAR(result.harmonics[0][50], 1.0, 0.1);
+  EXPECT_NEAR(result.thd[0], 100.0 * std::sqrt(26.0) / 50.0, 0.3);
+}
+
+TEST(HarmonicAnalyzerTest, RejectsShortWindow) {
+  HarmonicAnalyzer analyzer;
+  std::vector<SVSample> samples(analyzer.windowSize() - 1);
+  EXPECT_FALSE(analyzer.analyze(samples).valid);
+}
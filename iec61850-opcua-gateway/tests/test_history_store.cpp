@@ -0,0 +1,81 @@
+#include "storage/history_store.h"
+#include <gtest/gtest.h>
+
+using namespace gateway::storage;
+
+TEST(HistoryStoreTest, RoundTrip) {
+  HistoryStore store;
+  int64_t t0 = 1700000000000;
+  for (int i = 0; i < 1000; ++i) {
+    // Jittered 1 s polling with a slowly changing value
+    int64_t ts = t0 + i * 1000 + (i % 7);
+    store.append("p", ts, 230.0 + (i % 10) * 0.1, i == 500 ? 0x80000000u : 0);
+  }
+
+  std::vector<HistorySample> samples;
+  EXPECT_FALSE(store.readRaw("p", t0, t0 + 1000000, 0, 0, samples));
+  ASSERT_EQ(samples.size(), 1000u);
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(samples[i].timestampMs, t0 + i * 1000 + (i % 7));
+    EXPECT_DOUBLE_EQ(samples[i].value, 230.0 + (i % 10) * 0.1);
+    EXPECT_EQ(samples[i].status, i == 500 ? 0x80000000u : 0u);
+  }
+  // Far below the 20 bytes per sample of the uncompressed form
+  EXPECT_LT(store.memoryBytes(), 1000u * 10);
+}
+
+TEST(HistoryStoreTest, Continuation) {
+  HistoryStore store;
+  for (int i = 0; i < 10; ++i)
+    store.append("p", 100, i, 0); // Same timestamp
+  for (int i = 0; i < 10; ++i)
+    store.append("p", 200 + i, i, 0);
+
+  std::vector<HistorySample> page;
+  EXPECT_TRUE(store.readRaw("p", 0, 1000, 0, 6, page));
+  ASSERT_EQ(page.size(), 6u);
+
+  // Resume at the last timestamp, skipping what was already returned
+  std::vector<HistorySample> rest;
+  EXPECT_FALSE(store.readRaw("p", 100, 1000, 6, 0, rest));
+  ASSERT_EQ(rest.size(), 14u);
+  EXPECT_DOUBLE_EQ(rest.front().value, 6.0);
+  EXPECT_EQ(rest.back().timestampMs, 209);
+}
+
+TEST(HistoryStoreTest, RingEviction) {
+  HistoryStore store(64, 2);
+  for (int i = 0; i < 1000; ++i)
+    store.append("p", i * 1000, i * 1.5, 0);
+
+  std::vector<HistorySample> samples;
+  store.readRaw("p", 0, 1000000, 0, 0, samples);
+  ASSERT_FALSE(samples.empty());
+  EXPECT_LT(samples.size(), 1000u);
+  EXPECT_EQ(samples.size(), store.sampleCount());
+  EXPECT_EQ(samples.back().timestampMs, 999000);
+}
+
+TEST(HistoryStoreTest, Aggregates) {
+  HistoryStore store;
+  for (int i = 0; i < 20; ++i)
+    store.append("p", i * 100, i, 0);
+
+  std::vector<HistorySample> avg;
+  store.readProcessed("p", 0, 3000, 1000, HistoryAggregate::Average,
+                      0x809B0000u, avg);
+  ASSERT_EQ(avg.size(), 3u);
+  EXPECT_DOUBLE_EQ(avg[0].value, 4.5);
+  EXPECT_DOUBLE_EQ(avg[1].value, 14.5);
+  EXPECT_EQ(avg[2].status, 0x809B0000u); // No data
+
+  std::vector<HistorySample> max;
+  store.readProcessed("p", 0, 2000, 0, HistoryAggregate::Maximum, 0, max);
+  ASSERT_EQ(max.size(), 1u);
+  EXPECT_DOUBLE_EQ(max[0].value, 19.0);
+
+  std::vector<HistorySample> count;
+  store.readProcessed("p", 0, 3000, 1000, HistoryAggregate::Count, 0, count);
+  ASSERT_EQ(count.size(), 3u);
+  EXPECT_DOUBLE_EQ(count[2].value, 0.0);
+}
@@ -0,0 +1,13 @@
+#include "core/logger.h"
+#include <filesystem>
+#include <gtest/gtest.h>
+
+int main(int argc, char **argv) {
+  // The code under test logs through the gateway logger, which must exist;
+  // keep the console quiet unless something goes wrong
+  auto logPath = std::filesystem::temp_directory_path() / "unit_tests.log";
+  gateway::core::Logger::init(logPath.string(), spdlog::level::warn);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,326 @@
+#include "iec61850/scl/scl_parser.h"
+#include "opcua/namespace/namespace_builder.h"
+#include <gtest/gtest.h>
+#include <set>
+
+using namespace gateway::iec61850;
+using namespace gateway::opcua;
+using namespace gateway::opcua::ns;
+
+namespace {
+
+IEDConfig makeIED() {
+  auto cmv = std::make_shared<DOTypeTemplate>();
+  cmv->cdc = "CMV";
+  cmv->attributes = {{"cVal.mag.f", "MX", "FLOAT32"},
+                     {"cVal.ang.f", "MX", "FLOAT32"},
+                     {"q", "MX", "Quality"},
+                     {"units.SIUnit", "CF", "Enum"}};
+  auto bcr = std::make_shared<DOTypeTemplate>();
+  bcr->cdc = "BCR";
+  bcr->attributes = {{"actVal", "ST", "INT64"},
+                     {"q", "ST", "Quality"},
+                     {"pulsQty", "CF", "FLOAT32"}};
+
+  LogicalNode mmtr;
+  mmtr.name = "MMTR1";
+  mmtr.lnClass = "MMTR";
+  mmtr.inst = "1";
+  mmtr.dataObjects = {{"SupWh", "BCR", bcr},
+                      {"PhsA", "CMV", cmv},
+                      {"DmdWh", "BCR", nullptr},
+                      {"PhsB", "CMV", nullptr}};
+
+  LogicalDevice ld;
+  ld.name = "LD0";
+  ld.inst = "LD0";
+  ld.logicalNodes = {mmtr};
+
+  IEDConfig ied;
+  ied.name = "IED1";
+  ied.logicalDevices = {ld};
+  return ied;
+}
+
+const NodePlan *boundNode(const IEDPlan &plan, const std::string &ref) {
+  for (const auto &node : plan) {
+    if (node.ref == ref && !node.attribute.empty())
+      return &node;
+  }
+  return nullptr;
+}
+
+std::shared_ptr<DOTypeTemplate> statusType(const std::string &cdc,
+                                           const std::string &bType) {
+  auto type = std::make_shared<DOTypeTemplate>();
+  type->cdc = cdc;
+  type->attributes = {{"stVal", "ST", bType},
+                      {"q", "ST", "Quality"},
+                      {"d", "DC", "VisString255"}};
+  return type;
+}
+
+// IED1/LD0/GGIO1 with two SPS and one flat (unresolved) SPS
+IEDConfig station() {
+  auto sps = statusType("SPS", "BOOLEAN");
+
+  LogicalNode ggio;
+  ggio.name = "GGIO1";
+  ggio.lnClass = "GGIO";
+  ggio.inst = "1";
+  ggio.dataObjects = {
+      {"Ind1", "SPS", sps}, {"Ind2", "SPS", sps}, {"Ind3", "SPS", nullptr}};
+
+  LogicalDevice ld;
+  ld.name = "LD0";
+  ld.inst = "LD0";
+  ld.logicalNodes = {ggio};
+
+  IEDConfig ied;
+  ied.name = "IED1";
+  ied.manufacturer = "Vendor";
+  ied.type = "Relay";
+  ied.logicalDevices = {ld};
+  return ied;
+}
+
+std::vector<DataObject> &dataObjects(IEDConfig &ied) {
+  return ied.logicalDevices[0].logicalNodes[0].dataObjects;
+}
+
+std::set<std::string> nodeIds(const IEDPlan &plan,
+                              const std::vector<size_t> &indices) {
+  std::set<std::string> ids;
+  for (size_t i : indices)
+    ids.insert(plan[i].nodeId);
+  return ids;
+}
+
+std::set<std::string> wantedIds(const IEDPlan &plan, const PlanDiff &diff) {
+  std::set<std::string> ids;
+  for (size_t i = 0; i < plan.size(); ++i) {
+    if (diff.wanted[i])
+      ids.insert(plan[i].nodeId);
+  }
+  return ids;
+}
+
+using Ids = std::set<std::string>;
+
+} // namespace
+
+TEST(NamespaceBuilderTest, BindsTheCdcPrimaryAttributeWithItsFc) {
+  IEDPlan plan = NamespaceBuilder::compileIED(makeIED());
+
+  struct Expected {
+    const char *ref;
+    NodePlan::Kind kind;
+    const char *attribute;
+    const char *fc;
+  };
+  const Expected expected[] = {
+      // Typed DOs bind the DA node the DOType declares
+      {"IED1/LD0/MMTR1.SupWh", NodePlan::Kind::DataAttribute, "actVal", "ST"},
+      {"IED1/LD0/MMTR1.PhsA", NodePlan::Kind::DataAttribute, "cVal.mag.f",
+       "MX"},
+      // Unresolved DOTypes fall back to the CDC table
+      {"IED1/LD0/MMTR1.DmdWh", NodePlan::Kind::DataObject, "actVal", "ST"},
+      {"IED1/LD0/MMTR1.PhsB", NodePlan::Kind::DataObject, "cVal.mag.f", "MX"},
+  };
+
+  for (const auto &e : expected) {
+    const NodePlan *node = boundNode(plan, e.ref);
+    ASSERT_NE(node, nullptr) << e.ref;
+    EXPECT_EQ(node->kind, e.kind) << e.ref;
+    EXPECT_EQ(node->attribute, e.attribute) << e.ref;
+    EXPECT_EQ(node->fc, e.fc) << e.ref;
+  }
+
+  // Exactly one node per DO carries the binding
+  size_t bound = 0;
+  for (const auto &node : plan) {
+    if (!node.attribute.empty())
+      bound++;
+  }
+  EXPECT_EQ(bound, 4u);
+}
+
+TEST(NamespaceBuilderTest, BinderKeepsTheReadPlanOfEachBinding) {
+  IEDPlan plan = NamespaceBuilder::compileIED(makeIED());
+
+  // What insertPlan() hands the binder for the bound nodes
+  std::vector<DataBinder::Binding> bindings;
+  for (const auto &node : plan) {
+    if (node.attribute.empty())
+      continue;
+    bindings.push_back({node.ref,
+                        UA_NODEID_STRING(2, (char *)node.nodeId.c_str()),
+                        {node.attribute, node.fc, node.cdc}});
+  }
+
+  DataBinder binder(nullptr);
+  ASSERT_EQ(binder.bindDataPoints(bindings), 4u);
+
+  DataBinder::ReadPlan cmv;
+  ASSERT_TRUE(binder.getReadPlan("IED1/LD0/MMTR1.PhsA", &cmv));
+  EXPECT_EQ(cmv.attribute, "cVal.mag.f");
+  EXPECT_EQ(cmv.fc, "MX");
+  EXPECT_EQ(cmv.cdc, "CMV");
+
+  DataBinder::ReadPlan bcr;
+  ASSERT_TRUE(binder.getReadPlan("IED1/LD0/MMTR1.SupWh", &bcr));
+  EXPECT_EQ(bcr.attribute, "actVal");
+  EXPECT_EQ(bcr.fc, "ST");
+  EXPECT_EQ(bcr.cdc, "BCR");
+
+  binder.unbindDataPoints({"IED1/LD0/MMTR1.PhsA"});
+  EXPECT_FALSE(binder.getReadPlan("IED1/LD0/MMTR1.PhsA", &cmv));
+}
+
+TEST(NamespaceBuilderTest, UnchangedIedHasNoDiff) {
+  IEDPlan plan = NamespaceBuilder::compileIED(station());
+  PlanDiff diff = NamespaceBuilder::diffPlans(plan, plan);
+
+  EXPECT_FALSE(diff.changed);
+  EXPECT_EQ(wantedIds(plan, diff), Ids());
+  EXPECT_TRUE(diff.replaced.empty());
+  EXPECT_TRUE(diff.updated.empty());
+  EXPECT_TRUE(diff.removed.empty());
+  EXPECT_TRUE(diff.unbound.empty());
+}
+
+TEST(NamespaceBuilderTest, AddedDoIsInsertedWithItsAttributes) {
+  IEDConfig ied = station();
+  IEDPlan oldPlan = NamespaceBuilder::compileIED(ied);
+  dataObjects(ied).push_back({"Ind4", "SPS", statusType("SPS", "BOOLEAN")});
+  IEDPlan newPlan = NamespaceBuilder::compileIED(ied);
+
+  PlanDiff diff = NamespaceBuilder::diffPlans(oldPlan, newPlan);
+
+  EXPECT_TRUE(diff.changed);
+  // Only ST/MX attributes are instantiated
+  EXPECT_EQ(wantedIds(newPlan, diff),
+            Ids({"IED1.LD0.GGIO1.Ind4", "IED1.LD0.GGIO1.Ind4.stVal",
+                 "IED1.LD0.GGIO1.Ind4.q"}));
+  EXPECT_TRUE(diff.replaced.empty());
+  EXPECT_TRUE(diff.updated.empty());
+  EXPECT_TRUE(diff.removed.empty());
+  EXPECT_TRUE(diff.unbound.empty());
+}
+
+TEST(NamespaceBuilderTest, RemovedDoIsDeletedAndUnbound) {
+  IEDConfig ied = station();
+  IEDPlan oldPlan = NamespaceBuilder::compileIED(ied);
+  dataObjects(ied).erase(dataObjects(ied).begin() + 1); // Ind2
+  IEDPlan newPlan = NamespaceBuilder::compileIED(ied);
+
+  PlanDiff diff = NamespaceBuilder::diffPlans(oldPlan, newPlan);
+
+  EXPECT_TRUE(diff.changed);
+  EXPECT_EQ(wantedIds(newPlan, diff), Ids());
+  // One delete for the subtree root; its attributes go with it
+  EXPECT_EQ(nodeIds(oldPlan, diff.removed), Ids({"IED1.LD0.GGIO1.Ind2"}));
+  EXPECT_EQ(nodeIds(oldPlan, diff.unbound),
+            Ids({"IED1.LD0.GGIO1.Ind2.stVal"}));
+  ASSERT_EQ(diff.unbound.size(), 1u);
+  EXPECT_EQ(oldPlan[diff.unbound[0]].ref, "IED1/LD0/GGIO1.Ind2");
+}
+
+TEST(NamespaceBuilderTest, ChangedDoTouchesOnlyWhatChanged) {
+  IEDConfig ied = station();
+  IEDPlan oldPlan = NamespaceBuilder::compileIED(ied);
+
+  // Ind1 gains a timestamp and its quality changes basic type
+  auto sps = statusType("SPS", "BOOLEAN");
+  sps->attributes[1].bType = "Quality2";
+  sps->attributes.push_back({"t", "ST", "Timestamp"});
+  dataObjects(ied)[0].typeTemplate = sps;
+  // Container changes are patched in place
+  ied.manufacturer = "Other";
+  ied.logicalDevices[0].logicalNodes[0].lnClass = "GAPC";
+  IEDPlan newPlan = NamespaceBuilder::compileIED(ied);
+
+  PlanDiff diff = NamespaceBuilder::diffPlans(oldPlan, newPlan);
+
+  EXPECT_TRUE(diff.changed);
+  EXPECT_EQ(nodeIds(newPlan, diff.updated),
+            Ids({"IED1", "IED1.LD0.GGIO1"}));
+  EXPECT_EQ(nodeIds(newPlan, diff.replaced), Ids({"IED1.LD0.GGIO1.Ind1.q"}));
+  EXPECT_EQ(wantedIds(newPlan, diff),
+            Ids({"IED1.LD0.GGIO1.Ind1.q", "IED1.LD0.GGIO1.Ind1.t"}));
+  EXPECT_TRUE(diff.removed.empty());
+  EXPECT_TRUE(diff.unbound.empty());
+}
+
+TEST(NamespaceBuilderTest, ChangedCdcReplacesTheDataObject) {
+  IEDConfig ied = station();
+  IEDPlan oldPlan = NamespaceBuilder::compileIED(ied);
+  dataObjects(ied)[0] = {"Ind1", "DPS", statusType("DPS", "Dbpos")};
+  IEDPlan newPlan = NamespaceBuilder::compileIED(ied);
+
+  PlanDiff diff = NamespaceBuilder::diffPlans(oldPlan, newPlan);
+
+  EXPECT_TRUE(diff.changed);
+  EXPECT_EQ(nodeIds(newPlan, diff.replaced), Ids({"IED1.LD0.GGIO1.Ind1"}));
+  // The replaced subtree is re-added whole, with the binding on stVal
+  EXPECT_EQ(wantedIds(newPlan, diff),
+            Ids({"IED1.LD0.GGIO1.Ind1", "IED1.LD0.GGIO1.Ind1.stVal",
+                 "IED1.LD0.GGIO1.Ind1.q"}));
+  EXPECT_TRUE(diff.updated.empty());
+  EXPECT_TRUE(diff.removed.empty());
+  EXPECT_TRUE(diff.unbound.empty());
+
+  const NodePlan *bound = boundNode(newPlan, "IED1/LD0/GGIO1.Ind1");
+  ASSERT_NE(bound, nullptr);
+  EXPECT_EQ(bound->cdc, "DPS");
+  EXPECT_EQ(bound->value, "Dbpos");
+}
+
+TEST(NamespaceBuilderTest, RebindingFollowsTheBoundNode) {
+  IEDConfig ied = station();
+  IEDPlan flatPlan = NamespaceBuilder::compileIED(ied);
+  // Ind3's DOType resolves: its binding moves from the DO to its stVal
+  dataObjects(ied)[2].typeTemplate = statusType("SPS", "BOOLEAN");
+  IEDPlan typedPlan = NamespaceBuilder::compileIED(ied);
+
+  PlanDiff diff = NamespaceBuilder::diffPlans(flatPlan, typedPlan);
+  EXPECT_EQ(nodeIds(typedPlan, diff.replaced), Ids({"IED1.LD0.GGIO1.Ind3"}));
+  EXPECT_EQ(wantedIds(typedPlan, diff),
+            Ids({"IED1.LD0.GGIO1.Ind3", "IED1.LD0.GGIO1.Ind3.stVal",
+                 "IED1.LD0.GGIO1.Ind3.q"}));
+  EXPECT_TRUE(diff.unbound.empty());
+
+  // And back: the typed attribute vanishes and is unbound, while the flat
+  // DO binds the same reference again
+  PlanDiff back = NamespaceBuilder::diffPlans(typedPlan, flatPlan);
+  EXPECT_EQ(nodeIds(flatPlan, back.replaced), Ids({"IED1.LD0.GGIO1.Ind3"}));
+  EXPECT_EQ(wantedIds(flatPlan, back), Ids({"IED1.LD0.GGIO1.Ind3"}));
+  EXPECT_EQ(nodeIds(typedPlan, back.unbound),
+            Ids({"IED1.LD0.GGIO1.Ind3.stVal"}));
+
+  // Applied in update order, unbind then bind, the reference stays bound
+  // to the flat DO with the CDC's read plan
+  DataBinder binder(nullptr);
+  const NodePlan *typed = boundNode(typedPlan, "IED1/LD0/GGIO1.Ind3");
+  ASSERT_NE(typed, nullptr);
+  binder.bindDataPoint(typed->ref,
+                       UA_NODEID_STRING(2, (char *)typed->nodeId.c_str()),
+                       {typed->attribute, typed->fc, typed->cdc});
+
+  std::vector<std::string> unbound;
+  for (size_t i : back.unbound)
+    unbound.push_back(typedPlan[i].ref);
+  EXPECT_EQ(binder.unbindDataPoints(unbound), 1u);
+
+  const NodePlan *flat = boundNode(flatPlan, "IED1/LD0/GGIO1.Ind3");
+  ASSERT_NE(flat, nullptr);
+  UA_NodeId flatNode = UA_NODEID_STRING(2, (char *)flat->nodeId.c_str());
+  binder.bindDataPoint(flat->ref, flatNode,
+                       {flat->attribute, flat->fc, flat->cdc});
+
+  EXPECT_EQ(binder.getReference(flatNode), "IED1/LD0/GGIO1.Ind3");
+  DataBinder::ReadPlan plan;
+  ASSERT_TRUE(binder.getReadPlan("IED1/LD0/GGIO1.Ind3", &plan));
+  EXPECT_EQ(plan.attribute, "stVal");
+  EXPECT_EQ(plan.fc, "ST");
+}
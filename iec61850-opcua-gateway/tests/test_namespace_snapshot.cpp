@@ -0,0 +1,192 @@
+#include "opcua/namespace/namespace_snapshot.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+
+using namespace gateway::opcua::ns;
+
+namespace {
+
+constexpr uint64_t kScdHash = 0x5c0ffee5ull;
+
+// Offsets into the header: magic, u32 version, u64 scdHash
+constexpr size_t kVersionOffset = 4;
+constexpr size_t kHashOffset = 8;
+
+std::string readFile(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in),
+                     std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string &path, const std::string &content) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(content.data(), static_cast<std::streamsize>(content.size()));
+}
+
+// Append the FNV-1a trailer to @p payload, so that a
+// patched snapshot fails only the check under test
+std::string seal(std::string payload) {
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : payload) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  payload.append(reinterpret_cast<const char *>(&hash), sizeof(hash));
+  return payload;
+}
+
+std::string unsealed(const std::string &snapshot) {
+  return snapshot.substr(0, snapshot.size() - sizeof(uint64_t));
+}
+
+void expectSamePlan(const IEDPlan &expected, const IEDPlan &actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i].kind, actual[i].kind) << i;
+    EXPECT_EQ(expected[i].parent, actual[i].parent) << i;
+    EXPECT_EQ(expected[i].nodeId, actual[i].nodeId) << i;
+    EXPECT_EQ(expected[i].browseName, actual[i].browseName) << i;
+    EXPECT_EQ(expected[i].displayName, actual[i].displayName) << i;
+    EXPECT_EQ(expected[i].value, actual[i].value) << i;
+    EXPECT_EQ(expected[i].cdc, actual[i].cdc) << i;
+    EXPECT_EQ(expected[i].ref, actual[i].ref) << i;
+    EXPECT_EQ(expected[i].attribute, actual[i].attribute) << i;
+    EXPECT_EQ(expected[i].fc, actual[i].fc) << i;
+  }
+}
+
+} // namespace
+
+class NamespaceSnapshotTest : public ::testing::Test {
+protected:
+  using Kind = NodePlan::Kind;
+
+  void SetUp() override {
+    types_ = {
+        {Kind::ObjectType, NodePlan::npos, "CDC:CMV", "CMVType", "CMVType",
+         "", "CMV", "", "", ""},
+        {Kind::TypeAttribute, 0, "CDC:CMV.cVal.mag.f", "cVal.mag.f",
+         "cVal.mag.f", "FLOAT32", "MX", "", "", ""},
+    };
+    IEDPlan ied1 = {
+        {Kind::IED, NodePlan::npos, "IED1", "IED1", "IED1", "ABB - REF615",
+         "", "", "", ""},
+        {Kind::IPAddress, 0, "IED1.IPAddress", "IPAddress", "IPAddress",
+         "10.0.0.1", "", "", "", ""},
+        {Kind::LogicalDevice, 0, "IED1.LD0", "LD0", "LD0", "", "", "", "",
+         ""},
+        {Kind::LogicalNode, 2, "IED1.LD0.MMXU1", "MMXU1", "MMXU1 [MMXU]", "",
+         "", "", "", ""},
+        {Kind::TypedDataObject, 3, "IED1.LD0.MMXU1.PhsA", "PhsA",
+         "PhsA [CMV]", "", "CMV", "IED1/LD0/MMXU1.PhsA", "", ""},
+        {Kind::DataAttribute, 4, "IED1.LD0.MMXU1.PhsA.cVal.mag.f",
+         "cVal.mag.f", "cVal.mag.f", "FLOAT32", "CMV", "IED1/LD0/MMXU1.PhsA",
+         "cVal.mag.f", "MX"},
+    };
+    IEDPlan ied2 = {
+        {Kind::IED, NodePlan::npos, "IED2", "IED2", "IED2", "", "", "", "",
+         ""},
+        {Kind::DataObject, 0, "IED2.LD0.MMTR1.SupWh", "SupWh", "SupWh [BCR]",
+         "", "BCR", "IED2/LD0/MMTR1.SupWh", "actVal", "ST"},
+    };
+    ieds_ = {{"IED1", ied1}, {"IED2", ied2}};
+
+    ASSERT_TRUE(NamespaceSnapshot::save(path_, kScdHash, types_, ieds_));
+    saved_ = readFile(path_);
+    ASSERT_GT(saved_.size(), kHashOffset + sizeof(uint64_t));
+  }
+
+  void TearDown() override { std::remove(path_.c_str()); }
+
+  bool load() {
+    return NamespaceSnapshot::load(path_, kScdHash, &loadedTypes_,
+                                   &loadedIeds_);
+  }
+
+  const std::string path_ = "test.snap";
+  IEDPlan types_;
+  std::vector<NamespaceSnapshot::Entry> ieds_;
+  std::string saved_;
+
+  IEDPlan loadedTypes_;
+  std::vector<NamespaceSnapshot::Entry> loadedIeds_;
+};
+
+TEST_F(NamespaceSnapshotTest, RoundTripsEveryField) {
+  ASSERT_TRUE(load());
+
+  expectSamePlan(types_, loadedTypes_);
+  ASSERT_EQ(loadedIeds_.size(), ieds_.size());
+  for (size_t i = 0; i < ieds_.size(); ++i) {
+    EXPECT_EQ(loadedIeds_[i].first, ieds_[i].first);
+    expectSamePlan(ieds_[i].second, loadedIeds_[i].second);
+  }
+}
+
+TEST_F(NamespaceSnapshotTest, RejectsBadMagic) {
+  std::string payload = unsealed(saved_);
+  payload[0] = 'X';
+  writeFile(path_, seal(payload));
+
+  EXPECT_FALSE(load());
+}
+
+TEST_F(NamespaceSnapshotTest, RejectsOtherVersion) {
+  std::string payload = unsealed(saved_);
+  uint32_t version;
+  std::memcpy(&version, &payload[kVersionOffset], sizeof(version));
+  version++;
+  std::memcpy(&payload[kVersionOffset], &version, sizeof(version));
+  writeFile(path_, seal(payload));
+
+  EXPECT_FALSE(load());
+}
+
+TEST_F(NamespaceSnapshotTest, RejectsOtherScdHash) {
+  EXPECT_FALSE(NamespaceSnapshot::load(path_, kScdHash + 1, &loadedTypes_,
+                                       &loadedIeds_));
+
+  // Also when the stored hash is what changed
+  std::string payload = unsealed(saved_);
+  payload[kHashOffset] ^= 0x01;
+  writeFile(path_, seal(payload));
+  EXPECT_FALSE(load());
+}
+
+TEST_F(NamespaceSnapshotTest, RejectsBadChecksum) {
+  // Flip one byte of a string in the body; the trailer no longer matches
+  std::string corrupt = saved_;
+  size_t pos = corrupt.find("cVal.mag.f");
+  ASSERT_NE(pos, std::string::npos);
+  corrupt[pos] = 'X';
+  writeFile(path_, corrupt);
+
+  EXPECT_FALSE(load());
+}
+
+TEST_F(NamespaceSnapshotTest, RejectsTruncatedFile) {
+  // Cut inside the header
+  writeFile(path_, saved_.substr(0, kHashOffset));
+  EXPECT_FALSE(load());
+
+  // Cut inside the node list, resealed so only the bounds checks see it
+  std::string payload = unsealed(saved_);
+  writeFile(path_, seal(payload.substr(0, payload.size() / 2)));
+  EXPECT_FALSE(load());
+
+  // Cut trailer
+  writeFile(path_, saved_.substr(0, saved_.size() - 3));
+  EXPECT_FALSE(load());
+}
+
+TEST_F(NamespaceSnapshotTest, LeavesOutputsUntouchedOnFailure) {
+  loadedTypes_ = types_;
+  writeFile(path_, saved_.substr(0, saved_.size() / 2));
+
+  EXPECT_FALSE(load());
+  expectSamePlan(types_, loadedTypes_);
+  EXPECT_TRUE(loadedIeds_.empty());
+}
@@ -0,0 +1,156 @@
+#include "iec61850/capture/packet_ring.h"
+#include <chrono>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <vector>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace gateway::iec61850::capture;
+
+namespace {
+
+std::vector<uint8_t> frame(uint16_t etherType, uint16_t appId, uint8_t seq,
+                           bool vlan = false) {
+  std::vector<uint8_t> f = {0x01, 0x0C, 0xCD, 0x01, 0x00, 0x01,
+                            0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+  if (vlan)
+    f.insert(f.end(), {0x81, 0x00, 0x80, 0x00});
+  f.insert(f.end(), {static_cast<uint8_t>(etherType >> 8),
+                     static_cast<uint8_t>(etherType & 0xFF),
+                     static_cast<uint8_t>(appId >> 8),
+                     static_cast<uint8_t>(appId & 0xFF)});
+  f.resize(f.size() + 60, seq);
+  return f;
+}
+
+#ifdef __linux__
+
+// A veth pair: frames sent on one end are received on the other
+class VethPair {
+public:
+  VethPair() {
+    std::system("ip link del gwring0 >/dev/null 2>&1");
+    ok_ = std::system("ip link add gwring0 type veth peer name gwring1 "
+                      ">/dev/null 2>&1 && ip link set gwring0 up && "
+                      "ip link set gwring1 up") == 0;
+  }
+  ~VethPair() {
+    if (ok_)
+      std::system("ip link del gwring0 >/dev/null 2>&1");
+  }
+  bool ok() const { return ok_; }
+
+private:
+  bool ok_ = false;
+};
+
+class Sender {
+public:
+  explicit Sender(const char *ifName) {
+    fd_ = socket(AF_PACKET, SOCK_RAW, 0);
+    addr_.sll_family = AF_PACKET;
+    addr_.sll_ifindex = static_cast<int>(if_nametoindex(ifName));
+    addr_.sll_halen = 6;
+  }
+  ~Sender() {
+    if (fd_ >= 0)
+      close(fd_);
+  }
+  bool send(const std::vector<uint8_t> &f) {
+    return sendto(fd_, f.data(), f.size(), 0,
+                  reinterpret_cast<const sockaddr *>(&addr_),
+                  sizeof(addr_)) == static_cast<ssize_t>(f.size());
+  }
+
+private:
+  int fd_ = -1;
+  sockaddr_ll addr_{};
+};
+
+#endif
+
+} // namespace
+
+TEST(PacketRingTest, FilterProgramLayout) {
+  auto prog = buildEtherTypeFilter({kEtherTypeGoose, kEtherTypeSV}, {0x1001});
+  // VLAN skip, 2 EtherTypes, APPID load and test, accept, reject
+  ASSERT_EQ(prog.size(), 11u);
+  EXPECT_EQ(prog[5].k, kEtherTypeGoose);
+  EXPECT_EQ(prog[5].jt, 1); // To the APPID load
+  EXPECT_EQ(prog[6].jf, 3); // To reject
+  EXPECT_EQ(prog[8].k, 0x1001u);
+  EXPECT_EQ(prog.back().k, 0u);
+
+  // Too many APPIDs for the jump offsets: EtherTypes only
+  std::vector<uint16_t> many(300);
+  for (size_t i = 0; i < many.size(); ++i)
+    many[i] = static_cast<uint16_t>(i);
+  EXPECT_EQ(buildEtherTypeFilter({kEtherTypeGoose}, many).size(), 8u);
+}
+
+#ifdef __linux__
+
+TEST(PacketRingTest, ReceivesFilteredFramesOverVeth) {
+  if (getuid() != 0)
+    GTEST_SKIP() << "needs root for the veth pair and AF_PACKET";
+  VethPair veth;
+  if (!veth.ok())
+    GTEST_SKIP() << "cannot create veth pair";
+
+  PacketRingConfig config;
+  config.interfaceName = "gwring0";
+  config.appIds = {0x1001, 0x4000};
+  config.blockSize = 1 << 16;
+  config.blockCount = 4;
+  config.retireTimeoutMs = 1;
+  PacketRing ring;
+  ASSERT_TRUE(ring.open(config));
+
+  Sender sender("gwring1");
+  constexpr int kFrames = 200;
+  for (int i = 0; i < kFrames; ++i) {
+    ASSERT_TRUE(sender.send(frame(kEtherTypeGoose, 0x1001, i, i % 4 == 0)));
+    ASSERT_TRUE(sender.send(frame(kEtherTypeSV, 0x4000, i)));
+    ASSERT_TRUE(sender.send(frame(kEtherTypeGoose, 0x1002, i))); // Not ours
+    ASSERT_TRUE(sender.send(frame(0x0800, 0x1001, i)));         // IPv4
+  }
+
+  std::vector<uint8_t> goose, sv;
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while ((goose.size() < kFrames || sv.size() < kFrames) &&
+         std::chrono::steady_clock::now() < deadline) {
+    ring.poll(50, [&](const CapturedFrame *frames, size_t count) {
+      for (size_t i = 0; i < count; ++i) {
+        const CapturedFrame &f = frames[i];
+        EXPECT_GT(f.timestampNs, 0u);
+        if (f.etherType == kEtherTypeGoose)
+          goose.push_back(f.data[f.length - 1]);
+        else if (f.etherType == kEtherTypeSV)
+          sv.push_back(f.data[f.length - 1]);
+        else
+          ADD_FAILURE() << "unexpected EtherType " << f.etherType;
+      }
+    });
+  }
+
+  ASSERT_EQ(goose.size(), static_cast<size_t>(kFrames));
+  ASSERT_EQ(sv.size(), static_cast<size_t>(kFrames));
+  for (int i = 0; i < kFrames; ++i) {
+    EXPECT_EQ(goose[i], static_cast<uint8_t>(i));
+    EXPECT_EQ(sv[i], static_cast<uint8_t>(i));
+  }
+  PacketRingStats stats = ring.getStats();
+  EXPECT_EQ(stats.frames, 2u * kFrames);
+  EXPECT_EQ(stats.drops, 0u);
+  EXPECT_GT(stats.maxBatch, 1u);
+}
+
+#endif
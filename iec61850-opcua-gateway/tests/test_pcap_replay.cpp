@@ -0,0 +1,175 @@
+#include "iec61850/capture/pcap_replay.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace gateway::iec61850::capture;
+
+namespace {
+
+void put16(std::vector<uint8_t> &out, uint16_t v) {
+  out.push_back(v & 0xFF);
+  out.push_back(v >> 8);
+}
+
+void put32(std::vector<uint8_t> &out, uint32_t v) {
+  for (int i = 0; i < 4; ++i)
+    out.push_back((v >> (8 * i)) & 0xFF);
+}
+
+// Minimal Ethernet frame: broadcast, optional VLAN tag, EtherType, seq
+std::vector<uint8_t> frame(uint16_t etherType, uint8_t seq, bool vlan) {
+  std::vector<uint8_t> f(12, 0xFF);
+  if (vlan) {
+    f.insert(f.end(), {0x81, 0x00, 0x80, 0x00});
+  }
+  f.push_back(etherType >> 8);
+  f.push_back(etherType & 0xFF);
+  f.resize(f.size() + 46, seq);
+  return f;
+}
+
+std::string tempPath(const char *name) {
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+void write(const std::string &path, const std::vector<uint8_t> &bytes) {
+  std::ofstream out(path, std::ios::binary);
+  out.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+}
+
+// Classic little-endian microsecond pcap, frames 10 ms apart
+std::string writePcap(int frames) {
+  std::vector<uint8_t> out;
+  put32(out, 0xA1B2C3D4);
+  put16(out, 2);
+  put16(out, 4);
+  put32(out, 0);
+  put32(out, 0);
+  put32(out, 65535);
+  put32(out, 1);
+  for (int i = 0; i < frames; ++i) {
+    auto f = frame(i % 2 ? kEtherTypeSV : kEtherTypeGoose, i, i % 3 == 0);
+    put32(out, 1000);
+    put32(out, i * 10000);
+    put32(out, f.size());
+    put32(out, f.size());
+    out.insert(out.end(), f.begin(), f.end());
+  }
+  std::string path = tempPath("gateway_replay_test.pcap");
+  write(path, out);
+  return path;
+}
+
+void block(std::vector<uint8_t> &out, uint32_t type,
+           const std::vector<uint8_t> &body) {
+  uint32_t total = 12 + body.size();
+  put32(out, type);
+  put32(out, total);
+  out.insert(out.end(), body.begin(), body.end());
+  put32(out, total);
+}
+
+} // namespace
+
+TEST(PcapReplayTest, ReplaysPcapAsFastAsPossible) {
+  std::string path = writePcap(20);
+  PcapReplay replay;
+  std::vector<uint8_t> goose, sv;
+  replay.addHandler(kEtherTypeGoose, "goose", [&](const CapturedFrame &f) {
+    goose.push_back(f.data[f.length - 1]);
+  });
+  replay.addHandler(kEtherTypeSV, "sv", [&](const CapturedFrame &f) {
+    sv.push_back(f.data[f.length - 1]);
+  });
+
+  ReplayStats stats = replay.run(path, 0);
+  EXPECT_EQ(stats.frames, 20u);
+  EXPECT_EQ(stats.unhandled, 0u);
+  EXPECT_NEAR(stats.recordedSec, 0.19, 1e-9);
+  ASSERT_EQ(goose.size(), 10u);
+  ASSERT_EQ(sv.size(), 10u);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(goose[i], 2 * i);
+    EXPECT_EQ(sv[i], 2 * i + 1);
+  }
+  ASSERT_EQ(stats.stages.size(), 3u);
+  EXPECT_EQ(stats.stages[0].name, "read");
+  EXPECT_EQ(stats.stages[0].frames, 20u);
+  EXPECT_EQ(stats.stages[1].frames, 10u);
+  EXPECT_GT(stats.framesPerSecond, 0.0);
+  std::remove(path.c_str());
+}
+
+TEST(PcapReplayTest, PacesAtMultipleOfRecordedSpeed) {
+  std::string path = writePcap(11); // 100 ms recorded
+  PcapReplay replay;
+  ReplayStats stats = replay.run(path, 2.0);
+  EXPECT_EQ(stats.frames, 11u);
+  EXPECT_EQ(stats.unhandled, 11u);
+  EXPECT_GE(stats.elapsedSec, 0.045);
+  EXPECT_LT(stats.elapsedSec, 0.5);
+  std::remove(path.c_str());
+}
+
+TEST(PcapReplayTest, ReadsPcapNgInterfacesAndResolution) {
+  std::vector<uint8_t> out, body;
+  // Section header
+  put32(body, 0x1A2B3C4D);
+  put16(body, 1);
+  put16(body, 0);
+  put32(body, 0xFFFFFFFF);
+  put32(body, 0xFFFFFFFF);
+  block(out, 0x0A0D0D0A, body);
+  // LAN A in microseconds, LAN B in nanoseconds (if_tsresol = 9)
+  body.clear();
+  put16(body, 1);
+  put16(body, 0);
+  put32(body, 0);
+  block(out, 1, body);
+  body.clear();
+  put16(body, 1);
+  put16(body, 0);
+  put32(body, 0);
+  put16(body, 9);
+  put16(body, 1);
+  body.insert(body.end(), {9, 0, 0, 0});
+  put16(body, 0);
+  put16(body, 0);
+  block(out, 1, body);
+  // The same GOOSE frame on both LANs, 2 s plus 250 us apart
+  for (uint32_t id = 0; id < 2; ++id) {
+    uint64_t ticks = id ? 2000250000ULL : 0;
+    auto f = frame(kEtherTypeGoose, 7, false);
+    body.clear();
+    put32(body, id);
+    put32(body, ticks >> 32);
+    put32(body, ticks & 0xFFFFFFFF);
+    put32(body, f.size());
+    put32(body, f.size() + 10); // Snapped
+    body.insert(body.end(), f.begin(), f.end());
+    body.resize((body.size() + 3) & ~size_t(3), 0);
+    block(out, 6, body);
+  }
+  std::string path = tempPath("gateway_replay_test.pcapng");
+  write(path, out);
+
+  PcapReader reader;
+  ASSERT_TRUE(reader.open(path));
+  EXPECT_TRUE(reader.isPcapNg());
+  CapturedFrame f;
+  ASSERT_TRUE(reader.next(f));
+  EXPECT_EQ(f.interfaceId, 0);
+  EXPECT_EQ(f.timestampNs, 0u);
+  EXPECT_EQ(f.etherType, kEtherTypeGoose);
+  EXPECT_EQ(f.length, 60u);
+  ASSERT_TRUE(reader.next(f));
+  EXPECT_EQ(f.interfaceId, 1);
+  EXPECT_EQ(f.timestampNs, 2000250000ULL);
+  EXPECT_FALSE(reader.next(f));
+  EXPECT_EQ(reader.truncatedFrames(), 2u);
+  std::remove(path.c_str());
+}
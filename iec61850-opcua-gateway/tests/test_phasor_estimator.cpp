@@ -0,0 +1,132 @@
+#include "iec61850/sv/phasor_estimator.h"
+#include <cmath>
+#include <gtest/gtest.h>
+
+using namespace gateway::iec61850::sv;
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+struct Wave {
+  double rms;   // A or V
+  double angle; // Radians at smpCnt 0
+};
+
+/**
+ * @brief Feed @p samples of a 4000 Hz stream at @p frequency, phases
+ * a, b, c of both currents and voltages as given
+ */
+void feed(PhasorEstimator &estimator, double frequency, Wave a, Wave b,
+          Wave c, uint32_t samples) {
+  const Wave phases[3] = {a, b, c};
+  for (uint32_t i = 0; i < samples; ++i) {
+    SVSample sample;
+    sample.smpCnt = static_cast<uint16_t>(i % 4000);
+    sample.timestamp = i * 250;
+    double t = i / 4000.0;
+    for (int p = 0; p < 3; ++p) {
+      double x = std::sqrt(2.0) * phases[p].rms *
+                 std::cos(2 * kPi * frequency * t + phases[p].angle);
+      sample.values[p] = static_cast<int32_t>(std::lround(x / kCurrentScale));
+      sample.values[kCurrentChannels + p] =
+          static_cast<int32_t>(std::lround(100 * x / kVoltageScale));
+    }
+    estimator.add(sample);
+  }
+}
+
+} // namespace
+
+TEST(PhasorEstimatorTest, MeasuresNominalSine) {
+  PhasorEstimator partial;
+  ASSERT_EQ(partial.windowSize(), 80u);
+  feed(partial, 50.0, {100.0, 0.5}, {100.0, 0.5 - 2 * kPi / 3},
+       {100.0, 0.5 + 2 * kPi / 3}, 79);
+  EXPECT_FALSE(partial.result().valid);
+
+  PhasorEstimator estimator;
+  feed(estimator, 50.0, {100.0, 0.5}, {100.0, 0.5 - 2 * kPi / 3},
+       {100.0, 0.5 + 2 * kPi / 3}, 800);
+  PhasorResult result = estimator.result();
+  ASSERT_TRUE(result.valid);
+  EXPECT_NEAR(result.rms[0], 100.0, 0.01);
+  EXPECT_NEAR(result.rms[kCurrentChannels], 10000.0, 0.1);
+  EXPECT_NEAR(result.phasors[0].magnitude, 100.0, 0.01);
+  EXPECT_NEAR(result.phasors[0].angle, 0.5, 1e-4);
+  EXPECT_NEAR(result.phasors[1].angle, 0.5 - 2 * kPi / 3, 1e-4);
+  EXPECT_NEAR(result.frequency, 50.0, 1e-3);
+  EXPECT_NEAR(result.rms[3], 0.0, 1e-9);
+}
+
+TEST(PhasorEstimatorTest, TracksOffNominalFrequency) {
+  for (double frequency : {49.5, 50.8}) {
+    PhasorEstimator estimator;
+    feed(estimator, frequency, {10.0, 0.0}, {10.0, -2 * kPi / 3},
+         {10.0, 2 * kPi / 3}, 4000);
+    PhasorResult result = estimator.result();
+    EXPECT_NEAR(result.frequency, frequency, 0.01) << frequency;
+    EXPECT_NEAR(result.voltage.positive.magnitude, 1000.0, 5.0);
+  }
+}
+
+TEST(PhasorEstimatorTest, SeparatesSequenceComponents) {
+  PhasorEstimator estimator;
+  feed(estimator, 50.0, {10.0, 0.0}, {10.0, -2 * kPi / 3},
+       {10.0, 2 * kPi / 3}, 400);
+  PhasorResult balanced = estimator.result();
+  EXPECT_NEAR(balanced.current.positive.magnitude, 10.0, 1e-3);
+  EXPECT_NEAR(balanced.current.negative.magnitude, 0.0, 1e-3);
+  EXPECT_NEAR(balanced.current.zero.magnitude, 0.0, 1e-3);
+
+  // Phases B and C swapped: all negative sequence
+  estimator.reset();
+  feed(estimator, 50.0, {10.0, 0.0}, {10.0, 2 * kPi / 3},
+       {10.0, -2 * kPi / 3}, 400);
+  PhasorResult swapped = estimator.result();
+  EXPECT_NEAR(swapped.current.positive.magnitude, 0.0, 1e-3);
+  EXPECT_NEAR(swapped.current.negative.magnitude, 10.0, 1e-3);
+}
+
+TEST(PhasorEstimatorTest, BridgesLostSamples) {
+  PhasorEstimator estimator;
+  feed(estimator, 50.0, {10.0, 0.0}, {10.0, -2 * kPi / 3},
+       {10.0, 2 * kPi / 3}, 400);
+
+  // Two samples lost: held values barely move the cycle's estimate
+  SVSample sample;
+  sample.smpCnt = 402;
+  sample.values[0] = static_cast<int32_t>(
+      std::lround(std::sqrt(2.0) * 10.0 * std::cos(2 * kPi * 50 * 0.1005) /
+                  kCurrentScale));
+  estimator.add(sample);
+  EXPECT_NEAR(estimator.result().phasors[0].magnitude, 10.0, 0.5);
+
+  // A gap of a cycle or more starts over
+  sample.smpCnt = 600;
+  estimator.add(sample);
+  EXPECT_FALSE(estimator.result().valid);
+}
+
+TEST(PhasorEstimatorTest, IgnoresDuplicateAndLateSamples) {
+  PhasorEstimator estimator;
+  feed(estimator, 50.0, {10.0, 0.0}, {10.0, -2 * kPi / 3},
+       {10.0, 2 * kPi / 3}, 400);
+  ASSERT_TRUE(estimator.result().valid);
+
+  // smpCnt 399 again, then one from before it: neither starts over
+  SVSample sample;
+  sample.smpCnt = 399;
+  EXPECT_FALSE(estimator.add(sample));
+  sample.smpCnt = 390;
+  EXPECT_FALSE(estimator.add(sample));
+  EXPECT_TRUE(estimator.result().valid);
+  EXPECT_NEAR(estimator.result().phasors[0].magnitude, 10.0, 1e-3);
+
+  // A stream that restarted from 0 is taken up after a cycle
+  for (uint16_t smpCnt = 0; smpCnt <= 80; ++smpCnt) {
+    sample.smpCnt = smpCnt;
+    estimator.add(sample);
+  }
+  EXPECT_FALSE(estimator.result().valid);
+}
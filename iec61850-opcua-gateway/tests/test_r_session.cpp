@@ -0,0 +1,148 @@
+#include "iec61850/capture/r_session.h"
+#include "iec61850/goose/goose_receiver.h"
+#include "iec61850/sv/sv_stream_receiver.h"
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <libiec61850/goose_publisher.h>
+#include <libiec61850/goose_subscriber.h>
+#include <libiec61850/sv_publisher.h>
+#include <thread>
+
+using namespace gateway;
+using namespace gateway::iec61850;
+
+namespace {
+
+constexpr const char *kKey = "00112233445566778899aabbccddeeff";
+
+core::RSessionConfig session(int port, bool publishing) {
+  core::RSessionConfig config;
+  config.enabled = true;
+  config.localAddress = "127.0.0.1";
+  config.port = port;
+  if (publishing)
+    config.remoteAddress = "127.0.0.1";
+  config.keys.push_back({1, kKey, "none", "hmac-sha256-256"});
+  config.activeKeyId = 1;
+  return config;
+}
+
+template <typename Done> bool waitFor(Done done) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (!done() && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  return done();
+}
+
+} // namespace
+
+TEST(RSessionTest, ParsesKeysAndAlgorithms) {
+  std::vector<uint8_t> key;
+  EXPECT_TRUE(capture::parseHexKey("00:1a-2B 3c", key));
+  EXPECT_EQ(key, (std::vector<uint8_t>{0x00, 0x1A, 0x2B, 0x3C}));
+  EXPECT_FALSE(capture::parseHexKey("abc", key)); // Odd digit count
+  EXPECT_FALSE(capture::parseHexKey("zz", key));
+  EXPECT_FALSE(capture::parseHexKey("", key));
+
+  RSecurityAlgorithm security;
+  EXPECT_TRUE(capture::parseSecurityAlgorithm("aes-128-gcm", security));
+  EXPECT_EQ(security, R_SESSION_SEC_ALGO_AES_128_GCM);
+  EXPECT_FALSE(capture::parseSecurityAlgorithm("des", security));
+
+  RSignatureAlgorithm signature;
+  EXPECT_TRUE(capture::parseSignatureAlgorithm("hmac-sha256-80", signature));
+  EXPECT_EQ(signature, R_SESSION_SIG_ALGO_HMAC_SHA256_80);
+  EXPECT_FALSE(capture::parseSignatureAlgorithm("md5", signature));
+
+  core::RSessionConfig config = session(30100, false);
+  config.keys[0].key = "0g";
+  EXPECT_EQ(capture::openRSession(config), nullptr);
+  EXPECT_EQ(capture::describeRSession(session(30100, true)),
+            "udp://127.0.0.1:30100");
+}
+
+TEST(RSessionTest, ReceivesRGooseOnLoopback) {
+  constexpr uint16_t kAppId = 0x1001;
+  char goCbRef[] = "IED1LD0/LLN0$GO$gcb1";
+  char dataSetRef[] = "IED1LD0/LLN0$DataSet1";
+
+  goose::GOOSEReceiver receiver(session(30102, false));
+  ASSERT_TRUE(receiver.isRoutable());
+  std::atomic<int> received{0};
+  GooseSubscriber subscriber = GooseSubscriber_create(goCbRef, nullptr);
+  GooseSubscriber_setAppId(subscriber, kAppId);
+  GooseSubscriber_setListener(
+      subscriber,
+      [](GooseSubscriber sub, void *parameter) {
+        if (GooseSubscriber_isValid(sub))
+          (*static_cast<std::atomic<int> *>(parameter))++;
+      },
+      &received);
+  capture::DispatchKey key;
+  key.appId = kAppId;
+  receiver.addSubscriber(subscriber, key);
+  receiver.start();
+  ASSERT_TRUE(receiver.isRunning());
+
+  auto publishing = capture::openRSession(session(30102, true));
+  ASSERT_NE(publishing, nullptr);
+  GoosePublisher publisher =
+      GoosePublisher_createRemote(publishing.get(), kAppId);
+  ASSERT_NE(publisher, nullptr);
+  GoosePublisher_setGoCbRef(publisher, goCbRef);
+  GoosePublisher_setDataSetRef(publisher, dataSetRef);
+  GoosePublisher_setTimeAllowedToLive(publisher, 1000);
+  LinkedList values = LinkedList_create();
+  LinkedList_add(values, MmsValue_newBoolean(true));
+  for (int i = 0; i < 10; ++i)
+    GoosePublisher_publish(publisher, values);
+
+  EXPECT_TRUE(waitFor([&] { return received >= 10; }));
+  EXPECT_EQ(receiver.getDecodedFrames(), 10u);
+  EXPECT_EQ(receiver.getUnknownKeyMessages(), 0u);
+
+  receiver.stop();
+  receiver.removeSubscriber(subscriber);
+  GooseSubscriber_destroy(subscriber);
+  LinkedList_destroyDeep(values,
+                         (LinkedListValueDeleteFunction)MmsValue_delete);
+  GoosePublisher_destroy(publisher);
+}
+
+TEST(RSessionTest, ReceivesRSvOnLoopback) {
+  constexpr uint16_t kAppId = 0x4001;
+
+  sv::SVStreamReceiver receiver(session(30103, false));
+  std::atomic<int> received{0};
+  std::atomic<int> lastSmpCnt{-1};
+  std::atomic<float> lastValue{0.0f};
+  ASSERT_TRUE(receiver.addStream(kAppId, [&](SVSubscriber_ASDU asdu) {
+    lastSmpCnt = SVSubscriber_ASDU_getSmpCnt(asdu);
+    lastValue = SVSubscriber_ASDU_getFLOAT32(asdu, 0);
+    received++;
+  }));
+  ASSERT_TRUE(receiver.start());
+
+  auto publishing = capture::openRSession(session(30103, true));
+  ASSERT_NE(publishing, nullptr);
+  SVPublisher publisher = SVPublisher_createRemote(publishing.get(), kAppId);
+  ASSERT_NE(publisher, nullptr);
+  SVPublisher_ASDU asdu =
+      SVPublisher_addASDU(publisher, "MU01", "MU01/LLN0$PhsMeas1", 1);
+  int index = SVPublisher_ASDU_addFLOAT(asdu);
+  SVPublisher_setupComplete(publisher);
+  for (uint16_t i = 0; i < 8; ++i) {
+    SVPublisher_ASDU_setFLOAT(asdu, index, 1.5f * i);
+    SVPublisher_ASDU_setSmpCnt(asdu, i);
+    SVPublisher_publish(publisher);
+  }
+
+  EXPECT_TRUE(waitFor([&] { return received >= 8; }));
+  EXPECT_EQ(lastSmpCnt, 7);
+  EXPECT_FLOAT_EQ(lastValue, 10.5f);
+  EXPECT_EQ(receiver.getMessages(), 8u);
+
+  receiver.stop();
+  SVPublisher_destroy(publisher);
+}
@@ -0,0 +1,46 @@
+#include "iec61850/goose/retransmission_curve.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace gateway::iec61850::goose;
+using Clock = RetransmissionSchedule::Clock;
+using std::chrono::milliseconds;
+
+TEST(RetransmissionCurveTest, DoublesFromMinTimeToMaxTime) {
+  RetransmissionCurve curve{4, 1000};
+  std::vector<uint32_t> intervals;
+  for (uint32_t repeat = 0; repeat < 10; ++repeat)
+    intervals.push_back(curve.intervalMs(repeat));
+  EXPECT_EQ(intervals, (std::vector<uint32_t>{4, 8, 16, 32, 64, 128, 256,
+                                               512, 1000, 1000}));
+  EXPECT_EQ(curve.timeAllowedToLiveMs(0), 8u);
+  EXPECT_EQ(curve.timeAllowedToLiveMs(100), 2000u);
+
+  // Misconfigured curves stay usable
+  EXPECT_EQ((RetransmissionCurve{0, 0}).intervalMs(0), 1u);
+  EXPECT_EQ((RetransmissionCurve{50, 10}).intervalMs(3), 50u);
+}
+
+TEST(RetransmissionCurveTest, ScheduleRestartsOnStateChange) {
+  RetransmissionSchedule schedule(RetransmissionCurve{2, 100});
+  Clock::time_point t0 = Clock::now();
+
+  schedule.trigger(t0);
+  EXPECT_TRUE(schedule.due(t0));
+  // Sent 1 ms late: the next due time keeps to the schedule
+  schedule.sent(t0 + milliseconds(1));
+  EXPECT_EQ(schedule.next(), t0 + milliseconds(2));
+  schedule.sent(t0 + milliseconds(2));
+  EXPECT_EQ(schedule.next(), t0 + milliseconds(6));
+  EXPECT_EQ(schedule.repeat(), 2u);
+  EXPECT_FALSE(schedule.due(t0 + milliseconds(5)));
+
+  // Far behind: restart from now instead of bursting
+  schedule.sent(t0 + milliseconds(50));
+  EXPECT_EQ(schedule.next(), t0 + milliseconds(58));
+
+  schedule.trigger(t0 + milliseconds(60));
+  EXPECT_EQ(schedule.repeat(), 0u);
+  EXPECT_EQ(schedule.nextIntervalMs(), 2u);
+  EXPECT_TRUE(schedule.due(t0 + milliseconds(60)));
+}
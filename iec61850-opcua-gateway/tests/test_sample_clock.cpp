@@ -0,0 +1,75 @@
+#include "iec61850/sv/sample_clock.h"
+#include <gtest/gtest.h>
+
+using namespace gateway::iec61850::sv;
+
+namespace {
+constexpr uint64_t kSecond = 1000000;
+constexpr uint64_t kT0 = 1700000000ull * kSecond;
+} // namespace
+
+TEST(SampleClockTest, DetectsRateWhereSmpCntWraps) {
+  struct Case {
+    uint32_t rate;
+    uint16_t spc;
+    uint16_t freq;
+  };
+  for (Case c : {Case{4000, 80, 50}, Case{4800, 80, 60}, Case{12800, 256, 50},
+                 Case{15360, 256, 60}}) {
+    SampleClock clock;
+    // Start mid-second and run past the wrap
+    for (uint32_t i = c.rate / 2; i < c.rate + 10; ++i)
+      clock.timestamp(static_cast<uint16_t>(i % c.rate), true, kT0);
+    EXPECT_TRUE(clock.format().detected) << c.rate;
+    EXPECT_EQ(clock.format().sampleRate, c.rate);
+    EXPECT_EQ(clock.format().samplesPerCycle, c.spc);
+    EXPECT_EQ(clock.format().nominalFrequency, c.freq);
+    EXPECT_EQ(clock.lostSamples(), 0u);
+  }
+
+  // Before the wrap the smallest fitting rate is assumed
+  SampleClock clock;
+  clock.timestamp(100, true, kT0);
+  EXPECT_FALSE(clock.format().detected);
+  EXPECT_EQ(clock.format().sampleRate, 4000u);
+  clock.timestamp(4500, true, kT0);
+  EXPECT_EQ(clock.format().sampleRate, 4800u);
+  // A late sample is not a wrap
+  clock.timestamp(4499, true, kT0);
+  EXPECT_FALSE(clock.format().detected);
+}
+
+TEST(SampleClockTest, SynchronisedSamplesAlignToTheSecond) {
+  SampleClock clock;
+  // 80 samples per cycle at 50 Hz: 250 us apart, received 300 us late
+  EXPECT_EQ(clock.timestamp(0, true, kT0 + 300), kT0);
+  EXPECT_EQ(clock.timestamp(1, true, kT0 + 550), kT0 + 250);
+  EXPECT_EQ(clock.timestamp(5, true, kT0 + 1560), kT0 + 1250);
+  EXPECT_EQ(clock.lostSamples(), 3u);
+  for (uint16_t i = 6; i < 3999; ++i)
+    clock.timestamp(i, true, kT0 + i * 250 + 300);
+  EXPECT_EQ(clock.timestamp(3999, true, kT0 + kSecond + 50),
+            kT0 + 999750);
+  EXPECT_EQ(clock.timestamp(0, true, kT0 + kSecond + 280), kT0 + kSecond);
+}
+
+TEST(SampleClockTest, UnsynchronisedSamplesAreEvenlySpaced) {
+  SampleClock clock;
+  // A free-running counter, arrival jitter of up to 40 us
+  EXPECT_EQ(clock.timestamp(1234, false, kT0), kT0);
+  EXPECT_EQ(clock.timestamp(1235, false, kT0 + 290), kT0 + 250);
+  EXPECT_EQ(clock.timestamp(1237, false, kT0 + 710), kT0 + 750);
+  EXPECT_EQ(clock.lostSamples(), 1u);
+  // Duplicate: same time, nothing lost
+  EXPECT_EQ(clock.timestamp(1237, false, kT0 + 720), kT0 + 750);
+
+  // A restarted merging unit is re-anchored
+  EXPECT_EQ(clock.timestamp(1238, false, kT0 + 5 * kSecond),
+            kT0 + 5 * kSecond);
+
+  // Synchronisation regained, then lost again
+  EXPECT_EQ(clock.timestamp(0, true, kT0 + 6 * kSecond + 100),
+            kT0 + 6 * kSecond);
+  EXPECT_EQ(clock.timestamp(1, false, kT0 + 6 * kSecond + 400),
+            kT0 + 6 * kSecond + 400);
+}
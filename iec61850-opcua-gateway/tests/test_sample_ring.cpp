@@ -0,0 +1,101 @@
+#include "iec61850/sv/sample_ring.h"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace gateway::iec61850::sv;
+
+namespace {
+
+// Every field derived from the index, so a torn copy shows
+SVSample sampleAt(uint64_t index) {
+  SVSample sample;
+  sample.timestamp = index;
+  sample.smpCnt = static_cast<uint16_t>(index % 4000);
+  sample.synchronised = index % 3 == 0;
+  for (int channel = 0; channel < kChannels; ++channel) {
+    sample.values[channel] = static_cast<int32_t>(index * kChannels + channel);
+    sample.quality[channel] = static_cast<uint32_t>(index + channel);
+  }
+  return sample;
+}
+
+bool matches(const SVSample &sample, uint64_t index) {
+  SVSample expected = sampleAt(index);
+  if (sample.timestamp != expected.timestamp ||
+      sample.smpCnt != expected.smpCnt ||
+      sample.synchronised != expected.synchronised)
+    return false;
+  for (int channel = 0; channel < kChannels; ++channel) {
+    if (sample.values[channel] != expected.values[channel] ||
+        sample.quality[channel] != expected.quality[channel])
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+TEST(SampleRingTest, KeepsTheNewestSamples) {
+  SampleRing ring(6);
+  EXPECT_EQ(ring.capacity(), 8u);
+  std::vector<SVSample> out;
+  EXPECT_EQ(ring.read(0, UINT64_MAX, out), 0u);
+  EXPECT_TRUE(out.empty());
+
+  for (uint64_t i = 0; i < 5; ++i)
+    ring.push(sampleAt(i));
+  EXPECT_EQ(ring.read(1, 4, out), 1u);
+  ASSERT_EQ(out.size(), 3u);
+  EXPECT_TRUE(matches(out[0], 1));
+  EXPECT_TRUE(matches(out[2], 3));
+
+  for (uint64_t i = 5; i < 20; ++i)
+    ring.push(sampleAt(i));
+  EXPECT_EQ(ring.written(), 20u);
+  // The oldest slot is the one the next push replaces
+  EXPECT_EQ(ring.read(0, UINT64_MAX, out), 13u);
+  ASSERT_EQ(out.size(), 7u);
+  for (size_t i = 0; i < out.size(); ++i)
+    EXPECT_TRUE(matches(out[i], 13 + i)) << i;
+
+  // One channel across the wrap of the arrays
+  std::vector<int32_t> values;
+  EXPECT_EQ(ring.readChannel(2, 14, 19, values), 14u);
+  EXPECT_EQ(values, (std::vector<int32_t>{114, 122, 130, 138, 146}));
+  EXPECT_EQ(ring.readChannel(kChannels, 14, 19, values), 14u);
+  EXPECT_TRUE(values.empty());
+}
+
+TEST(SampleRingTest, ReadersNeverSeeTornSamples) {
+  // 14.4 kHz for a minute, read while written
+  constexpr uint64_t kSamples = 864000;
+  SampleRing ring(1024);
+  std::atomic<bool> done{false};
+
+  std::thread producer([&] {
+    for (uint64_t i = 0; i < kSamples; ++i)
+      ring.push(sampleAt(i));
+    done = true;
+  });
+
+  uint64_t reads = 0;
+  std::vector<SVSample> out;
+  std::vector<int32_t> values;
+  while (!done) {
+    uint64_t end = ring.written();
+    uint64_t from = end > 600 ? end - 600 : 0;
+    uint64_t first = ring.read(from, end, out);
+    ASSERT_GE(first, from);
+    for (size_t i = 0; i < out.size(); ++i)
+      ASSERT_TRUE(matches(out[i], first + i)) << first + i;
+
+    first = ring.readChannel(5, from, end, values);
+    for (size_t i = 0; i < values.size(); ++i)
+      ASSERT_EQ(values[i], static_cast<int32_t>((first + i) * kChannels + 5));
+    reads++;
+  }
+  producer.join();
+  EXPECT_GT(reads, 0u);
+  EXPECT_EQ(ring.written(), kSamples);
+}
@@ -26,7 +26,14 @@ protected:
             <Server>
                 <LDevice inst="LD0">
                     <LN0 lnClass="LLN0" inst="" lnType="LLN0">
-                        <GSEControl name="gcb01" datSet="ds1" appID="0001"/>
+                        <DataSet name="ds1">
+                            <FCDA ldInst="LD0" lnClass="GGIO" lnInst="1"
+                                  doName="Ind1" daName="stVal" fc="ST"/>
+                            <FCDA ldInst="LD0" lnClass="GGIO" lnInst="1"
+                                  doName="Ind1" daName="q" fc="ST"/>
+                        </DataSet>
+                        <GSEControl name="gcb01" datSet="ds1" appID="0001"
+                                    confRev="3"/>
                     </LN0>
                 </LDevice>
             </Server>
@@ -63,3 +70,133 @@ TEST_F(SCLParserTest, ParseGOOSEControls) {
   EXPECT_EQ(configs[0].gooseControls[0].name, "gcb01");
   EXPECT_EQ(configs[0].gooseControls[0].appID, "0001");
 }
+
+TEST_F(SCLParserTest, ParseGOOSEDataSetMembers) {
+  SCLParser parser;
+  auto configs = parser.parse("test.icd");
+
+  ASSERT_EQ(configs.size(), 1);
+  ASSERT_EQ(configs[0].gooseControls.size(), 1);
+  const auto &gcb = configs[0].gooseControls[0];
+  EXPECT_EQ(gcb.reference, "IED1LD0/LLN0$GO$gcb01");
+  EXPECT_EQ(gcb.confRev, 3);
+  ASSERT_EQ(gcb.members.size(), 2);
+  EXPECT_EQ(gcb.members[0].doName, "Ind1");
+  EXPECT_EQ(gcb.members[0].daName, "stVal");
+  EXPECT_EQ(gcb.members[1].daName, "q");
+  EXPECT_EQ(gcb.members[1].fc, "ST");
+}
+
+TEST(SCLParserTemplateTest, FlattensDOTypeTemplates) {
+  std::ofstream file("templates.icd");
+  file << R"(<?xml version="1.0" encoding="UTF-8"?>
+<SCL xmlns="http://www.iec.ch/61850/2003/SCL" version="2007" revision="B">
+    <IED name="IED1">
+        <AccessPoint name="AP1">
+            <Server>
+                <LDevice inst="LD0">
+                    <LN lnClass="GGIO" inst="1" lnType="GGIO_1">
+                        <DOI name="Ind1"/>
+                        <DOI name="Ind2"/>
+                        <DOI name="AnIn1"/>
+                    </LN>
+                </LDevice>
+            </Server>
+        </AccessPoint>
+    </IED>
+    <DataTypeTemplates>
+        <LNodeType id="GGIO_1" lnClass="GGIO">
+            <DO name="Ind1" type="SPS_1"/>
+            <DO name="Ind2" type="SPS_1"/>
+            <DO name="AnIn1" type="MV_1"/>
+        </LNodeType>
+        <DOType id="SPS_1" cdc="SPS">
+            <DA name="stVal" fc="ST" bType="BOOLEAN"/>
+            <DA name="q" fc="ST" bType="Quality"/>
+            <DA name="d" fc="DC" bType="VisString255"/>
+        </DOType>
+        <DOType id="MV_1" cdc="MV">
+            <DA name="mag" fc="MX" bType="Struct" type="AV_1"/>
+        </DOType>
+        <DAType id="AV_1">
+            <BDA name="f" bType="FLOAT32"/>
+        </DAType>
+    </DataTypeTemplates>
+</SCL>)";
+  file.close();
+
+  SCLParser parser;
+  auto configs = parser.parse("templates.icd");
+  std::remove("templates.icd");
+
+  ASSERT_EQ(configs.size(), 1);
+  const auto &dos =
+      configs[0].logicalDevices.at(0).logicalNodes.at(0).dataObjects;
+  ASSERT_EQ(dos.size(), 3);
+
+  // DOs of the same DOType share one template
+  ASSERT_TRUE(dos[0].typeTemplate);
+  EXPECT_EQ(dos[0].typeTemplate, dos[1].typeTemplate);
+  EXPECT_EQ(dos[0].type, "SPS");
+  ASSERT_EQ(dos[0].typeTemplate->attributes.size(), 3);
+  EXPECT_EQ(dos[0].typeTemplate->attributes[2].name, "d");
+  EXPECT_EQ(dos[0].typeTemplate->attributes[2].fc, "DC");
+
+  // Struct DAs are flattened and BDAs inherit the DA's FC
+  ASSERT_TRUE(dos[2].typeTemplate);
+  ASSERT_EQ(dos[2].typeTemplate->attributes.size(), 1);
+  EXPECT_EQ(dos[2].typeTemplate->attributes[0].name, "mag.f");
+  EXPECT_EQ(dos[2].typeTemplate->attributes[0].fc, "MX");
+  EXPECT_EQ(dos[2].typeTemplate->attributes[0].bType, "FLOAT32");
+}
+
+TEST(SCLParserCommunicationTest, ReadsGSEAddressAndRetransmission) {
+  std::ofstream file("gse.icd");
+  file << R"(<?xml version="1.0" encoding="UTF-8"?>
+<SCL xmlns="http://www.iec.ch/61850/2003/SCL" version="2007" revision="B">
+    <Communication>
+        <SubNetwork name="StationBus">
+            <ConnectedAP iedName="IED1" apName="AP1">
+                <GSE ldInst="LD0" cbName="gcb01">
+                    <Address>
+                        <P type="MAC-Address">01-0C-CD-01-00-10</P>
+                        <P type="APPID">3010</P>
+                        <P type="VLAN-ID">01A</P>
+                        <P type="VLAN-PRIORITY">6</P>
+                    </Address>
+                    <MinTime unit="s" multiplier="m">4</MinTime>
+                    <MaxTime unit="s">2</MaxTime>
+                </GSE>
+            </ConnectedAP>
+        </SubNetwork>
+    </Communication>
+    <IED name="IED1">
+        <AccessPoint name="AP1">
+            <Server>
+                <LDevice inst="LD0">
+                    <LN0 lnClass="LLN0" inst="" lnType="LLN0">
+                        <DataSet name="ds1"/>
+                        <GSEControl name="gcb01" datSet="ds1" appID="IED1_GO"/>
+                    </LN0>
+                </LDevice>
+            </Server>
+        </AccessPoint>
+    </IED>
+</SCL>)";
+  file.close();
+
+  SCLParser parser;
+  auto configs = parser.parse("gse.icd");
+  std::remove("gse.icd");
+
+  ASSERT_EQ(configs.size(), 1);
+  ASSERT_EQ(configs[0].gooseControls.size(), 1);
+  const auto &gcb = configs[0].gooseControls[0];
+  EXPECT_EQ(gcb.goID, "IED1_GO");
+  EXPECT_EQ(gcb.appID, "3010");
+  EXPECT_EQ(gcb.macAddress, "01-0C-CD-01-00-10");
+  EXPECT_EQ(gcb.vlanID, 0x1A);
+  EXPECT_EQ(gcb.vlanPriority, 6);
+  EXPECT_EQ(gcb.minTimeMs, 4);
+  EXPECT_EQ(gcb.maxTimeMs, 2000); // No multiplier: seconds
+}
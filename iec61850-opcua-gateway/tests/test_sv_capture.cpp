@@ -30,13 +30,87 @@ TEST(SVWaveformCaptureTest, ThresholdTrigger) {
 
   capture.start(config);
 
-  // Simulate SV message below threshold
-  // Note: Since we can't easily mock the libiec61850 callback without a real
-  // subscriber, we would typically separate the logic or use a friend
-  // class/mock. For this test, we assume we can call onSVMessage directly if we
-  // mock the arguments. But onSVMessage takes opaque pointers. So we'll skip
-  // deep logic test here and rely on manual trigger test above.
-
+  // The threshold itself is exercised in StoresAllChannelsWithSampleTimes;
+  // a manual trigger still works with one configured
   capture.trigger(); // Manual trigger to verify state change
   EXPECT_TRUE(capture.isTriggered());
 }
+
+TEST(SVWaveformCaptureTest, StoresAllChannelsWithSampleTimes) {
+  SVWaveformCapture capture;
+  CaptureConfig config;
+  config.durationMs = 100;
+  config.preTriggerMs = 0;
+  config.triggerThreshold = 100.0; // A or V
+  capture.start(config);
+
+  // One second of a synchronised 80 samples per cycle, 60 Hz stream
+  const uint64_t t0 = 1700000000ull * 1000000;
+  for (uint16_t smpCnt = 0; smpCnt < 4800; ++smpCnt) {
+    SVSample sample;
+    sample.smpCnt = smpCnt;
+    sample.synchronised = true;
+    for (int channel = 0; channel < kChannels; ++channel)
+      sample.values[channel] = channel * 100;
+    capture.addSample(sample, t0 + smpCnt * 1000000ull / 4800 + 150);
+  }
+  EXPECT_FALSE(capture.isTriggered());
+
+  SVSample wrapped;
+  wrapped.smpCnt = 0;
+  wrapped.synchronised = true;
+  wrapped.values[3] = 4000;    // In = 4 A
+  wrapped.values[4] = 60000;   // Ua = 600 V
+  wrapped.quality[4] = 0x2000; // Test
+  capture.addSample(wrapped, t0 + 1000000 + 150);
+  EXPECT_TRUE(capture.isTriggered());
+
+  SVStreamFormat format = capture.getFormat();
+  EXPECT_TRUE(format.detected);
+  EXPECT_EQ(format.sampleRate, 4800u);
+  EXPECT_EQ(format.samplesPerCycle, 80);
+  EXPECT_EQ(format.nominalFrequency, 60);
+
+  // The buffer holds 100 ms at the detected rate
+  std::vector<SVSample> samples = capture.getSamples();
+  ASSERT_EQ(samples.size(), 480u);
+  const SVSample &last = samples.back();
+  EXPECT_EQ(last.timestamp, t0 + 1000000);
+  EXPECT_DOUBLE_EQ(scaledValue(last, 3), 4.0);
+  EXPECT_DOUBLE_EQ(scaledValue(last, 4), 600.0);
+  EXPECT_EQ(last.quality[4], 0x2000u);
+  EXPECT_EQ(samples[samples.size() - 2].values[7], 700);
+  EXPECT_EQ(samples[samples.size() - 2].timestamp,
+            t0 + 4799 * 1000000ull / 4800);
+  EXPECT_EQ(capture.getLostSamples(), 0u);
+}
+
+TEST(SVWaveformCaptureTest, CompletesAfterPostTriggerDuration) {
+  SVWaveformCapture capture;
+  CaptureConfig config;
+  config.durationMs = 100;
+  config.preTriggerMs = 50;
+  capture.start(config);
+
+  const uint64_t t0 = 1700000000ull * 1000000;
+  auto feed = [&](uint16_t from, uint16_t to) {
+    for (uint16_t smpCnt = from; smpCnt < to; ++smpCnt) {
+      SVSample sample;
+      sample.smpCnt = smpCnt;
+      sample.synchronised = true;
+      sample.values[0] = smpCnt;
+      capture.addSample(sample, t0 + smpCnt * 250ull);
+    }
+  };
+  feed(0, 1000);
+  capture.trigger();
+  feed(1000, 2000);
+  EXPECT_FALSE(capture.isCapturing());
+
+  // 50 ms before the trigger and 100 ms from it, at 4000 Hz
+  std::vector<SVSample> samples = capture.getSamples();
+  ASSERT_EQ(samples.size(), 600u);
+  EXPECT_EQ(samples.front().values[0], 800);
+  EXPECT_EQ(samples.back().values[0], 1399);
+  EXPECT_EQ(samples.back().timestamp, t0 + 1399 * 250);
+}
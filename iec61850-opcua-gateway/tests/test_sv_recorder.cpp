@@ -0,0 +1,184 @@
+#include "iec61850/sv/sv_recorder.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace gateway;
+using namespace gateway::iec61850::sv;
+
+namespace {
+
+// 14/11/2023 22:13:20 UTC
+constexpr uint64_t kT0 = 1700000000ull * 1000000;
+
+std::string testDirectory(const char *name) {
+  auto path = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove_all(path);
+  return path.string();
+}
+
+std::vector<std::string> readLines(const std::string &path) {
+  std::ifstream in(path);
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+SVSample sample(uint32_t n) {
+  SVSample s;
+  s.timestamp = kT0 + n * 250ull; // 4000 Hz
+  s.smpCnt = static_cast<uint16_t>(n % 4000);
+  s.synchronised = true;
+  s.values[0] = static_cast<int32_t>(n);
+  return s;
+}
+
+// Polls getStats() until @p done or a second has passed
+template <typename Done> bool waitFor(const SVRecorder &recorder, Done done) {
+  for (int i = 0; i < 100; ++i) {
+    if (done(recorder.getStats()))
+      return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return false;
+}
+
+} // namespace
+
+TEST(SampleSegmentTest, AppendsFindsAndDeletesWhenRetired) {
+  std::string path = testDirectory("sample_segment_test");
+  std::filesystem::create_directories(path);
+  path += "/segment.svseg";
+
+  auto segment = SampleSegment::create(path, 1000, 4);
+  ASSERT_TRUE(segment);
+  EXPECT_EQ(segment->fileSize(), 64 + 4 * sizeof(SVSample));
+  EXPECT_EQ(std::filesystem::file_size(path), segment->fileSize());
+  for (uint32_t n = 0; n < 4; ++n)
+    EXPECT_TRUE(segment->append(sample(n)));
+  EXPECT_FALSE(segment->append(sample(4)));
+  EXPECT_TRUE(segment->full());
+  EXPECT_EQ(segment->endIndex(), 1004u);
+  EXPECT_EQ(segment->at(1002).values[0], 2);
+  EXPECT_EQ(segment->lowerBound(kT0 + 300), 1002u);
+  EXPECT_EQ(segment->lowerBound(kT0 + 500), 1002u);
+  EXPECT_EQ(segment->lowerBound(kT0 + 10000), 1004u);
+
+  // Readers keep a retired segment alive
+  std::shared_ptr<SampleSegment> reader = segment;
+  segment->retire();
+  segment.reset();
+  EXPECT_TRUE(std::filesystem::exists(path));
+  reader.reset();
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST(SampleSegmentTest, ScansOnceTimesGoBack) {
+  std::string path = testDirectory("sample_segment_test");
+  std::filesystem::create_directories(path);
+  path += "/unordered.svseg";
+
+  auto segment = SampleSegment::create(path, 0, 4);
+  ASSERT_TRUE(segment);
+  // Late samples: smpCnt 1 and 2 arrive after 3
+  for (uint32_t n : {0u, 3u, 1u, 2u})
+    EXPECT_TRUE(segment->append(sample(n)));
+  EXPECT_EQ(segment->lowerBound(kT0 + 500), 1u);
+  EXPECT_EQ(segment->lowerBound(kT0 + 800), 4u);
+  segment->retire();
+}
+
+TEST(SVRecorderTest, CutsOverlappingTriggersFromSegments) {
+  core::SVConfig config;
+  config.streams.push_back({0x4000, "MU01", "", ""});
+  config.streams.push_back({0x4001, "MU02", "", ""});
+  config.recording.directory = testDirectory("sv_recorder_test");
+  config.recording.segmentSeconds = 1;
+  config.recording.preTriggerMs = 200;
+  config.recording.postTriggerMs = 300;
+  config.recording.currentThreshold = 50.0;
+  config.recording.gooseTriggers = {"IED1/PROT/PTRC1.Tr.general"};
+
+  SVRecorder recorder(config);
+  ASSERT_TRUE(recorder.start());
+  SVStreamFormat format;
+  const uint64_t segmentBytes = 64 + 4000 * sizeof(SVSample);
+
+  // Three one-second segments of MU01
+  for (uint32_t second = 0; second < 3; ++second) {
+    for (uint32_t n = second * 4000; n < (second + 1) * 4000; ++n) {
+      SVSample s = sample(n);
+      if (n == 8000 || n == 8004)
+        s.values[0] = 60000; // 60 A, the second one held off
+      recorder.record(0, s, format);
+      if (n == 7600) {
+        EXPECT_EQ(recorder.trigger("REST", "MU01", s.timestamp), 1u);
+      }
+    }
+    // The next segment is made ahead, on the housekeeping thread
+    ASSERT_TRUE(waitFor(recorder, [&](const RecorderStats &stats) {
+      return stats.streams[0].diskBytes == (second + 2) * segmentBytes;
+    }));
+  }
+
+  ASSERT_TRUE(waitFor(recorder, [](const RecorderStats &stats) {
+    return stats.recordings.size() == 2;
+  }));
+  RecorderStats stats = recorder.getStats();
+  EXPECT_EQ(stats.triggers, 2u);
+  EXPECT_EQ(stats.streams[0].samples, 12000u);
+  EXPECT_EQ(stats.streams[0].dropped, 0u);
+  EXPECT_EQ(stats.streams[0].segments, 3u);
+  EXPECT_EQ(stats.streams[0].oldestUs, kT0);
+  EXPECT_EQ(stats.streams[1].samples, 0u);
+
+  // The last second by default, straight from the segments
+  WaveformEnvelope waveform;
+  ASSERT_TRUE(recorder.waveform("MU01", 0, 0, 100, waveform));
+  EXPECT_EQ(waveform.toUs, kT0 + 11999 * 250 + 1);
+  EXPECT_EQ(waveform.buckets, 100u);
+  EXPECT_EQ(waveform.samples, 4000u);
+  EXPECT_EQ(waveform.max[99 * kChannels], 11999);
+  EXPECT_FALSE(recorder.waveform("MU03", 0, 0, 100, waveform));
+
+  // 200 ms before and 300 ms after each trigger, both ends included
+  const RecordingInfo &rest = stats.recordings[0];
+  EXPECT_EQ(rest.reason, "REST");
+  EXPECT_TRUE(rest.written);
+  EXPECT_EQ(rest.rows, 2001u);
+  std::vector<std::string> cfg = readLines(rest.path + ".cfg");
+  ASSERT_GT(cfg.size(), 24u);
+  EXPECT_EQ(cfg[0], "GATEWAY,MU01,2013");
+  EXPECT_EQ(cfg[21], "4000,2001");
+  EXPECT_EQ(cfg[22], "14/11/2023,22:13:21.700000");
+  EXPECT_EQ(cfg[23], "14/11/2023,22:13:21.900000");
+
+  const RecordingInfo &threshold = stats.recordings[1];
+  EXPECT_EQ(threshold.reason, "Ia above 50 A");
+  EXPECT_EQ(threshold.triggerUs, kT0 + 2000000);
+  EXPECT_EQ(threshold.rows, 2001u);
+  EXPECT_EQ(readLines(threshold.path + ".hdr")[0], "Trigger: Ia above 50 A");
+
+  // A GOOSE trip triggers both streams once per rise
+  MmsValue *trip = MmsValue_newBoolean(true);
+  recorder.onGooseValue("IED1/PROT/PTRC1.Tr.general", trip);
+  recorder.onGooseValue("IED1/PROT/PTRC1.Tr.general", trip);
+  recorder.onGooseValue("IED1/PROT/PTRC1.Op.general", trip);
+  MmsValue_delete(trip);
+  EXPECT_EQ(recorder.getStats().triggers, 4u);
+
+  // Written on stop with what there is: nothing
+  recorder.stop();
+  stats = recorder.getStats();
+  ASSERT_EQ(stats.recordings.size(), 4u);
+  EXPECT_EQ(stats.recordings[2].reason, "GOOSE IED1/PROT/PTRC1.Tr.general");
+  EXPECT_FALSE(stats.recordings[2].written);
+  EXPECT_EQ(stats.pendingTriggers, 0u);
+}
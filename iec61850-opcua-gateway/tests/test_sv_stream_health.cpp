@@ -0,0 +1,87 @@
+#include "iec61850/sv/sv_stream_health.h"
+#include <gtest/gtest.h>
+
+using namespace gateway::iec61850::sv;
+
+namespace {
+SVFrameInfo frame(uint64_t arrivalUs, uint16_t smpCnt, bool synch = true,
+                  uint32_t confRev = 1) {
+  SVFrameInfo f;
+  f.arrivalUs = arrivalUs;
+  f.smpCnt = smpCnt;
+  f.synchronised = synch;
+  f.confRev = confRev;
+  return f;
+}
+} // namespace
+
+TEST(SVStreamHealthTest, CleanStreamAcrossTheWrap) {
+  SVStreamHealth health;
+  // 4000 Hz: one sample every 250 us, smpCnt wrapping after 3999
+  for (uint32_t n = 3990; n < 4010; ++n)
+    health.record(frame(n * 250ull, static_cast<uint16_t>(n % 4000)), 4000);
+
+  SVHealthSnapshot s = health.snapshot();
+  EXPECT_EQ(s.samples, 20u);
+  EXPECT_EQ(s.missingSamples, 0u);
+  EXPECT_EQ(s.gaps, 0u);
+  EXPECT_EQ(s.duplicates, 0u);
+  EXPECT_EQ(s.outOfOrder, 0u);
+  EXPECT_EQ(s.jitter[0], 19u);
+  EXPECT_EQ(s.maxJitterUs, 0u);
+  EXPECT_TRUE(s.synchronised);
+  EXPECT_EQ(s.confRev, 1u);
+  EXPECT_EQ(s.lastArrivalUs, 4009 * 250ull);
+}
+
+TEST(SVStreamHealthTest, TellsLateSamplesFromDuplicates) {
+  SVStreamHealth health;
+  health.record(frame(0, 10), 4000);
+  health.record(frame(250, 11), 4000);
+  health.record(frame(1000, 14), 4000); // 12 and 13 missing
+  health.record(frame(1010, 12), 4000); // Late, no longer missing
+  health.record(frame(1020, 12), 4000); // Again: a duplicate
+  health.record(frame(1030, 14), 4000); // Duplicate of the last
+  health.record(frame(1250, 15), 4000);
+
+  SVHealthSnapshot s = health.snapshot();
+  EXPECT_EQ(s.samples, 7u);
+  EXPECT_EQ(s.gaps, 1u);
+  EXPECT_EQ(s.missingSamples, 1u);
+  EXPECT_EQ(s.outOfOrder, 1u);
+  EXPECT_EQ(s.duplicates, 2u);
+  // Every in-order interval matched its sample periods
+  EXPECT_EQ(s.jitter[0], 3u);
+}
+
+TEST(SVStreamHealthTest, JitterSynchAndConfRevChanges) {
+  SVStreamHealth health;
+  health.record(frame(0, 0), 4000);
+  health.record(frame(290, 1), 4000);         // 40 us late
+  health.record(frame(500, 2, false), 4000);  // 40 us early, lost synch
+  health.record(frame(2750, 3, false), 4000); // 2 ms stall
+  health.record(frame(3000, 4, true, 2), 4000);
+
+  SVHealthSnapshot s = health.snapshot();
+  EXPECT_EQ(s.jitter[2], 2u); // <= 50 us
+  EXPECT_EQ(s.jitter[kArrivalJitterBuckets - 1], 1u);
+  EXPECT_EQ(s.jitter[0], 1u);
+  EXPECT_EQ(s.maxJitterUs, 2000u);
+  EXPECT_EQ(s.synchChanges, 2u);
+  EXPECT_EQ(s.lastSynchChangeUs, 3000u);
+  EXPECT_TRUE(s.synchronised);
+  EXPECT_EQ(s.confRevChanges, 1u);
+  EXPECT_EQ(s.lastConfRevChangeUs, 3000u);
+  EXPECT_EQ(s.confRev, 2u);
+}
+
+TEST(SVStreamHealthTest, CountsMalformedASDUs) {
+  SVStreamHealth health;
+  health.record(frame(0, 0), 4000);
+  health.recordMalformed(250);
+
+  SVHealthSnapshot s = health.snapshot();
+  EXPECT_EQ(s.malformed, 1u);
+  EXPECT_EQ(s.samples, 1u);
+  EXPECT_EQ(s.lastArrivalUs, 250u);
+}
@@ -0,0 +1,158 @@
+#include "iec61850/sv/sv_stream_merger.h"
+#include <gtest/gtest.h>
+
+using namespace gateway::iec61850::sv;
+
+namespace {
+
+// 14/11/2023 22:13:20 UTC, the top of a second
+constexpr uint64_t kT0 = 1700000000ull * 1000000;
+constexpr SVStreamFormat kFormat = {4000, 80, 50, true};
+
+// Sample n of a synchronised 4000 Hz stream; Ia carries @p value
+SVSample sample(uint32_t n, int32_t value, bool synchronised = true) {
+  SVSample s;
+  s.timestamp = kT0 + n * 250ull;
+  s.smpCnt = static_cast<uint16_t>(n % 4000);
+  s.synchronised = synchronised;
+  s.values[0] = value;
+  return s;
+}
+
+struct Collected {
+  uint64_t sampleIndex;
+  uint32_t present;
+  int32_t a;
+  int32_t b;
+};
+
+} // namespace
+
+TEST(SVStreamMergerTest, AlignsOnSmpCntDespiteArrivalSkew) {
+  // 2 ms of skew: 8 samples at 4000 Hz
+  SVStreamMerger merger({"MU01", "MU02"}, 2000);
+  std::vector<Collected> frames;
+  merger.setFrameSink([&](const MergedFrame &f) {
+    frames.push_back({f.sampleIndex, f.present, f.samples[0].values[0],
+                      f.samples[1].values[0]});
+  });
+
+  // MU02 arrives 3 samples (750 us) behind MU01, across the wrap
+  for (uint32_t n = 3990; n < 4010; ++n) {
+    uint64_t arrival = kT0 + n * 250ull + 100;
+    merger.add(0, sample(n, n), kFormat, arrival);
+    if (n >= 3993)
+      merger.add(1, sample(n - 3, -(n - 3)), kFormat, arrival);
+  }
+  merger.poll(kT0 + 4009 * 250ull + 100);
+
+  ASSERT_EQ(frames.size(), 17u);
+  for (size_t i = 0; i < frames.size(); ++i) {
+    uint32_t n = 3990 + static_cast<uint32_t>(i);
+    EXPECT_EQ(frames[i].sampleIndex, 1700000000ull * 4000 + n);
+    EXPECT_EQ(frames[i].present, 3u);
+    EXPECT_EQ(frames[i].a, static_cast<int32_t>(n));
+    EXPECT_EQ(frames[i].b, -static_cast<int32_t>(n));
+  }
+
+  MergeStats stats = merger.getStats();
+  EXPECT_EQ(stats.sampleRate, 4000u);
+  EXPECT_EQ(stats.frames, 17u);
+  EXPECT_EQ(stats.completeFrames, 17u);
+  EXPECT_EQ(stats.maxLatencyUs, 750u);
+  EXPECT_EQ(stats.latency[4], 17u); // <= 1000 us
+  EXPECT_EQ(stats.streams[1].maxLagUs, 750u);
+  EXPECT_DOUBLE_EQ(stats.streams[1].avgLagUs, 750.0);
+  EXPECT_EQ(stats.streams[0].maxLagUs, 0u);
+}
+
+TEST(SVStreamMergerTest, EmitsPartialFramesAndCountsLateSamples) {
+  SVStreamMerger merger({"MU01", "MU02"}, 2000);
+  std::vector<Collected> frames;
+  merger.setFrameSink([&](const MergedFrame &f) {
+    frames.push_back({f.sampleIndex, f.present, f.samples[0].values[0], 0});
+  });
+
+  for (uint32_t n = 0; n < 20; ++n) {
+    uint64_t arrival = kT0 + n * 250ull;
+    merger.add(0, sample(n, n), kFormat, arrival);
+    if (n != 5) // MU02 loses sample 5
+      merger.add(1, sample(n, n), kFormat, arrival);
+  }
+  // Frame 5 went out without MU02 once MU01 was over 8 samples ahead
+  merger.add(1, sample(5, 5), kFormat, kT0 + 20 * 250);
+  // Unsynchronised: not matched
+  merger.add(1, sample(20, 20, false), kFormat, kT0 + 20 * 250);
+  merger.poll(kT0 + 20 * 250);
+
+  ASSERT_EQ(frames.size(), 20u);
+  EXPECT_EQ(frames[5].present, 1u);
+  EXPECT_EQ(frames[5].a, 5);
+  MergeStats stats = merger.getStats();
+  EXPECT_EQ(stats.completeFrames, 19u);
+  EXPECT_EQ(stats.streams[1].missing, 1u);
+  EXPECT_EQ(stats.streams[1].late, 1u);
+  EXPECT_EQ(stats.streams[1].unaligned, 1u);
+  EXPECT_EQ(stats.streams[1].samples, 21u);
+}
+
+TEST(SVStreamMergerTest, PollReleasesFramesOfASilentStream) {
+  SVStreamMerger merger({"MU01", "MU02", "MU03"}, 2000);
+  std::vector<Collected> frames;
+  merger.setFrameSink([&](const MergedFrame &f) {
+    frames.push_back({f.sampleIndex, f.present, 0, 0});
+  });
+
+  // MU03 is silent; its frames wait for it up to the skew
+  merger.add(0, sample(0, 0), kFormat, kT0);
+  merger.add(1, sample(0, 0), kFormat, kT0 + 10);
+  merger.poll(kT0 + 1999);
+  EXPECT_TRUE(frames.empty());
+  merger.poll(kT0 + 2000);
+  ASSERT_EQ(frames.size(), 1u);
+  EXPECT_EQ(frames[0].present, 3u);
+  EXPECT_EQ(merger.getStats().maxLatencyUs, 2000u);
+
+  // A second later with nothing aligned: start over there
+  merger.add(0, sample(8000, 0), kFormat, kT0 + 2000000);
+  merger.poll(kT0 + 2000000);
+  EXPECT_EQ(merger.getStats().resyncs, 1u);
+  merger.add(1, sample(8000, 0), kFormat, kT0 + 2000000);
+  merger.add(2, sample(8000, 0), kFormat, kT0 + 2000000);
+  merger.poll(kT0 + 2000000);
+  ASSERT_EQ(frames.size(), 2u);
+  EXPECT_EQ(frames[1].present, 7u);
+  EXPECT_EQ(frames[1].sampleIndex, 1700000002ull * 4000);
+}
+
+TEST(SVStreamMergerTest, TakesHandedOverSamplesInArrivalOrder) {
+  SVStreamMerger merger({"MU01", "MU02"}, 2000);
+  std::vector<Collected> frames;
+  merger.setFrameSink([&](const MergedFrame &f) {
+    frames.push_back({f.sampleIndex, f.present, f.samples[0].values[0],
+                      f.samples[1].values[0]});
+  });
+
+  // Each receive thread hands over 40 samples before the poll; 10 ms of
+  // one stream alone would be past the skew if taken stream by stream
+  for (uint32_t n = 0; n < 40; ++n)
+    merger.add(0, sample(n, n), kFormat, kT0 + n * 250ull);
+  for (uint32_t n = 0; n < 40; ++n)
+    merger.add(1, sample(n, -n), kFormat, kT0 + n * 250ull + 50);
+  EXPECT_TRUE(frames.empty());
+  merger.poll(kT0 + 40 * 250);
+
+  ASSERT_EQ(frames.size(), 40u);
+  EXPECT_EQ(merger.getStats().completeFrames, 40u);
+  EXPECT_EQ(merger.getStats().streams[1].maxLagUs, 50u);
+
+  // Not polled for a full hand-off: the rest is dropped, not overwritten
+  for (uint32_t n = 0; n <= SVStreamMerger::kHandOff; ++n)
+    merger.add(0, sample(40 + n, 0), kFormat, kT0 + 10000 + n * 250ull);
+  MergeStats stats = merger.getStats();
+  EXPECT_EQ(stats.streams[0].dropped, 1u);
+  EXPECT_EQ(stats.streams[0].samples, 40u);
+  merger.poll(kT0 + 10000);
+  EXPECT_EQ(merger.getStats().streams[0].samples,
+            40u + SVStreamMerger::kHandOff);
+}
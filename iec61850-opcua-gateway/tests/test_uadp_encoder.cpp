@@ -0,0 +1,76 @@
+#include "opcua/pubsub/uadp_encoder.h"
+#include <gtest/gtest.h>
+
+using namespace gateway::opcua::pubsub;
+
+namespace {
+
+std::vector<uint8_t> encode(UA_Double value) {
+  UA_Variant v;
+  UA_Variant_init(&v);
+  UA_Variant_setScalar(&v, &value, &UA_TYPES[UA_TYPES_DOUBLE]);
+  std::vector<uint8_t> out;
+  UadpEncoder::encodeVariant(v, out);
+  return out;
+}
+
+} // namespace
+
+TEST(UadpEncoderTest, KeyFrameRoundTrip) {
+  auto a = encode(1.5);
+  auto b = encode(-230.25);
+
+  DataSetMessage msg;
+  msg.writerId = 7;
+  msg.sequenceNumber = 42;
+  msg.type = DataSetMessageType::KeyFrame;
+  msg.fields = {{0, &a}, {1, &b}};
+
+  std::vector<uint8_t> buffer;
+  UadpEncoder::encodeNetworkMessage(3, 7, 100, 123456789, {msg}, buffer);
+
+  DecodedNetworkMessage decoded;
+  ASSERT_TRUE(
+      UadpEncoder::decodeNetworkMessage(buffer.data(), buffer.size(), decoded));
+  EXPECT_EQ(decoded.publisherId, 3);
+  EXPECT_EQ(decoded.writerGroupId, 7);
+  EXPECT_EQ(decoded.sequenceNumber, 100);
+  EXPECT_EQ(decoded.timestamp, 123456789);
+  ASSERT_EQ(decoded.messages.size(), 1u);
+  const auto &m = decoded.messages[0];
+  EXPECT_EQ(m.writerId, 7);
+  EXPECT_EQ(m.sequenceNumber, 42);
+  EXPECT_EQ(m.type, DataSetMessageType::KeyFrame);
+  ASSERT_EQ(m.values.size(), 2u);
+  EXPECT_DOUBLE_EQ(m.values[0], 1.5);
+  EXPECT_DOUBLE_EQ(m.values[1], -230.25);
+}
+
+TEST(UadpEncoderTest, DeltaFrameAndKeepAlive) {
+  auto c = encode(9.0);
+
+  DataSetMessage delta;
+  delta.writerId = 1;
+  delta.type = DataSetMessageType::DeltaFrame;
+  delta.fields = {{5, &c}};
+  DataSetMessage keepAlive;
+  keepAlive.writerId = 2;
+  keepAlive.type = DataSetMessageType::KeepAlive;
+
+  std::vector<uint8_t> buffer;
+  UadpEncoder::encodeNetworkMessage(1, 1, 0, 0, {delta, keepAlive}, buffer);
+
+  DecodedNetworkMessage decoded;
+  ASSERT_TRUE(
+      UadpEncoder::decodeNetworkMessage(buffer.data(), buffer.size(), decoded));
+  ASSERT_EQ(decoded.messages.size(), 2u);
+  ASSERT_EQ(decoded.messages[0].fieldIndexes.size(), 1u);
+  EXPECT_EQ(decoded.messages[0].fieldIndexes[0], 5);
+  EXPECT_DOUBLE_EQ(decoded.messages[0].values[0], 9.0);
+  EXPECT_EQ(decoded.messages[1].type, DataSetMessageType::KeepAlive);
+
+  // Truncated buffers are rejected
+  EXPECT_FALSE(
+      UadpEncoder::decodeNetworkMessage(buffer.data(), buffer.size() - 1,
+                                        decoded));
+}
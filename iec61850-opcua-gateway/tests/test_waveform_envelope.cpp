@@ -0,0 +1,84 @@
+#include "iec61850/sv/waveform_envelope.h"
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <gtest/gtest.h>
+
+using namespace gateway::iec61850::sv;
+
+namespace {
+
+constexpr uint64_t kT0 = 1700000000ull * 1000000;
+
+// 4000 Hz samples n .. n + count - 1: Ia = n, Ua = -n
+std::shared_ptr<SampleSegment> segment(const std::string &name, uint32_t n,
+                                       size_t count) {
+  auto path = std::filesystem::temp_directory_path() / "waveform_test";
+  std::filesystem::create_directories(path);
+  auto segment = SampleSegment::create((path / name).string(), n, count);
+  for (uint32_t i = n; i < n + count; ++i) {
+    SVSample s;
+    s.timestamp = kT0 + i * 250ull;
+    s.values[0] = static_cast<int32_t>(i);
+    s.values[4] = -static_cast<int32_t>(i);
+    segment->append(s);
+  }
+  segment->retire();
+  return segment;
+}
+
+} // namespace
+
+TEST(WaveformEnvelopeTest, MinMaxKernelCoversEveryChannel) {
+  std::vector<SVSample> samples(37);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    for (int ch = 0; ch < kChannels; ++ch)
+      samples[i].values[ch] = static_cast<int32_t>((i * 7 + ch * 13) % 37) -
+                              18 + ch * 100;
+  }
+  int32_t min[kChannels], max[kChannels];
+  std::fill(min, min + kChannels, INT32_MAX);
+  std::fill(max, max + kChannels, INT32_MIN);
+  accumulateMinMax(samples.data(), samples.size(), min, max);
+  for (int ch = 0; ch < kChannels; ++ch) {
+    EXPECT_EQ(min[ch], -18 + ch * 100);
+    EXPECT_EQ(max[ch], 18 + ch * 100);
+  }
+}
+
+TEST(WaveformEnvelopeTest, BucketsSpanSegmentsAndShowGaps) {
+  // Samples 0 .. 999 and, after a 1000-sample gap, 2000 .. 2999
+  std::vector<std::shared_ptr<SampleSegment>> segments = {
+      segment("a.svseg", 0, 600), segment("b.svseg", 600, 400),
+      segment("c.svseg", 2000, 1000)};
+
+  // Samples 100 .. 2899 in 14 buckets of 200 sample periods
+  WaveformEnvelope e =
+      envelope(segments, kT0 + 100 * 250, kT0 + 2900 * 250, 14);
+  ASSERT_EQ(e.buckets, 14u);
+  EXPECT_EQ(e.samples, 900u + 900u);
+  EXPECT_EQ(e.counts[0], 200u);
+  // 500 .. 699, across segments a and b
+  EXPECT_EQ(e.counts[2], 200u);
+  EXPECT_EQ(e.min[2 * kChannels], 500);
+  EXPECT_EQ(e.max[2 * kChannels], 699);
+  EXPECT_EQ(e.min[2 * kChannels + 4], -699);
+  EXPECT_EQ(e.counts[4], 100u); // 900 .. 999
+  for (size_t b = 5; b < 9; ++b)
+    EXPECT_EQ(e.counts[b], 0u) << b;
+  EXPECT_EQ(e.counts[9], 100u); // 2000 .. 2099
+  EXPECT_EQ(e.max[13 * kChannels], 2899);
+
+  std::string encoded = encodeEnvelope(e, 0x11); // Ia and Ua
+  ASSERT_EQ(encoded.size(), 32u + 2 * 2 * 14 * sizeof(float));
+  EXPECT_EQ(encoded.substr(0, 4), "GWWF");
+  uint32_t buckets;
+  std::memcpy(&buckets, &encoded[8], sizeof(buckets));
+  EXPECT_EQ(buckets, 14u);
+  float values[2 * 2 * 14];
+  std::memcpy(values, &encoded[32], sizeof(values));
+  EXPECT_FLOAT_EQ(values[2], 0.5f);       // Ia min of bucket 2, in A
+  EXPECT_FLOAT_EQ(values[14 + 2], 0.699f); // Ia max
+  EXPECT_TRUE(std::isnan(values[5]));
+  EXPECT_FLOAT_EQ(values[28 + 2], -6.99f); // Ua min, in V
+}
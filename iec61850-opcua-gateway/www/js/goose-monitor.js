@@ -13,6 +13,8 @@ class GOOSEMonitor {
             networkA: { rate: 0, errors: 0, quality: 100 },
             networkB: { rate: 0, errors: 0, quality: 100 }
         };
+        this.statsTimer = null;
+        this.lastStreams = new Map();
 
         this.init();
     }
@@ -22,6 +24,7 @@ class GOOSEMonitor {
         this.createDefs();
         await this.loadTopologyFromAPI();
         this.startAnimation();
+        this.startStatisticsPolling();
     }
 
     createSVG() {
@@ -1722,6 +1725,178 @@ class GOOSEMonitor {
         window.dispatchEvent(event);
     }
 
+    startStatisticsPolling(intervalMs = 2000) {
+        this.pollStatistics();
+        this.statsTimer = setInterval(() => this.pollStatistics(), intervalMs);
+    }
+
+    async pollStatistics() {
+        try {
+            const response = await fetch('/api/v1/goose/statistics', { cache: 'no-cache' });
+            if (!response.ok) return;
+            this.applyStatistics(await response.json());
+        } catch (error) {
+            console.warn('Error loading GOOSE statistics:', error);
+        }
+    }
+
+    applyStatistics(stats) {
+        const toNetwork = (net) => net ? {
+            rate: net.messageRate,
+            errors: net.errors,
+            quality: net.quality
+        } : { rate: 0, errors: 0, quality: 0 };
+        this.updateNetworkStats(toNetwork(stats.networkA), toNetwork(stats.networkB));
+
+        this.renderNetworkCard('a', stats.networkA);
+        this.renderNetworkCard('b', stats.networkB);
+
+        const gocbs = stats.gocbs || [];
+        const setText = (id, text) => {
+            const el = document.getElementById(id);
+            if (el) el.textContent = text;
+        };
+        setText('goose-subs-count', gocbs.filter(g => g.status === 'online').length);
+        setText('goose-msg-count', gocbs.reduce((sum, g) => sum + g.messages, 0));
+        setText('goose-rate', gocbs.reduce((sum, g) => sum + g.messageRate, 0).toFixed(1));
+        setText('stat-goose-rate', gocbs.reduce((sum, g) => sum + g.messageRate, 0).toFixed(1));
+
+        this.renderSubscriptionTable(gocbs, stats.jitterBucketsUs || []);
+        this.logStreamEvents(gocbs);
+    }
+
+    renderNetworkCard(lan, net) {
+        const title = document.getElementById(`net-${lan}-title`);
+        const dot = document.getElementById(`net-${lan}-dot`);
+        const status = document.getElementById(`net-${lan}-status`);
+        const rate = document.getElementById(`net-${lan}-rate`);
+        const errors = document.getElementById(`net-${lan}-errors`);
+        const quality = document.getElementById(`net-${lan}-quality`);
+        const fill = document.getElementById(`net-${lan}-quality-fill`);
+        if (!rate) return;
+
+        const state = net ? net.status : 'offline';
+        const levels = { online: 'success', degraded: 'warning', offline: 'error' };
+        const dots = { online: 'online', degraded: 'warning', offline: 'offline' };
+
+        if (title && net && net.interface) {
+            title.textContent = `${i18n.t(`goose.lan.${lan}`)} (${net.interface})`;
+        }
+        if (dot) dot.className = `status-dot ${dots[state] || 'offline'}`;
+        if (status) {
+            status.setAttribute('data-i18n', `goose.${state}`);
+            status.textContent = i18n.t(`goose.${state}`);
+        }
+
+        rate.textContent = `${net ? net.messageRate : 0} msg/s`;
+        rate.className = `metric-value ${state === 'online' ? 'success' : ''}`;
+        errors.textContent = net ? net.errors : 0;
+        errors.className = `metric-value ${net && net.errors > 0 ? 'warning' : 'success'}`;
+
+        const hasTraffic = net && state !== 'offline';
+        const q = hasTraffic ? net.quality : 0;
+        quality.textContent = hasTraffic ? `${q.toFixed(1)}%` : '-';
+        quality.className = `metric-value ${hasTraffic ? levels[state] : ''}`;
+        if (fill) {
+            fill.style.width = `${q}%`;
+            fill.className = `quality-fill ${q >= 99 ? 'high' : q >= 95 ? 'medium' : 'low'}`;
+        }
+    }
+
+    // 99th percentile bucket of the heartbeat jitter histogram
+    formatJitter(histogram, bounds) {
+        const total = (histogram || []).reduce((sum, n) => sum + n, 0);
+        if (!total) return '-';
+        let cumulative = 0;
+        for (let i = 0; i < histogram.length; i++) {
+            cumulative += histogram[i];
+            if (cumulative >= total * 0.99) {
+                return i < bounds.length ? `≤ ${bounds[i]} µs` : `> ${bounds[bounds.length - 1]} µs`;
+            }
+        }
+        return '-';
+    }
+
+    renderSubscriptionTable(gocbs, bounds) {
+        const tbody = document.getElementById('goose-table-body');
+        if (!tbody) return;
+
+        if (gocbs.length === 0) {
+            tbody.innerHTML = `<tr><td colspan="8" style="color: var(--text-muted);" data-i18n="goose.nosubs">${i18n.t('goose.nosubs')}</td></tr>`;
+            return;
+        }
+
+        const badges = { online: 'success', expired: 'danger', waiting: 'warning' };
+        tbody.innerHTML = '';
+        gocbs.forEach(g => {
+            const row = document.createElement('tr');
+            const lastMsg = g.messages ? `${(g.msSinceLast / 1000).toFixed(1)}s` : '-';
+            const cells = [
+                g.gocbRef, g.dataSet, null, lastMsg,
+                `${g.messageRate.toFixed(1)} msg/s`,
+                `${g.sqNumGaps} / ${g.stNumGaps}`,
+                g.talExpiries,
+                this.formatJitter(g.jitterHistogram, bounds)
+            ];
+            cells.forEach((value, i) => {
+                const td = document.createElement('td');
+                if (i === 0) {
+                    const code = document.createElement('code');
+                    code.textContent = value;
+                    td.appendChild(code);
+                } else if (i === 2) {
+                    const badge = document.createElement('span');
+                    badge.className = `badge badge-${badges[g.status] || 'secondary'}`;
+                    badge.textContent = i18n.t(`goose.${g.status}`);
+                    td.appendChild(badge);
+                } else {
+                    td.textContent = value;
+                }
+                row.appendChild(td);
+            });
+            tbody.appendChild(row);
+        });
+    }
+
+    // Report state changes and TimeAllowedToLive expiries since the last poll
+    logStreamEvents(gocbs) {
+        const log = document.getElementById('goose-log');
+        gocbs.forEach(g => {
+            const last = this.lastStreams.get(g.gocbRef);
+            this.lastStreams.set(g.gocbRef, g);
+            if (!log || !last) return;
+
+            const events = [];
+            if (g.stateChanges > last.stateChanges) {
+                events.push(`${i18n.t('goose.log.statechange')}: +${g.stateChanges - last.stateChanges}`);
+            }
+            if (g.talExpiries > last.talExpiries) {
+                events.push(i18n.t('goose.log.expired'));
+            }
+            if (g.stNumGaps > last.stNumGaps) {
+                events.push(`${i18n.t('goose.log.lost')}: ${g.stNumGaps - last.stNumGaps}`);
+            }
+            events.forEach(detail => {
+                const entry = document.createElement('div');
+                entry.className = 'log-entry';
+                const time = document.createElement('div');
+                time.className = 'log-time';
+                time.textContent = new Date().toLocaleTimeString();
+                const ref = document.createElement('div');
+                ref.className = 'log-ref';
+                ref.textContent = g.gocbRef;
+                const text = document.createElement('div');
+                text.className = 'log-detail';
+                text.textContent = detail;
+                entry.append(time, ref, text);
+                log.prepend(entry);
+            });
+            while (log.children.length > 50) {
+                log.removeChild(log.lastChild);
+            }
+        });
+    }
+
     updateNodeStatus(nodeId, status) {
         const node = this.nodes.get(nodeId);
         if (!node) return;
@@ -1749,6 +1924,10 @@ class GOOSEMonitor {
     }
 
     destroy() {
+        if (this.statsTimer) {
+            clearInterval(this.statsTimer);
+            this.statsTimer = null;
+        }
         if (this.container && this.svg) {
             this.container.removeChild(this.svg);
         }
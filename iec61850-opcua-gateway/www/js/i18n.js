@@ -98,6 +98,19 @@ const i18n = {
             'goose.online': 'Online',
             'goose.errors': 'Errors',
             'goose.quality': 'Quality',
+            'goose.offline': 'Offline',
+            'goose.degraded': 'Degraded',
+            'goose.expired': 'Expired',
+            'goose.waiting': 'Waiting',
+            'goose.lan.a': 'Network A',
+            'goose.lan.b': 'Network B',
+            'goose.gaps': 'Gaps (sq/st)',
+            'goose.tal': 'TAL Expiries',
+            'goose.jitter': 'Jitter (p99)',
+            'goose.nosubs': 'No GOOSE subscriptions',
+            'goose.log.statechange': 'State change',
+            'goose.log.expired': 'TimeAllowedToLive expired',
+            'goose.log.lost': 'State changes lost',
             // OPC UA
             'opcua.server.status': 'Server Status',
             'opcua.uptime': 'Uptime',
@@ -237,6 +250,19 @@ const i18n = {
             'goose.online': '在线',
             'goose.errors': '错误',
             'goose.quality': '质量',
+            'goose.offline': '离线',
+            'goose.degraded': '降级',
+            'goose.expired': '已超时',
+            'goose.waiting': '等待中',
+            'goose.lan.a': '网络 A',
+            'goose.lan.b': '网络 B',
+            'goose.gaps': '丢帧 (sq/st)',
+            'goose.tal': 'TAL 超时',
+            'goose.jitter': '抖动 (p99)',
+            'goose.nosubs': '无 GOOSE 订阅',
+            'goose.log.statechange': '状态变位',
+            'goose.log.expired': '超出允许生存时间',
+            'goose.log.lost': '丢失的状态变位',
             // OPC UA
             'opcua.server.status': '服务器状态',
             'opcua.uptime': '运行时间',
@@ -376,6 +402,19 @@ const i18n = {
             'goose.online': 'オンライン',
             'goose.errors': 'エラー',
             'goose.quality': '品質',
+            'goose.offline': 'オフライン',
+            'goose.degraded': '劣化',
+            'goose.expired': '期限切れ',
+            'goose.waiting': '待機中',
+            'goose.lan.a': 'ネットワーク A',
+            'goose.lan.b': 'ネットワーク B',
+            'goose.gaps': '欠落 (sq/st)',
+            'goose.tal': 'TAL 超過',
+            'goose.jitter': 'ジッタ (p99)',
+            'goose.nosubs': 'GOOSE サブスクリプションなし',
+            'goose.log.statechange': '状態変化',
+            'goose.log.expired': '許容生存時間超過',
+            'goose.log.lost': '失われた状態変化',
             // OPC UA
             'opcua.server.status': 'サーバーステータス',
             'opcua.uptime': '稼働時間',